@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: allocHook.cpp
+//
+// Desc: Global operator new/delete over malloc/free with the allocation
+//       hook. Kept in its own translation unit so the compiler never sees
+//       a caller's new and delete inlined together.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "allocHook.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<AllocHook> g_hook(NULL);
+
+void setAllocHook(AllocHook hook)
+{
+	g_hook.store(hook, std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	AllocHook hook = g_hook.load(std::memory_order_relaxed);
+	if (hook != NULL)
+		hook();
+	void* p = malloc(size ? size : 1);
+	if (p == NULL)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
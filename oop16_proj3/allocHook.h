@@ -0,0 +1,24 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: allocHook.h
+//
+// Desc: Replacement of the global operator new/delete for the console
+//       tools that count heap allocations (bench/replayHarness,
+//       server/gameServer). Linking allocHook.cpp replaces them for the
+//       whole program; every operator new then calls the hook set with
+//       setAllocHook(), from whatever thread allocates.
+//       Not part of the game project: the game keeps the default
+//       operator new.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __allocHookH__
+#define __allocHookH__
+
+// 할당 한 번마다 불림, 할당하면 안 되고 여러 스레드에서 동시에 불릴 수 있음
+typedef void (*AllocHook)(void);
+
+// NULL이면 세지 않음 (기본)
+void setAllocHook(AllocHook hook);
+
+#endif // __allocHookH__
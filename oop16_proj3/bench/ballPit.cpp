@@ -0,0 +1,166 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: ballPit.cpp
+//
+// Desc: Ball pit stress mode and scalability test of the whole physics
+//       pipeline. Thousands of balls are packed onto a table scaled to hold
+//       them (about half of the floor covered) with random velocities, and
+//       CGame::step() is run for a fixed number of steps, once with the
+//       serial solver and then with the graph-colored solver on 1, 2, 4 ...
+//       threads. For each run it reports:
+//         steps_per_sec       whole CGame::step() (integrate, cushions,
+//                             contacts)
+//         contacts_per_step   average contacts found per step
+//         contacts_per_sec    contacts solved per second of solver time
+//         batches             average color batches per step
+//         find_pct, color_pct, solve_pct   share of the step spent in
+//                             each solver phase
+//         thread<i>_util      busy time of thread i divided by solver time
+//         same_as_1thread     1 if the final state matches the 1-thread
+//                             colored run bit for bit
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. ballPit.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o ballPit
+//         cl /O2 /EHsc /I.. ballPit.cpp ..\game.cpp ..\physics.cpp ..\capsule.cpp ..\contactSolver.cpp ..\workerPool.cpp ..\brickField.cpp ..\levelFormat.cpp ..\snapshotRing.cpp
+//
+//       Usage:
+//         ballPit [--balls N] [--steps S] [--threads T]
+//
+//       Output is CSV: threads,balls,metric,value (threads 0 = serial solver)
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define FILL 0.5f			// 공이 덮는 바닥 비율
+#define MAX_SPEED 3.0f
+
+typedef std::chrono::steady_clock Clock;
+
+static float frand(float lo, float hi) { return lo + (hi - lo) * (rand() / (float)RAND_MAX); }
+
+// 9 x 6 비율의 테이블에 격자로 공을 놓고 임의의 속도를 줌
+static void setupPit(CGame& game, int balls, unsigned int seed)
+{
+	const float area = balls * (float)M_PI * BALL_RADIUS * BALL_RADIUS / FILL;
+	const float depth = sqrtf(area * 6 / 9), width = depth * 9 / 6;
+	TableGeometry table = { width, depth, DEFAULT_TABLE.cushionThickness, DEFAULT_TABLE.cushionHeight };
+
+	CGame::Rules rules = game.getRules();
+	rules.mode = MODE_POOL;			// 포켓 없는 포켓볼, 공 수 제한이 없음
+	game.setRules(rules);
+	game.clearWalls();
+	for (int i = 0; i < TABLE_CUSHIONS; i++) {
+		WallBody w = table.cushion(i);
+		game.addWall(w.x, w.z, w.width, w.depth);
+	}
+	game.clearPockets();
+
+	int cols = (int)(width / (2 * BALL_RADIUS));
+	float cell = width / cols;
+	srand(seed);
+	game.setBallCount(balls);
+	for (int i = 0; i < balls; i++) {
+		game.setBall(i, -width / 2 + cell * (i % cols + 0.5f), -depth / 2 + cell * (i / cols + 0.5f));
+		game.setBallVelocity(i, frand(-MAX_SPEED, MAX_SPEED), frand(-MAX_SPEED, MAX_SPEED));
+	}
+}
+
+struct Run {
+	double		stepSeconds;
+	double		findSeconds, colorSeconds, solveSeconds;
+	long long	contacts;
+	long long	batches;
+	std::vector<double> busy;		// 스레드별
+	std::vector<BallBody> final;
+};
+
+static Run runPit(int balls, int steps, int threads)
+{
+	CGame game;
+	setupPit(game, balls, 7);
+	CContactSolver::Settings settings = game.getSolver().getSettings();
+	settings.threads = threads;
+	game.setSolverSettings(settings);
+
+	Run run;
+	run.stepSeconds = run.findSeconds = run.colorSeconds = run.solveSeconds = 0;
+	run.contacts = run.batches = 0;
+	for (int s = 0; s < steps; s++) {
+		Clock::time_point t0 = Clock::now();
+		game.step(PHYSICS_STEP);
+		run.stepSeconds += std::chrono::duration<double>(Clock::now() - t0).count();
+
+		const CContactSolver& solver = game.getSolver();
+		const CContactSolver::Timing& t = solver.getTiming();
+		run.findSeconds += t.findSeconds;
+		run.colorSeconds += t.colorSeconds;
+		run.solveSeconds += t.solveSeconds;
+		run.contacts += solver.getContactCount();
+		run.batches += solver.getBatchCount();
+	}
+
+	const CWorkerPool* pPool = game.getSolver().getPool();
+	for (int i = 0; pPool != NULL && i < pPool->getThreadCount(); i++)
+		run.busy.push_back(pPool->getStats(i).busySeconds);
+	for (int i = 0; i < game.getBallCount(); i++)
+		run.final.push_back(game.getBall(i));
+	return run;
+}
+
+static void report(int threads, int balls, int steps, const Run& run, const Run* pReference)
+{
+	double solverSeconds = run.findSeconds + run.colorSeconds + run.solveSeconds;
+	printf("%d,%d,steps_per_sec,%.1f\n", threads, balls, steps / run.stepSeconds);
+	printf("%d,%d,contacts_per_step,%.1f\n", threads, balls, (double)run.contacts / steps);
+	printf("%d,%d,contacts_per_sec,%.0f\n", threads, balls, run.contacts / solverSeconds);
+	printf("%d,%d,batches,%.1f\n", threads, balls, (double)run.batches / steps);
+	printf("%d,%d,find_pct,%.1f\n", threads, balls, 100 * run.findSeconds / run.stepSeconds);
+	printf("%d,%d,color_pct,%.1f\n", threads, balls, 100 * run.colorSeconds / run.stepSeconds);
+	printf("%d,%d,solve_pct,%.1f\n", threads, balls, 100 * run.solveSeconds / run.stepSeconds);
+	// 스레드 통계는 solveBatches()의 run() 안에서만 쌓임
+	for (size_t i = 0; i < run.busy.size(); i++)
+		printf("%d,%d,thread%d_util,%.3f\n", threads, balls, (int)i, run.busy[i] / run.solveSeconds);
+	if (pReference != NULL) {
+		bool same = run.final.size() == pReference->final.size() &&
+			memcmp(&run.final[0], &pReference->final[0], run.final.size() * sizeof(BallBody)) == 0;
+		printf("%d,%d,same_as_1thread,%d\n", threads, balls, same ? 1 : 0);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	int balls = 4000;
+	int steps = 240;		// 2초
+	int maxThreads = (int)std::thread::hardware_concurrency();
+	if (maxThreads < 4)
+		maxThreads = 4;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+			balls = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+			steps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			maxThreads = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--balls N] [--steps S] [--threads T]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	printf("threads,balls,metric,value\n");
+	report(0, balls, steps, runPit(balls, steps, 0), NULL);
+	Run one = runPit(balls, steps, 1);
+	report(1, balls, steps, one, &one);
+	for (int t = 2; t <= maxThreads; t *= 2)
+		report(t, balls, steps, runPit(balls, steps, t), &one);
+	return 0;
+}
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: breakBench.cpp
+//
+// Desc: Pool break shot through CGame::step(), the same code the game runs.
+//       A triangle rack of object balls (15 is the real game, larger racks
+//       on a proportionally larger table show how it scales) sits frozen
+//       together, the cue ball is struck at the apex the way WndProc does
+//       it (right-button aim, VK_SPACE), and the table is stepped at the
+//       fixed physics rate until everything stops. For each rack it
+//       reports:
+//         steps            fixed steps until the table settled
+//         break_steps_per_sec   first second of the shot, the cue ball
+//                          reaches the rack within it and the whole rack
+//                          is in dense contact (the worst part of the shot)
+//         steps_per_sec    the whole shot
+//         realtime_x       break_steps_per_sec / PHYSICS_HZ, how many times
+//                          faster than the game needs (must stay above 1
+//                          with room for drawing)
+//         worst_step_us    slowest single step
+//         pocketed         balls that went into a pocket
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. breakBench.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o breakBench
+//         cl /O2 /EHsc /I.. breakBench.cpp ..\game.cpp ..\physics.cpp ..\capsule.cpp ..\contactSolver.cpp ..\workerPool.cpp ..\brickField.cpp ..\levelFormat.cpp ..\snapshotRing.cpp
+//
+//       Output is CSV: balls,metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include <chrono>
+#include <cstdio>
+
+#define POCKET_RADIUS 0.4f
+#define BREAK_POWER 8.0f		// 수구에서 목표(파란 공)까지 거리, 당구채 속도가 됨
+#define MAX_STEPS (PHYSICS_HZ * 120)	// 2분이 지나도 멈추지 않으면 포기
+static const int REPEATS = 3;			// 측정 반복, 가장 빠른 값을 씀
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result {
+	int		steps;
+	int		pocketed;
+	double	breakSeconds;		// 처음 PHYSICS_HZ 스텝
+	double	totalSeconds;
+	double	worstStep;
+};
+
+// rows줄 삼각형 랙, 테이블은 랙 크기에 맞춰 9 x 6 비율로 늘림
+static void setupRack(CGame& game, int rows)
+{
+	const float spacing = 2 * BALL_RADIUS + 0.004f;		// levels/pool.txt와 같은 간격
+	const float rowStep = spacing * 0.8660254f;
+	float scale = rows <= 5 ? 1.0f : rows / 5.0f;
+	TableGeometry table = { DEFAULT_TABLE.width * scale, DEFAULT_TABLE.depth * scale,
+		DEFAULT_TABLE.cushionThickness, DEFAULT_TABLE.cushionHeight };
+
+	CGame::Rules rules = game.getRules();
+	rules.mode = MODE_POOL;
+	rules.startScore = 0;
+	rules.scoreStep = 1;
+	game.setRules(rules);
+
+	game.clearWalls();
+	for (int i = 0; i < TABLE_CUSHIONS; i++) {
+		WallBody w = table.cushion(i);
+		game.addWall(w.x, w.z, w.width, w.depth);
+	}
+	game.clearPockets();
+	for (int i = 0; i < TABLE_POCKETS; i++) {
+		Pocket p = table.pocket(i, POCKET_RADIUS);
+		game.addPocket(p.x, p.z, p.radius);
+	}
+
+	// 수구는 head spot, 랙 꼭짓점은 foot spot
+	float head = -table.width / 4, foot = table.width / 4;
+	game.setBallCount(1 + rows * (rows + 1) / 2);
+	game.setBall(0, head, 0);
+	int index = 1;
+	for (int row = 0; row < rows; row++) {
+		for (int k = 0; k <= row; k++)
+			game.setBall(index++, foot + row * rowStep, (k - row / 2.0f) * spacing);
+	}
+	game.setStick(7, 0.1f);		// Setup()의 당구채
+}
+
+// WndProc처럼 우클릭 이동으로 목표를 꼭짓점 쪽에 두고 스페이스로 침
+static void breakShot(CGame& game)
+{
+	const BallBody& cue = game.getBall(0);
+	float tx = cue.x + BREAK_POWER;
+	float tz = cue.z + 0.01f;		// 정확히 가운데를 맞히면 너무 대칭이라 살짝 비껴 침
+	int px = (int)(-(tx - game.getTargetX()) / 0.007f);
+	int py = (int)((tz - game.getTargetZ()) / 0.007f);
+	game.aim(true, px, py);
+	game.strike();
+}
+
+static Result run(int rows)
+{
+	Result best = { 0, 0, 0, 0, 0 };
+	for (int r = 0; r < REPEATS; r++) {
+		CGame game;
+		setupRack(game, rows);
+		int before = game.getBallCount();
+		breakShot(game);
+
+		Result res = { 0, 0, 0, 0, 0 };
+		Clock::time_point start = Clock::now();
+		while (game.isAnimating() && res.steps < MAX_STEPS) {
+			Clock::time_point t0 = Clock::now();
+			game.step(PHYSICS_STEP);
+			Clock::time_point t1 = Clock::now();
+			double sec = std::chrono::duration<double>(t1 - t0).count();
+			if (sec > res.worstStep)
+				res.worstStep = sec;
+			if (++res.steps == PHYSICS_HZ)
+				res.breakSeconds = std::chrono::duration<double>(t1 - start).count();
+		}
+		res.totalSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+		res.pocketed = before - game.getBallCount();
+
+		if (r == 0 || res.totalSeconds < best.totalSeconds)
+			best = res;
+	}
+	return best;
+}
+
+static void report(int rows)
+{
+	Result res = run(rows);
+	int balls = 1 + rows * (rows + 1) / 2;
+	double breakRate = res.breakSeconds > 0 ? PHYSICS_HZ / res.breakSeconds : 0;
+	printf("%d,steps,%d\n", balls, res.steps);
+	printf("%d,break_steps_per_sec,%.0f\n", balls, breakRate);
+	printf("%d,steps_per_sec,%.0f\n", balls, res.steps / res.totalSeconds);
+	printf("%d,realtime_x,%.1f\n", balls, breakRate / PHYSICS_HZ);
+	printf("%d,worst_step_us,%.2f\n", balls, res.worstStep * 1e6);
+	printf("%d,pocketed,%d\n", balls, res.pocketed);
+}
+
+int main(void)
+{
+	printf("balls,metric,value\n");
+	report(5);		// 15개 랙 + 수구, 실제 게임
+	report(10);
+	report(20);
+	return 0;
+}
@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: brickFieldBench.cpp
+//
+// Desc: Compares the grid lookup of CBrickField against testing every brick
+//       the way CWall::hasIntersected does, for growing brick counts.
+//       Last line tunnel_ok is 1 if a ball that jumps over a one-brick wall in
+//       one step still hits its near face.
+//       Console program, no Direct3D needed:
+//
+//         g++ -O2 -std=c++14 -I.. brickFieldBench.cpp ../brickField.cpp -o brickFieldBench
+//         cl /O2 /EHsc /I.. brickFieldBench.cpp ..\brickField.cpp
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "brickField.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#define M_RADIUS 0.21f
+
+// CWall과 같은 데이터와 같은 판정식
+struct BruteBrick {
+	float m_x, m_z, m_width, m_depth;
+
+	bool hasIntersected(float ballX, float ballZ) const
+	{
+		return fabsf(ballX - m_x) < (m_width / 2) + M_RADIUS && fabsf(ballZ - m_z) < (m_depth / 2) + M_RADIUS;
+	}
+};
+
+struct Ball { float prevX, prevZ, x, z; };
+
+static float frand(float lo, float hi) { return lo + (hi - lo) * (rand() / (float)RAND_MAX); }
+
+int main(void)
+{
+	const int sizes[] = { 10, 32, 100, 200 };	// 한 변의 벽돌 수
+	const int BALLS = 4096;
+	const float CELL_W = 0.6f, CELL_D = 0.4f;
+	const float STEP = 3.3f * 0.7f / 120;		// 120Hz 한 번 갱신 동안 움직이는 거리 비율
+
+	srand(1);
+	printf("bricks,grid_ns_per_ball,brute_ns_per_ball,grid_hits,brute_hits\n");
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+		int n = sizes[s];
+		CBrickField field;
+		field.create(n, n, 0, 0, CELL_W, CELL_D, 1);
+
+		// 절반 정도 벽돌을 제거해서 실제 게임 중간 상태처럼 만듦
+		std::vector<BruteBrick> bricks;
+		for (int row = 0; row < n; row++) {
+			for (int col = 0; col < n; col++) {
+				if (rand() & 1) {
+					field.setBrick(col, row, 0);
+					continue;
+				}
+				BruteBrick b = { field.getCenterX(col), field.getCenterZ(row), CELL_W, CELL_D };
+				bricks.push_back(b);
+			}
+		}
+
+		std::vector<Ball> balls(BALLS);
+		for (int i = 0; i < BALLS; i++) {
+			float vx = frand(-3, 3), vz = frand(-3, 3);
+			balls[i].x = frand(0, n * CELL_W);
+			balls[i].z = frand(0, n * CELL_D);
+			balls[i].prevX = balls[i].x - vx * STEP;
+			balls[i].prevZ = balls[i].z - vz * STEP;
+		}
+
+		// 작은 필드는 측정 시간이 너무 짧으므로 반복
+		int repeat = 1 + 2000 / n;
+
+		int gridHits = 0;
+		auto t0 = std::chrono::high_resolution_clock::now();
+		for (int r = 0; r < repeat; r++) {
+			for (int i = 0; i < BALLS; i++) {
+				CBrickField::Hit hit;
+				gridHits += field.collide(balls[i].prevX, balls[i].prevZ, balls[i].x, balls[i].z, M_RADIUS, &hit);
+			}
+		}
+		auto t1 = std::chrono::high_resolution_clock::now();
+
+		int bruteHits = 0;
+		int bruteRepeat = repeat > 4 ? repeat / 4 : 1;
+		for (int r = 0; r < bruteRepeat; r++) {
+			for (int i = 0; i < BALLS; i++) {
+				for (size_t b = 0; b < bricks.size(); b++) {
+					if (bricks[b].hasIntersected(balls[i].x, balls[i].z)) {
+						bruteHits++;
+						break;
+					}
+				}
+			}
+		}
+		auto t2 = std::chrono::high_resolution_clock::now();
+
+		double gridNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)BALLS * repeat);
+		double bruteNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / ((double)BALLS * bruteRepeat);
+		printf("%d,%.1f,%.1f,%d,%d\n", field.getAliveCount(), gridNs, bruteNs, gridHits / repeat, bruteHits / bruteRepeat);
+	}
+
+	// 한 줄짜리 벽 (z 0.4..0.8)을 한 스텝에 건너뛰는 공, 벽 앞면 (z 0.4 - 반지름)에서 닿아야 함
+	CBrickField wall;
+	wall.create(8, 3, 0, 0, CELL_W, CELL_D, 0);
+	for (int col = 0; col < 8; col++)
+		wall.setBrick(col, 1, 1);
+	CBrickField::Hit hit;
+	float fromZ = 0.4f - M_RADIUS - 0.1f, toZ = 0.8f + M_RADIUS + 0.1f;
+	bool hitWall = wall.collide(2.0f, fromZ, 2.0f, toZ, M_RADIUS, &hit);
+	float hitZ = fromZ + (toZ - fromZ) * hit.time;
+	bool tunnelOk = hitWall && hit.row == 1 && hit.normalZ < 0 && fabsf(hitZ - (0.4f - M_RADIUS)) < 1e-4f;
+	printf("tunnel_ok,%d\n", tunnelOk ? 1 : 0);
+	return tunnelOk ? 0 : 1;
+}
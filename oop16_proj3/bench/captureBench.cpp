@@ -0,0 +1,134 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: captureBench.cpp
+//
+// Desc: The file side of window recording (CFrameWriter) without a device.
+//       A fake render loop produces window-sized frames at the recording
+//       rate and hands each one over the way CFrameCapture::readBack()
+//       does (acquire, copy the rows, submit); the writer thread saves
+//       them. What the render thread pays per frame and whether frames
+//       get dropped shows whether the disk keeps up:
+//         frames              frames produced
+//         written             frames the writer thread saved
+//         dropped             frames with no free buffer (writer behind)
+//         handoff_us_p50/p99/max   acquire + row copy + submit on the
+//                             render thread
+//         write_ms_mean/max   one frame on the writer thread
+//         worst_queued        most frames waiting at once (of --buffers)
+//         mb_per_sec          write throughput
+//         pattern_ok          1 if start() refuses paths with a % other
+//                             than one frame number (%s, %n, two numbers)
+//       --fps 0 produces frames as fast as possible, to see the drop
+//       behaviour when the writer cannot keep up. Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. captureBench.cpp ../frameWriter.cpp -o captureBench
+//         cl /O2 /EHsc /I.. captureBench.cpp ..\frameWriter.cpp
+//
+//         captureBench [--path file.raw|frame%04d.tga] [--frames N] [--fps F] [--buffers B] [--size WxH]
+//
+//       Output is CSV: metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "frameWriter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+	size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[i];
+}
+
+int main(int argc, char* argv[])
+{
+	const char* path = "capture.raw";
+	int frames = 600;
+	int fps = 60;
+	int buffers = 16;			// CAPTURE_BUFFERS
+	int width = 1024, height = 768;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--path") == 0 && i + 1 < argc)
+			path = argv[++i];
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+			fps = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--buffers") == 0 && i + 1 < argc)
+			buffers = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+			sscanf(argv[++i], "%dx%d", &width, &height);
+		else {
+			fprintf(stderr, "usage: %s [--path file.raw|frame%%04d.tga] [--frames N] [--fps F] [--buffers B] [--size WxH]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	CFrameWriter writer;
+	if (!writer.start(path, width, height, buffers)) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 1;
+	}
+
+	// 읽어 온 시스템 메모리 표면 대신, 줄 간격이 더 넓은 버퍼를 프레임마다 조금씩 바꿈
+	int srcPitch = width * 4 + 64;
+	std::vector<unsigned char> surface((size_t)srcPitch * height);
+	std::vector<double> handoff;
+	handoff.reserve(frames);
+
+	Clock::time_point start = Clock::now();
+	Clock::time_point next = start;
+	for (int f = 0; f < frames; f++) {
+		memset(&surface[(size_t)(f % height) * srcPitch], f & 0xff, width * 4);
+
+		Clock::time_point t0 = Clock::now();
+		unsigned char* pFrame = writer.acquire();
+		if (pFrame != NULL) {
+			int pitch = writer.getPitch();
+			for (int y = 0; y < height; y++)
+				memcpy(pFrame + y * pitch, &surface[(size_t)y * srcPitch], pitch);
+			writer.submit(pFrame);
+		}
+		handoff.push_back(std::chrono::duration<double>(Clock::now() - t0).count() * 1e6);
+
+		if (fps > 0) {
+			next += std::chrono::microseconds(1000000 / fps);
+			std::this_thread::sleep_until(next);
+		}
+	}
+	writer.stop();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	CFrameWriter::Stats s = writer.getStats();
+	std::sort(handoff.begin(), handoff.end());
+	printf("metric,value\n");
+	printf("frames,%d\n", frames);
+	printf("written,%lld\n", s.framesWritten);
+	printf("dropped,%lld\n", s.framesDropped);
+	printf("handoff_us_p50,%.1f\n", percentile(handoff, 0.50));
+	printf("handoff_us_p99,%.1f\n", percentile(handoff, 0.99));
+	printf("handoff_us_max,%.1f\n", handoff.empty() ? 0.0 : handoff.back());
+	printf("write_ms_mean,%.2f\n", s.framesWritten > 0 ? s.writeSeconds / s.framesWritten * 1e3 : 0.0);
+	printf("write_ms_max,%.2f\n", s.worstWriteSeconds * 1e3);
+	printf("worst_queued,%d\n", s.worstQueued);
+	printf("mb_per_sec,%.0f\n", s.bytesWritten / seconds / (1024 * 1024));
+
+	// 번호 말고 다른 %가 있는 경로는 파일을 만들기 전에 거절해야 함
+	static const char* bad[] = { "frame%s.tga", "frame%n.tga", "frame%04d_%d.tga", "frame%x.tga", "frame%.tga" };
+	bool patternOk = true;
+	for (int i = 0; i < (int)(sizeof(bad) / sizeof(bad[0])); i++) {
+		CFrameWriter refused;
+		patternOk = !refused.start(bad[i], 4, 4, 1) && patternOk;
+	}
+	printf("pattern_ok,%d\n", patternOk ? 1 : 0);
+	return patternOk ? 0 : 1;
+}
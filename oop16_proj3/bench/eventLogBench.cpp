@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventLogBench.cpp
+//
+// Desc: Cost of CEventLog::log() on the threads that log, and whether the
+//       flush thread keeps up. Each producer thread logs --events contact
+//       records, at --rate per second (a busy table is a few thousand) or
+//       as fast as possible with --rate 0, which overruns the rings on
+//       purpose to show the drop accounting. The file is read back at the
+//       end and every record checked.
+//         log_ns_p50/p99/max  one log() call, timed over batches of 64
+//         logged, dropped     records put in a ring, records lost
+//         written             records in the file (incl. dropped markers)
+//         file_ok             1 if the file holds exactly the logged
+//                             records of every thread, in order
+//         flush_ms_worst      longest flush of all rings
+//         overflow_ok         1 if, with EVENT_MAX_THREADS + 1 threads logging,
+//                             the thread left without a ring loses exactly
+//                             its own records and the others lose none
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. eventLogBench.cpp ../eventLog.cpp -o eventLogBench
+//         cl /O2 /EHsc /I.. eventLogBench.cpp ..\eventLog.cpp
+//
+//         eventLogBench [--threads T] [--events N] [--rate R] [--ring S] [--path file.events]
+//
+//       Output is CSV: metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "eventLog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define BATCH 64
+
+typedef std::chrono::steady_clock Clock;
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+	if (sorted.empty())
+		return 0;
+	size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+	return sorted[i];
+}
+
+// 스레드 t의 k번째 기록은 match = t, f[0] = k 이므로 파일에서 빠짐과 순서를 확인할 수 있음
+static void produce(CEventLog& log, int thread, int events, int rate, std::vector<double>& batchNs)
+{
+	batchNs.reserve(events / BATCH + 1);
+	Clock::time_point next = Clock::now();
+	for (int k = 0; k < events; k += BATCH) {
+		int end = std::min(k + BATCH, events);
+		Clock::time_point t0 = Clock::now();
+		for (int j = k; j < end; j++)
+			log.log(EVENT_CONTACT, 0, thread, (float)j, 0.5f, 1.0f);
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+		batchNs.push_back(ns / (end - k));
+		if (rate > 0) {
+			next += std::chrono::microseconds((long long)(end - k) * 1000000 / rate);
+			std::this_thread::sleep_until(next);
+		}
+	}
+}
+
+// 링보다 하나 많은 스레드가 링이 넘치지 않을 만큼만 기록, 링을 못 받은 스레드의 기록만 버려져야 함
+static bool checkOverflow(const char* path)
+{
+	const int events = 20000;
+	const int threads = EVENT_MAX_THREADS + 1;
+	CEventLog log;
+	if (!log.start(path, events))
+		return false;
+	std::vector<std::vector<double> > batchNs(threads);
+	std::vector<std::thread> producers;
+	for (int t = 0; t < threads; t++)
+		producers.push_back(std::thread(produce, std::ref(log), t, events, 0, std::ref(batchNs[t])));
+	for (int t = 0; t < threads; t++)
+		producers[t].join();
+	log.stop();
+	CEventLog::Stats s = log.getStats();
+	return s.threads == EVENT_MAX_THREADS && s.logged == (long long)EVENT_MAX_THREADS * events && s.dropped == events;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* path = "bench.events";
+	int threads = 4;
+	int events = 200000;
+	int rate = 20000;
+	int ring = EVENT_RING_SIZE;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--path") == 0 && i + 1 < argc)
+			path = argv[++i];
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+			events = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+			rate = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--ring") == 0 && i + 1 < argc)
+			ring = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--threads T] [--events N] [--rate R] [--ring S] [--path file.events]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (threads < 1 || threads > EVENT_MAX_THREADS) {
+		fprintf(stderr, "--threads must be 1..%d\n", EVENT_MAX_THREADS);
+		return 1;
+	}
+
+	CEventLog log;
+	if (!log.start(path, ring)) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return 1;
+	}
+	std::vector<std::vector<double> > batchNs(threads);
+	std::vector<std::thread> producers;
+	Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; t++)
+		producers.push_back(std::thread(produce, std::ref(log), t, events, rate, std::ref(batchNs[t])));
+	for (int t = 0; t < threads; t++)
+		producers[t].join();
+	log.stop();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	CEventLog::Stats s = log.getStats();
+
+	// 스레드마다 f[0]이 늘어나기만 하는지, 버린 수와 합쳐 모두 맞는지
+	bool ok = true;
+	long long records = 0, dropMarks = 0, dropped = 0;
+	std::vector<int> lastSeen(threads, -1);
+	std::vector<long long> seen(threads, 0);
+	FILE* fp = fopen(path, "rb");
+	EventLogHeader h;
+	if (fp == NULL || fread(&h, sizeof(h), 1, fp) != 1 || h.magic != EVENTLOG_MAGIC || h.eventSize != sizeof(LogEvent))
+		ok = false;
+	LogEvent e;
+	while (ok && fread(&e, sizeof(e), 1, fp) == 1) {
+		records++;
+		if (e.type == EVENT_DROPPED) {
+			dropMarks++;
+			dropped += (long long)e.f[0];
+			continue;
+		}
+		int t = e.match;
+		if (e.type != EVENT_CONTACT || t < 0 || t >= threads || (int)e.f[0] <= lastSeen[t]) {
+			ok = false;
+			break;
+		}
+		lastSeen[t] = (int)e.f[0];
+		seen[t]++;
+	}
+	if (fp != NULL)
+		fclose(fp);
+	long long total = 0;
+	for (int t = 0; t < threads; t++)
+		total += seen[t];
+	ok = ok && records == s.written && total == s.logged && dropped == s.dropped &&
+		total + dropped == (long long)threads * events;
+
+	std::vector<double> all;
+	for (int t = 0; t < threads; t++)
+		all.insert(all.end(), batchNs[t].begin(), batchNs[t].end());
+	std::sort(all.begin(), all.end());
+	bool overflowOk = checkOverflow(path);
+
+	printf("metric,value\n");
+	printf("threads,%d\n", threads);
+	printf("events_per_thread,%d\n", events);
+	printf("rate_per_thread,%d\n", rate);
+	printf("ring_events,%d\n", ring);
+	printf("log_ns_p50,%.1f\n", percentile(all, 0.50));
+	printf("log_ns_p99,%.1f\n", percentile(all, 0.99));
+	printf("log_ns_max,%.1f\n", all.empty() ? 0.0 : all.back());
+	printf("logged,%lld\n", s.logged);
+	printf("dropped,%lld\n", s.dropped);
+	printf("written,%lld\n", s.written);
+	printf("drop_markers,%lld\n", dropMarks);
+	printf("file_ok,%d\n", ok ? 1 : 0);
+	printf("flush_ms_worst,%.2f\n", s.worstFlushSeconds * 1e3);
+	printf("overflow_ok,%d\n", overflowOk ? 1 : 0);
+	printf("seconds,%.2f\n", seconds);
+	return ok && overflowOk ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: metricsBench.cpp
+//
+// Desc: Cost of updating the live metrics (metrics.h) on the threads that
+//       update them, all threads hitting the same counter, gauge and
+//       histogram as every server shard does, and of writing them out for
+//       one scrape. Totals are checked against what the threads added.
+//         counter_ns, gauge_ns    one add() / set(), per thread average
+//                                 (with more threads than cores this includes
+//                                 time waiting for a core)
+//         histogram_ns            one observe() over 12 bounds
+//         write_us, write_bytes   one CMetrics::write() of all metrics
+//         totals_ok               1 if every count and sum adds up
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. metricsBench.cpp ../metrics.cpp -o metricsBench
+//         cl /O2 /EHsc /I.. metricsBench.cpp ..\metrics.cpp ws2_32.lib
+//
+//         metricsBench [--threads T] [--updates N]
+//
+//       Output is CSV: metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#define EXTRA_COUNTERS 40		// 실제 서버처럼 지표가 여럿일 때의 write() 시간
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result {
+	double	counterNs;
+	double	gaugeNs;
+	double	histogramNs;
+};
+
+// 스레드마다 같은 지표에 updates번씩, 관찰값은 0..15 ms를 돌아가며
+static void update(CCounter* pCounter, CGauge* pGauge, CHistogram* pHistogram, int thread, int updates, Result& r)
+{
+	Clock::time_point t0 = Clock::now();
+	for (int i = 0; i < updates; i++)
+		pCounter->add();
+	Clock::time_point t1 = Clock::now();
+	for (int i = 0; i < updates; i++)
+		pGauge->set((double)(thread + i));
+	Clock::time_point t2 = Clock::now();
+	for (int i = 0; i < updates; i++)
+		pHistogram->observe((double)(i & 15));
+	Clock::time_point t3 = Clock::now();
+	r.counterNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / updates;
+	r.gaugeNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / updates;
+	r.histogramNs = std::chrono::duration<double, std::nano>(t3 - t2).count() / updates;
+}
+
+int main(int argc, char* argv[])
+{
+	int threads = 4;
+	int updates = 10000000;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--updates") == 0 && i + 1 < argc)
+			updates = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--threads T] [--updates N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (threads < 1 || updates < 1) {
+		fprintf(stderr, "--threads and --updates must be positive\n");
+		return 1;
+	}
+
+	static const double bounds[] = { 0.5, 1, 1.5, 2, 3, 4, 6, 8, 10, 12, 14, 15 };
+	CMetrics metrics;
+	CCounter* pCounter = metrics.addCounter("bench_updates_total", "Counter updated by every thread.");
+	CGauge* pGauge = metrics.addGauge("bench_last_value", "Gauge set by every thread.");
+	CHistogram* pHistogram = metrics.addHistogram("bench_value_ms", "Histogram observed by every thread.",
+		bounds, (int)(sizeof(bounds) / sizeof(bounds[0])));
+	GameMetrics game;
+	if (pCounter == NULL || pGauge == NULL || pHistogram == NULL || !registerGameMetrics(metrics, game)) {
+		fprintf(stderr, "cannot register metrics\n");
+		return 1;
+	}
+	for (int i = 0; i < EXTRA_COUNTERS; i++) {
+		char name[64];
+		sprintf(name, "bench_extra_%d_total", i);
+		metrics.addCounter(name, "Idle counter.")->add((uint64_t)i);
+	}
+
+	std::vector<Result> results(threads);
+	std::vector<std::thread> workers;
+	Clock::time_point start = Clock::now();
+	for (int t = 0; t < threads; t++)
+		workers.push_back(std::thread(update, pCounter, pGauge, pHistogram, t, updates, std::ref(results[t])));
+	for (int t = 0; t < threads; t++)
+		workers[t].join();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	// i & 15 는 0..15가 고르게 나오므로 합과 +Inf 위의 개수를 셈으로 알 수 있음
+	uint64_t buckets[METRIC_MAX_BUCKETS + 1];
+	double sum;
+	pHistogram->read(buckets, sum);
+	uint64_t count = 0;
+	for (int j = 0; j <= pHistogram->getBoundCount(); j++)
+		count += buckets[j];
+	double expectedSum = 0;
+	for (int i = 0; i < updates; i++)
+		expectedSum += (double)(i & 15);
+	expectedSum *= threads;
+	uint64_t total = (uint64_t)threads * updates;
+	bool ok = pCounter->get() == total && count == total && sum == expectedSum &&
+		buckets[pHistogram->getBoundCount()] == 0;
+
+	// 바쁜 서버에서 읽을 때처럼 한 번 데운 뒤 여러 번
+	std::string text;
+	metrics.write(text);
+	const int writes = 200;
+	Clock::time_point w0 = Clock::now();
+	for (int i = 0; i < writes; i++) {
+		text.clear();
+		metrics.write(text);
+	}
+	double writeUs = std::chrono::duration<double, std::micro>(Clock::now() - w0).count() / writes;
+
+	double counterNs = 0, gaugeNs = 0, histogramNs = 0;
+	for (int t = 0; t < threads; t++) {
+		counterNs += results[t].counterNs;
+		gaugeNs += results[t].gaugeNs;
+		histogramNs += results[t].histogramNs;
+	}
+
+	printf("metric,value\n");
+	printf("threads,%d\n", threads);
+	printf("updates_per_thread,%d\n", updates);
+	printf("counter_ns,%.2f\n", counterNs / threads);
+	printf("gauge_ns,%.2f\n", gaugeNs / threads);
+	printf("histogram_ns,%.2f\n", histogramNs / threads);
+	printf("write_us,%.1f\n", writeUs);
+	printf("write_bytes,%u\n", (unsigned int)text.size());
+	printf("totals_ok,%d\n", ok ? 1 : 0);
+	printf("seconds,%.2f\n", seconds);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,407 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physicsBench.cpp
+//
+// Desc: Micro-benchmarks for the table physics in physics.h: the bodies of
+//       CSphere::hasIntersected/hitBy/ballUpdate, CWall::hasIntersected/
+//       hitBy and CStick::hitBy over randomized inputs, plus whole-table
+//       steps for growing ball counts. Console program, no Direct3D needed:
+//
+//         g++ -O2 -std=c++14 -I.. physicsBench.cpp ../physics.cpp ../capsule.cpp -o physicsBench
+//         cl /O2 /EHsc /I.. physicsBench.cpp ..\physics.cpp ..\capsule.cpp
+//
+//       Usage:
+//         physicsBench > new.csv                       run, CSV on stdout
+//         physicsBench --compare old.csv new.csv [pct] diff two runs, exits 1
+//                                                      if any case got slower
+//                                                      than pct (default 10)
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "physics.h"
+#include "table.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#define M_RADIUS 0.21f
+#define DECREASE_RATE 0.9982f
+#define WALL_RESTITUTION 0.7f
+#define PHYSICS_STEP (0.7f / 120)	// 게임과 같은 고정 스텝
+
+static const int INPUTS = 4096;		// 입력 세트 크기, L1/L2에 들어가는 정도
+static const int REPEATS = 7;		// 측정 반복, 가장 빠른 값을 씀
+static const double MIN_TIME = 0.02;	// 한 번 측정의 최소 시간(초)
+
+static float frand(float lo, float hi) { return lo + (hi - lo) * (rand() / (float)RAND_MAX); }
+
+static volatile int g_sink;		// 결과를 버리지 않게 함
+
+typedef std::chrono::steady_clock Clock;
+
+// 측정 결과 한 줄
+struct Result {
+	std::string	name;
+	int			n;			// 공 개수, 단일 연산이면 1
+	double		nsPerOp;
+	double		opsPerRun;
+};
+
+// body() 한 번이 opsPerCall번 연산을 하고, MIN_TIME을 넘길 때까지 반복 횟수를 늘려
+// REPEATS번 잰 값 중 가장 빠른 값을 연산당 ns로 돌려줌 (다른 프로세스 영향을 덜 받음)
+template<typename F>
+static double measure(F body, int opsPerCall)
+{
+	int calls = 1;
+	for (;;) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		if (sec >= MIN_TIME)
+			break;
+		calls *= 2;
+	}
+
+	double best = 0;
+	for (int r = 0; r < REPEATS; r++) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		double ns = sec * 1e9 / ((double)calls * opsPerCall);
+		if (r == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+// 공 두 개가 대략 절반 정도 겹치도록 배치
+static void randomPairs(std::vector<BallBody>& a, std::vector<BallBody>& b)
+{
+	a.resize(INPUTS);
+	b.resize(INPUTS);
+	for (int i = 0; i < INPUTS; i++) {
+		BallBody p = { frand(-4, 4), M_RADIUS, frand(-2.5f, 2.5f), 0, 0, frand(-2, 2), frand(-2, 2), 0, 0, 0 };
+		float angle = frand(0, 6.2832f);
+		float dist = frand(0, 4 * M_RADIUS);
+		BallBody q = { p.x + cosf(angle) * dist, M_RADIUS, p.z + sinf(angle) * dist, 0, 0, frand(-2, 2), frand(-2, 2), 0, 0, 0 };
+		p.prevX = p.x; p.prevZ = p.z;
+		q.prevX = q.x; q.prevZ = q.z;
+		a[i] = p;
+		b[i] = q;
+	}
+}
+
+// 테이블 안쪽 벽 가까이에 공을 흩뿌림, 절반 정도가 벽에 닿음
+static void randomWallInputs(std::vector<WallBody>& walls, std::vector<BallBody>& balls)
+{
+	const WallBody sides[4] = {
+		DEFAULT_TABLE.cushion(0), DEFAULT_TABLE.cushion(1), DEFAULT_TABLE.cushion(2), DEFAULT_TABLE.cushion(3),
+	};
+	walls.resize(INPUTS);
+	balls.resize(INPUTS);
+	for (int i = 0; i < INPUTS; i++) {
+		const WallBody& w = sides[rand() & 3];
+		float gap = frand(-M_RADIUS, 2 * M_RADIUS);
+		BallBody b = { 0, M_RADIUS, 0, 0, 0, frand(-2, 2), frand(-2, 2), 0, 0, 0 };
+		if (w.width > w.depth) {
+			b.x = frand(-4, 4);
+			b.z = w.z - (w.z > 0 ? 1 : -1) * (w.depth / 2 + gap);
+		}
+		else {
+			b.x = w.x - (w.x > 0 ? 1 : -1) * (w.width / 2 + gap);
+			b.z = frand(-2.5f, 2.5f);
+		}
+		b.prevX = b.x; b.prevZ = b.z;
+		walls[i] = w;
+		balls[i] = b;
+	}
+}
+
+// Setup()의 당구채(길이 7, 굵은 쪽 반지름 0.1)를 공 쪽으로 한 스텝 움직인 상태
+static void randomStickInputs(std::vector<StickBody>& sticks, std::vector<BallBody>& balls)
+{
+	sticks.resize(INPUTS);
+	balls.resize(INPUTS);
+	for (int i = 0; i < INPUTS; i++) {
+		BallBody b = { frand(-4, 4), M_RADIUS, frand(-2.5f, 2.5f), 0, 0, 0, 0, 0, 0, 0 };
+		b.prevX = b.x; b.prevZ = b.z;
+
+		float angle = frand(0, 6.2832f);
+		float ux = sinf(angle), uz = cosf(angle);
+		float gap = frand(0, 0.5f);		// 스텝 시작 때 팁과 공 사이 거리
+		float speed = frand(1, 40);
+		StickBody s;
+		s.length = 7;
+		s.radius = 0.1f;
+		s.angle = angle;
+		s.y = M_RADIUS;
+		s.prevX = b.x - ux * (s.length / 2 + M_RADIUS + gap) + frand(-0.3f, 0.3f) * uz;
+		s.prevZ = b.z - uz * (s.length / 2 + M_RADIUS + gap) - frand(-0.3f, 0.3f) * ux;
+		s.vx = ux * speed;
+		s.vz = uz * speed;
+		s.x = s.prevX + s.vx * PHYSICS_TIME_SCALE * PHYSICS_STEP;
+		s.z = s.prevZ + s.vz * PHYSICS_TIME_SCALE * PHYSICS_STEP;
+		sticks[i] = s;
+		balls[i] = b;
+	}
+}
+
+// stepPhysics()의 물리 부분과 같은 순서: 이동, 벽, 공끼리
+struct Table {
+	std::vector<BallBody>	balls;
+	WallBody				walls[4];
+
+	void create(int count)
+	{
+		// 공 밀도가 게임 테이블과 비슷하도록 테이블 크기를 늘림
+		int side = (int)ceil(sqrt((double)count));
+		float spacing = 4 * M_RADIUS;
+		float halfW = side * spacing / 2 + M_RADIUS, halfD = halfW * 2 / 3;
+		if (halfW < 4.5f) { halfW = 4.5f; halfD = 3; }
+		int cols = (int)(2 * halfW / spacing), rows = (int)(2 * halfD / spacing);
+		while (cols * rows < count) { halfD += spacing; rows++; }
+
+		WallBody w[4] = {
+			{ 0, halfD + 0.06f, 2 * halfW, 0.12f }, { 0, -halfD - 0.06f, 2 * halfW, 0.12f },
+			{ halfW + 0.06f, 0, 0.12f, 2 * halfD + 0.24f }, { -halfW - 0.06f, 0, 0.12f, 2 * halfD + 0.24f },
+		};
+		memcpy(walls, w, sizeof(w));
+
+		balls.resize(count);
+		for (int i = 0; i < count; i++) {
+			BallBody& b = balls[i];
+			b.x = -halfW + spacing / 2 + (i % cols) * spacing;
+			b.z = -halfD + spacing / 2 + (i / cols) * spacing;
+			b.y = M_RADIUS;
+			b.prevX = b.x; b.prevZ = b.z;
+			b.vx = frand(-3, 3);
+			b.vz = frand(-3, 3);
+		}
+	}
+
+	void step(float dt)
+	{
+		int n = (int)balls.size();
+		for (int i = 0; i < n; i++) {
+			integrateBall(balls[i], dt, DECREASE_RATE);
+			for (int j = 0; j < 4; j++)
+				collideWall(walls[j], balls[i], M_RADIUS, WALL_RESTITUTION, NULL);
+		}
+		for (int i = 0; i < n; i++) {
+			for (int j = i + 1; j < n; j++)
+				collideBalls(balls[i], balls[j], M_RADIUS, NULL);
+		}
+	}
+};
+
+static int runBenchmarks(void)
+{
+	std::vector<Result> results;
+	srand(1);
+
+	std::vector<BallBody> pa, pb;
+	randomPairs(pa, pb);
+	std::vector<WallBody> walls;
+	std::vector<BallBody> wallBalls;
+	randomWallInputs(walls, wallBalls);
+	std::vector<StickBody> sticks;
+	std::vector<BallBody> stickBalls;
+	randomStickInputs(sticks, stickBalls);
+
+	// 상태를 바꾸는 연산은 매번 입력의 복사본으로 돌려서 반복해도 같은 입력이 되게 함
+	Result r;
+	r.n = 1;
+	r.opsPerRun = INPUTS;
+
+	r.name = "sphere_hasIntersected";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++)
+			hits += ballsOverlap(pa[i], pb[i], M_RADIUS);
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	r.name = "sphere_hitBy";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++) {
+			BallBody a = pa[i], b = pb[i];
+			hits += collideBalls(a, b, M_RADIUS, NULL);
+			g_sink = (int)a.vx;
+		}
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	r.name = "sphere_ballUpdate";
+	r.nsPerOp = measure([&]() {
+		for (int i = 0; i < INPUTS; i++) {
+			BallBody a = pa[i];
+			integrateBall(a, PHYSICS_STEP, DECREASE_RATE);
+			g_sink = (int)a.x;
+		}
+	}, INPUTS);
+	results.push_back(r);
+
+	r.name = "wall_hasIntersected";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++)
+			hits += wallOverlaps(walls[i], wallBalls[i], M_RADIUS);
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	r.name = "wall_hitBy";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++) {
+			BallBody b = wallBalls[i];
+			hits += collideWall(walls[i], b, M_RADIUS, WALL_RESTITUTION, NULL);
+			g_sink = (int)b.vx;
+		}
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	// 방향을 컴파일 때 정한 벽, 입력은 wall_hitBy와 같음
+	r.name = "wall_axis";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++) {
+			BallBody b = wallBalls[i];
+			if (walls[i].width > walls[i].depth)
+				hits += collideAxisWall<WALL_ALONG_X>(walls[i], b, M_RADIUS, WALL_RESTITUTION, NULL);
+			else
+				hits += collideAxisWall<WALL_ALONG_Z>(walls[i], b, M_RADIUS, WALL_RESTITUTION, NULL);
+			g_sink = (int)b.vx;
+		}
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	// 같은 공을 네 쿠션 전체에 대해 한번에 검사 (wall_hitBy는 벽 하나씩)
+	r.name = "wall_tableRect";
+	const TableRect rect = DEFAULT_TABLE.inner();
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++) {
+			BallBody b = wallBalls[i];
+			hits += collideTableRect(rect, b, M_RADIUS, WALL_RESTITUTION, NULL);
+			g_sink = (int)b.vx;
+		}
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	r.name = "stick_hitBy";
+	r.nsPerOp = measure([&]() {
+		int hits = 0;
+		for (int i = 0; i < INPUTS; i++) {
+			StickBody s = sticks[i];
+			BallBody b = stickBalls[i];
+			hits += collideStick(s, b, M_RADIUS);
+			g_sink = (int)b.vx;
+		}
+		g_sink = hits;
+	}, INPUTS);
+	results.push_back(r);
+
+	// 공 개수별 테이블 한 스텝, 2초 분량(240스텝)을 처음 상태부터 매번 다시 돌림
+	const int counts[] = { 4, 16, 64, 256, 1024 };
+	const int STEPS = 240;
+	for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+		Table start;
+		start.create(counts[c]);
+		Table table;
+		r.name = "table_step";
+		r.n = counts[c];
+		r.opsPerRun = STEPS;
+		r.nsPerOp = measure([&]() {
+			table = start;
+			for (int s = 0; s < STEPS; s++)
+				table.step(PHYSICS_STEP);
+			g_sink = (int)table.balls[0].x;
+		}, STEPS);
+		results.push_back(r);
+	}
+
+	printf("name,n,ns_per_op,ops_per_run\n");
+	for (size_t i = 0; i < results.size(); i++)
+		printf("%s,%d,%.3f,%.0f\n", results[i].name.c_str(), results[i].n, results[i].nsPerOp, results[i].opsPerRun);
+	return 0;
+}
+
+// "name,n" -> ns_per_op
+static bool loadResults(const char* path, std::map<std::string, double>& out)
+{
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+	char line[256];
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		char name[128];
+		int n;
+		double ns;
+		if (sscanf(line, "%127[^,],%d,%lf", name, &n, &ns) != 3)
+			continue;		// 머리줄
+		char key[160];
+		sprintf(key, "%s,%d", name, n);
+		out[key] = ns;
+	}
+	fclose(fp);
+	return true;
+}
+
+static int compareResults(const char* oldPath, const char* newPath, double threshold)
+{
+	std::map<std::string, double> before, after;
+	if (!loadResults(oldPath, before) || !loadResults(newPath, after))
+		return 2;
+
+	int regressions = 0;
+	printf("name,n,old_ns,new_ns,change_pct,status\n");
+	for (std::map<std::string, double>::const_iterator it = after.begin(); it != after.end(); ++it) {
+		std::map<std::string, double>::const_iterator old = before.find(it->first);
+		if (old == before.end()) {
+			printf("%s,,%.3f,,new\n", it->first.c_str(), it->second);
+			continue;
+		}
+		double pct = (it->second - old->second) / old->second * 100;
+		const char* status = "ok";
+		if (pct > threshold) {
+			status = "slower";
+			regressions++;
+		}
+		else if (pct < -threshold) {
+			status = "faster";
+		}
+		printf("%s,%.3f,%.3f,%+.1f,%s\n", it->first.c_str(), old->second, it->second, pct, status);
+	}
+	for (std::map<std::string, double>::const_iterator it = before.begin(); it != before.end(); ++it) {
+		if (after.find(it->first) == after.end())
+			printf("%s,%.3f,,,missing\n", it->first.c_str(), it->second);
+	}
+	return regressions > 0 ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc >= 4 && strcmp(argv[1], "--compare") == 0)
+		return compareResults(argv[2], argv[3], argc >= 5 ? atof(argv[4]) : 10.0);
+	if (argc != 1) {
+		fprintf(stderr, "usage: %s [--compare old.csv new.csv [threshold_pct]]\n", argv[0]);
+		return 2;
+	}
+	return runBenchmarks();
+}
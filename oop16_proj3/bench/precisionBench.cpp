@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: precisionBench.cpp
+//
+// Desc: Speed and accuracy of the physics under each scalar policy in
+//       scalar.h (float, double, Fixed). The same tables are stepped with
+//       every policy. Speed is ns per table step. Accuracy is how far the
+//       balls end up from the double run, reported for a single rolling
+//       ball (no collisions) and for full tables where collisions amplify
+//       rounding differences over time. Console program:
+//
+//         g++ -O2 -std=c++14 -I.. precisionBench.cpp ../physics.cpp ../capsule.cpp -o precisionBench
+//         cl /O2 /EHsc /I.. precisionBench.cpp ..\physics.cpp ..\capsule.cpp
+//
+//       Output is CSV: policy,case,n,value (ns_per_step for "speed",
+//       maximum position error in table units for the "error_*" cases).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "physics.h"
+#include "table.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#define M_RADIUS 0.21
+#define DECREASE_RATE 0.9982
+#define WALL_RESTITUTION 0.7
+#define PHYSICS_STEP (0.7 / 120)	// 게임과 같은 고정 스텝
+
+static const int REPEATS = 7;		// 측정 반복, 가장 빠른 값을 씀
+static const double MIN_TIME = 0.02;	// 한 번 측정의 최소 시간(초)
+
+static double drand(double lo, double hi) { return lo + (hi - lo) * (rand() / (double)RAND_MAX); }
+
+static volatile double g_sink;		// 결과를 버리지 않게 함
+
+typedef std::chrono::steady_clock Clock;
+
+// 처음 상태는 double로 만들고 각 정밀도로 한 번만 바꿈
+struct StartBall {
+	double x, z, vx, vz;
+};
+
+// 공 밀도가 게임 테이블과 비슷하도록 테이블 크기를 늘림 (physicsBench의 Table과 같은 배치)
+static void createTable(int count, std::vector<StartBall>& balls, double& halfW, double& halfD)
+{
+	int side = (int)ceil(sqrt((double)count));
+	double spacing = 4 * M_RADIUS;
+	halfW = side * spacing / 2 + M_RADIUS;
+	halfD = halfW * 2 / 3;
+	if (halfW < 4.5) { halfW = 4.5; halfD = 3; }
+	int cols = (int)(2 * halfW / spacing), rows = (int)(2 * halfD / spacing);
+	while (cols * rows < count) { halfD += spacing; rows++; }
+
+	balls.resize(count);
+	for (int i = 0; i < count; i++) {
+		StartBall& b = balls[i];
+		b.x = -halfW + spacing / 2 + (i % cols) * spacing;
+		b.z = -halfD + spacing / 2 + (i / cols) * spacing;
+		b.vx = drand(-3, 3);
+		b.vz = drand(-3, 3);
+	}
+}
+
+// 게임의 CGame::step()에서 공과 쿠션 부분
+template<typename S>
+struct Table {
+	std::vector<BallBodyT<S> >	balls;
+	TableRectT<S>				rect;
+	S							radius, restitution, decreaseRate, dt;
+
+	void create(const std::vector<StartBall>& start, double halfW, double halfD)
+	{
+		TableRectT<S> r = { scalar<S>(-halfW), scalar<S>(halfW), scalar<S>(-halfD), scalar<S>(halfD) };
+		rect = r;
+		radius = scalar<S>(M_RADIUS);
+		restitution = scalar<S>(WALL_RESTITUTION);
+		decreaseRate = scalar<S>(DECREASE_RATE);
+		dt = scalar<S>(PHYSICS_STEP);
+
+		balls.resize(start.size());
+		for (size_t i = 0; i < start.size(); i++) {
+			BallBodyT<S>& b = balls[i];
+			b.x = b.prevX = scalar<S>(start[i].x);
+			b.z = b.prevZ = scalar<S>(start[i].z);
+			b.y = radius;
+			b.vx = scalar<S>(start[i].vx);
+			b.vz = scalar<S>(start[i].vz);
+		}
+	}
+
+	void step(void)
+	{
+		int n = (int)balls.size();
+		for (int i = 0; i < n; i++) {
+			integrateBall(balls[i], dt, decreaseRate);
+			collideTableRect(rect, balls[i], radius, restitution, NULL);
+		}
+		for (int i = 0; i < n; i++) {
+			for (int j = i + 1; j < n; j++)
+				collideBalls(balls[i], balls[j], radius, NULL);
+		}
+	}
+
+	double x(int i) const { return scalarToDouble(balls[i].x); }
+	double z(int i) const { return scalarToDouble(balls[i].z); }
+};
+
+template<typename F>
+static double measure(F body, int opsPerCall)
+{
+	int calls = 1;
+	for (;;) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		if (sec >= MIN_TIME)
+			break;
+		calls *= 2;
+	}
+
+	double best = 0;
+	for (int r = 0; r < REPEATS; r++) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		double ns = sec * 1e9 / ((double)calls * opsPerCall);
+		if (r == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+// 2초 분량(240스텝)을 처음 상태부터 매번 다시 돌림
+template<typename S>
+static double speed(const std::vector<StartBall>& start, double halfW, double halfD)
+{
+	const int STEPS = 240;
+	Table<S> first, table;
+	first.create(start, halfW, halfD);
+	return measure([&]() {
+		table = first;
+		for (int s = 0; s < STEPS; s++)
+			table.step();
+		g_sink = table.x(0);
+	}, STEPS);
+}
+
+// steps만큼 돌린 뒤 double 결과와의 최대 위치 차이
+template<typename S>
+static double error(const std::vector<StartBall>& start, double halfW, double halfD, int steps)
+{
+	Table<S> table;
+	Table<double> reference;
+	table.create(start, halfW, halfD);
+	reference.create(start, halfW, halfD);
+	for (int s = 0; s < steps; s++) {
+		table.step();
+		reference.step();
+	}
+	double worst = 0;
+	for (size_t i = 0; i < start.size(); i++)
+		worst = fmax(worst, hypot(table.x((int)i) - reference.x((int)i), table.z((int)i) - reference.z((int)i)));
+	return worst;
+}
+
+template<typename S>
+static void report(const char* policy)
+{
+	const int counts[] = { 16, 64, 256 };
+	const int horizons[] = { 30, 120, 480 };	// 0.25초, 1초, 4초
+
+	for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+		srand(counts[c]);
+		std::vector<StartBall> start;
+		double halfW, halfD;
+		createTable(counts[c], start, halfW, halfD);
+		printf("%s,speed,%d,%.3f\n", policy, counts[c], speed<S>(start, halfW, halfD));
+	}
+
+	// 공 하나가 벽에 튕기며 멈출 때까지 굴러감, 반올림 오차만 쌓임
+	std::vector<StartBall> single(1);
+	StartBall b = { -2.7, -0.9, 2.5, 1.1 };
+	single[0] = b;
+	printf("%s,error_single_ball_rest,1,%.3g\n", policy, error<S>(single, 4.5, 3, 2400));
+
+	// 충돌이 차이를 키움, 시간이 지날수록 커짐
+	srand(64);
+	std::vector<StartBall> start;
+	double halfW, halfD;
+	createTable(64, start, halfW, halfD);
+	for (int h = 0; h < (int)(sizeof(horizons) / sizeof(horizons[0])); h++) {
+		char name[32];
+		sprintf(name, "error_table_%dsteps", horizons[h]);
+		printf("%s,%s,64,%.3g\n", policy, name, error<S>(start, halfW, halfD, horizons[h]));
+	}
+}
+
+int main(void)
+{
+	printf("policy,case,n,value\n");
+	report<float>("float");
+	report<double>("double");
+	report<Fixed>("fixed");
+	return 0;
+}
@@ -0,0 +1,365 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: replayHarness.cpp
+//
+// Desc: Headless end-to-end run of the game loop. Feeds scripted input into
+//       CGame the same way WndProc does (right-button mouse moves for the
+//       blue target ball, VK_SPACE strikes, 'B', VK_BACK) and advances it
+//       the same way Display does, rewind history included, without a
+//       window or a device, as fast as it can.
+//       Reports frame-time percentiles, time per shot and heap allocations
+//       per frame as CSV. Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. replayHarness.cpp ../allocHook.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o replayHarness
+//         cl /O2 /EHsc /I.. replayHarness.cpp ..\allocHook.cpp ..\game.cpp ..\physics.cpp ..\capsule.cpp ..\contactSolver.cpp ..\workerPool.cpp ..\brickField.cpp ..\levelFormat.cpp ..\snapshotRing.cpp
+//
+//       Usage:
+//         replayHarness [--games N] [--seed S] [--level file.lvl] [--script file.txt]
+//
+//       The default level is ../levels/default.lvl next to the executable.
+//
+//       Without --script every shot is generated from the seed: the target
+//       is dragged toward a random other ball with random power, the cue
+//       tip is moved to a random spot near the center, then the stick is
+//       struck and the table left to settle. A game ends when a score
+//       leaves 0..100 (pool: when only the cue ball is left) or after
+//       MAX_SHOTS shots. A script is a text file with one command per
+//       line, replayed once per game:
+//
+//         aim <dx> <dy>   mouse move with the right button held (pixels, old - new)
+//         release         mouse move with no button, ends aiming
+//         strike          VK_SPACE
+//         tip <right> <up>   arrow key presses, moves the cue tip on the ball
+//         bricks          'B', toggles the ARKANOID bricks
+//         takeback        VK_BACK, takes back the last shot
+//         frames <n>      n frames without input
+//         settle          frames until nothing on the table moves
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include "allocHook.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define FRAME_MS 16.667			// 60Hz 화면 갱신 간격
+#define MAX_SHOTS 200
+#define MAX_SETTLE_FRAMES 20000	// 이 이상 멈추지 않으면 포기
+#define AIM_MOVES 8				// 목표까지 마우스를 나눠 움직이는 횟수
+
+// -----------------------------------------------------------------------------
+// 힙 할당 세기, 프레임 안에서 일어난 할당만 기록함
+// -----------------------------------------------------------------------------
+
+static std::atomic<unsigned long long> g_allocCount(0);
+
+static void countAllocation(void)
+{
+	g_allocCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+typedef std::chrono::steady_clock Clock;
+
+// -----------------------------------------------------------------------------
+// 입력과 측정
+// -----------------------------------------------------------------------------
+
+struct Command {
+	enum Type { AIM, RELEASE, STRIKE, TIP, BRICKS, TAKEBACK, FRAMES, SETTLE } type;
+	int a, b;
+};
+
+class CReplay {
+public:
+	CReplay(void)
+	{
+		m_allocFrames = 0;
+		m_allocTotal = 0;
+		m_shotFrames = 0;
+		m_shotSec = 0;
+		m_inShot = false;
+	}
+
+	void begin(CGame* pGame) { m_pGame = pGame; }
+
+	// Display 한 번에 해당: 물리 진행만 하고 그리지는 않음
+	// 기록용 벡터가 늘어나며 하는 할당은 세지 않도록 측정 구간 밖에서 기록
+	void frame(void)
+	{
+		unsigned long long allocs = g_allocCount;
+		Clock::time_point t0 = Clock::now();
+		m_pGame->advance((float)(FRAME_MS * 0.0007));
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		allocs = g_allocCount - allocs;
+
+		m_frameUs.push_back(sec * 1e6);
+		m_allocTotal += allocs;
+		if (allocs != 0)
+			m_allocFrames++;
+
+		if (m_inShot) {
+			m_shotFrames++;
+			m_shotSec += sec;
+			if (!m_pGame->isAnimating())
+				endShot();
+		}
+	}
+
+	void apply(const Command& c)
+	{
+		switch (c.type) {
+		case Command::AIM:		m_pGame->aim(true, c.a, c.b); frame(); break;
+		case Command::RELEASE:	m_pGame->aim(false, 0, 0); frame(); break;
+		case Command::TIP:		m_pGame->moveTip(c.a, c.b); frame(); break;
+		case Command::BRICKS:	m_pGame->toggleBricks(); frame(); break;
+		case Command::TAKEBACK:	m_pGame->takeBack(); frame(); break;
+		case Command::STRIKE:
+			if (m_pGame->strike())
+				beginShot();
+			frame();
+			break;
+		case Command::FRAMES:
+			for (int i = 0; i < c.a; i++)
+				frame();
+			break;
+		case Command::SETTLE:
+			for (int i = 0; i < MAX_SETTLE_FRAMES && m_pGame->isAnimating(); i++)
+				frame();
+			break;
+		}
+	}
+
+	void report(int games) const
+	{
+		std::vector<double> frames(m_frameUs);
+		std::sort(frames.begin(), frames.end());
+		std::vector<double> shots(m_shotUs);
+		std::sort(shots.begin(), shots.end());
+		double simFrames = 0;
+		for (size_t i = 0; i < m_shotSimFrames.size(); i++)
+			simFrames += m_shotSimFrames[i];
+
+		printf("metric,value\n");
+		printf("games,%d\n", games);
+		printf("frames,%zu\n", frames.size());
+		printf("shots,%zu\n", shots.size());
+		printf("frame_us_p50,%.3f\n", percentile(frames, 0.50));
+		printf("frame_us_p90,%.3f\n", percentile(frames, 0.90));
+		printf("frame_us_p99,%.3f\n", percentile(frames, 0.99));
+		printf("frame_us_p999,%.3f\n", percentile(frames, 0.999));
+		printf("frame_us_max,%.3f\n", frames.empty() ? 0 : frames.back());
+		printf("shot_us_p50,%.3f\n", percentile(shots, 0.50));
+		printf("shot_us_p99,%.3f\n", percentile(shots, 0.99));
+		printf("shot_game_seconds_mean,%.3f\n", shots.empty() ? 0 : simFrames / shots.size() * FRAME_MS / 1000);
+		printf("allocs_per_frame,%.4f\n", frames.empty() ? 0 : (double)m_allocTotal / frames.size());
+		printf("frames_with_allocs,%llu\n", m_allocFrames);
+	}
+
+private:
+	void beginShot(void)
+	{
+		m_inShot = true;
+		m_shotFrames = 0;
+		m_shotSec = 0;
+	}
+	void endShot(void)
+	{
+		m_inShot = false;
+		m_shotUs.push_back(m_shotSec * 1e6);
+		m_shotSimFrames.push_back(m_shotFrames);
+	}
+
+	static double percentile(const std::vector<double>& sorted, double p)
+	{
+		if (sorted.empty())
+			return 0;
+		size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+		return sorted[i];
+	}
+
+	CGame*				m_pGame;
+	std::vector<double>	m_frameUs;		// 프레임마다 걸린 시간
+	std::vector<double>	m_shotUs;		// 친 뒤 모든 공이 멈출 때까지 계산에 든 시간
+	std::vector<int>	m_shotSimFrames;	// 같은 구간의 프레임 수 (게임 안의 시간)
+	unsigned long long	m_allocTotal;
+	unsigned long long	m_allocFrames;
+	int					m_shotFrames;
+	double				m_shotSec;
+	bool				m_inShot;
+};
+
+// -----------------------------------------------------------------------------
+// 스크립트
+// -----------------------------------------------------------------------------
+
+static bool loadScript(const char* path, std::vector<Command>& script)
+{
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return false;
+	}
+	char line[256];
+	int lineNo = 0;
+	bool ok = true;
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		lineNo++;
+		char word[32];
+		Command c = { Command::FRAMES, 0, 0 };
+		if (sscanf(line, "%31s", word) != 1 || word[0] == '#')
+			continue;
+		if (strcmp(word, "aim") == 0 && sscanf(line, "%*s %d %d", &c.a, &c.b) == 2)
+			c.type = Command::AIM;
+		else if (strcmp(word, "release") == 0)
+			c.type = Command::RELEASE;
+		else if (strcmp(word, "strike") == 0)
+			c.type = Command::STRIKE;
+		else if (strcmp(word, "tip") == 0 && sscanf(line, "%*s %d %d", &c.a, &c.b) == 2)
+			c.type = Command::TIP;
+		else if (strcmp(word, "bricks") == 0)
+			c.type = Command::BRICKS;
+		else if (strcmp(word, "takeback") == 0)
+			c.type = Command::TAKEBACK;
+		else if (strcmp(word, "frames") == 0 && sscanf(line, "%*s %d", &c.a) == 1)
+			c.type = Command::FRAMES;
+		else if (strcmp(word, "settle") == 0)
+			c.type = Command::SETTLE;
+		else {
+			fprintf(stderr, "%s:%d: bad command\n", path, lineNo);
+			ok = false;
+			break;
+		}
+		script.push_back(c);
+	}
+	fclose(fp);
+	return ok;
+}
+
+// 지금 칠 공에서 다른 공 하나를 향해 임의의 힘으로 조준하는 입력
+static void generateShot(const CGame& game, std::vector<Command>& out)
+{
+	const BallBody& white = game.getBall(game.getCurrentBall());
+	int other;
+	do {
+		other = rand() % game.getBallCount();
+	} while (other == game.getCurrentBall());
+	const BallBody& aimAt = game.getBall(other);
+
+	float dx = aimAt.x - white.x;
+	float dz = aimAt.z - white.z;
+	float len = sqrtf(dx * dx + dz * dz);
+	float power = 0.5f + 3.5f * (rand() / (float)RAND_MAX);
+	float spread = 0.15f * (rand() / (float)RAND_MAX - 0.5f);	// 정확히 맞히지는 않음
+	float tx = white.x + (dx / len + spread * -dz / len) * power;
+	float tz = white.z + (dz / len + spread * dx / len) * power;
+
+	// CGame::aim()의 0.007 배율을 거꾸로 해서 마우스 이동량으로 바꿈
+	int px = (int)(-(tx - game.getTargetX()) / 0.007f);
+	int py = (int)((tz - game.getTargetZ()) / 0.007f);
+	for (int i = 0; i < AIM_MOVES; i++) {
+		Command c = { Command::AIM, px / AIM_MOVES, py / AIM_MOVES };
+		if (i == AIM_MOVES - 1) {
+			c.a = px - px / AIM_MOVES * (AIM_MOVES - 1);
+			c.b = py - py / AIM_MOVES * (AIM_MOVES - 1);
+		}
+		out.push_back(c);
+	}
+
+	// 당점은 반지름의 0.3 안에서 임의로, 지금 당점에서 화살표를 누른 횟수로 바꿈
+	int right = rand() % 7 - 3, up = rand() % 7 - 3;
+	Command tip = { Command::TIP,
+		right - (int)floorf(game.getTipSide() / TIP_STEP + 0.5f),
+		up - (int)floorf(game.getTipHeight() / TIP_STEP + 0.5f) };
+	out.push_back(tip);
+	Command strike = { Command::STRIKE, 0, 0 };
+	Command settle = { Command::SETTLE, 0, 0 };
+	out.push_back(strike);
+	out.push_back(settle);
+}
+
+static bool isOver(const CGame& game)
+{
+	if (game.getRules().mode == MODE_POOL)
+		return game.isGameOver();
+	for (int p = 1; p <= 2; p++) {
+		if (game.getScore(p) <= 0 || game.getScore(p) >= 100)
+			return true;
+	}
+	return false;
+}
+
+int main(int argc, char* argv[])
+{
+	int games = 20;
+	unsigned int seed = 1;
+	std::string defaultLevel = getToolLevelPath("default.lvl");
+	const char* levelPath = defaultLevel.c_str();
+	const char* scriptPath = NULL;
+	setAllocHook(countAllocation);
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+			games = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = (unsigned int)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+			scriptPath = argv[++i];
+		else {
+			fprintf(stderr, "usage: %s [--games N] [--seed S] [--level file.lvl] [--script file.txt]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	CLevelFile level;
+	if (!level.open(levelPath)) {
+		fprintf(stderr, "cannot open level %s\n", levelPath);
+		return 1;
+	}
+
+	std::vector<Command> script;
+	if (scriptPath != NULL && !loadScript(scriptPath, script))
+		return 1;
+
+	srand(seed);
+	CReplay replay;
+
+	std::vector<Command> shot;
+	shot.reserve(AIM_MOVES + 3);
+	for (int g = 0; g < games; g++) {
+		CGame game;
+		if (!game.loadLevel(level)) {
+			fprintf(stderr, "unsupported level %s\n", levelPath);
+			return 1;
+		}
+		game.setStick(7, 0.1f);		// Setup()의 당구채
+		game.enableHistory(HISTORY_SLOTS, HISTORY_INTERVAL);
+		replay.begin(&game);
+
+		if (!script.empty()) {
+			for (size_t i = 0; i < script.size(); i++)
+				replay.apply(script[i]);
+			Command settle = { Command::SETTLE, 0, 0 };
+			replay.apply(settle);
+			continue;
+		}
+
+		for (int s = 0; s < MAX_SHOTS && !isOver(game); s++) {
+			shot.clear();
+			generateShot(game, shot);
+			for (size_t i = 0; i < shot.size(); i++)
+				replay.apply(shot[i]);
+		}
+	}
+
+	replay.report(games);
+	return 0;
+}
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: snapshotBench.cpp
+//
+// Desc: Cost of the rewind history (CGame::enableHistory). For each level
+//       one shot is played with history on (bricks switched on, so their
+//       state is part of every snapshot), then the flat snapshot copy is
+//       timed on its own into a ring the same size as the game's:
+//         snapshot_bytes   size of one slot
+//         history_kb       whole ring, allocated once
+//         recorded         snapshots the shot left in the history
+//         capture_ns       CGame::saveCompact() into the next ring slot
+//         restore_ns       CGame::restoreCompact() from a ring slot
+//         takeback_us      CGame::takeBack() after the shot
+//         takeback_exact   1 if the table after takeBack() is byte for
+//                          byte the one just before the strike
+//         replay_exact     1 if striking again from there ends the shot
+//                          exactly where the first one did
+//         state_exact      1 if CGame::restoreState() of a Snapshot saved
+//                          before the strike gives the same table
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. snapshotBench.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o snapshotBench
+//         cl /O2 /EHsc /I.. snapshotBench.cpp ..\game.cpp ..\physics.cpp ..\capsule.cpp ..\contactSolver.cpp ..\workerPool.cpp ..\brickField.cpp ..\levelFormat.cpp ..\snapshotRing.cpp
+//
+//         snapshotBench [file.lvl ...]     (default default.lvl and pool.lvl in ../levels
+//                                           next to the executable)
+//
+//       Output is CSV: level,metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define MAX_STEPS (PHYSICS_HZ * 120)	// 2분이 지나도 멈추지 않으면 포기
+static const int ITERATIONS = 1000000;	// 복사 시간 측정 반복
+static const int REPEATS = 3;			// 측정 반복, 가장 빠른 값을 씀
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point t0)
+{
+	return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static void aimShot(CGame& game)
+{
+	const BallBody& cue = game.getBall(game.getCurrentBall());
+	game.aimAt(cue.x + 3.0f, cue.z + 0.7f);
+	game.moveTip(1, -1);
+}
+
+static void finishShot(CGame& game)
+{
+	game.strike();
+	for (int steps = 0; game.isAnimating() && steps < MAX_STEPS; steps++)
+		game.step(PHYSICS_STEP);
+}
+
+// 공 수가 다르면 크기도 달라 뒷부분까지 비교되지 않으므로 먼저 봄
+static bool sameTable(const CGame& game, const std::vector<unsigned char>& saved, std::vector<unsigned char>& scratch)
+{
+	size_t size = game.getCompactSize(game.getBallCount());
+	if (size > saved.size())
+		return false;
+	game.saveCompact(scratch.data());
+	return memcmp(scratch.data(), saved.data(), size) == 0;
+}
+
+static bool report(const char* path)
+{
+	CLevelFile level;
+	CGame game;
+	if (!level.open(path) || !game.loadLevel(level)) {
+		fprintf(stderr, "cannot load level %s\n", path);
+		return false;
+	}
+	game.setStick(7, 0.1f);		// Setup()의 당구채
+	game.toggleBricks();
+	game.enableHistory(HISTORY_SLOTS, HISTORY_INTERVAL);
+
+	size_t slotSize = game.getCompactSize(game.getBallCount());
+	std::vector<unsigned char> before(slotSize, 0), after(slotSize, 0), scratch(slotSize, 0);
+	aimShot(game);
+	game.saveCompact(before.data());
+	CGame::Snapshot state;
+	game.saveState(state);
+	finishShot(game);
+	game.saveCompact(after.data());
+	int recorded = game.getHistoryCount();
+
+	Clock::time_point t0 = Clock::now();
+	bool taken = game.takeBack();
+	double takeBackSeconds = secondsSince(t0);
+	bool takeBackExact = taken && sameTable(game, before, scratch);
+	finishShot(game);
+	bool replayExact = sameTable(game, after, scratch);
+	game.restoreState(state);
+	bool stateExact = sameTable(game, before, scratch);
+
+	// 게임 안의 기록과 같은 크기의 링에 되풀이해서 복사
+	CSnapshotRing ring;
+	ring.create(HISTORY_SLOTS, slotSize);
+	double capture = 0, restore = 0;
+	for (int r = 0; r < REPEATS; r++) {
+		Clock::time_point c0 = Clock::now();
+		for (int i = 0; i < ITERATIONS; i++)
+			game.saveCompact(ring.push(i, false));
+		double c = secondsSince(c0) / ITERATIONS;
+		Clock::time_point r0 = Clock::now();
+		for (int i = 0; i < ITERATIONS; i++)
+			game.restoreCompact(ring.get(i % HISTORY_SLOTS));
+		double s = secondsSince(r0) / ITERATIONS;
+		if (r == 0 || c < capture)
+			capture = c;
+		if (r == 0 || s < restore)
+			restore = s;
+	}
+
+	printf("%s,snapshot_bytes,%d\n", path, (int)slotSize);
+	printf("%s,history_kb,%.0f\n", path, HISTORY_SLOTS * slotSize / 1024.0);
+	printf("%s,recorded,%d\n", path, recorded);
+	printf("%s,capture_ns,%.1f\n", path, capture * 1e9);
+	printf("%s,restore_ns,%.1f\n", path, restore * 1e9);
+	printf("%s,takeback_us,%.2f\n", path, takeBackSeconds * 1e6);
+	printf("%s,takeback_exact,%d\n", path, takeBackExact ? 1 : 0);
+	printf("%s,replay_exact,%d\n", path, replayExact ? 1 : 0);
+	printf("%s,state_exact,%d\n", path, stateExact ? 1 : 0);
+	return takeBackExact && replayExact && stateExact;
+}
+
+int main(int argc, char* argv[])
+{
+	static const char* defaults[] = { "default.lvl", "pool.lvl" };
+	bool ok = true;
+	printf("level,metric,value\n");
+	if (argc > 1) {
+		for (int i = 1; i < argc; i++)
+			ok = report(argv[i]) && ok;
+	}
+	else {
+		for (int i = 0; i < 2; i++)
+			ok = report(getToolLevelPath(defaults[i]).c_str()) && ok;
+	}
+	return ok ? 0 : 1;
+}
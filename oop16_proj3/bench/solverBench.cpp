@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: solverBench.cpp
+//
+// Desc: Clustered collisions with the old pairwise collideBalls loop and
+//       with CContactSolver. Balls are packed into a triangle that just
+//       touches (like a rack), optionally hit by a fast cue ball. For each
+//       method it reports:
+//         ns_per_step      time of one step (integrate, cushions, balls)
+//         max_overlap      deepest overlap left after 2 seconds
+//         energy_ratio     kinetic energy after the first 10 steps divided
+//                          by the energy before (above 1 means it blew up)
+//         max_speed        fastest ball after 2 seconds, a frozen rack
+//                          must stay near 0 instead of exploding
+//         order_diff       largest final position difference when the
+//                          same rack is stepped with balls numbered in
+//                          reverse order
+//       and, for the threaded solver, restart_diff: the largest position
+//       difference between one thread and a run whose thread count is
+//       changed every few steps (restarting the worker pool), must be 0.
+//       Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. solverBench.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp -o solverBench
+//         cl /O2 /EHsc /I.. solverBench.cpp ..\physics.cpp ..\capsule.cpp ..\contactSolver.cpp ..\workerPool.cpp
+//
+//       Output is CSV: method,case,n,metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "contactSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#define M_RADIUS 0.21f
+#define DECREASE_RATE 0.9982f
+#define WALL_RESTITUTION 0.7f
+#define PHYSICS_STEP (0.7f / 120)	// 게임과 같은 고정 스텝
+
+static const int STEPS = 240;		// 2초
+static const int REPEATS = 5;		// 측정 반복, 가장 빠른 값을 씀
+
+typedef std::chrono::steady_clock Clock;
+
+enum Method { PAIRWISE, SOLVER };
+
+struct Table {
+	std::vector<BallBody>	balls;
+	TableRect				rect;
+	CContactSolver			solver;
+
+	void step(Method method)
+	{
+		int n = (int)balls.size();
+		for (int i = 0; i < n; i++) {
+			integrateBall(balls[i], PHYSICS_STEP, DECREASE_RATE);
+			collideTableRect(rect, balls[i], M_RADIUS, WALL_RESTITUTION, NULL);
+		}
+		if (method == SOLVER) {
+			solver.solve(&balls[0], n, M_RADIUS);
+			return;
+		}
+		for (int i = 0; i < n; i++) {
+			for (int j = i + 1; j < n; j++)
+				collideBalls(balls[i], balls[j], M_RADIUS, NULL);
+		}
+	}
+
+	float energy(void) const
+	{
+		float e = 0;
+		for (size_t i = 0; i < balls.size(); i++)
+			e += balls[i].vx * balls[i].vx + balls[i].vz * balls[i].vz;
+		return e;
+	}
+
+	float maxSpeed(void) const
+	{
+		float worst = 0;
+		for (size_t i = 0; i < balls.size(); i++)
+			worst = std::max(worst, hypotf(balls[i].vx, balls[i].vz));
+		return worst;
+	}
+
+	float maxOverlap(void) const
+	{
+		float worst = 0;
+		for (size_t i = 0; i < balls.size(); i++) {
+			for (size_t j = i + 1; j < balls.size(); j++) {
+				float dx = balls[j].x - balls[i].x, dz = balls[j].z - balls[i].z;
+				worst = std::max(worst, 2 * M_RADIUS - sqrtf(dx * dx + dz * dz));
+			}
+		}
+		return worst;
+	}
+};
+
+// 삼각형으로 count개를 쌓음, 이웃끼리 살짝 겹치게 (squeeze) 놓아 얼어붙은 공을 흉내 냄
+// cueSpeed가 0이 아니면 맨 끝에 왼쪽에서 날아오는 공을 하나 더함
+static void rack(Table& table, int count, float squeeze, float cueSpeed)
+{
+	int rows = 1;
+	while (rows * (rows + 1) / 2 < count)
+		rows++;
+	float spacing = 2 * M_RADIUS - squeeze;
+	float rowStep = spacing * 0.8660254f;
+
+	float halfW = std::max(4.5f, rows * spacing + 2), halfD = std::max(3.0f, rows * spacing);
+	TableRect r = { -halfW, halfW, -halfD, halfD };
+	table.rect = r;
+
+	table.balls.clear();
+	for (int row = 0, placed = 0; row < rows && placed < count; row++) {
+		for (int k = 0; k <= row && placed < count; k++, placed++) {
+			BallBody b = { 0, M_RADIUS, 0, 0, 0, 0, 0, 0, 0, 0 };
+			b.x = b.prevX = row * rowStep;
+			b.z = b.prevZ = (k - row / 2.0f) * spacing;
+			table.balls.push_back(b);
+		}
+	}
+	if (cueSpeed != 0) {
+		BallBody cue = { -2.5f, M_RADIUS, 0.01f, -2.5f, 0.01f, cueSpeed, 0, 0, 0, 0 };
+		table.balls.push_back(cue);
+	}
+}
+
+static double timeSteps(const Table& start, Method method)
+{
+	double best = 0;
+	for (int r = 0; r < REPEATS; r++) {
+		Table table = start;
+		Clock::time_point t0 = Clock::now();
+		for (int s = 0; s < STEPS; s++)
+			table.step(method);
+		double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / STEPS;
+		if (r == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+// 공 번호를 거꾸로 매겨 돌린 결과와 비교
+static float orderDiff(const Table& start, Method method)
+{
+	Table forward = start, backward = start;
+	std::reverse(backward.balls.begin(), backward.balls.end());
+	for (int s = 0; s < STEPS; s++) {
+		forward.step(method);
+		backward.step(method);
+	}
+	int n = (int)start.balls.size();
+	float worst = 0;
+	for (int i = 0; i < n; i++) {
+		const BallBody& a = forward.balls[i];
+		const BallBody& b = backward.balls[n - 1 - i];
+		worst = std::max(worst, hypotf(a.x - b.x, a.z - b.z));
+	}
+	return worst;
+}
+
+static void run(const char* name, int count, float squeeze, float cueSpeed)
+{
+	Table start;
+	rack(start, count, squeeze, cueSpeed);
+	int n = (int)start.balls.size();
+
+	const Method methods[2] = { PAIRWISE, SOLVER };
+	const char* methodNames[2] = { "pairwise", "solver" };
+	for (int m = 0; m < 2; m++) {
+		Table table = start;
+		float before = table.energy();
+		for (int s = 0; s < 10; s++)
+			table.step(methods[m]);
+		float after = table.energy();
+		for (int s = 10; s < STEPS; s++)
+			table.step(methods[m]);
+
+		printf("%s,%s,%d,ns_per_step,%.1f\n", methodNames[m], name, n, timeSteps(start, methods[m]));
+		printf("%s,%s,%d,max_overlap,%.4f\n", methodNames[m], name, n, table.maxOverlap());
+		if (before > 0)
+			printf("%s,%s,%d,energy_ratio,%.4f\n", methodNames[m], name, n, after / before);
+		printf("%s,%s,%d,max_speed,%.4f\n", methodNames[m], name, n, table.maxSpeed());
+		printf("%s,%s,%d,order_diff,%.4f\n", methodNames[m], name, n, orderDiff(start, methods[m]));
+	}
+}
+
+// 풀 때마다 다른 스레드 수로 바꿈, 색칠한 묶음은 스레드 수와 상관없이 같은 결과
+static void runRestart(const char* name, int count, float cueSpeed)
+{
+	Table start;
+	rack(start, count, 0.0f, cueSpeed);
+	int n = (int)start.balls.size();
+
+	Table single = start, restarted = start;
+	CContactSolver::Settings settings = single.solver.getSettings();
+	settings.threads = 1;
+	single.solver.setSettings(settings);
+	static const int threadCounts[] = { 2, 3, 1, 4, 2 };
+	for (int s = 0; s < STEPS; s++) {
+		if (s % 20 == 0) {
+			settings.threads = threadCounts[(s / 20) % 5];
+			restarted.solver.setSettings(settings);
+		}
+		single.step(SOLVER);
+		restarted.step(SOLVER);
+	}
+	float worst = 0;
+	for (int i = 0; i < n; i++)
+		worst = std::max(worst, hypotf(single.balls[i].x - restarted.balls[i].x, single.balls[i].z - restarted.balls[i].z));
+	printf("solver,%s,%d,restart_diff,%.4f\n", name, n, worst);
+}
+
+int main(void)
+{
+	printf("method,case,n,metric,value\n");
+	// 초구: 서로 닿아 있는 공 무리에 빠른 공 하나
+	run("break", 15, 0.0f, 12.0f);
+	run("break", 105, 0.0f, 12.0f);
+	// 얼어붙은 공: 0.02씩 겹친 채 멈춰 있음
+	run("frozen", 15, 0.02f, 0.0f);
+	run("frozen", 300, 0.02f, 0.0f);
+	// 큰 무리에 초구
+	run("break", 300, 0.0f, 12.0f);
+	// 스레드 수를 바꿔 가며 (작업 스레드 풀을 다시 시작)
+	runRestart("break", 300, 12.0f);
+	return 0;
+}
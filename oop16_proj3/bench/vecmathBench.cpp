@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: vecmathBench.cpp
+//
+// Desc: Compares the SSE/NEON paths in vecmath.h with plain scalar code for
+//       the operations the renderer runs every frame: Mat4 products
+//       (mLocal * mWorld in CRenderQueue::submit), point transforms and
+//       Vec3 normalize. Also checks that both paths agree. Console program:
+//
+//         g++ -O2 -std=c++14 -I.. vecmathBench.cpp -o vecmathBench
+//         g++ -O2 -std=c++14 -I.. -DVECMATH_NO_SIMD vecmathBench.cpp -o vecmathBench_scalar
+//         cl /O2 /EHsc /I.. vecmathBench.cpp
+//
+//       CSV goes to stdout in the same format as physicsBench, so
+//       "physicsBench --compare" works on it too. The SIMD path in use and
+//       the largest difference from the scalar results go to stderr.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "vecmath.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const int INPUTS = 4096;		// 입력 세트 크기
+static const int REPEATS = 7;		// 측정 반복, 가장 빠른 값을 씀
+static const double MIN_TIME = 0.02;	// 한 번 측정의 최소 시간(초)
+
+static float frand(float lo, float hi) { return lo + (hi - lo) * (rand() / (float)RAND_MAX); }
+
+static volatile float g_sink;		// 결과를 버리지 않게 함
+
+typedef std::chrono::steady_clock Clock;
+
+// physicsBench와 같은 방식: MIN_TIME을 넘길 때까지 반복 횟수를 늘리고 REPEATS번 중 가장 빠른 값
+template<typename F>
+static double measure(F body, int opsPerCall)
+{
+	int calls = 1;
+	for (;;) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		if (sec >= MIN_TIME)
+			break;
+		calls *= 2;
+	}
+
+	double best = 0;
+	for (int r = 0; r < REPEATS; r++) {
+		Clock::time_point t0 = Clock::now();
+		for (int c = 0; c < calls; c++)
+			body();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+		double ns = sec * 1e9 / ((double)calls * opsPerCall);
+		if (r == 0 || ns < best)
+			best = ns;
+	}
+	return best;
+}
+
+// -----------------------------------------------------------------------------
+// 비교 대상 스칼라 코드 (D3DX와 같은 계산 순서)
+// -----------------------------------------------------------------------------
+
+static Mat4 multiplyScalar(const Mat4& a, const Mat4& b)
+{
+	Mat4 r;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+	}
+	return r;
+}
+
+static Vec3 transformCoordScalar(const Vec3& v, const Mat4& m)
+{
+	float x = v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0] + m.m[3][0];
+	float y = v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1] + m.m[3][1];
+	float z = v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2] + m.m[3][2];
+	float w = v.x * m.m[0][3] + v.y * m.m[1][3] + v.z * m.m[2][3] + m.m[3][3];
+	float invW = w != 0 ? 1.0f / w : 0.0f;
+	return Vec3(x * invW, y * invW, z * invW);
+}
+
+// 게임에서 쓰는 것과 비슷한 local 행렬 (크기, 회전, 이동)
+static Mat4 randomLocal(void)
+{
+	float s = frand(0.5f, 2);
+	return Mat4::scaling(s, s, s) * Mat4::rotationX(frand(-1, 1)) * Mat4::rotationY(frand(0, 6.2832f))
+		* Mat4::translation(frand(-4, 4), frand(0, 1), frand(-3, 3));
+}
+
+static float maxDiff(const Mat4& a, const Mat4& b)
+{
+	float d = 0;
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			d = fmaxf(d, fabsf(a.m[i][j] - b.m[i][j]));
+	}
+	return d;
+}
+
+static float maxDiff(const Vec3& a, const Vec3& b)
+{
+	return fmaxf(fabsf(a.x - b.x), fmaxf(fabsf(a.y - b.y), fabsf(a.z - b.z)));
+}
+
+static void report(const char* name, double ns)
+{
+	printf("%s,1,%.3f,%d\n", name, ns, INPUTS);
+}
+
+int main(void)
+{
+	srand(1234);
+
+#if defined(VECMATH_SSE)
+	fprintf(stderr, "vecmath path: SSE\n");
+#elif defined(VECMATH_NEON)
+	fprintf(stderr, "vecmath path: NEON\n");
+#else
+	fprintf(stderr, "vecmath path: scalar\n");
+#endif
+
+	std::vector<Mat4> locals(INPUTS), out(INPUTS);
+	std::vector<Vec3> points(INPUTS), transformed(INPUTS);
+	for (int i = 0; i < INPUTS; i++) {
+		locals[i] = randomLocal();
+		points[i] = Vec3(frand(-5, 5), frand(-5, 5), frand(-5, 5));
+	}
+	// 테이블 회전 * view * projection, 원근 나눗셈까지 검사됨
+	Mat4 world = Mat4::rotationY(0.3f) * Mat4::rotationX(-0.2f);
+	Mat4 viewProj = world * Mat4::lookAtLH(Vec3(0, 5, -8), Vec3(0, 0, 0), Vec3(0, 2, 0))
+		* Mat4::perspectiveFovLH(3.14159265f / 4, 1024.0f / 768.0f, 1.0f, 100.0f);
+
+	// 두 경로가 같은 값을 내는지
+	float matErr = 0, pointErr = 0;
+	for (int i = 0; i < INPUTS; i++) {
+		matErr = fmaxf(matErr, maxDiff(locals[i] * world, multiplyScalar(locals[i], world)));
+		pointErr = fmaxf(pointErr, maxDiff(transformCoord(points[i], viewProj), transformCoordScalar(points[i], viewProj)));
+	}
+	fprintf(stderr, "max |simd - scalar|: mat4_mul %g, transform_coord %g\n", matErr, pointErr);
+
+	printf("name,n,ns_per_op,ops_per_run\n");
+
+	report("mat4_mul_scalar", measure([&]() {
+		for (int i = 0; i < INPUTS; i++)
+			out[i] = multiplyScalar(locals[i], world);
+		g_sink = out[INPUTS - 1].m[3][0];
+	}, INPUTS));
+	report("mat4_mul", measure([&]() {
+		for (int i = 0; i < INPUTS; i++)
+			out[i] = locals[i] * world;
+		g_sink = out[INPUTS - 1].m[3][0];
+	}, INPUTS));
+
+	report("transform_coord_scalar", measure([&]() {
+		for (int i = 0; i < INPUTS; i++)
+			transformed[i] = transformCoordScalar(points[i], viewProj);
+		g_sink = transformed[INPUTS - 1].x;
+	}, INPUTS));
+	report("transform_coord", measure([&]() {
+		for (int i = 0; i < INPUTS; i++)
+			transformed[i] = transformCoord(points[i], viewProj);
+		g_sink = transformed[INPUTS - 1].x;
+	}, INPUTS));
+	report("transform_coords_batch", measure([&]() {
+		transformCoords(viewProj, &points[0], &transformed[0], INPUTS);
+		g_sink = transformed[INPUTS - 1].x;
+	}, INPUTS));
+
+	report("vec3_normalize", measure([&]() {
+		for (int i = 0; i < INPUTS; i++)
+			transformed[i] = normalize(points[i]);
+		g_sink = transformed[INPUTS - 1].x;
+	}, INPUTS));
+
+	return 0;
+}
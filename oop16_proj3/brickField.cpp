@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: brickField.cpp
+//
+// Desc: Grid-indexed ball vs brick collision for the ARKANOID mode.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "brickField.h"
+#include <math.h>
+#include <string.h>
+
+CBrickField::CBrickField(void)
+{
+	m_cols = m_rows = 0;
+	m_aliveCount = 0;
+	m_minX = m_minZ = 0;
+	m_cellWidth = m_cellDepth = 1;
+}
+
+void CBrickField::create(int cols, int rows, float minX, float minZ, float cellWidth, float cellDepth, unsigned char hitPoints)
+{
+	m_cols = cols;
+	m_rows = rows;
+	m_minX = minX;
+	m_minZ = minZ;
+	m_cellWidth = cellWidth;
+	m_cellDepth = cellDepth;
+
+	int count = cols * rows;
+	m_alive.assign((count + 63) / 64, 0);
+	m_hitPoints.assign(count, 0);
+	m_aliveCount = 0;
+
+	if (hitPoints == 0)
+		return;
+	for (int row = 0; row < rows; row++) {
+		for (int col = 0; col < cols; col++)
+			setBrick(col, row, hitPoints);
+	}
+}
+
+void CBrickField::clear(void)
+{
+	m_alive.assign(m_alive.size(), 0);
+	m_hitPoints.assign(m_hitPoints.size(), 0);
+	m_aliveCount = 0;
+}
+
+void CBrickField::saveState(void* pDest) const
+{
+	unsigned char* p = (unsigned char*)pDest;
+	memcpy(p, &m_aliveCount, sizeof(int));
+	p += sizeof(int);
+	memcpy(p, m_alive.data(), m_alive.size() * sizeof(uint64_t));
+	p += m_alive.size() * sizeof(uint64_t);
+	memcpy(p, m_hitPoints.data(), m_hitPoints.size());
+}
+
+void CBrickField::restoreState(const void* pSrc)
+{
+	const unsigned char* p = (const unsigned char*)pSrc;
+	memcpy(&m_aliveCount, p, sizeof(int));
+	p += sizeof(int);
+	memcpy(m_alive.data(), p, m_alive.size() * sizeof(uint64_t));
+	p += m_alive.size() * sizeof(uint64_t);
+	memcpy(m_hitPoints.data(), p, m_hitPoints.size());
+}
+
+void CBrickField::setBrick(int col, int row, unsigned char hitPoints)
+{
+	int i = row * m_cols + col;
+	uint64_t bit = (uint64_t)1 << (i & 63);
+	bool wasAlive = (m_alive[i >> 6] & bit) != 0;
+
+	m_hitPoints[i] = hitPoints;
+	if (hitPoints > 0) {
+		m_alive[i >> 6] |= bit;
+		if (!wasAlive) m_aliveCount++;
+	}
+	else {
+		m_alive[i >> 6] &= ~bit;
+		if (wasAlive) m_aliveCount--;
+	}
+}
+
+bool CBrickField::collide(float prevX, float prevZ, float x, float z, float radius, Hit* pHit) const
+{
+	if (m_cols == 0 || m_rows == 0)
+		return false;
+
+	// 이번 갱신 동안 공이 지나간 영역(swept bounds)
+	float loX = (prevX < x ? prevX : x) - radius;
+	float hiX = (prevX < x ? x : prevX) + radius;
+	float loZ = (prevZ < z ? prevZ : z) - radius;
+	float hiZ = (prevZ < z ? z : prevZ) + radius;
+
+	int c0 = (int)floorf((loX - m_minX) / m_cellWidth);
+	int c1 = (int)floorf((hiX - m_minX) / m_cellWidth);
+	int r0 = (int)floorf((loZ - m_minZ) / m_cellDepth);
+	int r1 = (int)floorf((hiZ - m_minZ) / m_cellDepth);
+	if (c1 < 0 || r1 < 0 || c0 >= m_cols || r0 >= m_rows)
+		return false;
+	if (c0 < 0) c0 = 0;
+	if (r0 < 0) r0 = 0;
+	if (c1 >= m_cols) c1 = m_cols - 1;
+	if (r1 >= m_rows) r1 = m_rows - 1;
+
+	bool found = false;
+	float halfW = m_cellWidth / 2;
+	float halfD = m_cellDepth / 2;
+
+	for (int row = r0; row <= r1; row++) {
+		for (int col = c0; col <= c1; col++) {
+			if (!isAlive(col, row))
+				continue;
+
+			// 원과 사각형 사이의 가장 가까운 점
+			float cx = getCenterX(col);
+			float cz = getCenterZ(row);
+			float dx = x - cx;
+			float dz = z - cz;
+			float px = dx < -halfW ? -halfW : (dx > halfW ? halfW : dx);
+			float pz = dz < -halfD ? -halfD : (dz > halfD ? halfD : dz);
+
+			float nx, nz, depth;
+			if (px == dx && pz == dz) {
+				// 공의 중심이 벽돌 안에 있음, 가장 얕은 면 쪽으로 밀어냄
+				float ox = halfW - fabsf(dx);
+				float oz = halfD - fabsf(dz);
+				if (ox < oz) { nx = dx < 0 ? -1.0f : 1.0f; nz = 0; depth = ox + radius; }
+				else { nx = 0; nz = dz < 0 ? -1.0f : 1.0f; depth = oz + radius; }
+			}
+			else {
+				float ex = dx - px;
+				float ez = dz - pz;
+				float dist2 = ex * ex + ez * ez;
+				if (dist2 >= radius * radius)
+					continue;
+				float dist = sqrtf(dist2);
+				nx = ex / dist;
+				nz = ez / dist;
+				depth = radius - dist;
+			}
+
+			if (!found || depth > pHit->penetration) {
+				pHit->col = col;
+				pHit->row = row;
+				pHit->normalX = nx;
+				pHit->normalZ = nz;
+				pHit->penetration = depth;
+				pHit->time = 1;
+				found = true;
+			}
+		}
+	}
+	if (found)
+		return true;
+
+	// 끝에서 닿은 벽돌이 없으면 한 스텝에 벽돌을 건너뛰었는지, 반지름만큼 키운 상자와 선분의 교차 (slab)
+	float mx = x - prevX;
+	float mz = z - prevZ;
+	float first = 2;
+	for (int row = r0; row <= r1; row++) {
+		for (int col = c0; col <= c1; col++) {
+			if (!isAlive(col, row))
+				continue;
+			float t, nx, nz;
+			if (sweepBox(prevX, prevZ, mx, mz, getCenterX(col), getCenterZ(row), halfW + radius, halfD + radius, &t, &nx, &nz) &&
+				t < first) {
+				first = t;
+				pHit->col = col;
+				pHit->row = row;
+				pHit->normalX = nx;
+				pHit->normalZ = nz;
+				pHit->penetration = 0;
+				pHit->time = t;
+			}
+		}
+	}
+	return first <= 1;
+}
+
+// (x, z)에서 (mx, mz)만큼 가는 선분이 중심 (cx, cz), 반폭 (hx, hz) 상자에 들어가는 비율과 들어간 면의 법선
+// 처음부터 상자 안이면 (멀어지는 중) 닿지 않은 것으로 봄
+bool CBrickField::sweepBox(float x, float z, float mx, float mz, float cx, float cz, float hx, float hz,
+	float* pTime, float* pNormalX, float* pNormalZ)
+{
+	float enter = -1, leave = 2;
+	float nx = 0, nz = 0;
+	if (mx == 0) {
+		if (x <= cx - hx || x >= cx + hx)
+			return false;
+	}
+	else {
+		float t0 = (cx - hx - x) / mx;
+		float t1 = (cx + hx - x) / mx;
+		if (t0 > t1) { float s = t0; t0 = t1; t1 = s; }
+		if (t0 > enter) { enter = t0; nx = mx > 0 ? -1.0f : 1.0f; nz = 0; }
+		if (t1 < leave) leave = t1;
+	}
+	if (mz == 0) {
+		if (z <= cz - hz || z >= cz + hz)
+			return false;
+	}
+	else {
+		float t0 = (cz - hz - z) / mz;
+		float t1 = (cz + hz - z) / mz;
+		if (t0 > t1) { float s = t0; t0 = t1; t1 = s; }
+		if (t0 > enter) { enter = t0; nx = 0; nz = mz > 0 ? -1.0f : 1.0f; }
+		if (t1 < leave) leave = t1;
+	}
+	if (enter <= 0 || enter > 1 || enter >= leave)
+		return false;
+	*pTime = enter;
+	*pNormalX = nx;
+	*pNormalZ = nz;
+	return true;
+}
+
+bool CBrickField::damage(int col, int row)
+{
+	if (!isAlive(col, row))
+		return false;
+	int i = row * m_cols + col;
+	setBrick(col, row, (unsigned char)(m_hitPoints[i] - 1));
+	return !isAlive(col, row);
+}
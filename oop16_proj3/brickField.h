@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: brickField.h
+//
+// Desc: Breakable bricks laid out on a regular grid for the ARKANOID mode.
+//       Alive flags are packed in a bitset and hit points in a byte array,
+//       so a level with tens of thousands of bricks stays a few KB and a
+//       ball only has to look at the grid cells its swept bounds touch.
+//       No Direct3D dependency, the renderer reads the field through
+//       forEachAlive().
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __brickFieldH__
+#define __brickFieldH__
+
+#include <vector>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+class CBrickField {
+public:
+	// 공이 벽돌에 닿았을 때의 정보
+	struct Hit {
+		int		col, row;
+		float	normalX, normalZ;	// 벽돌 표면에서 공 쪽을 향하는 법선
+		float	penetration;		// 겹친 깊이
+		float	time;				// 이동 경로에서 처음 닿은 비율 (0~1], 끝 위치에서 겹쳤으면 1
+	};
+
+	CBrickField(void);
+
+	// (minX, minZ)를 왼쪽 아래 모서리로 cols x rows 개의 벽돌을 채움
+	void create(int cols, int rows, float minX, float minZ, float cellWidth, float cellDepth, unsigned char hitPoints);
+	void clear(void);
+
+	bool isAlive(int col, int row) const
+	{
+		int i = row * m_cols + col;
+		return ((m_alive[i >> 6] >> (i & 63)) & 1) != 0;
+	}
+	int getHitPoints(int col, int row) const { return isAlive(col, row) ? m_hitPoints[row * m_cols + col] : 0; }
+	void setBrick(int col, int row, unsigned char hitPoints);
+
+	int getCols(void) const { return m_cols; }
+	int getRows(void) const { return m_rows; }
+	int getAliveCount(void) const { return m_aliveCount; }
+	float getCellWidth(void) const { return m_cellWidth; }
+	float getCellDepth(void) const { return m_cellDepth; }
+	float getCenterX(int col) const { return m_minX + (col + 0.5f) * m_cellWidth; }
+	float getCenterZ(int row) const { return m_minZ + (row + 0.5f) * m_cellDepth; }
+
+	// 공이 (prevX, prevZ)에서 (x, z)로 움직이는 동안 지나간 칸만 검사
+	// 끝 위치에서 겹친 벽돌 중 가장 깊이 들어간 것을 pHit에 돌려줌
+	// 겹친 벽돌이 없으면 경로가 (반지름만큼 키운) 벽돌을 지나갔는지 보고, 가장 먼저 닿은 것을
+	// 돌려줌 (빠른 공이 한 칸 두께의 벽을 뚫고 지나가지 않게), 이때 penetration은 0
+	bool collide(float prevX, float prevZ, float x, float z, float radius, Hit* pHit) const;
+
+	// 내구도를 1 줄이고, 0이 되면 벽돌을 제거하고 true 반환
+	bool damage(int col, int row);
+
+	// 되감기용, 배치는 그대로 두고 벽돌의 생사와 내구도만 고정 크기로 복사
+	size_t getStateSize(void) const { return sizeof(int) + m_alive.size() * sizeof(uint64_t) + m_hitPoints.size(); }
+	void saveState(void* pDest) const;
+	void restoreState(const void* pSrc);
+
+	// 살아있는 벽돌마다 f(col, row, hitPoints) 호출, 빈 64칸은 한번에 건너뜀
+	template<typename F> void forEachAlive(F f) const
+	{
+		for (size_t w = 0; w < m_alive.size(); w++) {
+			uint64_t bits = m_alive[w];
+			while (bits) {
+				int i = (int)(w << 6) + lowestBit(bits);
+				f(i % m_cols, i / m_cols, (int)m_hitPoints[i]);
+				bits &= bits - 1;
+			}
+		}
+	}
+
+private:
+	static bool sweepBox(float x, float z, float mx, float mz, float cx, float cz, float hx, float hz,
+		float* pTime, float* pNormalX, float* pNormalZ);
+
+	static int lowestBit(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long)bits))
+			return (int)index;
+		_BitScanForward(&index, (unsigned long)(bits >> 32));
+		return (int)index + 32;
+#else
+		return __builtin_ctzll(bits);
+#endif
+	}
+
+	int							m_cols, m_rows;
+	int							m_aliveCount;
+	float						m_minX, m_minZ;
+	float						m_cellWidth, m_cellDepth;
+	std::vector<uint64_t>		m_alive;		// 1비트 = 벽돌 1개
+	std::vector<unsigned char>	m_hitPoints;	// 남은 내구도
+};
+
+#endif // __brickFieldH__
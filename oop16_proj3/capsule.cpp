@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: capsule.cpp
+//
+// Desc: Swept capsule vs. circle time of impact and contact response.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "capsule.h"
+#include <math.h>
+
+namespace
+{
+	const float EPSILON = 1e-6f;
+
+	// 선분 a-b 위에서 점 p와 가장 가까운 점의 매개변수, 0..1
+	float closestParam(float ax, float az, float bx, float bz, float px, float pz)
+	{
+		float ux = bx - ax, uz = bz - az;
+		float len2 = ux * ux + uz * uz;
+		if (len2 < EPSILON)
+			return 0.0f;
+		float s = ((px - ax) * ux + (pz - az) * uz) / len2;
+		return s < 0.0f ? 0.0f : (s > 1.0f ? 1.0f : s);
+	}
+
+	// p + t*m 이 중심 c, 반지름 r인 원에 처음 들어가는 t, 없으면 음수
+	float rayCircle(float px, float pz, float mx, float mz, float cx, float cz, float r)
+	{
+		float fx = px - cx, fz = pz - cz;
+		float a = mx * mx + mz * mz;
+		float b = fx * mx + fz * mz;
+		float c = fx * fx + fz * fz - r * r;
+		if (a < EPSILON || b >= 0.0f)
+			return -1.0f;
+		float disc = b * b - a * c;
+		if (disc < 0.0f)
+			return -1.0f;
+		return (-b - sqrtf(disc)) / a;
+	}
+}
+
+bool sweepCapsuleCircle(const Capsule& capsule, float moveX, float moveZ,
+	float x, float z, float ballMoveX, float ballMoveZ, float ballRadius, CapsuleHit* pHit)
+{
+	// 캡슐을 멈춰 세우고 공만 상대 속도로 움직인다고 봄
+	// 그러면 공 중심이 반지름 R = 캡슐 + 공 인 캡슐에 들어가는 광선 문제가 됨
+	float mx = ballMoveX - moveX;
+	float mz = ballMoveZ - moveZ;
+	float R = capsule.radius + ballRadius;
+
+	float ux = capsule.bx - capsule.ax;
+	float uz = capsule.bz - capsule.az;
+	float len = sqrtf(ux * ux + uz * uz);
+
+	float t;
+	float s0 = closestParam(capsule.ax, capsule.az, capsule.bx, capsule.bz, x, z);
+	float qx = capsule.ax + ux * s0 - x;
+	float qz = capsule.az + uz * s0 - z;
+	if (qx * qx + qz * qz <= R * R) {
+		t = 0.0f;
+	}
+	else {
+		t = 2.0f;
+
+		// 옆면: 축과 평행하게 R만큼 떨어진 두 직선
+		if (len > EPSILON) {
+			ux /= len;
+			uz /= len;
+			float nx = -uz, nz = ux;
+			float d = (x - capsule.ax) * nx + (z - capsule.az) * nz;
+			float side = d < 0.0f ? -1.0f : 1.0f;
+			float approach = -(mx * nx + mz * nz) * side;
+			if (approach > EPSILON) {
+				float ts = (d * side - R) / approach;
+				if (ts >= 0.0f && ts <= 1.0f) {
+					float along = (x + mx * ts - capsule.ax) * ux + (z + mz * ts - capsule.az) * uz;
+					if (along >= 0.0f && along <= len)
+						t = ts;
+				}
+			}
+		}
+
+		// 양 끝의 반원
+		float ta = rayCircle(x, z, mx, mz, capsule.ax, capsule.az, R);
+		if (ta >= 0.0f && ta < t)
+			t = ta;
+		float tb = rayCircle(x, z, mx, mz, capsule.bx, capsule.bz, R);
+		if (tb >= 0.0f && tb < t)
+			t = tb;
+
+		if (t > 1.0f)
+			return false;
+	}
+
+	if (pHit != NULL) {
+		// 접촉 시각의 실제 위치에서 법선과 접촉 지점을 다시 계산
+		float ox = moveX * t, oz = moveZ * t;
+		float ax = capsule.ax + ox, az = capsule.az + oz;
+		float bx = capsule.bx + ox, bz = capsule.bz + oz;
+		float px = x + ballMoveX * t, pz = z + ballMoveZ * t;
+
+		float s = closestParam(ax, az, bx, bz, px, pz);
+		float cx = ax + (bx - ax) * s;
+		float cz = az + (bz - az) * s;
+		float nx = px - cx, nz = pz - cz;
+		float dist = sqrtf(nx * nx + nz * nz);
+		if (dist > EPSILON) {
+			nx /= dist;
+			nz /= dist;
+		}
+		else {
+			// 중심이 축 위에 있으면 들어온 방향의 반대를 법선으로 씀
+			float m = sqrtf(mx * mx + mz * mz);
+			nx = m > EPSILON ? -mx / m : 1.0f;
+			nz = m > EPSILON ? -mz / m : 0.0f;
+		}
+
+		pHit->t = t;
+		pHit->pointX = cx + nx * capsule.radius;
+		pHit->pointZ = cz + nz * capsule.radius;
+		pHit->normalX = nx;
+		pHit->normalZ = nz;
+		pHit->along = len > EPSILON ? s * 2.0f - 1.0f : 0.0f;
+	}
+	return true;
+}
+
+bool resolveCapsuleHit(const Capsule& capsule, const CapsuleHit& hit, float velocityX, float velocityZ,
+	float restitution, float deflection, float* pBallVelocityX, float* pBallVelocityZ)
+{
+	float nx = hit.normalX;
+	float nz = hit.normalZ;
+
+	if (deflection != 0.0f) {
+		float ux = capsule.bx - capsule.ax;
+		float uz = capsule.bz - capsule.az;
+		float len = sqrtf(ux * ux + uz * uz);
+		if (len > EPSILON) {
+			nx += ux / len * hit.along * deflection;
+			nz += uz / len * hit.along * deflection;
+			float n = sqrtf(nx * nx + nz * nz);
+			nx /= n;
+			nz /= n;
+		}
+	}
+
+	float relX = *pBallVelocityX - velocityX;
+	float relZ = *pBallVelocityZ - velocityZ;
+	float vn = relX * nx + relZ * nz;
+	if (vn >= 0.0f)
+		return false;
+
+	float j = -(1.0f + restitution) * vn;
+	*pBallVelocityX += j * nx;
+	*pBallVelocityZ += j * nz;
+	return true;
+}
@@ -0,0 +1,42 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: capsule.h
+//
+// Desc: Swept capsule vs. circle test on the table plane, used for the cue
+//       stick (and any paddle-like body). The capsule is a segment grown by
+//       a radius; both bodies move linearly over one physics step and the
+//       test returns the first time of contact, so a fast stick can no
+//       longer pass through a ball between two steps.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __capsuleH__
+#define __capsuleH__
+
+// 선분 (ax, az)-(bx, bz)을 radius만큼 부풀린 캡슐, 테이블 평면(x, z) 기준
+struct Capsule {
+	float	ax, az;
+	float	bx, bz;
+	float	radius;
+};
+
+// 캡슐과 공이 처음 닿는 순간의 정보
+struct CapsuleHit {
+	float	t;					// 이번 스텝 안에서의 접촉 시각, 0..1
+	float	pointX, pointZ;		// 캡슐 표면의 접촉 지점
+	float	normalX, normalZ;	// 캡슐에서 공 쪽을 향하는 단위 법선
+	float	along;				// 축 위의 접촉 위치, a 끝 -1 .. b 끝 1
+};
+
+// 스텝 시작 때의 캡슐이 (moveX, moveZ)만큼, 공 (x, z)가 (ballMoveX, ballMoveZ)만큼
+// 움직일 때 처음 닿는 시각과 법선을 구함. 스텝 시작부터 겹쳐 있으면 t = 0
+bool sweepCapsuleCircle(const Capsule& capsule, float moveX, float moveZ,
+	float x, float z, float ballMoveX, float ballMoveZ, float ballRadius, CapsuleHit* pHit);
+
+// 접촉 법선 방향으로 충격량을 주어 공의 속도를 바꿈, 캡슐의 질량은 무한대로 봄
+// deflection > 0이면 축 끝쪽에 맞을수록 법선을 그쪽으로 기울임 (패들의 각도 반사)
+// 서로 멀어지는 중이면 false
+bool resolveCapsuleHit(const Capsule& capsule, const CapsuleHit& hit, float velocityX, float velocityZ,
+	float restitution, float deflection, float* pBallVelocityX, float* pBallVelocityZ);
+
+#endif // __capsuleH__
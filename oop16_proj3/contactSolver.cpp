@@ -0,0 +1,415 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: contactSolver.cpp
+//
+// Desc: Sequential-impulse ball contact solver with warm starting.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "contactSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+
+#define MAX_COLORS 64		// 마지막 색은 색이 모자란 접촉을 모아 한 스레드가 풂
+#define MIN_BATCH 64		// 이보다 작은 묶음은 나누지 않고 0번 스레드가 풂
+#define GRID_MIN_BALLS 256	// 이보다 많으면 격자로 접촉을 찾음
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point t0)
+{
+	return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+CContactSolver::CContactSolver(void)
+{
+	m_settings.restitution = 1.0f;
+	m_settings.restingSpeed = 0.01f;
+	m_settings.iterations = 8;
+	m_settings.positionIterations = 2;
+	m_settings.correction = 0.8f;
+	m_settings.slop = 0.001f;
+	m_settings.warmStart = 0.8f;
+	m_settings.threads = 0;
+	m_settings.throwFriction = 0.06f;
+	m_timing.findSeconds = m_timing.colorSeconds = m_timing.solveSeconds = 0;
+
+	// 보통 크기의 테이블은 스텝 중에 메모리를 할당하지 않도록
+	m_order.reserve(64);
+	m_contacts.reserve(128);
+	m_previous.reserve(128);
+}
+
+CContactSolver::CContactSolver(const CContactSolver& other)
+	: m_settings(other.m_settings), m_timing(other.m_timing), m_order(other.m_order),
+	m_contacts(other.m_contacts), m_previous(other.m_previous)
+{
+}
+
+CContactSolver& CContactSolver::operator=(const CContactSolver& other)
+{
+	if (this != &other) {
+		setSettings(other.m_settings);
+		m_timing = other.m_timing;
+		m_order = other.m_order;
+		m_contacts = other.m_contacts;
+		m_previous = other.m_previous;
+	}
+	return *this;
+}
+
+void CContactSolver::setSettings(const Settings& settings)
+{
+	m_settings = settings;
+	if (m_settings.threads <= 0)
+		m_pPool.reset();
+	else if (m_pPool && m_pPool->getThreadCount() != m_settings.threads)
+		m_pPool->start(m_settings.threads);
+}
+
+int CContactSolver::solve(BallBody* pBalls, int count, float radius)
+{
+	Clock::time_point t0 = Clock::now();
+	m_previous.swap(m_contacts);
+	findContacts(pBalls, count, radius);
+	m_timing.findSeconds = secondsSince(t0);
+	m_timing.colorSeconds = m_timing.solveSeconds = 0;
+	if (m_contacts.empty())
+		return 0;
+
+	if (m_settings.threads > 0) {
+		t0 = Clock::now();
+		colorContacts(count);
+		m_timing.colorSeconds = secondsSince(t0);
+		t0 = Clock::now();
+		solveBatches(pBalls, radius);
+		m_timing.solveSeconds = secondsSince(t0);
+		return (int)m_contacts.size();
+	}
+
+	t0 = Clock::now();
+	warmStart(pBalls);
+	for (int i = 0; i < m_settings.iterations; i++)
+		solveVelocities(pBalls);
+	for (int i = 0; i < m_settings.positionIterations; i++)
+		correctPositions(pBalls, radius);
+	m_timing.solveSeconds = secondsSince(t0);
+	return (int)m_contacts.size();
+}
+
+// 공이 적으면 x로 정렬한 뒤 x 간격이 지름보다 가까운 쌍만 검사
+// 많으면 x 간격 안에 다른 줄의 공이 너무 많이 들어오므로 격자로 찾음, 찾는 쌍은 같음
+void CContactSolver::findContacts(const BallBody* pBalls, int count, float radius)
+{
+	m_contacts.clear();
+	if (count >= GRID_MIN_BALLS) {
+		findContactsGrid(pBalls, count, radius);
+	}
+	else {
+		const float diameter = 2 * radius;
+
+		m_order.resize(count);
+		for (int i = 0; i < count; i++)
+			m_order[i] = i;
+		std::sort(m_order.begin(), m_order.end(), [pBalls](int l, int r) { return pBalls[l].x < pBalls[r].x; });
+
+		for (int i = 0; i < count; i++) {
+			const BallBody& p = pBalls[m_order[i]];
+			for (int j = i + 1; j < count; j++) {
+				const BallBody& q = pBalls[m_order[j]];
+				if (q.x - p.x >= diameter)
+					break;
+				if (ballsOverlap(p, q, radius))
+					addContact(pBalls, m_order[i], m_order[j], radius);
+			}
+		}
+	}
+
+	// 공 순서에 상관없이 같은 순서로 풀도록 (a, b)로 정렬
+	std::sort(m_contacts.begin(), m_contacts.end(), [](const SolverContact& l, const SolverContact& r) {
+		return l.a != r.a ? l.a < r.a : l.b < r.b;
+	});
+}
+
+// 직전 스텝에도 있던 접촉은 그때의 충격량을 먼저 적용해 반복 횟수를 줄임
+void CContactSolver::warmStart(BallBody* pBalls)
+{
+	size_t p = 0;
+	for (size_t i = 0; i < m_contacts.size(); i++) {
+		SolverContact& c = m_contacts[i];
+		while (p < m_previous.size() && (m_previous[p].a < c.a || (m_previous[p].a == c.a && m_previous[p].b < c.b)))
+			p++;
+		if (p == m_previous.size() || m_previous[p].a != c.a || m_previous[p].b != c.b)
+			continue;
+
+		// 새로 부딪힌 접촉은 반발 목표가 있으므로 이어받지 않음
+		// 서로 밀지 않고 멈춰 있는 접촉도 건너뜀, 적용했다가 되돌리면서 남는 반올림 오차가
+		// 멈춘 공 무리를 계속 조금씩 움직이게 해서 턴이 끝나지 않음
+		if (c.targetSpeed > 0 || c.approachSpeed == 0)
+			continue;
+		float j = m_previous[p].impulse * m_settings.warmStart;
+		c.impulse = j;
+		BallBody& a = pBalls[c.a];
+		BallBody& b = pBalls[c.b];
+		a.vx -= j * c.normalX;
+		a.vz -= j * c.normalZ;
+		b.vx += j * c.normalX;
+		b.vz += j * c.normalZ;
+	}
+}
+
+// 칸 크기를 지름 이상으로 두면 겹친 두 공은 같은 칸이나 이웃 칸에 있음
+// 칸마다 공 번호를 모아 (counting sort) 자기 칸과 오른쪽/위쪽 이웃 네 칸만 검사, 한 쌍을 두 번 보지 않음
+void CContactSolver::findContactsGrid(const BallBody* pBalls, int count, float radius)
+{
+	float minX = pBalls[0].x, maxX = minX, minZ = pBalls[0].z, maxZ = minZ;
+	for (int i = 1; i < count; i++) {
+		minX = std::min(minX, pBalls[i].x);
+		maxX = std::max(maxX, pBalls[i].x);
+		minZ = std::min(minZ, pBalls[i].z);
+		maxZ = std::max(maxZ, pBalls[i].z);
+	}
+	// 공이 넓게 흩어져 있으면 칸 수가 공 수의 4배를 넘지 않게 칸을 키움
+	float cell = 2 * radius;
+	while ((double)((maxX - minX) / cell + 1) * ((maxZ - minZ) / cell + 1) > 4.0 * count)
+		cell *= 2;
+	const int cols = (int)((maxX - minX) / cell) + 1;
+	const int rows = (int)((maxZ - minZ) / cell) + 1;
+	const float inv = 1 / cell;
+
+	m_ballCell.resize(count);
+	m_cellStart.assign(cols * rows + 1, 0);
+	for (int i = 0; i < count; i++) {
+		int cx = std::min((int)((pBalls[i].x - minX) * inv), cols - 1);
+		int cz = std::min((int)((pBalls[i].z - minZ) * inv), rows - 1);
+		m_ballCell[i] = cz * cols + cx;
+		m_cellStart[m_ballCell[i] + 1]++;
+	}
+	for (int k = 0; k < cols * rows; k++)
+		m_cellStart[k + 1] += m_cellStart[k];
+	m_order.resize(count);
+	m_cellNext.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+	for (int i = 0; i < count; i++)
+		m_order[m_cellNext[m_ballCell[i]]++] = i;
+
+	static const int NEIGHBORS[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+	for (int cz = 0; cz < rows; cz++) {
+		for (int cx = 0; cx < cols; cx++) {
+			int cellIndex = cz * cols + cx;
+			int first = m_cellStart[cellIndex], last = m_cellStart[cellIndex + 1];
+			for (int i = first; i < last; i++) {
+				int p = m_order[i];
+				for (int j = i + 1; j < last; j++) {
+					if (ballsOverlap(pBalls[p], pBalls[m_order[j]], radius))
+						addContact(pBalls, p, m_order[j], radius);
+				}
+				for (int n = 0; n < 4; n++) {
+					int nx = cx + NEIGHBORS[n][0], nz = cz + NEIGHBORS[n][1];
+					if (nx < 0 || nx >= cols || nz >= rows)
+						continue;
+					int other = nz * cols + nx;
+					for (int j = m_cellStart[other]; j < m_cellStart[other + 1]; j++) {
+						if (ballsOverlap(pBalls[p], pBalls[m_order[j]], radius))
+							addContact(pBalls, p, m_order[j], radius);
+					}
+				}
+			}
+		}
+	}
+}
+
+void CContactSolver::addContact(const BallBody* pBalls, int i, int j, float radius)
+{
+	SolverContact c;
+	c.a = i < j ? i : j;
+	c.b = i < j ? j : i;
+	const BallBody& a = pBalls[c.a];
+	const BallBody& b = pBalls[c.b];
+	float nx = b.x - a.x, nz = b.z - a.z;
+	float len = sqrtf(nx * nx + nz * nz);
+	if (len > 0) {
+		nx /= len;
+		nz /= len;
+	}
+	else {
+		nx = 1;		// 완전히 겹치면 아무 방향으로나 밀어냄
+		nz = 0;
+	}
+	c.normalX = nx;
+	c.normalZ = nz;
+	c.penetration = 2 * radius - len;
+
+	float vn = (b.vx - a.vx) * nx + (b.vz - a.vz) * nz;
+	c.approachSpeed = -vn;
+	c.targetSpeed = c.approachSpeed > m_settings.restingSpeed ? m_settings.restitution * c.approachSpeed : 0;
+	c.impulse = 0;
+	c.tangentImpulse = 0;
+	m_contacts.push_back(c);
+}
+
+// 접촉마다 분리 속도가 목표에 맞도록 충격량을 더함, 누적 충격량은 0 이상 (당기지 않음)
+void CContactSolver::solveVelocities(BallBody* pBalls)
+{
+	for (size_t i = 0; i < m_contacts.size(); i++)
+		solveVelocity(m_contacts[i], pBalls);
+}
+
+void CContactSolver::solveVelocity(SolverContact& c, BallBody* pBalls) const
+{
+	BallBody& a = pBalls[c.a];
+	BallBody& b = pBalls[c.b];
+
+	float vn = (b.vx - a.vx) * c.normalX + (b.vz - a.vz) * c.normalZ;
+	// 질량이 같은 두 공에 크기가 같고 방향이 반대인 충격을 주면 상대 속도는 2배로 바뀜
+	float j = (c.targetSpeed - vn) * 0.5f;
+	float total = c.impulse + j;
+	if (total < 0)
+		total = 0;
+	j = total - c.impulse;
+	c.impulse = total;
+
+	a.vx -= j * c.normalX;
+	a.vz -= j * c.normalZ;
+	b.vx += j * c.normalX;
+	b.vz += j * c.normalZ;
+
+	if (m_settings.throwFriction <= 0 || c.impulse <= 0)
+		return;
+
+	// 접점에서 미끄러지는 속도, 접선 방향 상대 속도와 두 공의 수직축 회전
+	// 마찰 충격량 jt는 두 공의 선속도를 jt씩, 표면 회전 속도를 5/2 jt씩 바꿔 미끄러짐이 7 jt 줄어듦
+	float tx = -c.normalZ, tz = c.normalX;
+	float slip = (b.vx - a.vx) * tx + (b.vz - a.vz) * tz + a.wy + b.wy;
+	float jt = -slip / 7;
+	float limit = m_settings.throwFriction * c.impulse;
+	float tangent = c.tangentImpulse + jt;
+	if (tangent > limit)
+		tangent = limit;
+	else if (tangent < -limit)
+		tangent = -limit;
+	jt = tangent - c.tangentImpulse;
+	c.tangentImpulse = tangent;
+
+	a.vx -= jt * tx;
+	a.vz -= jt * tz;
+	b.vx += jt * tx;
+	b.vz += jt * tz;
+	a.wy += 2.5f * jt;
+	b.wy += 2.5f * jt;
+}
+
+// 속도와 따로 위치만 밀어내므로 겹침을 고쳐도 에너지가 늘지 않음
+void CContactSolver::correctPositions(BallBody* pBalls, float radius)
+{
+	const float diameter = 2 * radius;
+	for (size_t i = 0; i < m_contacts.size(); i++)
+		correctPosition(m_contacts[i], pBalls, diameter);
+}
+
+void CContactSolver::correctPosition(const SolverContact& c, BallBody* pBalls, float diameter) const
+{
+	BallBody& a = pBalls[c.a];
+	BallBody& b = pBalls[c.b];
+
+	float nx = b.x - a.x, nz = b.z - a.z;
+	float len = sqrtf(nx * nx + nz * nz);
+	if (len > 0) {
+		nx /= len;
+		nz /= len;
+	}
+	else {
+		nx = c.normalX;
+		nz = c.normalZ;
+	}
+	float overlap = diameter - len - m_settings.slop;
+	if (overlap <= 0)
+		return;
+
+	float push = overlap * m_settings.correction * 0.5f;
+	a.x -= push * nx;
+	a.z -= push * nz;
+	b.x += push * nx;
+	b.z += push * nz;
+}
+
+// 접촉을 (a, b) 순서대로 보며 두 공 모두 아직 쓰지 않은 가장 작은 색을 줌
+// 같은 색의 접촉끼리는 공을 나누지 않으므로 동시에 풀어도 됨
+void CContactSolver::colorContacts(int count)
+{
+	const int overflow = MAX_COLORS - 1;
+	int colors = 0;
+
+	m_ballColors.assign(count, 0);
+	m_contactColor.resize(m_contacts.size());
+	for (size_t i = 0; i < m_contacts.size(); i++) {
+		const SolverContact& c = m_contacts[i];
+		unsigned long long used = m_ballColors[c.a] | m_ballColors[c.b];
+		int color = 0;
+		while (color < overflow && (used & (1ull << color)))
+			color++;
+		if (color < overflow) {
+			m_ballColors[c.a] |= 1ull << color;
+			m_ballColors[c.b] |= 1ull << color;
+		}
+		m_contactColor[i] = color;
+		if (color + 1 > colors)
+			colors = color + 1;
+	}
+
+	// 색별로 센 뒤 차례로 채움 (counting sort), 묶음 안은 (a, b) 순서 그대로
+	m_batchStart.assign(colors + 1, 0);
+	for (size_t i = 0; i < m_contacts.size(); i++)
+		m_batchStart[m_contactColor[i] + 1]++;
+	for (int k = 0; k < colors; k++)
+		m_batchStart[k + 1] += m_batchStart[k];
+	m_batched.resize(m_contacts.size());
+	m_cellNext.assign(m_batchStart.begin(), m_batchStart.end() - 1);	// 색별 다음 자리
+	for (size_t i = 0; i < m_contacts.size(); i++)
+		m_batched[m_cellNext[m_contactColor[i]]++] = (int)i;
+}
+
+// 묶음마다 스레드가 구간을 나눠 풀고, 다음 묶음 전에 모두 기다림
+// 색이 모자란 접촉 (마지막 색)과 작은 묶음은 0번 스레드가 혼자 풂
+void CContactSolver::solveBatches(BallBody* pBalls, float radius)
+{
+	if (!m_pPool) {
+		m_pPool.reset(new CWorkerPool());
+		m_pPool->start(m_settings.threads);
+	}
+
+	const int batches = getBatchCount();
+	const float diameter = 2 * radius;
+	CWorkerPool& pool = *m_pPool;
+	const int threads = pool.getThreadCount();
+
+	// warm start는 접촉마다 하는 일이 적어 나누지 않음
+	warmStart(pBalls);
+
+	pool.run([&](int thread) {
+		for (int pass = 0; pass < m_settings.iterations + m_settings.positionIterations; pass++) {
+			bool velocity = pass < m_settings.iterations;
+			for (int k = 0; k < batches; k++) {
+				int first = m_batchStart[k], last = m_batchStart[k + 1];
+				int size = last - first;
+				bool serial = k == MAX_COLORS - 1 || size < MIN_BATCH;
+				if (serial && thread != 0)
+					first = last;
+				else if (!serial) {
+					int begin = first + (int)((long long)size * thread / threads);
+					int end = first + (int)((long long)size * (thread + 1) / threads);
+					first = begin;
+					last = end;
+				}
+				for (int i = first; i < last; i++) {
+					SolverContact& c = m_contacts[m_batched[i]];
+					if (velocity)
+						solveVelocity(c, pBalls);
+					else
+						correctPosition(c, pBalls, diameter);
+				}
+				pool.barrier(thread);
+			}
+		}
+	});
+}
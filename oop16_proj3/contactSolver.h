@@ -0,0 +1,118 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: contactSolver.h
+//
+// Desc: Ball-vs-ball contact solver. All overlapping pairs of a step are
+//       gathered first (sweep and prune on x) and then solved together
+//       with sequential impulses, warm started from the impulses of the
+//       previous step, followed by a position pass that pushes
+//       overlapping balls apart. Unlike resolving pairs one by one in
+//       i < j order, a cluster (a break, balls frozen together) converges
+//       to the same answer regardless of ball order and does not keep
+//       re-colliding on later steps.
+//       With Settings::threads set, contacts are split by greedy graph
+//       coloring into batches that share no ball, and each batch is solved
+//       in parallel on a CWorkerPool. Contacts in a batch are independent,
+//       so the result is the same for any number of threads.
+//       Friction at the contact point, limited by the normal impulse,
+//       carries side spin and cut angle into a small sideways throw.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __contactSolverH__
+#define __contactSolverH__
+
+#include "physics.h"
+#include "workerPool.h"
+#include <memory>
+#include <vector>
+
+// 한 스텝에서 찾은 공 두 개의 접촉
+struct SolverContact {
+	int		a, b;				// 공 번호, a < b
+	float	normalX, normalZ;	// a에서 b 방향
+	float	penetration;		// 겹친 깊이
+	float	approachSpeed;		// 풀기 전 법선 방향으로 다가오던 속도, 멀어지는 중이면 0 이하
+	float	targetSpeed;		// 반발 후 목표 분리 속도
+	float	impulse;			// 누적 충격량, 다음 스텝의 warm start에 씀
+	float	tangentImpulse;		// 이번 스텝의 누적 마찰 충격량, (-normalZ, normalX) 방향
+};
+
+class CContactSolver {
+public:
+	struct Settings {
+		float	restitution;		// 1이면 원래 collideBalls처럼 법선 속도를 그대로 주고받음
+		float	restingSpeed;		// 이보다 느리게 다가오면 튕기지 않고 붙어 있게 함
+		int		iterations;			// 속도 반복 횟수
+		int		positionIterations;	// 위치 보정 반복 횟수
+		float	correction;			// 한 번에 없앨 겹침 비율 (0~1)
+		float	slop;				// 이만큼의 겹침은 그대로 둠, 떨림 방지
+		float	warmStart;			// 직전 충격량을 얼마나 먼저 적용할지 (0~1)
+		int		threads;			// 0이면 (a, b) 순서로 하나씩, 1 이상이면 색칠한 묶음을 이 수의 스레드로
+		float	throwFriction;		// 공끼리의 마찰 계수, 0이면 던짐(throw) 없음
+	};
+
+	// 마지막 solve()에서 걸린 시간
+	struct Timing {
+		double	findSeconds;		// 접촉 찾기
+		double	colorSeconds;		// 묶음 나누기
+		double	solveSeconds;		// warm start, 속도, 위치
+	};
+
+	CContactSolver(void);
+	// 스레드는 복사하지 않음, 복사본은 처음 풀 때 자기 스레드를 만듦
+	CContactSolver(const CContactSolver& other);
+	CContactSolver& operator=(const CContactSolver& other);
+
+	void setSettings(const Settings& settings);
+	const Settings& getSettings(void) const { return m_settings; }
+
+	// 이번 스텝의 접촉을 모아 속도와 위치를 고침, 찾은 접촉 수를 돌려줌
+	// 질량은 모두 같다고 봄
+	int solve(BallBody* pBalls, int count, float radius);
+	// 공 배치가 바뀌었을 때 (새 게임 등) 이전 충격량을 버림
+	void reset(void) { m_previous.clear(); m_contacts.clear(); }
+	// 되감기용, 다음 solve()가 warm start에 쓰는 마지막 스텝의 접촉
+	void saveContacts(std::vector<SolverContact>& out) const { out = m_contacts; }
+	void restoreContacts(const std::vector<SolverContact>& contacts) { m_contacts = contacts; }
+
+	int getContactCount(void) const { return (int)m_contacts.size(); }
+	const SolverContact& getContact(int index) const { return m_contacts[index]; }
+	int getBatchCount(void) const { return m_batchStart.empty() ? 0 : (int)m_batchStart.size() - 1; }
+	const Timing& getTiming(void) const { return m_timing; }
+	// threads가 1 이상일 때 스레드별 작업/대기 시간, 없으면 NULL
+	const CWorkerPool* getPool(void) const { return m_pPool.get(); }
+	CWorkerPool* getPool(void) { return m_pPool.get(); }
+
+private:
+	void findContacts(const BallBody* pBalls, int count, float radius);
+	void findContactsGrid(const BallBody* pBalls, int count, float radius);
+	void addContact(const BallBody* pBalls, int i, int j, float radius);
+	void colorContacts(int count);
+	void warmStart(BallBody* pBalls);
+	void solveVelocities(BallBody* pBalls);
+	void correctPositions(BallBody* pBalls, float radius);
+	void solveBatches(BallBody* pBalls, float radius);
+
+	// 접촉 하나의 속도/위치 풀이, 묶음으로 풀 때와 하나씩 풀 때가 같은 코드를 씀
+	void solveVelocity(SolverContact& c, BallBody* pBalls) const;
+	void correctPosition(const SolverContact& c, BallBody* pBalls, float diameter) const;
+
+	Settings					m_settings;
+	Timing						m_timing;
+	std::vector<int>			m_order;		// x 순서로 정렬한 공 번호, 격자에서는 칸 순서
+	std::vector<int>			m_ballCell;		// 격자: 공마다 칸 번호
+	std::vector<int>			m_cellStart;	// 격자: 칸마다 m_order 안의 시작 위치
+	std::vector<int>			m_cellNext;		// counting sort에서 다음에 채울 자리
+	std::vector<SolverContact>	m_contacts;		// (a, b) 순서로 정렬됨
+	std::vector<SolverContact>	m_previous;		// 직전 스텝의 접촉
+
+	// 색칠한 묶음, m_batched[m_batchStart[k] .. m_batchStart[k + 1])이 k번 묶음의 접촉 번호
+	std::vector<unsigned long long> m_ballColors;	// 공마다 이미 쓴 색 (비트)
+	std::vector<int>			m_contactColor;
+	std::vector<int>			m_batched;
+	std::vector<int>			m_batchStart;
+	std::unique_ptr<CWorkerPool> m_pPool;
+};
+
+#endif // __contactSolverH__
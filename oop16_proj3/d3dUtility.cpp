@@ -1,267 +1,426 @@
-//////////////////////////////////////////////////////////////////////////////////////////////////
-// 
-// File: d3dUtility.cpp
-// 
-// Author: Frank Luna (C) All Rights Reserved
-//
-// System: AMD Athlon 1800+ XP, 512 DDR, Geforce 3, Windows XP, MSVC++ 7.0 
-//
-// Desc: Provides utility functions for simplifying common tasks.
-//          
-//////////////////////////////////////////////////////////////////////////////////////////////////
-
-#include "d3dUtility.h"
-
-bool d3d::InitD3D(
-	HINSTANCE hInstance,
-	int width, int height,
-	bool windowed,
-	D3DDEVTYPE deviceType,
-	IDirect3DDevice9** device)
-{
-	//
-	// Create the main application window.
-	//
-
-	WNDCLASS wc;
-
-	wc.style         = CS_HREDRAW | CS_VREDRAW;
-	wc.lpfnWndProc   = (WNDPROC)d3d::WndProc; 
-	wc.cbClsExtra    = 0;
-	wc.cbWndExtra    = 0;
-	wc.hInstance     = hInstance;
-	wc.hIcon         = LoadIcon(0, IDI_APPLICATION);
-	wc.hCursor       = LoadCursor(0, IDC_ARROW);
-	wc.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
-	wc.lpszMenuName  = 0;
-	wc.lpszClassName = "Direct3D9App";
-
-	if( !RegisterClass(&wc) ) 
-	{
-		::MessageBox(0, "RegisterClass() - FAILED", 0, 0);
-		return false;
-	}
-		
-	HWND hwnd = 0;
-    hwnd = ::CreateWindow("Direct3D9App",
-        "Virtual Billiard", 
-		WS_EX_TOPMOST,
-		0, 0, width, height,
-		0 /*parent hwnd*/, 0 /* menu */, hInstance, 0 /*extra*/); 
-
-	if( !hwnd )
-	{
-		::MessageBox(0, "CreateWindow() - FAILED", 0, 0);
-		return false;
-	}
-
-	::ShowWindow(hwnd, SW_SHOW);
-	::UpdateWindow(hwnd);
-
-	//
-	// Init D3D: 
-	//
-
-	HRESULT hr = 0;
-
-	// Step 1: Create the IDirect3D9 object.
-
-	IDirect3D9* d3d9 = 0;
-    d3d9 = Direct3DCreate9(D3D_SDK_VERSION);
-
-    if( !d3d9 )
-	{
-		::MessageBox(0, "Direct3DCreate9() - FAILED", 0, 0);
-		return false;
-	}
-
-	// Step 2: Check for hardware vp.
-
-	D3DCAPS9 caps;
-	d3d9->GetDeviceCaps(D3DADAPTER_DEFAULT, deviceType, &caps);
-
-	int vp = 0;
-	if( caps.DevCaps & D3DDEVCAPS_HWTRANSFORMANDLIGHT )
-		vp = D3DCREATE_HARDWARE_VERTEXPROCESSING;
-	else
-		vp = D3DCREATE_SOFTWARE_VERTEXPROCESSING;
-
-	// Step 3: Fill out the D3DPRESENT_PARAMETERS structure.
- 
-    RECT rc;
-    GetClientRect(hwnd, &rc);
-    UINT w = rc.right - rc.left;
-    UINT h = rc.bottom - rc.top;
-	D3DPRESENT_PARAMETERS d3dpp;
-	d3dpp.BackBufferWidth            = w;
-	d3dpp.BackBufferHeight           = h;
-	d3dpp.BackBufferFormat           = D3DFMT_A8R8G8B8;
-	d3dpp.BackBufferCount            = 1;
-	d3dpp.MultiSampleType            = D3DMULTISAMPLE_NONE;
-	d3dpp.MultiSampleQuality         = 0;
-	d3dpp.SwapEffect                 = D3DSWAPEFFECT_DISCARD; 
-	d3dpp.hDeviceWindow              = hwnd;
-	d3dpp.Windowed                   = windowed;
-	d3dpp.EnableAutoDepthStencil     = true; 
-	d3dpp.AutoDepthStencilFormat     = D3DFMT_D24S8;
-	d3dpp.Flags                      = 0;
-	d3dpp.FullScreen_RefreshRateInHz = D3DPRESENT_RATE_DEFAULT;
-	d3dpp.PresentationInterval       = D3DPRESENT_INTERVAL_IMMEDIATE;
-
-	// Step 4: Create the device.
-
-	hr = d3d9->CreateDevice(
-		D3DADAPTER_DEFAULT, // primary adapter
-		deviceType,         // device type
-		hwnd,               // window associated with device
-		vp,                 // vertex processing
-	    &d3dpp,             // present parameters
-	    device);            // return created device
-
-	if( FAILED(hr) )
-	{
-		// try again using a 16-bit depth buffer
-		d3dpp.AutoDepthStencilFormat = D3DFMT_D16;
-		
-		hr = d3d9->CreateDevice(
-			D3DADAPTER_DEFAULT,
-			deviceType,
-			hwnd,
-			vp,
-			&d3dpp,
-			device);
-
-		if( FAILED(hr) )
-		{
-			d3d9->Release(); // done with d3d9 object
-			::MessageBox(0, "CreateDevice() - FAILED", 0, 0);
-			return false;
-		}
-	}
-
-	d3d9->Release(); // done with d3d9 object
-	
-	return true;
-}
-
-int d3d::EnterMsgLoop( bool (*ptr_display)(float timeDelta) )
-{
-	MSG msg;
-	::ZeroMemory(&msg, sizeof(MSG));
-
-	static double lastTime = (double)timeGetTime(); 
-
-	while(msg.message != WM_QUIT)
-	{
-		if(::PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
-		{
-			::TranslateMessage(&msg);
-			::DispatchMessage(&msg);
-		}
-		else
-        {	
-			double currTime  = (double)timeGetTime();
-			double timeDelta = (currTime - lastTime)*0.0007;
-			ptr_display((float)timeDelta);
-
-			lastTime = currTime;
-        }
-    }
-    return msg.wParam;
-}
-
-D3DLIGHT9 d3d::InitDirectionalLight(D3DXVECTOR3* direction, D3DXCOLOR* color)
-{
-	D3DLIGHT9 light;
-	::ZeroMemory(&light, sizeof(light));
-
-	light.Type      = D3DLIGHT_DIRECTIONAL;
-	light.Ambient   = *color * 0.6f;
-	light.Diffuse   = *color;
-	light.Specular  = *color * 0.6f;
-	light.Direction = *direction;
-
-	return light;
-}
-
-D3DLIGHT9 d3d::InitPointLight(D3DXVECTOR3* position, D3DXCOLOR* color)
-{
-	D3DLIGHT9 light;
-	::ZeroMemory(&light, sizeof(light));
-
-	light.Type      = D3DLIGHT_POINT;
-	light.Ambient   = *color * 0.6f;
-	light.Diffuse   = *color;
-	light.Specular  = *color * 0.6f;
-	light.Position  = *position;
-	light.Range        = 1000.0f;
-	light.Falloff      = 1.0f;
-	light.Attenuation0 = 1.0f;
-	light.Attenuation1 = 0.0f;
-	light.Attenuation2 = 0.0f;
-
-	return light;
-}
-
-D3DLIGHT9 d3d::InitSpotLight(D3DXVECTOR3* position, D3DXVECTOR3* direction, D3DXCOLOR* color)
-{
-	D3DLIGHT9 light;
-	::ZeroMemory(&light, sizeof(light));
-
-	light.Type      = D3DLIGHT_SPOT;
-	light.Ambient   = *color * 0.0f;
-	light.Diffuse   = *color;
-	light.Specular  = *color * 0.6f;
-	light.Position  = *position;
-	light.Direction = *direction;
-	light.Range        = 1000.0f;
-	light.Falloff      = 1.0f;
-	light.Attenuation0 = 1.0f;
-	light.Attenuation1 = 0.0f;
-	light.Attenuation2 = 0.0f;
-	light.Theta        = 0.4f;
-	light.Phi          = 0.9f;
-
-	return light;
-}
-
-D3DMATERIAL9 d3d::InitMtrl(D3DXCOLOR a, D3DXCOLOR d, D3DXCOLOR s, D3DXCOLOR e, float p)
-{
-	D3DMATERIAL9 mtrl;
-	mtrl.Ambient  = a;
-	mtrl.Diffuse  = d;
-	mtrl.Specular = s;
-	mtrl.Emissive = e;
-	mtrl.Power    = p;
-	return mtrl;
-}
-
-d3d::BoundingBox::BoundingBox()
-{
-	// infinite small 
-	_min.x = INFINITY;
-	_min.y = INFINITY;
-	_min.z = INFINITY;
-
-	_max.x = -INFINITY;
-	_max.y = -INFINITY;
-	_max.z = -INFINITY;
-}
-
-bool d3d::BoundingBox::isPointInside(D3DXVECTOR3& p)
-{
-	if( p.x >= _min.x && p.y >= _min.y && p.z >= _min.z &&
-		p.x <= _max.x && p.y <= _max.y && p.z <= _max.z )
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
-}
-
-d3d::BoundingSphere::BoundingSphere()
-{
-	_radius = 0.0f;
-}
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// 
+// File: d3dUtility.cpp
+// 
+// Author: Frank Luna (C) All Rights Reserved
+//
+// System: AMD Athlon 1800+ XP, 512 DDR, Geforce 3, Windows XP, MSVC++ 7.0 
+//
+// Desc: Provides utility functions for simplifying common tasks.
+//          
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "d3dUtility.h"
+
+bool d3d::InitD3D(
+	HINSTANCE hInstance,
+	int width, int height,
+	bool windowed,
+	D3DDEVTYPE deviceType,
+	IDirect3DDevice9** device)
+{
+	//
+	// Create the main application window.
+	//
+
+	WNDCLASS wc;
+
+	wc.style         = CS_HREDRAW | CS_VREDRAW;
+	wc.lpfnWndProc   = (WNDPROC)d3d::WndProc; 
+	wc.cbClsExtra    = 0;
+	wc.cbWndExtra    = 0;
+	wc.hInstance     = hInstance;
+	wc.hIcon         = LoadIcon(0, IDI_APPLICATION);
+	wc.hCursor       = LoadCursor(0, IDC_ARROW);
+	wc.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
+	wc.lpszMenuName  = 0;
+	wc.lpszClassName = "Direct3D9App";
+
+	if( !RegisterClass(&wc) ) 
+	{
+		::MessageBox(0, "RegisterClass() - FAILED", 0, 0);
+		return false;
+	}
+		
+	HWND hwnd = 0;
+    hwnd = ::CreateWindow("Direct3D9App",
+        "Virtual Billiard", 
+		WS_EX_TOPMOST,
+		0, 0, width, height,
+		0 /*parent hwnd*/, 0 /* menu */, hInstance, 0 /*extra*/); 
+
+	if( !hwnd )
+	{
+		::MessageBox(0, "CreateWindow() - FAILED", 0, 0);
+		return false;
+	}
+
+	::ShowWindow(hwnd, SW_SHOW);
+	::UpdateWindow(hwnd);
+
+	//
+	// Init D3D: 
+	//
+
+	HRESULT hr = 0;
+
+	// Step 1: Create the IDirect3D9 object.
+
+	IDirect3D9* d3d9 = 0;
+    d3d9 = Direct3DCreate9(D3D_SDK_VERSION);
+
+    if( !d3d9 )
+	{
+		::MessageBox(0, "Direct3DCreate9() - FAILED", 0, 0);
+		return false;
+	}
+
+	// Step 2: Check for hardware vp.
+
+	D3DCAPS9 caps;
+	d3d9->GetDeviceCaps(D3DADAPTER_DEFAULT, deviceType, &caps);
+
+	int vp = 0;
+	if( caps.DevCaps & D3DDEVCAPS_HWTRANSFORMANDLIGHT )
+		vp = D3DCREATE_HARDWARE_VERTEXPROCESSING;
+	else
+		vp = D3DCREATE_SOFTWARE_VERTEXPROCESSING;
+
+	// Step 3: Fill out the D3DPRESENT_PARAMETERS structure.
+ 
+    RECT rc;
+    GetClientRect(hwnd, &rc);
+    UINT w = rc.right - rc.left;
+    UINT h = rc.bottom - rc.top;
+	D3DPRESENT_PARAMETERS d3dpp;
+	d3dpp.BackBufferWidth            = w;
+	d3dpp.BackBufferHeight           = h;
+	d3dpp.BackBufferFormat           = D3DFMT_A8R8G8B8;
+	d3dpp.BackBufferCount            = 1;
+	d3dpp.MultiSampleType            = D3DMULTISAMPLE_NONE;
+	d3dpp.MultiSampleQuality         = 0;
+	d3dpp.SwapEffect                 = D3DSWAPEFFECT_DISCARD; 
+	d3dpp.hDeviceWindow              = hwnd;
+	d3dpp.Windowed                   = windowed;
+	d3dpp.EnableAutoDepthStencil     = true; 
+	d3dpp.AutoDepthStencilFormat     = D3DFMT_D24S8;
+	d3dpp.Flags                      = 0;
+	d3dpp.FullScreen_RefreshRateInHz = D3DPRESENT_RATE_DEFAULT;
+	d3dpp.PresentationInterval       = D3DPRESENT_INTERVAL_IMMEDIATE;
+
+	// Step 4: Create the device.
+
+	hr = d3d9->CreateDevice(
+		D3DADAPTER_DEFAULT, // primary adapter
+		deviceType,         // device type
+		hwnd,               // window associated with device
+		vp,                 // vertex processing
+	    &d3dpp,             // present parameters
+	    device);            // return created device
+
+	if( FAILED(hr) )
+	{
+		// try again using a 16-bit depth buffer
+		d3dpp.AutoDepthStencilFormat = D3DFMT_D16;
+		
+		hr = d3d9->CreateDevice(
+			D3DADAPTER_DEFAULT,
+			deviceType,
+			hwnd,
+			vp,
+			&d3dpp,
+			device);
+
+		if( FAILED(hr) )
+		{
+			d3d9->Release(); // done with d3d9 object
+			::MessageBox(0, "CreateDevice() - FAILED", 0, 0);
+			return false;
+		}
+	}
+
+	d3d9->Release(); // done with d3d9 object
+	
+	return true;
+}
+
+bool d3d::InitOffscreenD3D(
+	HINSTANCE hInstance,
+	D3DDEVTYPE deviceType,
+	IDirect3DDevice9** device,
+	HWND* window)
+{
+	*device = 0;
+	*window = 0;
+
+	// the window is never shown, the back buffer is a small placeholder
+	static bool registered = false;
+	if( !registered )
+	{
+		WNDCLASS wc;
+		::ZeroMemory(&wc, sizeof(wc));
+		wc.lpfnWndProc   = ::DefWindowProc;
+		wc.hInstance     = hInstance;
+		wc.lpszClassName = "Direct3D9Offscreen";
+		if( !RegisterClass(&wc) )
+			return false;
+		registered = true;
+	}
+
+	HWND hwnd = ::CreateWindow("Direct3D9Offscreen", "", WS_POPUP,
+		0, 0, 64, 64, 0, 0, hInstance, 0);
+	if( !hwnd )
+		return false;
+
+	IDirect3D9* d3d9 = Direct3DCreate9(D3D_SDK_VERSION);
+	if( !d3d9 )
+	{
+		::DestroyWindow(hwnd);
+		return false;
+	}
+
+	D3DCAPS9 caps;
+	if( FAILED(d3d9->GetDeviceCaps(D3DADAPTER_DEFAULT, deviceType, &caps)) )
+	{
+		d3d9->Release();
+		::DestroyWindow(hwnd);
+		return false;
+	}
+	int vp = (caps.DevCaps & D3DDEVCAPS_HWTRANSFORMANDLIGHT) ?
+		D3DCREATE_HARDWARE_VERTEXPROCESSING : D3DCREATE_SOFTWARE_VERTEXPROCESSING;
+
+	D3DPRESENT_PARAMETERS d3dpp;
+	::ZeroMemory(&d3dpp, sizeof(d3dpp));
+	d3dpp.BackBufferWidth            = 64;
+	d3dpp.BackBufferHeight           = 64;
+	d3dpp.BackBufferFormat           = D3DFMT_A8R8G8B8;
+	d3dpp.BackBufferCount            = 1;
+	d3dpp.MultiSampleType            = D3DMULTISAMPLE_NONE;
+	d3dpp.SwapEffect                 = D3DSWAPEFFECT_DISCARD;
+	d3dpp.hDeviceWindow              = hwnd;
+	d3dpp.Windowed                   = true;
+	d3dpp.EnableAutoDepthStencil     = false;	// the caller makes one the size of its render target
+	d3dpp.PresentationInterval       = D3DPRESENT_INTERVAL_IMMEDIATE;
+
+	// no D3DCREATE_MULTITHREADED: the caller hands each device to one thread at a time
+	HRESULT hr = d3d9->CreateDevice(D3DADAPTER_DEFAULT, deviceType, hwnd, vp, &d3dpp, device);
+	d3d9->Release(); // done with d3d9 object
+	if( FAILED(hr) )
+	{
+		*device = 0;
+		::DestroyWindow(hwnd);
+		return false;
+	}
+	*window = hwnd;
+	return true;
+}
+
+int d3d::EnterMsgLoop( bool (*ptr_display)(float timeDelta) )
+{
+	MSG msg;
+	::ZeroMemory(&msg, sizeof(MSG));
+
+	static double lastTime = (double)timeGetTime(); 
+	bool animating = true;
+
+	while(msg.message != WM_QUIT)
+	{
+		if(::PeekMessage(&msg, 0, 0, 0, PM_REMOVE))
+		{
+			::TranslateMessage(&msg);
+			::DispatchMessage(&msg);
+		}
+		else if( !animating )
+		{
+			// static scene: sleep until input or a timer wakes us up
+			::MsgWaitForMultipleObjects(0, 0, FALSE, INFINITE, QS_ALLINPUT);
+
+			// don't count the idle time as simulation time
+			lastTime  = (double)timeGetTime();
+			animating = true;
+		}
+		else
+        {	
+			double currTime  = (double)timeGetTime();
+			double timeDelta = (currTime - lastTime)*0.0007;
+			animating = ptr_display((float)timeDelta);
+
+			lastTime = currTime;
+        }
+    }
+    return msg.wParam;
+}
+
+D3DLIGHT9 d3d::InitDirectionalLight(D3DXVECTOR3* direction, D3DXCOLOR* color)
+{
+	D3DLIGHT9 light;
+	::ZeroMemory(&light, sizeof(light));
+
+	light.Type      = D3DLIGHT_DIRECTIONAL;
+	light.Ambient   = *color * 0.6f;
+	light.Diffuse   = *color;
+	light.Specular  = *color * 0.6f;
+	light.Direction = *direction;
+
+	return light;
+}
+
+D3DLIGHT9 d3d::InitPointLight(D3DXVECTOR3* position, D3DXCOLOR* color)
+{
+	D3DLIGHT9 light;
+	::ZeroMemory(&light, sizeof(light));
+
+	light.Type      = D3DLIGHT_POINT;
+	light.Ambient   = *color * 0.6f;
+	light.Diffuse   = *color;
+	light.Specular  = *color * 0.6f;
+	light.Position  = *position;
+	light.Range        = 1000.0f;
+	light.Falloff      = 1.0f;
+	light.Attenuation0 = 1.0f;
+	light.Attenuation1 = 0.0f;
+	light.Attenuation2 = 0.0f;
+
+	return light;
+}
+
+D3DLIGHT9 d3d::InitSpotLight(D3DXVECTOR3* position, D3DXVECTOR3* direction, D3DXCOLOR* color)
+{
+	D3DLIGHT9 light;
+	::ZeroMemory(&light, sizeof(light));
+
+	light.Type      = D3DLIGHT_SPOT;
+	light.Ambient   = *color * 0.0f;
+	light.Diffuse   = *color;
+	light.Specular  = *color * 0.6f;
+	light.Position  = *position;
+	light.Direction = *direction;
+	light.Range        = 1000.0f;
+	light.Falloff      = 1.0f;
+	light.Attenuation0 = 1.0f;
+	light.Attenuation1 = 0.0f;
+	light.Attenuation2 = 0.0f;
+	light.Theta        = 0.4f;
+	light.Phi          = 0.9f;
+
+	return light;
+}
+
+D3DMATERIAL9 d3d::InitMtrl(D3DXCOLOR a, D3DXCOLOR d, D3DXCOLOR s, D3DXCOLOR e, float p)
+{
+	D3DMATERIAL9 mtrl;
+	mtrl.Ambient  = a;
+	mtrl.Diffuse  = d;
+	mtrl.Specular = s;
+	mtrl.Emissive = e;
+	mtrl.Power    = p;
+	return mtrl;
+}
+
+d3d::BoundingBox::BoundingBox()
+{
+	// infinite small 
+	_min.x = INFINITY;
+	_min.y = INFINITY;
+	_min.z = INFINITY;
+
+	_max.x = -INFINITY;
+	_max.y = -INFINITY;
+	_max.z = -INFINITY;
+}
+
+bool d3d::BoundingBox::isPointInside(D3DXVECTOR3& p)
+{
+	if( p.x >= _min.x && p.y >= _min.y && p.z >= _min.z &&
+		p.x <= _max.x && p.y <= _max.y && p.z <= _max.z )
+	{
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+d3d::BoundingSphere::BoundingSphere()
+{
+	_radius = 0.0f;
+}
+
+d3d::Frustum::Frustum()
+{
+	// planes 6, 7 are padding that never rejects anything
+	for(int i = 0; i < 8; i++)
+	{
+		_a[i] = _b[i] = _c[i] = 0.0f;
+		_d[i] = INFINITY;
+	}
+}
+
+void d3d::Frustum::extract(const D3DXMATRIX& m)
+{
+	// Gribb/Hartmann: left, right, bottom, top, near, far
+	D3DXPLANE p[6];
+	p[0] = D3DXPLANE(m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41);
+	p[1] = D3DXPLANE(m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41);
+	p[2] = D3DXPLANE(m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42);
+	p[3] = D3DXPLANE(m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42);
+	p[4] = D3DXPLANE(m._13, m._23, m._33, m._43);
+	p[5] = D3DXPLANE(m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43);
+
+	for(int i = 0; i < 6; i++)
+	{
+		float len = sqrtf(p[i].a * p[i].a + p[i].b * p[i].b + p[i].c * p[i].c);
+		if( len < EPSILON )
+			len = 1.0f;
+		_a[i] = p[i].a / len;
+		_b[i] = p[i].b / len;
+		_c[i] = p[i].c / len;
+		_d[i] = p[i].d / len;
+	}
+}
+
+bool d3d::Frustum::isVisible(const BoundingSphere& sphere) const
+{
+	__m128 cx = _mm_set1_ps(sphere._center.x);
+	__m128 cy = _mm_set1_ps(sphere._center.y);
+	__m128 cz = _mm_set1_ps(sphere._center.z);
+	__m128 r  = _mm_set1_ps(-sphere._radius);
+
+	for(int i = 0; i < 8; i += 4)
+	{
+		__m128 dist = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_a + i), cx), _mm_mul_ps(_mm_loadu_ps(_b + i), cy)),
+			_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_c + i), cz), _mm_loadu_ps(_d + i)));
+
+		// completely behind any plane
+		if( _mm_movemask_ps(_mm_cmplt_ps(dist, r)) )
+			return false;
+	}
+	return true;
+}
+
+bool d3d::Frustum::isVisible(const BoundingBox& box) const
+{
+	__m128 minX = _mm_set1_ps(box._min.x), maxX = _mm_set1_ps(box._max.x);
+	__m128 minY = _mm_set1_ps(box._min.y), maxY = _mm_set1_ps(box._max.y);
+	__m128 minZ = _mm_set1_ps(box._min.z), maxZ = _mm_set1_ps(box._max.z);
+
+	for(int i = 0; i < 8; i += 4)
+	{
+		__m128 a = _mm_loadu_ps(_a + i);
+		__m128 b = _mm_loadu_ps(_b + i);
+		__m128 c = _mm_loadu_ps(_c + i);
+
+		// distance of the corner furthest along each plane normal
+		__m128 dist = _mm_add_ps(
+			_mm_add_ps(_mm_max_ps(_mm_mul_ps(a, minX), _mm_mul_ps(a, maxX)),
+			           _mm_max_ps(_mm_mul_ps(b, minY), _mm_mul_ps(b, maxY))),
+			_mm_add_ps(_mm_max_ps(_mm_mul_ps(c, minZ), _mm_mul_ps(c, maxZ)),
+			           _mm_loadu_ps(_d + i)));
+
+		if( _mm_movemask_ps(_mm_cmplt_ps(dist, _mm_setzero_ps())) )
+			return false;
+	}
+	return true;
+}
\ No newline at end of file
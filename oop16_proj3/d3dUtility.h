@@ -1,134 +1,180 @@
-//////////////////////////////////////////////////////////////////////////////////////////////////
-// 
-// File: d3dUtility.h
-// 
-// Author: Frank Luna (C) All Rights Reserved
-//
-// System: AMD Athlon 1800+ XP, 512 DDR, Geforce 3, Windows XP, MSVC++ 7.0 
-//
-// Desc: Provides utility functions for simplifying common tasks.
-//          
-//////////////////////////////////////////////////////////////////////////////////////////////////
-
-#ifndef __d3dUtilityH__
-#define __d3dUtilityH__
-
-#include <d3dx9.h>
-#include <string>
-#include <limits>
-
-//#define INFINITY FLT_MAX
-
-#define EPSILON 0.001f
-#define INFINITY FLT_MAX
-
-
-namespace d3d
-{
-	//
-	// Init
-	//
-	bool InitD3D(
-		HINSTANCE hInstance,       // [in] Application instance.
-		int width, int height,     // [in] Backbuffer dimensions.
-		bool windowed,             // [in] Windowed (true)or full screen (false).
-		D3DDEVTYPE deviceType,     // [in] HAL or REF
-		IDirect3DDevice9** device);// [out]The created device.
-
-	int EnterMsgLoop( 
-		bool (*ptr_display)(float timeDelta));
-
-	LRESULT CALLBACK WndProc(
-		HWND hwnd,
-		UINT msg, 
-		WPARAM wParam,
-		LPARAM lParam);
-
-	//
-	// Cleanup
-	//
-	template<class T> void Release(T t)
-	{
-		if( t )
-		{
-			t->Release();
-			t = 0;
-		}
-	}
-		
-	template<class T> void Delete(T t)
-	{
-		if( t )
-		{
-			delete t;
-			t = 0;
-		}
-	}
-
-	//
-	// Colors
-	//
-	const D3DXCOLOR      WHITE( D3DCOLOR_XRGB(255, 255, 255) );
-	const D3DXCOLOR      BLACK( D3DCOLOR_XRGB(  0,   0,   0) );
-	const D3DXCOLOR        RED( D3DCOLOR_XRGB(255,   0,   0) );
-	const D3DXCOLOR      GREEN( D3DCOLOR_XRGB(  0, 255,   0) );
-	const D3DXCOLOR       BLUE( D3DCOLOR_XRGB(  0,   0, 255) );
-	const D3DXCOLOR     YELLOW( D3DCOLOR_XRGB(255, 255,   0) );
-	const D3DXCOLOR       CYAN( D3DCOLOR_XRGB(  0, 255, 255) );
-	const D3DXCOLOR    MAGENTA( D3DCOLOR_XRGB(255,   0, 255) );
-	const D3DXCOLOR	   DARKRED( D3DCOLOR_XRGB(215,	0,	0));
-
-	//
-	// Lights
-	//
-
-	D3DLIGHT9 InitDirectionalLight(D3DXVECTOR3* direction, D3DXCOLOR* color);
-	D3DLIGHT9 InitPointLight(D3DXVECTOR3* position, D3DXCOLOR* color);
-	D3DLIGHT9 InitSpotLight(D3DXVECTOR3* position, D3DXVECTOR3* direction, D3DXCOLOR* color);
-
-	//
-	// Materials
-	//
-
-	D3DMATERIAL9 InitMtrl(D3DXCOLOR a, D3DXCOLOR d, D3DXCOLOR s, D3DXCOLOR e, float p);
-
-	const D3DMATERIAL9 WHITE_MTRL  = InitMtrl(WHITE, WHITE, WHITE, BLACK, 2.0f);
-	const D3DMATERIAL9 RED_MTRL    = InitMtrl(RED, RED, RED, BLACK, 2.0f);
-	const D3DMATERIAL9 GREEN_MTRL  = InitMtrl(GREEN, GREEN, GREEN, BLACK, 2.0f);
-	const D3DMATERIAL9 BLUE_MTRL   = InitMtrl(BLUE, BLUE, BLUE, BLACK, 2.0f);
-	const D3DMATERIAL9 YELLOW_MTRL = InitMtrl(YELLOW, YELLOW, YELLOW, BLACK, 2.0f);
-
-	//
-	// Bounding Objects / Math Objects
-	//
-
-	struct BoundingBox
-	{
-		BoundingBox();
-
-		bool isPointInside(D3DXVECTOR3& p);
-
-		D3DXVECTOR3 _min;
-		D3DXVECTOR3 _max;
-	};
-
-	struct BoundingSphere
-	{
-		BoundingSphere();
-
-		D3DXVECTOR3 _center;
-		float       _radius;
-	};
-
-	struct Ray
-	{
-		D3DXVECTOR3 _origin;
-		D3DXVECTOR3 _direction;
-	};
-
-	//
-	// Constants
-	//
-}
-
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// 
+// File: d3dUtility.h
+// 
+// Author: Frank Luna (C) All Rights Reserved
+//
+// System: AMD Athlon 1800+ XP, 512 DDR, Geforce 3, Windows XP, MSVC++ 7.0 
+//
+// Desc: Provides utility functions for simplifying common tasks.
+//          
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __d3dUtilityH__
+#define __d3dUtilityH__
+
+#include <d3dx9.h>
+#include <xmmintrin.h>
+#include <string>
+#include <limits>
+#include "vecmath.h"
+
+//#define INFINITY FLT_MAX
+
+#define EPSILON 0.001f
+#define INFINITY FLT_MAX
+
+
+namespace d3d
+{
+	//
+	// Init
+	//
+	bool InitD3D(
+		HINSTANCE hInstance,       // [in] Application instance.
+		int width, int height,     // [in] Backbuffer dimensions.
+		bool windowed,             // [in] Windowed (true)or full screen (false).
+		D3DDEVTYPE deviceType,     // [in] HAL or REF
+		IDirect3DDevice9** device);// [out]The created device.
+
+	// Device on a hidden window for drawing into offscreen render targets
+	// only (offline rendering). The device is not created with
+	// D3DCREATE_MULTITHREADED: only one thread may use it at a time.
+	// Release the device, then DestroyWindow() the window, from the thread
+	// that called this (it owns the window).
+	bool InitOffscreenD3D(
+		HINSTANCE hInstance,       // [in] Application instance.
+		D3DDEVTYPE deviceType,     // [in] HAL or REF
+		IDirect3DDevice9** device, // [out]The created device.
+		HWND* window);             // [out]Its hidden window.
+
+	// ptr_display returns false when the scene did not change and nothing
+	// is animating; the loop then blocks until the next message arrives.
+	int EnterMsgLoop( 
+		bool (*ptr_display)(float timeDelta));
+
+	LRESULT CALLBACK WndProc(
+		HWND hwnd,
+		UINT msg, 
+		WPARAM wParam,
+		LPARAM lParam);
+
+	//
+	// Cleanup
+	//
+	template<class T> void Release(T t)
+	{
+		if( t )
+		{
+			t->Release();
+			t = 0;
+		}
+	}
+		
+	template<class T> void Delete(T t)
+	{
+		if( t )
+		{
+			delete t;
+			t = 0;
+		}
+	}
+
+	//
+	// Colors
+	//
+	const D3DXCOLOR      WHITE( D3DCOLOR_XRGB(255, 255, 255) );
+	const D3DXCOLOR      BLACK( D3DCOLOR_XRGB(  0,   0,   0) );
+	const D3DXCOLOR        RED( D3DCOLOR_XRGB(255,   0,   0) );
+	const D3DXCOLOR      GREEN( D3DCOLOR_XRGB(  0, 255,   0) );
+	const D3DXCOLOR       BLUE( D3DCOLOR_XRGB(  0,   0, 255) );
+	const D3DXCOLOR     YELLOW( D3DCOLOR_XRGB(255, 255,   0) );
+	const D3DXCOLOR       CYAN( D3DCOLOR_XRGB(  0, 255, 255) );
+	const D3DXCOLOR    MAGENTA( D3DCOLOR_XRGB(255,   0, 255) );
+	const D3DXCOLOR	   DARKRED( D3DCOLOR_XRGB(215,	0,	0));
+
+	//
+	// Lights
+	//
+
+	D3DLIGHT9 InitDirectionalLight(D3DXVECTOR3* direction, D3DXCOLOR* color);
+	D3DLIGHT9 InitPointLight(D3DXVECTOR3* position, D3DXCOLOR* color);
+	D3DLIGHT9 InitSpotLight(D3DXVECTOR3* position, D3DXVECTOR3* direction, D3DXCOLOR* color);
+
+	//
+	// Materials
+	//
+
+	D3DMATERIAL9 InitMtrl(D3DXCOLOR a, D3DXCOLOR d, D3DXCOLOR s, D3DXCOLOR e, float p);
+
+	const D3DMATERIAL9 WHITE_MTRL  = InitMtrl(WHITE, WHITE, WHITE, BLACK, 2.0f);
+	const D3DMATERIAL9 RED_MTRL    = InitMtrl(RED, RED, RED, BLACK, 2.0f);
+	const D3DMATERIAL9 GREEN_MTRL  = InitMtrl(GREEN, GREEN, GREEN, BLACK, 2.0f);
+	const D3DMATERIAL9 BLUE_MTRL   = InitMtrl(BLUE, BLUE, BLUE, BLACK, 2.0f);
+	const D3DMATERIAL9 YELLOW_MTRL = InitMtrl(YELLOW, YELLOW, YELLOW, BLACK, 2.0f);
+
+	//
+	// Bounding Objects / Math Objects
+	//
+
+	struct BoundingBox
+	{
+		BoundingBox();
+
+		bool isPointInside(D3DXVECTOR3& p);
+
+		D3DXVECTOR3 _min;
+		D3DXVECTOR3 _max;
+	};
+
+	struct BoundingSphere
+	{
+		BoundingSphere();
+
+		D3DXVECTOR3 _center;
+		float       _radius;
+	};
+
+	struct Ray
+	{
+		D3DXVECTOR3 _origin;
+		D3DXVECTOR3 _direction;
+	};
+
+	//
+	// View frustum, planes are stored SoA so four planes are tested at once
+	//
+
+	struct Frustum
+	{
+		Frustum();
+
+		// Extracts the six planes from a (world *) view * projection matrix.
+		void extract(const D3DXMATRIX& viewProj);
+
+		bool isVisible(const BoundingSphere& sphere) const;
+		bool isVisible(const BoundingBox& box) const;
+
+		float _a[8];
+		float _b[8];
+		float _c[8];
+		float _d[8];
+	};
+
+	//
+	// vecmath.h shims for calls into D3D/D3DX, Mat4 has the D3DXMATRIX layout
+	//
+
+	static_assert(sizeof(Mat4) == sizeof(D3DXMATRIX), "Mat4 must match D3DXMATRIX");
+	static_assert(sizeof(Vec3) == sizeof(D3DXVECTOR3), "Vec3 must match D3DXVECTOR3");
+
+	inline const D3DXMATRIX& toD3DX(const Mat4& m) { return *reinterpret_cast<const D3DXMATRIX*>(&m); }
+	inline D3DXVECTOR3 toD3DX(const Vec3& v) { return D3DXVECTOR3(v.x, v.y, v.z); }
+	inline Vec3 fromD3DX(const D3DXVECTOR3& v) { return Vec3(v.x, v.y, v.z); }
+
+	//
+	// Constants
+	//
+}
+
 #endif // __d3dUtilityH__
\ No newline at end of file
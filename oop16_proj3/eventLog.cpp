@@ -0,0 +1,247 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventLog.cpp
+//
+// Desc: Per-thread rings and the flush thread of the event log.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "eventLog.h"
+#include <cstring>
+
+typedef std::chrono::steady_clock Clock;
+
+#define THREAD_RING_CACHE 4		// 한 스레드가 동시에 쓰는 로그 수
+
+namespace {
+
+// 로그마다 start()할 때 받는 번호, 같은 주소에 새로 만든 로그와도 겹치지 않음
+std::atomic<unsigned int> g_nextGeneration(1);
+
+// 이 스레드가 받은 링, 로그와 start() 번호가 같을 때만 유효
+struct ThreadRing {
+	const void*		pLog;
+	unsigned int	generation;
+	void*			pRing;
+};
+thread_local ThreadRing t_rings[THREAD_RING_CACHE];
+
+}
+
+CEventLog::CEventLog(void)
+{
+	m_fp = NULL;
+	m_mask = 0;
+	m_ringCount = 0;
+	m_lost = 0;
+	m_running = false;
+	m_generation = 0;
+	m_quit = false;
+	m_written = 0;
+	m_flushSeconds = m_worstFlushSeconds = 0;
+}
+
+CEventLog::~CEventLog(void)
+{
+	stop();
+}
+
+bool CEventLog::start(const char* path, int ringEvents)
+{
+	stop();
+	m_fp = fopen(path, "wb");
+	if (m_fp == NULL)
+		return false;
+
+	uint32_t size = 1;
+	while (size < (uint32_t)ringEvents)
+		size <<= 1;
+	m_mask = size - 1;
+	for (int i = 0; i < EVENT_MAX_THREADS; i++) {
+		if (!m_rings[i])
+			m_rings[i].reset(new Ring());
+		Ring& r = *m_rings[i];
+		r.index = (uint8_t)i;
+		r.head = 0;
+		r.tail = 0;
+		r.dropped = 0;
+		r.droppedReported = 0;
+		r.events.resize(size);
+	}
+	m_ringCount = 0;
+	m_lost = 0;
+	m_written = 0;
+	m_flushSeconds = m_worstFlushSeconds = 0;
+	m_generation = g_nextGeneration++;
+
+	EventLogHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = EVENTLOG_MAGIC;
+	h.version = EVENTLOG_VERSION;
+	h.headerSize = sizeof(EventLogHeader);
+	h.eventSize = sizeof(LogEvent);
+	h.startTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	fwrite(&h, sizeof(h), 1, m_fp);
+
+	m_start = Clock::now();
+	m_quit = false;
+	m_running = true;
+	m_thread = std::thread(&CEventLog::flusherMain, this);
+	return true;
+}
+
+void CEventLog::stop(void)
+{
+	if (!m_running)
+		return;
+	m_running = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+	fclose(m_fp);
+	m_fp = NULL;
+}
+
+// 처음 한 번만 링 번호를 하나 가져옴, 그 뒤로는 스레드 지역 변수 비교뿐
+// 링이 모자라 받지 못한 것 (NULL)도 기억해 두므로 그런 스레드도 번호를 다시 가져가지 않음
+CEventLog::Ring* CEventLog::threadRing(void)
+{
+	ThreadRing* pFree = NULL;
+	for (int i = 0; i < THREAD_RING_CACHE; i++) {
+		ThreadRing& t = t_rings[i];
+		if (t.pLog == this && t.generation == m_generation)
+			return (Ring*)t.pRing;
+		if (pFree == NULL && (t.pLog == NULL || t.pLog == this))
+			pFree = &t;
+	}
+	// 번호는 EVENT_MAX_THREADS를 넘겨 올리지 않음
+	Ring* pRing = NULL;
+	int index = m_ringCount.load(std::memory_order_relaxed);
+	while (index < EVENT_MAX_THREADS) {
+		if (m_ringCount.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+			pRing = m_rings[index].get();
+			break;
+		}
+	}
+	if (pFree == NULL)
+		pFree = &t_rings[0];
+	pFree->pLog = this;
+	pFree->generation = m_generation;
+	pFree->pRing = pRing;
+	return pRing;
+}
+
+void CEventLog::log(EventType type, int i0, int match, float f0, float f1, float f2, float f3)
+{
+	if (!m_running.load(std::memory_order_relaxed))
+		return;
+	Ring* pRing = threadRing();
+	if (pRing == NULL) {
+		m_lost.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// 이 스레드만 head를 바꾸므로 relaxed로 읽고, tail은 쓰기 스레드가 다 읽은 뒤에 놓음
+	uint32_t head = pRing->head.load(std::memory_order_relaxed);
+	uint32_t tail = pRing->tail.load(std::memory_order_acquire);
+	if (head - tail > m_mask) {
+		pRing->dropped.store(pRing->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return;
+	}
+	LogEvent& e = pRing->events[head & m_mask];
+	e.time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+	e.type = (uint8_t)type;
+	e.thread = pRing->index;
+	e.i0 = (int16_t)i0;
+	e.match = match;
+	e.f[0] = f0;
+	e.f[1] = f1;
+	e.f[2] = f2;
+	e.f[3] = f3;
+	pRing->head.store(head + 1, std::memory_order_release);
+}
+
+CEventLog::Stats CEventLog::getStats(void) const
+{
+	Stats s;
+	memset(&s, 0, sizeof(s));
+	int rings = m_ringCount.load(std::memory_order_relaxed);
+	s.threads = rings < EVENT_MAX_THREADS ? rings : EVENT_MAX_THREADS;
+	for (int i = 0; i < s.threads; i++) {
+		s.logged += m_rings[i]->head.load(std::memory_order_relaxed);
+		s.dropped += m_rings[i]->dropped.load(std::memory_order_relaxed);
+	}
+	s.dropped += m_lost.load(std::memory_order_relaxed);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	s.written = m_written;
+	s.flushSeconds = m_flushSeconds;
+	s.worstFlushSeconds = m_worstFlushSeconds;
+	return s;
+}
+
+void CEventLog::flusherMain(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_wake.wait_for(lock, std::chrono::milliseconds(EVENT_FLUSH_MS), [this] { return m_quit; });
+		bool quit = m_quit;
+		lock.unlock();
+
+		Clock::time_point t0 = Clock::now();
+		drain();
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		lock.lock();
+		m_flushSeconds += sec;
+		if (sec > m_worstFlushSeconds)
+			m_worstFlushSeconds = sec;
+		if (quit)
+			break;
+	}
+}
+
+// 링의 기록은 넣은 스레드가 head를 옮긴 뒤에만 읽고, 파일에 쓴 뒤에 tail을 옮겨 자리를 돌려줌
+void CEventLog::drain(void)
+{
+	int rings = m_ringCount.load(std::memory_order_relaxed);
+	if (rings > EVENT_MAX_THREADS)
+		rings = EVENT_MAX_THREADS;
+	long long written = 0;
+	for (int i = 0; i < rings; i++) {
+		Ring& r = *m_rings[i];
+		uint32_t tail = r.tail.load(std::memory_order_relaxed);
+		uint32_t head = r.head.load(std::memory_order_acquire);
+		while (tail != head) {
+			uint32_t first = tail & m_mask;
+			uint32_t count = head - tail;
+			if (count > m_mask + 1 - first)
+				count = m_mask + 1 - first;		// 링 끝에서 한 번 끊음
+			fwrite(&r.events[first], sizeof(LogEvent), count, m_fp);
+			tail += count;
+			written += count;
+		}
+		r.tail.store(tail, std::memory_order_release);
+
+		long long dropped = r.dropped.load(std::memory_order_relaxed);
+		if (dropped != r.droppedReported) {
+			LogEvent e;
+			memset(&e, 0, sizeof(e));
+			e.time = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_start).count();
+			e.type = EVENT_DROPPED;
+			e.thread = (uint8_t)i;
+			e.i0 = (int16_t)i;
+			e.f[0] = (float)(dropped - r.droppedReported);
+			fwrite(&e, sizeof(e), 1, m_fp);
+			r.droppedReported = dropped;
+			written++;
+		}
+	}
+	fflush(m_fp);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_written += written;
+}
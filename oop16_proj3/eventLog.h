@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventLog.h
+//
+// Desc: Structured binary log of what happened in a game (shots, contacts,
+//       bricks, pockets, turn ends, score changes) and of frame-time
+//       spikes, for looking at a session afterwards.
+//       log() never locks and never allocates: every thread that logs
+//       takes one of the rings allocated by start() the first time it logs
+//       and is its only writer, and a background thread drains the rings
+//       into the file every EVENT_FLUSH_MS. When a ring is full the event
+//       is dropped and counted, and the flush thread writes an
+//       EVENT_DROPPED record so the loss shows in the log. Memory is fixed
+//       at EVENT_MAX_THREADS rings of the size given to start().
+//
+//       The file is an EventLogHeader followed by 32-byte LogEvent records,
+//       grouped per ring in flush order (sort by time to merge threads).
+//       tools/eventlog2csv converts it to CSV. CEventLogListener turns
+//       the CGame listener calls into records.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __eventLogH__
+#define __eventLogH__
+
+#include "game.h"
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define EVENTLOG_MAGIC		0x47564556	// "VEVG"
+#define EVENTLOG_VERSION	1
+
+#define EVENT_MAX_THREADS 16		// 링 수, 이보다 많은 스레드의 기록은 버림
+#define EVENT_RING_SIZE 4096		// 스레드마다 담아 둘 수 있는 기록 (2의 거듭제곱)
+#define EVENT_FLUSH_MS 50			// 쓰기 스레드가 링을 비우는 간격
+
+// 기록 종류와 각 필드의 뜻
+enum EventType {
+	EVENT_SHOT = 1,			// i0 친 플레이어, f 목표 x, z, 당점 옆, 위
+	EVENT_CONTACT,			// 공과 공, 벽, 벽돌의 충돌, f 위치 x, z, 부딪힌 속도
+	EVENT_BRICK,			// 벽돌이 깨짐, f 벽돌 중심 x, z
+	EVENT_POCKET,			// i0 빠진 공 번호 (getBallId), f 위치 x, z
+	EVENT_TURN_END,			// 공이 모두 멈춤, i0 다음 플레이어, f 점수1, 점수2, 샷에 걸린 스텝
+	EVENT_SCORE,			// i0 플레이어, f 점수 변화, 바뀐 점수
+	EVENT_FRAME_SPIKE,		// f 프레임 시간 ms, 기준 ms
+	EVENT_DROPPED,			// 링이 가득 차 버린 기록, i0 링 번호, f 이번에 버린 수
+};
+
+#pragma pack(push, 4)
+
+struct EventLogHeader {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	headerSize;
+	uint32_t	eventSize;			// sizeof(LogEvent)
+	uint32_t	reserved;
+	int64_t		startTime;			// start() 때의 시각, 1970년부터 ms
+};
+
+struct LogEvent {
+	int64_t		time;				// start()부터 ns
+	uint8_t		type;				// EventType
+	uint8_t		thread;				// 기록한 링 번호
+	int16_t		i0;
+	int32_t		match;				// 경기 번호 (서버), 창에서는 0
+	float		f[4];
+};
+
+#pragma pack(pop)
+
+class CEventLog {
+public:
+	struct Stats {
+		long long	logged;				// 링에 넣은 기록
+		long long	dropped;			// 링이 가득 차거나 링을 받지 못해 버린 기록
+		long long	written;			// 파일에 쓴 기록 (EVENT_DROPPED 포함)
+		int			threads;			// 링을 받은 스레드
+		double		flushSeconds;		// 쓰기 스레드가 링을 비우는 데 쓴 시간 합
+		double		worstFlushSeconds;
+	};
+
+	CEventLog(void);
+	~CEventLog(void);
+
+	// 링을 모두 잡고 파일을 연 뒤 쓰기 스레드 시작, ringEvents는 2의 거듭제곱으로 올림
+	bool start(const char* path, int ringEvents = EVENT_RING_SIZE);
+	// 링에 남은 기록까지 쓰고 파일을 닫음
+	void stop(void);
+	bool isRunning(void) const { return m_running.load(std::memory_order_relaxed); }
+
+	// 어느 스레드에서나, 시작하지 않았으면 아무것도 하지 않음
+	void log(EventType type, int i0, int match, float f0 = 0, float f1 = 0, float f2 = 0, float f3 = 0);
+
+	Stats getStats(void) const;
+
+private:
+	CEventLog(const CEventLog&);
+	CEventLog& operator=(const CEventLog&);
+
+	// 한 스레드가 쓰고 쓰기 스레드가 읽음, head와 tail 사이를 띄워 서로 다른 캐시 줄에
+	struct Ring {
+		std::atomic<uint32_t>	head;		// 다음에 쓸 자리, 기록하는 스레드만 바꿈
+		std::atomic<long long>	dropped;
+		char					pad[64];
+		std::atomic<uint32_t>	tail;		// 다음에 읽을 자리, 쓰기 스레드만 바꿈
+		long long				droppedReported;		// 쓰기 스레드가 EVENT_DROPPED로 남긴 수
+		uint8_t					index;
+		std::vector<LogEvent>	events;
+	};
+
+	Ring* threadRing(void);
+	void flusherMain(void);
+	void drain(void);
+
+	FILE*			m_fp;
+	uint32_t		m_mask;
+	std::unique_ptr<Ring>	m_rings[EVENT_MAX_THREADS];
+	std::atomic<int>		m_ringCount;		// 스레드에 나눠 준 링 수, EVENT_MAX_THREADS까지
+	std::atomic<long long>	m_lost;				// 링을 받지 못한 스레드가 버린 기록
+	std::atomic<bool>		m_running;
+	unsigned int	m_generation;				// start()마다 바뀜, 스레드가 기억한 링을 무효로
+	std::chrono::steady_clock::time_point	m_start;
+
+	mutable std::mutex			m_mutex;		// 쓰기 스레드와 통계만, log()는 쓰지 않음
+	std::condition_variable		m_wake;
+	std::thread		m_thread;
+	bool			m_quit;
+	long long		m_written;
+	double			m_flushSeconds;
+	double			m_worstFlushSeconds;
+};
+
+// CGame이 알려 주는 일을 기록하고, pNext (충돌 효과 등)가 있으면 그대로 넘김
+// 기록은 CGame을 진행하는 스레드의 링에 들어감
+class CEventLogListener : public CGameListener {
+public:
+	CEventLogListener(void) : m_pLog(NULL), m_pNext(NULL), m_match(0) {}
+
+	void attach(CEventLog* pLog, CGameListener* pNext = NULL) { m_pLog = pLog; m_pNext = pNext; }
+	// 서버처럼 한 리스너로 여러 경기를 진행할 때, 진행하기 전에 경기 번호를 바꿈
+	void setMatch(int match) { m_match = match; }
+
+	void onImpact(const Contact& c)
+	{
+		m_pLog->log(EVENT_CONTACT, 0, m_match, c.x, c.z, c.speed);
+		if (m_pNext != NULL)
+			m_pNext->onImpact(c);
+	}
+	void onBrickBroken(float x, float z, float normalX, float normalZ)
+	{
+		m_pLog->log(EVENT_BRICK, 0, m_match, x, z);
+		if (m_pNext != NULL)
+			m_pNext->onBrickBroken(x, z, normalX, normalZ);
+	}
+	void onPocketed(int ballId, float x, float z)
+	{
+		m_pLog->log(EVENT_POCKET, ballId, m_match, x, z);
+		if (m_pNext != NULL)
+			m_pNext->onPocketed(ballId, x, z);
+	}
+	void onStrike(int player, float targetX, float targetZ, float tipSide, float tipHeight)
+	{
+		m_pLog->log(EVENT_SHOT, player, m_match, targetX, targetZ, tipSide, tipHeight);
+		if (m_pNext != NULL)
+			m_pNext->onStrike(player, targetX, targetZ, tipSide, tipHeight);
+	}
+	// 점수가 바뀐 플레이어마다 EVENT_SCORE를 먼저 남김
+	void onTurnEnd(int nextPlayer, int score1, int score2, int delta1, int delta2, int steps)
+	{
+		if (delta1 != 0)
+			m_pLog->log(EVENT_SCORE, 1, m_match, (float)delta1, (float)score1);
+		if (delta2 != 0)
+			m_pLog->log(EVENT_SCORE, 2, m_match, (float)delta2, (float)score2);
+		m_pLog->log(EVENT_TURN_END, nextPlayer, m_match, (float)score1, (float)score2, (float)steps);
+		if (m_pNext != NULL)
+			m_pNext->onTurnEnd(nextPlayer, score1, score2, delta1, delta2, steps);
+	}
+
+private:
+	CEventLog*		m_pLog;
+	CGameListener*	m_pNext;
+	int				m_match;
+};
+
+#endif // __eventLogH__
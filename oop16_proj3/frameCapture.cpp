@@ -0,0 +1,169 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: frameCapture.cpp
+//
+// Desc: GPU copy ring and read-back of the window recorder.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "frameCapture.h"
+#include "d3dUtility.h"
+#include <string.h>
+
+typedef std::chrono::steady_clock Clock;
+
+CFrameCapture::CFrameCapture(void)
+{
+	m_pDevice = NULL;
+	m_pReadback = NULL;
+	memset(m_slots, 0, sizeof(m_slots));
+	m_next = 0;
+	m_width = m_height = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+CFrameCapture::~CFrameCapture(void)
+{
+	stop();
+}
+
+bool CFrameCapture::start(IDirect3DDevice9* pDevice, const char* path)
+{
+	stop();
+
+	IDirect3DSurface9* pBack = NULL;
+	if (FAILED(pDevice->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &pBack)))
+		return false;
+	D3DSURFACE_DESC desc;
+	HRESULT hr = pBack->GetDesc(&desc);
+	pBack->Release();
+	// 32비트 BGRA만 그대로 파일에 씀
+	if (FAILED(hr) || (desc.Format != D3DFMT_A8R8G8B8 && desc.Format != D3DFMT_X8R8G8B8))
+		return false;
+	m_width = (int)desc.Width;
+	m_height = (int)desc.Height;
+
+	m_pDevice = pDevice;
+	bool ok = SUCCEEDED(pDevice->CreateOffscreenPlainSurface(desc.Width, desc.Height, desc.Format,
+		D3DPOOL_SYSTEMMEM, &m_pReadback, NULL));
+	for (int i = 0; i < CAPTURE_SLOTS && ok; i++) {
+		Slot& s = m_slots[i];
+		ok = SUCCEEDED(pDevice->CreateRenderTarget(desc.Width, desc.Height, desc.Format,
+			D3DMULTISAMPLE_NONE, 0, FALSE, &s.pCopy, NULL)) &&
+			SUCCEEDED(pDevice->CreateQuery(D3DQUERYTYPE_EVENT, &s.pDone));
+		s.pending = false;
+	}
+	if (ok)
+		ok = m_writer.start(path, m_width, m_height, CAPTURE_BUFFERS);
+	if (!ok) {
+		release();
+		return false;
+	}
+
+	m_next = 0;
+	m_lastCopy = Clock::now() - std::chrono::seconds(1);
+	memset(&m_stats, 0, sizeof(m_stats));
+	return true;
+}
+
+// 녹화를 멈출 때는 기다려도 되므로 남은 복사본을 flush하고 모두 읽음
+void CFrameCapture::stop(void)
+{
+	if (m_pDevice == NULL)
+		return;
+	for (int k = 0; k < CAPTURE_SLOTS; k++) {
+		Slot& s = m_slots[(m_next + k) % CAPTURE_SLOTS];
+		if (!s.pending)
+			continue;
+		while (s.pDone->GetData(NULL, 0, D3DGETDATA_FLUSH) == S_FALSE)
+			;
+		readBack(s);
+	}
+	m_writer.stop();
+	release();
+}
+
+void CFrameCapture::release(void)
+{
+	for (int i = 0; i < CAPTURE_SLOTS; i++) {
+		d3d::Release(m_slots[i].pCopy);
+		d3d::Release(m_slots[i].pDone);
+		m_slots[i].pCopy = NULL;
+		m_slots[i].pDone = NULL;
+		m_slots[i].pending = false;
+	}
+	d3d::Release(m_pReadback);
+	m_pReadback = NULL;
+	m_pDevice = NULL;
+}
+
+void CFrameCapture::onFrame(void)
+{
+	if (m_pDevice == NULL)
+		return;
+	Clock::time_point t0 = Clock::now();
+	m_stats.frames++;
+
+	// 복사는 순서대로 끝나므로 가장 오래된 슬롯부터, 끝나지 않은 것을 만나면 다음 프레임에
+	// flush 없이 묻기만 해서 GPU를 기다리지 않음
+	for (int k = 0; k < CAPTURE_SLOTS; k++) {
+		Slot& s = m_slots[(m_next + k) % CAPTURE_SLOTS];
+		if (!s.pending)
+			continue;
+		if (s.pDone->GetData(NULL, 0, 0) != S_OK)
+			break;
+		readBack(s);
+	}
+
+	if (t0 - m_lastCopy >= std::chrono::microseconds(1000000 / CAPTURE_FPS)) {
+		m_lastCopy = t0;
+		Slot& s = m_slots[m_next];
+		IDirect3DSurface9* pBack = NULL;
+		if (s.pending)
+			m_stats.droppedRing++;
+		else if (SUCCEEDED(m_pDevice->GetBackBuffer(0, 0, D3DBACKBUFFER_TYPE_MONO, &pBack))) {
+			if (SUCCEEDED(m_pDevice->StretchRect(pBack, NULL, s.pCopy, NULL, D3DTEXF_NONE))) {
+				s.pDone->Issue(D3DISSUE_END);
+				s.pending = true;
+				s.frame = m_stats.frames;
+				m_next = (m_next + 1) % CAPTURE_SLOTS;
+				m_stats.copied++;
+			}
+			pBack->Release();
+		}
+	}
+
+	double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+	m_stats.cpuSeconds += sec;
+	if (sec > m_stats.worstCpuSeconds)
+		m_stats.worstCpuSeconds = sec;
+}
+
+// GPU가 복사를 끝낸 슬롯이므로 GetRenderTargetData()는 전송만 함
+void CFrameCapture::readBack(Slot& s)
+{
+	s.pending = false;
+	int latency = (int)(m_stats.frames - s.frame);
+	m_stats.latencyFrames += latency;
+	if (latency > m_stats.worstLatencyFrames)
+		m_stats.worstLatencyFrames = latency;
+
+	unsigned char* pFrame = m_writer.acquire();
+	if (pFrame == NULL) {
+		m_stats.droppedWriter++;
+		return;
+	}
+	D3DLOCKED_RECT locked;
+	if (FAILED(m_pDevice->GetRenderTargetData(s.pCopy, m_pReadback)) ||
+		FAILED(m_pReadback->LockRect(&locked, NULL, D3DLOCK_READONLY))) {
+		m_writer.discard(pFrame);
+		return;
+	}
+	int pitch = m_writer.getPitch();
+	const unsigned char* pSrc = (const unsigned char*)locked.pBits;
+	for (int y = 0; y < m_height; y++)
+		memcpy(pFrame + y * pitch, pSrc + y * locked.Pitch, pitch);
+	m_pReadback->UnlockRect();
+	m_writer.submit(pFrame);
+	m_stats.captured++;
+}
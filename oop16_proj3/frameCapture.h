@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: frameCapture.h
+//
+// Desc: Records the window to a file without stalling Present. Reading
+//       the back buffer right after drawing makes the CPU wait for the GPU
+//       to finish the frame, so each captured frame is first copied on the
+//       GPU (StretchRect) into one of a small ring of render targets and an
+//       event query is issued behind the copy. Later frames check the
+//       queries without flushing, and only a copy the GPU has finished is
+//       read back into system memory and handed to CFrameWriter, whose
+//       thread writes the file. When the ring or the writer is full the
+//       frame is dropped and counted, never waited for.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __frameCaptureH__
+#define __frameCaptureH__
+
+#include <d3dx9.h>
+#include <chrono>
+#include "frameWriter.h"
+
+#define CAPTURE_FPS 60			// 녹화하는 프레임 빈도, 더 자주 그려도 이만큼만 복사
+#define CAPTURE_SLOTS 4			// GPU 복사본 링, 읽기까지 이만큼의 프레임 여유가 있음
+#define CAPTURE_BUFFERS 16		// 쓰기를 기다릴 수 있는 프레임
+
+class CFrameCapture {
+public:
+	struct Stats {
+		long long	frames;				// onFrame() 호출, 그린 프레임
+		long long	copied;				// GPU에서 복사한 프레임
+		long long	captured;			// 읽어서 쓰기 스레드에 넘긴 프레임
+		long long	droppedRing;		// 복사본 링이 가득 차 건너뛴 프레임
+		long long	droppedWriter;		// 쓰기 스레드가 밀려 버린 프레임
+		long long	latencyFrames;		// 복사에서 읽기까지 지난 프레임 합
+		int			worstLatencyFrames;
+		double		cpuSeconds;			// onFrame() 안에서 쓴 시간 합
+		double		worstCpuSeconds;	// 가장 오래 걸린 한 프레임
+	};
+
+	CFrameCapture(void);
+	~CFrameCapture(void);
+
+	// 백 버퍼 크기로 링과 쓰기 스레드를 준비하고 녹화 시작
+	bool start(IDirect3DDevice9* pDevice, const char* path);
+	// 남은 복사본까지 읽어 쓰고 자원을 놓음
+	void stop(void);
+	bool isRecording(void) const { return m_pDevice != NULL; }
+
+	// EndScene()과 Present() 사이에서 매 프레임
+	void onFrame(void);
+
+	const Stats& getStats(void) const { return m_stats; }
+	const CFrameWriter& getWriter(void) const { return m_writer; }
+
+private:
+	CFrameCapture(const CFrameCapture&);
+	CFrameCapture& operator=(const CFrameCapture&);
+
+	struct Slot {
+		IDirect3DSurface9*	pCopy;			// GPU 쪽 복사본
+		IDirect3DQuery9*	pDone;			// 복사가 끝나면 신호
+		bool				pending;		// 복사했고 아직 읽지 않음
+		long long			frame;			// 복사한 프레임 번호
+	};
+
+	void readBack(Slot& slot);
+	void release(void);
+
+	IDirect3DDevice9*	m_pDevice;
+	IDirect3DSurface9*	m_pReadback;		// 시스템 메모리, 모든 슬롯이 같이 씀
+	Slot				m_slots[CAPTURE_SLOTS];
+	int					m_next;				// 다음에 복사할 슬롯, 가장 오래된 것부터 읽음
+	int					m_width, m_height;
+	std::chrono::steady_clock::time_point	m_lastCopy;
+	CFrameWriter		m_writer;
+	Stats				m_stats;
+};
+
+#endif // __frameCaptureH__
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: frameWriter.cpp
+//
+// Desc: Writer thread and buffer pool for captured frames.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "frameWriter.h"
+#include <chrono>
+#include <cstring>
+
+typedef std::chrono::steady_clock Clock;
+
+CFrameWriter::CFrameWriter(void)
+{
+	m_sequence = false;
+	m_digits = 0;
+	m_fp = NULL;
+	m_width = m_height = 0;
+	m_frameSize = 0;
+	m_frameIndex = 0;
+	m_queueHead = m_queueCount = 0;
+	m_running = false;
+	m_quit = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+// path의 %d 또는 %0Nd 하나를 번호 자리로 나눔, 다른 %가 있으면 false
+static bool splitNumber(const char* path, std::string& prefix, int& digits, std::string& suffix)
+{
+	const char* p = strchr(path, '%');
+	const char* q = p + 1;
+	digits = 0;
+	if (*q == '0') {
+		q++;
+		while (*q >= '0' && *q <= '9' && digits < 100)
+			digits = digits * 10 + (*q++ - '0');
+	}
+	if (*q != 'd' || strchr(q, '%') != NULL)
+		return false;
+	prefix.assign(path, p - path);
+	suffix = q + 1;
+	return true;
+}
+
+CFrameWriter::~CFrameWriter(void)
+{
+	stop();
+}
+
+bool CFrameWriter::start(const char* path, int width, int height, int buffers)
+{
+	stop();
+	m_sequence = strchr(path, '%') != NULL;
+	if (m_sequence) {
+		if (!splitNumber(path, m_prefix, m_digits, m_suffix))
+			return false;
+	}
+	else {
+		m_fp = fopen(path, "wb");
+		if (m_fp == NULL)
+			return false;
+	}
+	m_width = width;
+	m_height = height;
+	m_frameSize = (size_t)width * height * 4;
+	m_frameIndex = 0;
+
+	m_memory.assign(buffers * m_frameSize, 0);
+	m_free.resize(buffers);
+	for (int i = 0; i < buffers; i++)
+		m_free[i] = buffers - 1 - i;
+	m_queue.assign(buffers, 0);
+	m_queueHead = m_queueCount = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	m_quit = false;
+	m_running = true;
+	m_thread = std::thread(&CFrameWriter::writerMain, this);
+	return true;
+}
+
+void CFrameWriter::stop(void)
+{
+	if (!m_running)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+	m_running = false;
+	if (m_fp != NULL) {
+		fclose(m_fp);
+		m_fp = NULL;
+	}
+}
+
+unsigned char* CFrameWriter::acquire(bool wait)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (wait)
+		m_freed.wait(lock, [this] { return !m_free.empty(); });
+	if (m_free.empty()) {
+		m_stats.framesDropped++;
+		return NULL;
+	}
+	int i = m_free.back();
+	m_free.pop_back();
+	return &m_memory[i * m_frameSize];
+}
+
+void CFrameWriter::submit(unsigned char* pFrame)
+{
+	int i = (int)((pFrame - m_memory.data()) / m_frameSize);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		int tail = (m_queueHead + m_queueCount) % (int)m_queue.size();
+		m_queue[tail] = i;
+		m_queueCount++;
+		if (m_queueCount > m_stats.worstQueued)
+			m_stats.worstQueued = m_queueCount;
+	}
+	m_wake.notify_one();
+}
+
+void CFrameWriter::discard(unsigned char* pFrame)
+{
+	int i = (int)((pFrame - m_memory.data()) / m_frameSize);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_free.push_back(i);
+	}
+	m_freed.notify_one();
+}
+
+CFrameWriter::Stats CFrameWriter::getStats(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+// 쓰는 동안은 잠그지 않음, 큐에서 꺼낸 버퍼는 돌려줄 때까지 이 스레드만 씀
+void CFrameWriter::writerMain(void)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	for (;;) {
+		m_wake.wait(lock, [this] { return m_queueCount > 0 || m_quit; });
+		if (m_queueCount == 0)
+			break;		// m_quit, 남은 프레임을 다 씀
+		int i = m_queue[m_queueHead];
+		m_queueHead = (m_queueHead + 1) % (int)m_queue.size();
+		m_queueCount--;
+		lock.unlock();
+
+		Clock::time_point t0 = Clock::now();
+		bool ok = writeFrame(&m_memory[i * m_frameSize]);
+		double sec = std::chrono::duration<double>(Clock::now() - t0).count();
+
+		lock.lock();
+		m_free.push_back(i);
+		m_freed.notify_one();
+		if (ok) {
+			m_stats.framesWritten++;
+			m_stats.bytesWritten += m_frameSize;
+		}
+		m_stats.writeSeconds += sec;
+		if (sec > m_stats.worstWriteSeconds)
+			m_stats.worstWriteSeconds = sec;
+	}
+}
+
+bool CFrameWriter::writeFrame(const unsigned char* pFrame)
+{
+	long long index = m_frameIndex++;
+	if (!m_sequence)
+		return fwrite(pFrame, 1, m_frameSize, m_fp) == m_frameSize;
+
+	char number[32];
+	snprintf(number, sizeof(number), "%0*lld", m_digits, index);
+	std::string path = m_prefix + number + m_suffix;
+	FILE* fp = fopen(path.c_str(), "wb");
+	if (fp == NULL)
+		return false;
+	// 압축하지 않은 32비트 TGA, descriptor 0x20: 왼쪽 위 원점, 알파 비트 없음
+	unsigned char header[18] = { 0 };
+	header[2] = 2;
+	header[12] = (unsigned char)(m_width & 0xff);
+	header[13] = (unsigned char)(m_width >> 8);
+	header[14] = (unsigned char)(m_height & 0xff);
+	header[15] = (unsigned char)(m_height >> 8);
+	header[16] = 32;
+	header[17] = 0x20;
+	bool ok = fwrite(header, 1, sizeof(header), fp) == sizeof(header) &&
+		fwrite(pFrame, 1, m_frameSize, fp) == m_frameSize;
+	fclose(fp);
+	return ok;
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: frameWriter.h
+//
+// Desc: Background writer for captured frames. A fixed pool of frame
+//       buffers is allocated by start(); the render thread fills a free
+//       buffer (acquire), hands it over (submit) and goes on, and a writer
+//       thread saves frames in order and returns the buffers to the pool.
+//       When every buffer is still waiting to be written, acquire()
+//       returns NULL and the frame is dropped instead of waiting, so a
+//       slow disk can never hold up the frame loop. Offline rendering,
+//       where no frame may be lost, asks acquire(true) to wait instead.
+//
+//       Frames are 32-bit BGRA, top row first. Output is either one raw
+//       video file of frames back to back, readable with e.g.
+//
+//         ffmpeg -f rawvideo -pixel_format bgr0 -video_size 1024x768 -framerate 60 -i capture0.raw capture0.mp4
+//
+//       or, when the path contains a frame number (capture%04d.tga), one
+//       uncompressed TGA image per frame. The number is %d or %0Nd, once;
+//       start() refuses a path with any other %, and the path is never used
+//       as a printf format. The alpha byte of the back buffer is not
+//       meaningful and is marked unused in both.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __frameWriterH__
+#define __frameWriterH__
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class CFrameWriter {
+public:
+	struct Stats {
+		long long	framesWritten;
+		long long	framesDropped;		// 빈 버퍼가 없어 버린 프레임
+		long long	bytesWritten;
+		double		writeSeconds;		// 쓰기 스레드가 파일에 쓰는 데 걸린 시간 합
+		double		worstWriteSeconds;
+		int			worstQueued;		// 쓰기를 기다린 프레임 수 최대
+	};
+
+	CFrameWriter(void);
+	~CFrameWriter(void);
+
+	// buffers개의 프레임 버퍼를 한번에 잡고 쓰기 스레드를 시작
+	// 파일을 열지 못하거나 경로에 번호 (%d, %0Nd) 말고 다른 %가 있으면 false
+	bool start(const char* path, int width, int height, int buffers);
+	// 남은 프레임을 모두 쓰고 스레드를 끝냄
+	void stop(void);
+	bool isRunning(void) const { return m_running; }
+
+	// 채울 버퍼 (getPitch() 간격으로 height줄), 모두 쓰기를 기다리는 중이면 NULL
+	// wait가 true면 버리지 않고 하나가 쓰여 돌아올 때까지 기다림
+	unsigned char* acquire(bool wait = false);
+	// acquire()로 받은 버퍼를 쓰기 차례에 넣거나, 쓰지 않고 돌려줌
+	void submit(unsigned char* pFrame);
+	void discard(unsigned char* pFrame);
+
+	int getWidth(void) const { return m_width; }
+	int getHeight(void) const { return m_height; }
+	int getPitch(void) const { return m_width * 4; }
+	Stats getStats(void) const;
+
+private:
+	CFrameWriter(const CFrameWriter&);
+	CFrameWriter& operator=(const CFrameWriter&);
+
+	void writerMain(void);
+	bool writeFrame(const unsigned char* pFrame);
+
+	bool			m_sequence;			// 프레임마다 TGA 파일
+	std::string		m_prefix, m_suffix;	// 번호 앞뒤의 경로
+	int				m_digits;			// 번호를 0으로 채울 자릿수
+	FILE*			m_fp;				// raw 파일
+	int				m_width, m_height;
+	size_t			m_frameSize;
+	long long		m_frameIndex;		// 다음에 쓸 프레임 번호
+
+	std::vector<unsigned char>	m_memory;	// buffers * m_frameSize
+	std::vector<int>			m_free;		// 빈 버퍼 번호
+	std::vector<int>			m_queue;	// 쓰기를 기다리는 버퍼, 고정 크기 링
+	int				m_queueHead;
+	int				m_queueCount;
+
+	mutable std::mutex			m_mutex;
+	std::condition_variable		m_wake;
+	std::condition_variable		m_freed;	// 버퍼가 m_free로 돌아옴
+	std::thread		m_thread;
+	bool			m_running;
+	bool			m_quit;
+	Stats			m_stats;
+};
+
+#endif // __frameWriterH__
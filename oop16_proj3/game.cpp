@@ -0,0 +1,861 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: game.cpp
+//
+// Desc: Turn, aiming and scoring rules on top of the table physics.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#define PI 3.14159265
+
+namespace
+{
+	// 기록 한 칸의 앞부분, 뒤에 BallBody[ballCount], 번호 int[ballCount], isHit[ballCount],
+	// 벽돌 상태가 이어짐, 칸 크기는 공 수 최대치로 고정
+	struct CompactHeader {
+		StickBody		stick;
+		float			targetX, targetZ;
+		float			tipSide, tipHeight;
+		float			accumulator;
+		int				ballCount;
+		int				score1, score2;
+		int				currentPlayer, currentBall;
+		int				pocketedCount;
+		unsigned int	stepCount, lastStrikeStep;
+		unsigned char	stickMoving, aiming, newTurn, scratched;
+	};
+}
+
+CGame::CGame(void)
+{
+	m_rules.mode = MODE_CAROM;
+	m_rules.decreaseRate = (float)DECREASE_RATE;
+	m_rules.wallRestitution = 0.7f;
+	m_rules.startScore = 50;
+	m_rules.scoreStep = 10;
+	m_pListener = NULL;
+	m_pMetrics = NULL;
+
+	setBallCount(CAROM_BALLS);
+	m_cueSpotX = m_cueSpotZ = 0;
+	memset(m_walls, 0, sizeof(m_walls));
+	m_wallCount = 0;
+	m_segmentCount = 0;
+	classifyWalls();
+	m_pocketCount = 0;
+
+	memset(&m_stick, 0, sizeof(m_stick));
+	m_stickMoving = false;
+	m_targetX = m_targetZ = 0;
+	m_aiming = false;
+	m_tipSide = m_tipHeight = 0;
+
+	m_score1 = m_score2 = m_rules.startScore;
+	m_newTurn = false;
+	m_currentPlayer = 1;
+	m_currentBall = CAROM_BALLS - 1;
+	m_pocketedCount = 0;
+	m_scratched = false;
+	m_accumulator = 0;
+
+	m_stepCount = 0;
+	m_lastStrikeStep = 0;
+	m_historyInterval = 0;
+}
+
+bool CGame::loadLevel(const CLevelFile& level)
+{
+	const LevelHeader& h = level.getHeader();
+	const LevelRules& lr = level.getRules();
+	GameMode mode = lr.mode == LEVEL_MODE_POOL ? MODE_POOL : MODE_CAROM;
+	if (h.wallCount - 1 > MAX_WALLS || h.pocketCount > MAX_POCKETS)
+		return false;
+	if (mode == MODE_CAROM ? h.ballCount != CAROM_BALLS : h.ballCount < 2)
+		return false;
+
+	// 0번 벽은 테이블 바닥이라 충돌하지 않음
+	const LevelWall* walls = level.getWalls();
+	clearWalls();
+	for (unsigned int i = 1; i < h.wallCount; i++)
+		addWall(walls[i].x, walls[i].z, walls[i].width, walls[i].depth);
+
+	const LevelBall* balls = level.getBalls();
+	setBallCount((int)h.ballCount);
+	for (unsigned int i = 0; i < h.ballCount; i++)
+		setBall(i, balls[i].x, balls[i].z);
+
+	// 포켓은 포켓볼에서만 공을 잡음
+	const LevelPocket* pockets = level.getPockets();
+	clearPockets();
+	for (unsigned int i = 0; i < h.pocketCount; i++)
+		addPocket(pockets[i].x, pockets[i].z, pockets[i].radius);
+
+	const LevelBricks* bricks = level.getBricks();
+	if (bricks != NULL)
+		createBricks(bricks->cols, bricks->rows, bricks->minX, bricks->minZ, bricks->cellWidth, bricks->cellDepth,
+			level.getBrickHitPoints());
+	else
+		createBricks(12, 4, -3.6f, 1.0f, 0.6f, 0.4f);
+
+	Rules rules;
+	rules.mode = mode;
+	rules.decreaseRate = lr.decreaseRate;
+	rules.wallRestitution = lr.wallRestitution;
+	rules.startScore = lr.startScore;
+	rules.scoreStep = lr.scoreStep;
+	setRules(rules);
+	return true;
+}
+
+void CGame::setRules(const Rules& rules)
+{
+	m_rules = rules;
+	m_score1 = m_score2 = rules.startScore;
+	m_currentPlayer = 1;
+	m_currentBall = rules.mode == MODE_POOL ? 0 : CAROM_BALLS - 1;
+	m_pocketedCount = 0;
+	m_scratched = false;
+	m_history.clear();
+}
+
+void CGame::clearWalls(void)
+{
+	m_wallCount = 0;
+	m_segmentCount = 0;
+	classifyWalls();
+}
+
+bool CGame::addWall(float x, float z, float width, float depth)
+{
+	if (m_wallCount >= MAX_WALLS)
+		return false;
+	WallBody& w = m_walls[m_wallCount++];
+	w.x = x;
+	w.z = z;
+	w.width = width;
+	w.depth = depth;
+	classifyWalls();
+	return true;
+}
+
+bool CGame::addSegmentWall(float ax, float az, float bx, float bz, float halfThickness)
+{
+	if (m_segmentCount >= MAX_WALLS)
+		return false;
+	SegmentWall w = { ax, az, bx, bz, halfThickness };
+	m_segments[m_segmentCount++] = w;
+	return true;
+}
+
+// 벽을 방향별로 나누고, 가로 벽 두 개와 세로 벽 두 개가 직사각형을 감싸면 따로 떼어 냄
+// 감싸는 벽이 사각형 변 전체를 덮어야 collideAxisWall<>과 결과가 같음
+void CGame::classifyWalls(void)
+{
+	int i, j, k, l;
+	int rectWalls[4] = { -1, -1, -1, -1 };
+	m_hasTableRect = false;
+
+	for (i = 0; i < m_wallCount && !m_hasTableRect; i++) {
+		for (j = 0; j < m_wallCount && !m_hasTableRect; j++) {
+			const WallBody& top = m_walls[i];
+			const WallBody& bottom = m_walls[j];
+			if (!(top.width > top.depth) || !(bottom.width > bottom.depth) || top.z <= bottom.z)
+				continue;
+			for (k = 0; k < m_wallCount && !m_hasTableRect; k++) {
+				for (l = 0; l < m_wallCount && !m_hasTableRect; l++) {
+					const WallBody& right = m_walls[k];
+					const WallBody& left = m_walls[l];
+					if (right.width > right.depth || left.width > left.depth || right.x <= left.x)
+						continue;
+
+					TableRect r = { left.x + left.width / 2, right.x - right.width / 2,
+						bottom.z + bottom.depth / 2, top.z - top.depth / 2 };
+					if (r.minX >= r.maxX || r.minZ >= r.maxZ)
+						continue;
+					bool covered =
+						top.x - top.width / 2 <= r.minX && top.x + top.width / 2 >= r.maxX &&
+						bottom.x - bottom.width / 2 <= r.minX && bottom.x + bottom.width / 2 >= r.maxX &&
+						right.z - right.depth / 2 <= r.minZ && right.z + right.depth / 2 >= r.maxZ &&
+						left.z - left.depth / 2 <= r.minZ && left.z + left.depth / 2 >= r.maxZ;
+					if (!covered)
+						continue;
+
+					m_tableRect = r;
+					m_hasTableRect = true;
+					rectWalls[0] = i;	rectWalls[1] = j;	rectWalls[2] = k;	rectWalls[3] = l;
+				}
+			}
+		}
+	}
+
+	m_alongXCount = m_alongZCount = 0;
+	for (i = 0; i < m_wallCount; i++) {
+		if (i == rectWalls[0] || i == rectWalls[1] || i == rectWalls[2] || i == rectWalls[3])
+			continue;
+		if (m_walls[i].width > m_walls[i].depth)
+			m_alongX[m_alongXCount++] = i;
+		else
+			m_alongZ[m_alongZCount++] = i;
+	}
+}
+
+void CGame::setBallCount(int count)
+{
+	BallBody zero;
+	memset(&zero, 0, sizeof(zero));
+	m_balls.assign(count, zero);
+	m_ballIds.resize(count);
+	for (int i = 0; i < count; i++)
+		m_ballIds[i] = i;
+	m_isHit.assign(count, 0);
+	m_solver.reset();
+	m_history.clear();
+}
+
+void CGame::setBall(int index, float x, float z)
+{
+	m_solver.reset();
+	BallBody& b = m_balls[index];
+	b.x = b.prevX = x;
+	b.z = b.prevZ = z;
+	b.y = BALL_RADIUS;
+	b.vx = b.vz = 0;
+	b.wx = b.wy = b.wz = 0;
+	if (m_ballIds[index] == 0) {
+		m_cueSpotX = x;
+		m_cueSpotZ = z;
+	}
+}
+
+void CGame::setBallVelocity(int index, float vx, float vz)
+{
+	m_balls[index].vx = vx;
+	m_balls[index].vz = vz;
+}
+
+void CGame::clearPockets(void)
+{
+	m_pocketCount = 0;
+}
+
+bool CGame::addPocket(float x, float z, float radius)
+{
+	if (m_pocketCount >= MAX_POCKETS)
+		return false;
+	Pocket p = { x, z, radius };
+	m_pockets[m_pocketCount++] = p;
+	return true;
+}
+
+void CGame::setStick(float length, float radius)
+{
+	m_stick.length = length;
+	m_stick.radius = radius;
+}
+
+void CGame::createBricks(int cols, int rows, float minX, float minZ, float cellWidth, float cellDepth,
+	const unsigned char* pLayout)
+{
+	m_bricks.create(cols, rows, minX, minZ, cellWidth, cellDepth, 0);
+	if (pLayout != NULL)
+		m_brickLayout.assign(pLayout, pLayout + cols * rows);
+	else {
+		m_brickLayout.resize(cols * rows);
+		for (int i = 0; i < cols * rows; i++)
+			m_brickLayout[i] = (unsigned char)(1 + (i / cols) % BRICK_MAX_HP);
+	}
+	m_history.clear();
+}
+
+void CGame::aim(bool rightButton, int dx, int dy)
+{
+	m_aiming = false;		// 마우스 우클릭 해제
+	if (!rightButton)
+		return;
+
+	if (!m_stickMoving && !m_newTurn)
+		m_aiming = true;	// 흰 공과 당구채가 멈춰있을 때만 true
+
+	m_targetX += dx * (-0.007f);
+	m_targetZ += dy * 0.007f;
+	if (m_aiming)
+		aimStick();
+}
+
+void CGame::cancelAim(void)
+{
+	m_aiming = false;
+}
+
+void CGame::aimAt(float x, float z)
+{
+	m_targetX = x;
+	m_targetZ = z;
+	m_aiming = !m_stickMoving && !m_newTurn;
+	if (m_aiming)
+		aimStick();
+}
+
+bool CGame::strike(void)
+{
+	// 마우스 우클릭 + 흰 공이 멈춰있을 때만
+	if (!m_aiming)
+		return false;
+	// 치기 직전 (조준까지 포함)을 기록해 두어 takeBack()이 이 자리로 돌아옴
+	if (m_historyInterval > 0)
+		recordHistory(true);
+	m_lastStrikeStep = m_stepCount;
+	m_aiming = false;
+	aimStick();
+
+	// 흰 공에서 파란 공까지의 거리만큼의 속도로 당구채가 움직임
+	const BallBody& white = m_balls[m_currentBall];
+	float vx = m_targetX - white.x;
+	float vz = m_targetZ - white.z;
+	m_stick.vx = vx;
+	m_stick.vz = vz;
+	if (fabsf(vx) > 0.01f || fabsf(vz) > 0.01f)
+		m_stickMoving = true;
+
+	std::fill(m_isHit.begin(), m_isHit.end(), 0);		// 공을 칠 때마다 isHit 배열 초기화
+	if (m_pListener != NULL)
+		m_pListener->onStrike(m_currentPlayer, m_targetX, m_targetZ, m_tipSide, m_tipHeight);
+	if (m_pMetrics != NULL)
+		m_pMetrics->shots->add();
+	return true;
+}
+
+// 반지름의 절반 밖은 미스큐가 나는 자리이므로 옮기지 않음
+void CGame::moveTip(int right, int up)
+{
+	float side = m_tipSide + right * TIP_STEP;
+	float height = m_tipHeight + up * TIP_STEP;
+	if (side * side + height * height > MAX_TIP_OFFSET * MAX_TIP_OFFSET + 0.0001f)
+		return;
+	m_tipSide = side;
+	m_tipHeight = height;
+	if (m_aiming)
+		aimStick();
+}
+
+void CGame::toggleBricks(void)
+{
+	if (m_bricks.getAliveCount() != 0) {
+		m_bricks.clear();
+		return;
+	}
+	// 처음 배치대로 벽돌을 다시 채움
+	int cols = m_bricks.getCols();
+	for (int row = 0; row < m_bricks.getRows(); row++) {
+		for (int col = 0; col < cols; col++)
+			m_bricks.setBrick(col, row, m_brickLayout[row * cols + col]);
+	}
+}
+
+// 흰 공에서 파란 공 방향으로 당구채의 각도와 위치 설정
+void CGame::aimStick(void)
+{
+	const BallBody& white = m_balls[m_currentBall];
+	float dx = m_targetX - white.x;
+	float dz = m_targetZ - white.z;
+	float length = sqrtf(dx * dx + dz * dz);
+	if (length <= 0)
+		return;
+
+	float angle = acosf(-dz / length);
+	if (dx > 0)
+		angle = (float)(2 * PI) - angle;
+	float dist = m_stick.length * 0.5f + BALL_RADIUS + length * 0.5f;
+
+	m_stick.angle = angle;
+	m_stick.x = m_stick.prevX = white.x - dx / length * dist;
+	m_stick.z = m_stick.prevZ = white.z - dz / length * dist;
+	m_stick.y = white.y + m_tipHeight * BALL_RADIUS;		// 당구채 높이로 상하 당점을 보여 줌
+}
+
+float CGame::advance(float timeDelta)
+{
+	// 물리는 고정 간격으로 진행하고, 남은 시간 비율(alpha)만큼 이전/현재 상태를 보간해서 그림
+	m_accumulator += timeDelta;
+	if (m_accumulator > PHYSICS_STEP * MAX_PHYSICS_STEPS)
+		m_accumulator = PHYSICS_STEP * MAX_PHYSICS_STEPS;	// 오래 멈췄다가 돌아온 경우 따라잡지 않음
+	while (m_accumulator >= PHYSICS_STEP) {
+		step(PHYSICS_STEP);
+		m_accumulator -= PHYSICS_STEP;
+	}
+	return m_accumulator / PHYSICS_STEP;
+}
+
+// 멈춘 채 헛도는 공 (끌어치기 직후 등)은 곧 다시 움직이므로 회전도 봄
+bool CGame::isStopped(const BallBody& ball)
+{
+	return fabsf(ball.vx) < 0.01f && fabsf(ball.vz) < 0.01f && fabsf(ball.wx) < 0.01f && fabsf(ball.wz) < 0.01f;
+}
+
+bool CGame::isAnimating(void) const
+{
+	for (size_t i = 0; i < m_balls.size(); i++) {
+		const BallBody& b = m_balls[i];
+		if (b.vx != 0 || b.vz != 0 || b.wx != 0 || b.wz != 0)
+			return true;
+	}
+	return m_stickMoving || m_newTurn;
+}
+
+void CGame::saveState(Snapshot& s) const
+{
+	s.balls = m_balls;
+	s.ballIds = m_ballIds;
+	s.isHit = m_isHit;
+	m_solver.saveContacts(s.contacts);
+	s.bricks = m_bricks;
+	s.stick = m_stick;
+	s.stickMoving = m_stickMoving;
+	s.targetX = m_targetX;
+	s.targetZ = m_targetZ;
+	s.aiming = m_aiming;
+	s.tipSide = m_tipSide;
+	s.tipHeight = m_tipHeight;
+	s.score1 = m_score1;
+	s.score2 = m_score2;
+	s.newTurn = m_newTurn;
+	s.currentPlayer = m_currentPlayer;
+	s.currentBall = m_currentBall;
+	s.pocketedCount = m_pocketedCount;
+	s.scratched = m_scratched;
+	s.accumulator = m_accumulator;
+	s.stepCount = m_stepCount;
+	s.lastStrikeStep = m_lastStrikeStep;
+}
+
+void CGame::restoreState(const Snapshot& s)
+{
+	m_balls = s.balls;
+	m_ballIds = s.ballIds;
+	m_isHit = s.isHit;
+	m_solver.restoreContacts(s.contacts);
+	m_bricks = s.bricks;
+	m_stick = s.stick;
+	m_stickMoving = s.stickMoving;
+	m_targetX = s.targetX;
+	m_targetZ = s.targetZ;
+	m_aiming = s.aiming;
+	m_tipSide = s.tipSide;
+	m_tipHeight = s.tipHeight;
+	m_score1 = s.score1;
+	m_score2 = s.score2;
+	m_newTurn = s.newTurn;
+	m_currentPlayer = s.currentPlayer;
+	m_currentBall = s.currentBall;
+	m_pocketedCount = s.pocketedCount;
+	m_scratched = s.scratched;
+	m_accumulator = s.accumulator;
+	m_stepCount = s.stepCount;
+	m_lastStrikeStep = s.lastStrikeStep;
+}
+
+void CGame::enableHistory(int slots, int interval)
+{
+	m_historyInterval = slots > 0 ? interval : 0;
+	m_history.create(slots, getCompactSize((int)m_balls.size()));
+}
+
+// 공은 빠지기만 하므로 기록이 비었을 때의 공 수로 칸 크기를 정하면 됨
+// 테이블을 다 꾸민 뒤 enableHistory()를 부르면 여기서 메모리를 잡을 일은 없음
+void CGame::recordHistory(bool boundary)
+{
+	if (m_history.getCount() == 0) {
+		size_t size = getCompactSize((int)m_balls.size());
+		if (size > m_history.getSlotSize())
+			m_history.create(m_history.getSlots(), size);
+	}
+	saveCompact(m_history.push(m_stepCount, boundary));
+}
+
+bool CGame::rewind(int back)
+{
+	if (back < 0 || back >= m_history.getCount())
+		return false;
+	restoreCompact(m_history.get(back));
+	m_history.dropNewest(back);
+	return true;
+}
+
+// 치기 직전 기록은 그때의 m_stepCount로 남으므로, 마지막으로 친 때보다 늦지 않은 가장 최근 경계
+bool CGame::takeBack(void)
+{
+	for (int back = 0; back < m_history.getCount(); back++) {
+		if (m_history.isBoundary(back) && m_history.getStep(back) <= m_lastStrikeStep)
+			return rewind(back);
+	}
+	return false;
+}
+
+size_t CGame::getCompactSize(int ballCapacity) const
+{
+	return sizeof(CompactHeader) + ballCapacity * (sizeof(BallBody) + sizeof(int) + 1) + m_bricks.getStateSize();
+}
+
+void CGame::saveCompact(void* pDest) const
+{
+	CompactHeader h;
+	h.stick = m_stick;
+	h.targetX = m_targetX;
+	h.targetZ = m_targetZ;
+	h.tipSide = m_tipSide;
+	h.tipHeight = m_tipHeight;
+	h.accumulator = m_accumulator;
+	h.ballCount = (int)m_balls.size();
+	h.score1 = m_score1;
+	h.score2 = m_score2;
+	h.currentPlayer = m_currentPlayer;
+	h.currentBall = m_currentBall;
+	h.pocketedCount = m_pocketedCount;
+	h.stepCount = m_stepCount;
+	h.lastStrikeStep = m_lastStrikeStep;
+	h.stickMoving = m_stickMoving;
+	h.aiming = m_aiming;
+	h.newTurn = m_newTurn;
+	h.scratched = m_scratched;
+
+	unsigned char* p = (unsigned char*)pDest;
+	memcpy(p, &h, sizeof(h));
+	p += sizeof(h);
+	memcpy(p, m_balls.data(), h.ballCount * sizeof(BallBody));
+	p += h.ballCount * sizeof(BallBody);
+	memcpy(p, m_ballIds.data(), h.ballCount * sizeof(int));
+	p += h.ballCount * sizeof(int);
+	memcpy(p, m_isHit.data(), h.ballCount);
+	p += h.ballCount;
+	m_bricks.saveState(p);
+}
+
+// 공 목록은 빠지기만 하고 capacity는 줄지 않으므로 되돌려도 메모리를 새로 잡지 않음
+void CGame::restoreCompact(const void* pSrc)
+{
+	CompactHeader h;
+	const unsigned char* p = (const unsigned char*)pSrc;
+	memcpy(&h, p, sizeof(h));
+	p += sizeof(h);
+	const BallBody* balls = (const BallBody*)p;
+	m_balls.assign(balls, balls + h.ballCount);
+	p += h.ballCount * sizeof(BallBody);
+	const int* ids = (const int*)p;
+	m_ballIds.assign(ids, ids + h.ballCount);
+	p += h.ballCount * sizeof(int);
+	m_isHit.assign(p, p + h.ballCount);
+	p += h.ballCount;
+	m_bricks.restoreState(p);
+	m_solver.reset();
+
+	m_stick = h.stick;
+	m_targetX = h.targetX;
+	m_targetZ = h.targetZ;
+	m_tipSide = h.tipSide;
+	m_tipHeight = h.tipHeight;
+	m_accumulator = h.accumulator;
+	m_score1 = h.score1;
+	m_score2 = h.score2;
+	m_currentPlayer = h.currentPlayer;
+	m_currentBall = h.currentBall;
+	m_pocketedCount = h.pocketedCount;
+	m_stepCount = h.stepCount;
+	m_lastStrikeStep = h.lastStrikeStep;
+	m_stickMoving = h.stickMoving != 0;
+	m_aiming = h.aiming != 0;
+	m_newTurn = h.newTurn != 0;
+	m_scratched = h.scratched != 0;
+}
+
+bool CGame::isGameOver(void) const
+{
+	return m_rules.mode == MODE_POOL && m_balls.size() <= 1;
+}
+
+// 공이 이번 갱신 동안 지나간 칸의 벽돌만 검사, 벽돌 쪽으로 움직일 때만 반사
+bool CGame::hitBricks(BallBody& ball)
+{
+	CBrickField::Hit hit;
+	if (!m_bricks.collide(ball.prevX, ball.prevZ, ball.x, ball.z, BALL_RADIUS, &hit))
+		return false;
+
+	float vn = ball.vx * hit.normalX + ball.vz * hit.normalZ;
+	if (vn >= 0)
+		return false;
+
+	// 벽돌을 건너뛸 만큼 빨랐으면 처음 닿은 자리로 되돌린 뒤 튕김
+	if (hit.time < 1) {
+		ball.x = ball.prevX + (ball.x - ball.prevX) * hit.time;
+		ball.z = ball.prevZ + (ball.z - ball.prevZ) * hit.time;
+	}
+	ball.vx -= 2 * vn * hit.normalX;
+	ball.vz -= 2 * vn * hit.normalZ;
+	if (m_bricks.damage(hit.col, hit.row)) {
+		if (m_pMetrics != NULL)
+			m_pMetrics->bricks->add();
+		if (m_pListener != NULL)
+			m_pListener->onBrickBroken(m_bricks.getCenterX(hit.col), m_bricks.getCenterZ(hit.row), hit.normalX, hit.normalZ);
+	}
+	else if (m_pListener != NULL) {
+		Contact contact;
+		contact.x = ball.x - hit.normalX * BALL_RADIUS;
+		contact.z = ball.z - hit.normalZ * BALL_RADIUS;
+		contact.normalX = hit.normalX;
+		contact.normalZ = hit.normalZ;
+		contact.speed = -vn;
+		m_pListener->onImpact(contact);
+	}
+	return true;
+}
+
+void CGame::step(float timeDelta)
+{
+	int i = 0;
+	int j = 0;
+	Contact contact;
+	Contact* pContact = m_pListener != NULL ? &contact : NULL;
+
+	if (!m_newTurn && !isStopped(m_balls[m_currentBall])) {
+		// 포켓볼은 공이 모두 멈춘 뒤 scorePoolTurn()에서 차례를 정함
+		if (m_rules.mode == MODE_CAROM) {
+			if (m_currentPlayer == 1) {
+				m_currentPlayer = 2;
+				m_currentBall = 2; //노란 공
+			}
+			else {
+				m_currentPlayer = 1;
+				m_currentBall = 3; //흰 공
+			}
+		}
+		m_newTurn = true;
+	}
+
+	// update the position of each ball. during update, check whether each ball hit by walls.
+	int count = (int)m_balls.size();
+	for (i = 0; i < count; i++) {
+		BallBody& ball = m_balls[i];
+		const float e = m_rules.wallRestitution;
+		integrateBall(ball, timeDelta, m_rules.decreaseRate);
+		if (m_hasTableRect) {
+			Contact corner[2];
+			int hits = collideTableRect(m_tableRect, ball, BALL_RADIUS, e, pContact != NULL ? corner : NULL);
+			for (j = 0; j < hits && pContact != NULL; j++)
+				m_pListener->onImpact(corner[j]);
+		}
+		for (j = 0; j < m_alongXCount; j++) {
+			if (collideAxisWall<WALL_ALONG_X>(m_walls[m_alongX[j]], ball, BALL_RADIUS, e, pContact) && pContact != NULL)
+				m_pListener->onImpact(contact);
+		}
+		for (j = 0; j < m_alongZCount; j++) {
+			if (collideAxisWall<WALL_ALONG_Z>(m_walls[m_alongZ[j]], ball, BALL_RADIUS, e, pContact) && pContact != NULL)
+				m_pListener->onImpact(contact);
+		}
+		for (j = 0; j < m_segmentCount; j++) {
+			if (collideSegmentWall(m_segments[j], ball, BALL_RADIUS, e, pContact) && pContact != NULL)
+				m_pListener->onImpact(contact);
+		}
+		hitBricks(ball);
+	}
+
+	// check whether any two balls hit together and update the direction of balls
+	// 겹친 쌍을 모두 모아 한번에 풂, 붙어 있는 공 무리도 순서에 상관없이 같은 결과
+	bool turnEnded = false;
+	int contacts = m_solver.solve(m_balls.data(), count, BALL_RADIUS);
+	for (i = 0; i < contacts; i++) {
+		const SolverContact& c = m_solver.getContact(i);
+		m_isHit[c.a] = m_isHit[c.b] = true;
+
+		// 서로 다가가는 중일 때만 효과 표시, 효과는 접선 방향으로 퍼지게
+		if (pContact != NULL && c.approachSpeed > 0) {
+			const BallBody& a = m_balls[c.a];
+			const BallBody& b = m_balls[c.b];
+			contact.x = (a.x + b.x) / 2;
+			contact.z = (a.z + b.z) / 2;
+			contact.normalX = -c.normalZ;
+			contact.normalZ = c.normalX;
+			contact.speed = c.approachSpeed;
+			m_pListener->onImpact(contact);
+		}
+	}
+
+	if (m_rules.mode == MODE_POOL && m_pocketCount > 0)
+		capturePockets();
+
+	if (m_newTurn) {
+		bool stopped = true;
+		for (i = 0; i < (int)m_balls.size() && stopped; i++)
+			stopped = isStopped(m_balls[i]);
+		if (stopped) {
+			int score1 = m_score1;
+			int score2 = m_score2;
+			if (m_rules.mode == MODE_POOL)
+				scorePoolTurn();
+			else
+				scoreTurn();
+			m_newTurn = false;
+			std::fill(m_isHit.begin(), m_isHit.end(), 0);
+			turnEnded = true;
+			if (m_pListener != NULL)
+				m_pListener->onTurnEnd(m_currentPlayer, m_score1, m_score2, m_score1 - score1, m_score2 - score2,
+					(int)(m_stepCount + 1 - m_lastStrikeStep));
+			if (m_pMetrics != NULL) {
+				int delta1 = m_score1 - score1;
+				int delta2 = m_score2 - score2;
+				m_pMetrics->turns->add();
+				m_pMetrics->points->add((delta1 > 0 ? delta1 : 0) + (delta2 > 0 ? delta2 : 0));
+				m_pMetrics->pointsLost->add((delta1 < 0 ? -delta1 : 0) + (delta2 < 0 ? -delta2 : 0));
+				m_pMetrics->shotSteps->observe((double)(m_stepCount + 1 - m_lastStrikeStep));
+			}
+		}
+	}
+
+	if (m_stickMoving) {	// 당구채가 움직이는 중이라면
+		integrateStick(m_stick, timeDelta);		// 당구채 이동
+		if (collideStick(m_stick, m_balls[m_currentBall], BALL_RADIUS)) {	// 흰 공과 충돌 검사
+			applyCueSpin(m_balls[m_currentBall], m_tipSide, m_tipHeight);
+			m_stickMoving = false;
+		}
+	}
+
+	if (m_pMetrics != NULL) {
+		m_pMetrics->steps->add();
+		m_pMetrics->contacts->add((uint64_t)contacts);
+	}
+
+	// 멈춰 있는 동안은 기록할 것이 없음
+	m_stepCount++;
+	if (m_historyInterval > 0 &&
+		(turnEnded || ((m_newTurn || m_stickMoving) && m_stepCount % m_historyInterval == 0)))
+		recordHistory(turnEnded);
+}
+
+// 공 중심이 포켓 안에 들어오면 테이블에서 뺌, 수구는 멈춘 채 처음 자리 근처의 빈자리로 돌아감
+// 뒤에서부터 검사하므로 removeBall()이 맨 뒤 공을 당겨 와도 빠뜨리지 않음
+void CGame::capturePockets(void)
+{
+	for (int i = (int)m_balls.size() - 1; i >= 0; i--) {
+		BallBody& ball = m_balls[i];
+		for (int j = 0; j < m_pocketCount; j++) {
+			if (!ballInPocket(m_pockets[j], ball))
+				continue;
+			if (m_pListener != NULL)
+				m_pListener->onPocketed(m_ballIds[i], ball.x, ball.z);
+			if (m_pMetrics != NULL)
+				m_pMetrics->pocketed->add();
+
+			if (i == m_currentBall) {
+				m_scratched = true;
+				ball.x = ball.prevX = m_cueSpotX;
+				ball.z = ball.prevZ = findCueSpotZ(i);
+				ball.vx = ball.vz = 0;
+				ball.wx = ball.wy = ball.wz = 0;
+			}
+			else {
+				removeBall(i);
+				m_pocketedCount++;
+			}
+			break;
+		}
+	}
+}
+
+// 처음 자리에 다른 공이 있으면 헤드 스트링 (처음 자리를 지나는 z 방향 선)을 따라
+// 공 하나 간격씩 양쪽으로 번갈아 가며 다른 공, 포켓과 겹치지 않는 자리를 찾음
+// 테이블 안에 빈자리가 없으면 처음 자리
+float CGame::findCueSpotZ(int index) const
+{
+	const float gap = 2 * BALL_RADIUS + 0.001f;
+	const int tries = 32;
+	for (int n = 0; n < tries; n++) {
+		for (int side = 1; side >= -1; side -= 2) {
+			if (n == 0 && side < 0)
+				break;
+			BallBody spot = m_balls[index];
+			spot.x = m_cueSpotX;
+			spot.z = m_cueSpotZ + side * n * gap;
+			if (m_hasTableRect && (spot.z < m_tableRect.minZ + BALL_RADIUS || spot.z > m_tableRect.maxZ - BALL_RADIUS))
+				continue;
+			bool empty = true;
+			for (int j = 0; j < (int)m_balls.size() && empty; j++) {
+				float dx = m_balls[j].x - spot.x;
+				float dz = m_balls[j].z - spot.z;
+				empty = j == index || dx * dx + dz * dz >= 4 * BALL_RADIUS * BALL_RADIUS;
+			}
+			for (int j = 0; j < m_pocketCount && empty; j++)
+				empty = !ballInPocket(m_pockets[j], spot);
+			if (empty)
+				return spot.z;
+		}
+	}
+	return m_cueSpotZ;
+}
+
+// 맨 뒤 공을 빈자리로 옮겨 남은 공을 앞쪽에 모아 둠, 수구(0)는 옮겨지지 않음
+void CGame::removeBall(int index)
+{
+	int last = (int)m_balls.size() - 1;
+	m_balls[index] = m_balls[last];
+	m_ballIds[index] = m_ballIds[last];
+	m_isHit[index] = m_isHit[last];
+	m_balls.pop_back();
+	m_ballIds.pop_back();
+	m_isHit.pop_back();
+	m_solver.reset();		// 공 번호가 바뀌어 직전 충격량을 이어 쓸 수 없음
+}
+
+// 넣은 공마다 득점하고 같은 플레이어가 계속 침
+// 하나도 못 넣거나 수구가 빠지면 차례를 넘기고, 수구가 빠지면 감점
+void CGame::scorePoolTurn(void)
+{
+	int& score = m_currentPlayer == 1 ? m_score1 : m_score2;
+	if (m_scratched)
+		score -= m_rules.scoreStep;
+	else
+		score += m_pocketedCount * m_rules.scoreStep;
+	if (m_scratched || m_pocketedCount == 0)
+		m_currentPlayer = m_currentPlayer == 1 ? 2 : 1;
+	m_pocketedCount = 0;
+	m_scratched = false;
+}
+
+// 모든 공이 멈췄을 때 방금 친 플레이어의 점수 계산
+void CGame::scoreTurn(void)
+{
+	const int step = m_rules.scoreStep;
+	if (m_currentPlayer != 1)//하얀공이면(이전의 플레이어를 계산하는 방식)
+	{
+		if (!m_isHit[0] && !m_isHit[1] && !m_isHit[2])
+			m_score1 -= step;				// 아무 공에도 맞지 않으면 점수 -10
+		else if (m_isHit[2])
+			m_score1 -= step;				// 노란 공에 맞으면 점수 -10
+		else {
+			if (m_isHit[0] && m_isHit[1]) {
+				m_score1 += step;			// 빨간 공 2개에 연달아 맞으면 점수 +10
+				if (m_score1 < 0) m_score1 = 0;
+			}
+			if ((m_isHit[0] && !m_isHit[1]) || (!m_isHit[0] && m_isHit[1])) {
+				m_score1 += 0;				// 빨간 공 하나만 맞으면 점수 +0
+			}
+		}
+	}
+	else if (m_currentPlayer != 2) {
+		if (!m_isHit[0] && !m_isHit[1] && !m_isHit[3])
+			m_score2 -= step;				// 아무 공에도 맞지 않으면 점수 -10
+		else if (m_isHit[3])
+			m_score2 -= step;				// 노란 공에 맞으면 점수 -10
+		else {
+			if (m_isHit[0] && m_isHit[1]) {
+				m_score2 += step;			// 빨간 공 2개에 연달아 맞으면 점수 +10
+				if (m_score1 < 0) m_score1 = 0;
+			}
+			if ((m_isHit[0] && !m_isHit[1]) || (!m_isHit[0] && m_isHit[1])) {
+				m_score2 += 0;				// 빨간 공 하나만 맞으면 점수 +0
+			}
+		}
+	}
+}
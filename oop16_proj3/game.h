@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: game.h
+//
+// Desc: Billiard game state and rules without any window or device: balls,
+//       walls, bricks, the cue stick, aiming, turns and scores. WndProc and
+//       Display in virtualLego.cpp only translate messages into the input
+//       calls below and draw the resulting state, so a headless driver
+//       (bench/replayHarness.cpp) can run exactly the same game loop.
+//       Two modes: 4-ball carom and pool, where balls that fall into a
+//       pocket are removed. The number of balls comes from the level.
+//       An optional rewind history keeps flat table snapshots in a fixed
+//       ring (every few steps of a shot and at each turn boundary), for
+//       instant rewind and taking back the last shot.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __gameH__
+#define __gameH__
+
+#include "physics.h"
+#include "table.h"
+#include "contactSolver.h"
+#include "brickField.h"
+#include "levelFormat.h"
+#include "snapshotRing.h"
+#include "metrics.h"
+#include <vector>
+
+#define CAROM_BALLS 4				// 4구: 빨간 공 0, 1, 노란 공 2, 흰 공 3
+#define BALL_RADIUS 0.21f
+#define MAX_WALLS 16
+#define MAX_POCKETS 6
+#define BRICK_MAX_HP 3
+#define TIP_STEP 0.1f				// 화살표 한 번에 옮기는 당점, 반지름 단위
+#define MAX_TIP_OFFSET 0.5f			// 당점이 공 중심에서 벗어날 수 있는 거리
+#define DECREASE_RATE 0.9982
+#define PHYSICS_HZ 120				// 물리 갱신 빈도
+#define MAX_PHYSICS_STEPS 8			// 한 프레임에 최대 갱신 횟수
+#define HISTORY_SLOTS 600			// 되감기 기록 수
+#define HISTORY_INTERVAL 12			// 공이 움직이는 동안 기록하는 간격 (스텝), 0.1초
+
+// timeDelta는 (ms * 0.0007) 단위이므로 같은 단위로 맞춤
+const float PHYSICS_STEP = 0.7f / PHYSICS_HZ;
+
+enum GameMode {
+	MODE_CAROM,			// 4구, 공 4개
+	MODE_POOL,			// 포켓볼, 0번 공이 수구, 나머지를 포켓에 넣음
+};
+
+// 충돌 효과 등 게임 밖에서 반응할 일을 알려줌
+class CGameListener {
+public:
+	virtual ~CGameListener(void) {}
+	virtual void onImpact(const Contact&) {}
+	// 벽돌 중심 (x, z)와 공이 맞은 면의 법선
+	virtual void onBrickBroken(float /*x*/, float /*z*/, float /*normalX*/, float /*normalZ*/) {}
+	// 포켓에 빠진 공 번호 (getBallId)와 빠진 위치
+	virtual void onPocketed(int /*ballId*/, float /*x*/, float /*z*/) {}
+	// strike()가 당구채를 움직임, 친 플레이어와 파란 공 위치, 당점
+	virtual void onStrike(int /*player*/, float /*targetX*/, float /*targetZ*/, float /*tipSide*/, float /*tipHeight*/) {}
+	// 공이 모두 멈춰 점수를 매김, 다음 플레이어, 바뀐 점수와 변화량, 샷에 걸린 스텝
+	virtual void onTurnEnd(int /*nextPlayer*/, int /*score1*/, int /*score2*/, int /*delta1*/, int /*delta2*/, int /*steps*/) {}
+};
+
+class CGame {
+public:
+	// 레벨 파일에서 바꿀 수 있는 규칙
+	struct Rules {
+		GameMode mode;
+		float	decreaseRate;		// 공의 감속
+		float	wallRestitution;	// 벽에 부딪힌 뒤 남는 속도 비율
+		int		startScore;
+		int		scoreStep;			// 득점/감점 단위
+	};
+
+	// 되감기용으로 저장하는 상태, 레벨 구성 (벽, 포켓, 규칙)은 바뀌지 않으므로 빼고
+	// 공, 벽돌, 당구채, 차례와 점수, 충돌 풀이의 warm start까지 담음
+	// 같은 Snapshot에 다시 저장하면 메모리를 새로 할당하지 않음
+	struct Snapshot {
+		std::vector<BallBody>		balls;
+		std::vector<int>			ballIds;
+		std::vector<unsigned char>	isHit;
+		std::vector<SolverContact>	contacts;
+		CBrickField		bricks;
+		StickBody		stick;
+		bool			stickMoving;
+		float			targetX, targetZ;
+		bool			aiming;
+		float			tipSide, tipHeight;
+		int				score1, score2;
+		bool			newTurn;
+		int				currentPlayer;
+		int				currentBall;
+		int				pocketedCount;
+		bool			scratched;
+		float			accumulator;
+		unsigned int	stepCount;
+		unsigned int	lastStrikeStep;
+	};
+
+	CGame(void);
+
+	// 테이블 구성
+	// 벽, 공, 포켓, 벽돌, 규칙, 4구인데 공이 CAROM_BALLS개가 아니거나 포켓볼인데 공이 2개 미만이면 false
+	bool loadLevel(const CLevelFile& level);
+	void setRules(const Rules& rules);		// 점수와 차례도 처음으로 되돌림
+	const Rules& getRules(void) const { return m_rules; }
+	void clearWalls(void);
+	// 네 벽이 직사각형을 이루면 그 네 벽은 collideTableRect()로 한번에 처리
+	bool addWall(float x, float z, float width, float depth);
+	bool addSegmentWall(float ax, float az, float bx, float bz, float halfThickness);
+	// 공 수를 정하고 모두 테이블에 되돌림, 위치는 setBall()로
+	void setBallCount(int count);
+	void setBall(int index, float x, float z);
+	void setBallVelocity(int index, float vx, float vz);		// 시험용 배치 (ballPit 등)
+	void clearPockets(void);
+	bool addPocket(float x, float z, float radius);
+	void setStick(float length, float radius);
+	// pLayout: 칸마다 내구도 (cols * rows 바이트), NULL이면 줄마다 내구도를 다르게 채움
+	// 벽돌은 toggleBricks()로 켜기 전까지 비어 있음
+	void createBricks(int cols, int rows, float minX, float minZ, float cellWidth, float cellDepth,
+		const unsigned char* pLayout = NULL);
+	void setListener(CGameListener* pListener) { m_pListener = pListener; }
+	// 스텝, 충돌, 샷, 턴과 점수를 지표에 더함, NULL이면 끔
+	void setMetrics(const GameMetrics* pMetrics) { m_pMetrics = pMetrics; }
+	// 공끼리 충돌 풀이 설정, threads를 주면 여러 스레드로 풂
+	void setSolverSettings(const CContactSolver::Settings& settings) { m_solver.setSettings(settings); }
+	const CContactSolver& getSolver(void) const { return m_solver; }
+
+	// 입력
+	void aim(bool rightButton, int dx, int dy);	// 마우스 이동, 우클릭 중이면 파란 공을 옮기고 조준
+	void cancelAim(void);							// 좌클릭으로 카메라를 돌리는 중
+	void aimAt(float x, float z);					// 마우스 없이 파란 공을 (x, z)에 놓고 조준 (서버, 봇)
+	bool strike(void);								// 스페이스, 조준 중일 때만 당구채를 움직임
+	void moveTip(int right, int up);				// 화살표, 당점을 반지름의 0.1씩 옮김
+	void toggleBricks(void);						// ARKANOID 벽돌 켜기/끄기
+
+	// 진행
+	// 프레임 사이 시간을 받아 고정 간격으로 step()을 돌리고, 그리기용 보간 비율을 돌려줌
+	float advance(float timeDelta);
+	void resetClock(void) { m_accumulator = 0; }
+	void step(float timeDelta);
+	bool isAnimating(void) const;		// 공이나 당구채가 움직이는 중이면 true
+	bool isGameOver(void) const;		// 포켓볼에서 수구만 남음
+	// 저장한 때로 되돌리면 같은 입력에 같은 결과가 나옴 (예측과 되감기)
+	void saveState(Snapshot& snapshot) const;
+	void restoreState(const Snapshot& snapshot);
+
+	// 되감기 기록, 샷이 진행되는 동안 interval 스텝마다, 그리고 칠 때와 턴이 끝날 때
+	// 최근 slots개를 미리 잡아 둔 메모리에 남김 (slots가 0이면 끔)
+	// 테이블 구성을 바꾸면 (setBallCount, createBricks, setRules) 기록은 비워짐
+	void enableHistory(int slots, int interval);
+	int getHistoryCount(void) const { return m_history.getCount(); }
+	bool rewind(int back);		// back번째 전 기록으로 (0이 가장 최근), 그보다 새 기록은 버림
+	bool takeBack(void);		// 마지막 샷을 치기 직전으로, 거듭 부르면 그 전 샷으로
+	// 기록 한 칸, 공 ballCapacity개까지 담는 평평한 복사본, 충돌 풀이의 warm start는 빠짐
+	size_t getCompactSize(int ballCapacity) const;
+	void saveCompact(void* pDest) const;
+	void restoreCompact(const void* pSrc);
+	unsigned int getStepCount(void) const { return m_stepCount; }
+
+	// 테이블에 남은 공, 빠진 공은 목록에서 지워지므로 index는 바뀔 수 있음
+	// getBallId()는 처음 배치(레벨) 순서의 번호로, 색 등을 찾을 때 씀
+	int getBallCount(void) const { return (int)m_balls.size(); }
+	const BallBody& getBall(int index) const { return m_balls[index]; }
+	int getBallId(int index) const { return m_ballIds[index]; }
+	int getPocketCount(void) const { return m_pocketCount; }
+	const Pocket& getPocket(int index) const { return m_pockets[index]; }
+	int getWallCount(void) const { return m_wallCount; }
+	const WallBody& getWall(int index) const { return m_walls[index]; }
+	bool hasTableRect(void) const { return m_hasTableRect; }
+	const CBrickField& getBricks(void) const { return m_bricks; }
+	const StickBody& getStick(void) const { return m_stick; }
+	bool isStickMoving(void) const { return m_stickMoving; }
+	float getTargetX(void) const { return m_targetX; }
+	float getTargetZ(void) const { return m_targetZ; }
+	bool isAiming(void) const { return m_aiming; }
+	float getTipSide(void) const { return m_tipSide; }		// 당점, 공 중심에서 반지름 단위
+	float getTipHeight(void) const { return m_tipHeight; }
+	bool isTurnPending(void) const { return m_newTurn; }	// 친 공들이 아직 멈추지 않음
+	int getScore(int player) const { return player == 1 ? m_score1 : m_score2; }
+	int getCurrentPlayer(void) const { return m_currentPlayer; }
+	int getCurrentBall(void) const { return m_currentBall; }
+
+private:
+	void classifyWalls(void);
+	void aimStick(void);
+	bool hitBricks(BallBody& ball);
+	void capturePockets(void);
+	float findCueSpotZ(int index) const;
+	void removeBall(int index);
+	void scoreTurn(void);
+	void scorePoolTurn(void);
+	void recordHistory(bool boundary);
+
+	static bool isStopped(const BallBody& ball);
+
+	Rules			m_rules;
+	CGameListener*	m_pListener;
+	const GameMetrics*	m_pMetrics;
+
+	// 테이블에 남은 공만 앞에서부터 채워 둠, 충돌 검사와 풀이는 이 범위만 돎
+	std::vector<BallBody>	m_balls;
+	std::vector<int>		m_ballIds;		// 각 공의 처음 번호
+	float			m_cueSpotX, m_cueSpotZ;	// 수구가 빠지면 돌아갈 자리 (처음 위치)
+	Pocket			m_pockets[MAX_POCKETS];
+	int				m_pocketCount;
+	WallBody		m_walls[MAX_WALLS];
+	int				m_wallCount;
+	// classifyWalls()가 나눈 결과, 직사각형에 속한 벽은 목록에서 빠짐
+	bool			m_hasTableRect;
+	TableRect		m_tableRect;
+	int				m_alongX[MAX_WALLS];		// 가로 벽 번호
+	int				m_alongXCount;
+	int				m_alongZ[MAX_WALLS];		// 세로 벽 번호
+	int				m_alongZCount;
+	SegmentWall		m_segments[MAX_WALLS];
+	int				m_segmentCount;
+	CContactSolver	m_solver;				// 공끼리 충돌
+	CBrickField		m_bricks;
+	std::vector<unsigned char> m_brickLayout;	// toggleBricks()에서 쓰는 처음 배치
+
+	StickBody		m_stick;
+	bool			m_stickMoving;
+	float			m_targetX, m_targetZ;	// 파란 공 위치
+	bool			m_aiming;				// 마우스 우클릭 여부
+	float			m_tipSide, m_tipHeight;	// 당점, 오른쪽과 위가 +
+
+	int				m_score1, m_score2;
+	bool			m_newTurn;				// 게임의 턴이 새로 돌아왔는지 저장
+	std::vector<unsigned char> m_isHit;		// 각 공의 충돌 여부 저장
+	int				m_currentPlayer;		// 처음 시작은 Player1(흰공)
+	int				m_currentBall;			// 4구는 시작 흰공(3), 다음 노란공(2), 포켓볼은 늘 수구(0)
+	int				m_pocketedCount;		// 이번 턴에 포켓에 넣은 공 수
+	bool			m_scratched;			// 이번 턴에 수구가 빠짐
+
+	float			m_accumulator;			// 아직 시뮬레이션하지 않은 시간
+
+	unsigned int	m_stepCount;			// 진행한 스텝 수, 기록의 시점
+	unsigned int	m_lastStrikeStep;		// 마지막으로 친 때
+	CSnapshotRing	m_history;
+	int				m_historyInterval;		// 0이면 기록하지 않음
+};
+
+#endif // __gameH__
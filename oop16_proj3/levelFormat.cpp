@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: levelFormat.cpp
+//
+// Desc: Memory-mapped loading of the binary level format.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "levelFormat.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CLevelFile::CLevelFile(void)
+{
+	m_pData = NULL;
+	m_size = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#else
+	m_fd = -1;
+#endif
+}
+
+CLevelFile::~CLevelFile(void)
+{
+	close();
+}
+
+bool CLevelFile::open(const char* path)
+{
+	close();
+
+#ifdef _WIN32
+	m_hFile = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(m_hFile, &size) || size.QuadPart < (LONGLONG)sizeof(LevelHeader)) {
+		close();
+		return false;
+	}
+	m_size = (size_t)size.QuadPart;
+
+	m_hMapping = ::CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping == NULL) {
+		close();
+		return false;
+	}
+	m_pData = (const unsigned char*)::MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	m_fd = ::open(path, O_RDONLY);
+	if (m_fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(m_fd, &st) != 0 || st.st_size < (off_t)sizeof(LevelHeader)) {
+		close();
+		return false;
+	}
+	m_size = (size_t)st.st_size;
+
+	void* p = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+	m_pData = (p == MAP_FAILED) ? NULL : (const unsigned char*)p;
+#endif
+
+	if (m_pData == NULL || !validate()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void CLevelFile::close(void)
+{
+#ifdef _WIN32
+	if (m_pData != NULL)
+		::UnmapViewOfFile(m_pData);
+	if (m_hMapping != NULL)
+		::CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		::CloseHandle(m_hFile);
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+#else
+	if (m_pData != NULL)
+		munmap((void*)m_pData, m_size);
+	if (m_fd >= 0)
+		::close(m_fd);
+	m_fd = -1;
+#endif
+	m_pData = NULL;
+	m_size = 0;
+}
+
+bool CLevelFile::inside(uint32_t offset, size_t count, size_t size) const
+{
+	if (offset % 4 != 0 || offset > m_size)
+		return false;
+	return count <= (m_size - offset) / (size ? size : 1);
+}
+
+// 섹션 범위는 한 번씩만 검사, 벽돌 내구도 배열은 통째로 범위만 확인
+bool CLevelFile::validate(void) const
+{
+	const LevelHeader& h = getHeader();
+	if (h.magic != LEVEL_MAGIC || h.version != LEVEL_VERSION || h.headerSize != sizeof(LevelHeader))
+		return false;
+	if (h.fileSize != m_size)
+		return false;
+
+	if (!inside(h.materialOffset, h.materialCount, sizeof(LevelMaterial)) ||
+		!inside(h.wallOffset, h.wallCount, sizeof(LevelWall)) ||
+		!inside(h.ballOffset, h.ballCount, sizeof(LevelBall)) ||
+		!inside(h.pocketOffset, h.pocketCount, sizeof(LevelPocket)) ||
+		!inside(h.rulesOffset, 1, sizeof(LevelRules)))
+		return false;
+	if (h.wallCount == 0)
+		return false;
+	const LevelRules& rules = getRules();
+	if (rules.mode != LEVEL_MODE_CAROM && rules.mode != LEVEL_MODE_POOL)
+		return false;
+
+	if (h.bricksOffset != 0) {
+		if (!inside(h.bricksOffset, 1, sizeof(LevelBricks)))
+			return false;
+		const LevelBricks& b = *at<LevelBricks>(h.bricksOffset);
+		if (b.cols == 0 || b.rows == 0 || b.cols > 0xffff || b.rows > 0xffff)
+			return false;
+		if (!inside(b.hitPointsOffset, (size_t)b.cols * b.rows, 1))
+			return false;
+	}
+
+	// 재질 번호가 범위 안에 있는지 확인
+	const LevelWall* walls = getWalls();
+	for (uint32_t i = 0; i < h.wallCount; i++) {
+		if (walls[i].material >= h.materialCount)
+			return false;
+	}
+	const LevelBall* balls = getBalls();
+	for (uint32_t i = 0; i < h.ballCount; i++) {
+		if (balls[i].material >= h.materialCount)
+			return false;
+	}
+	return true;
+}
+
+std::string getToolLevelPath(const char* name)
+{
+	std::string dir;
+#ifdef _WIN32
+	char path[MAX_PATH];
+	DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+	if (length > 0 && length < MAX_PATH)
+		dir.assign(path, length);
+#else
+	char path[4096];
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path));
+	if (length > 0 && length < (ssize_t)sizeof(path))
+		dir.assign(path, (size_t)length);
+#endif
+	size_t slash = dir.find_last_of("/\\");
+	dir = slash == std::string::npos ? std::string() : dir.substr(0, slash + 1);
+	return dir + "../levels/" + name;
+}
@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: levelFormat.h
+//
+// Desc: Compact versioned binary level format (.lvl).
+//       The file is memory-mapped and used in place: every section is an
+//       array of fixed-size, 4-byte aligned little-endian records located
+//       by an offset in the header, so loading a level is one map call and
+//       a handful of bounds checks, with no per-element parsing.
+//       Levels are written by tools/levelconv from a readable text file.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __levelFormatH__
+#define __levelFormatH__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+#define LEVEL_MAGIC		0x4C564C56	// "VLVL"
+#define LEVEL_VERSION	2		// 2: 포켓, 게임 방식
+
+#define LEVEL_MODE_CAROM	0	// 4구
+#define LEVEL_MODE_POOL		1	// 포켓볼, 0번 공이 수구
+
+#pragma pack(push, 4)
+
+struct LevelMaterial {
+	float		r, g, b, a;
+};
+
+// 테이블 바닥과 벽 (CWall::create 인자와 같음)
+struct LevelWall {
+	float		x, y, z;
+	float		width, height, depth;
+	uint32_t	material;
+};
+
+struct LevelBall {
+	float		x, z;
+	uint32_t	material;
+};
+
+struct LevelPocket {
+	float		x, z;
+	float		radius;
+};
+
+// 벽돌 격자, 뒤에 cols * rows 바이트의 내구도가 이어짐 (0 = 빈 칸)
+struct LevelBricks {
+	float		minX, minZ;
+	float		cellWidth, cellDepth;
+	uint32_t	cols, rows;
+	uint32_t	hitPointsOffset;
+};
+
+struct LevelRules {
+	float		decreaseRate;		// 공의 감속 (DECREASE_RATE)
+	float		wallRestitution;	// 벽에 부딪힌 뒤 남는 속도 비율
+	int32_t		startScore;
+	int32_t		scoreStep;			// 득점/감점 단위
+	uint32_t	mode;				// LEVEL_MODE_*
+};
+
+struct LevelHeader {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	headerSize;
+	uint32_t	fileSize;
+
+	uint32_t	materialCount, materialOffset;
+	uint32_t	wallCount, wallOffset;			// 0번은 테이블 바닥
+	uint32_t	ballCount, ballOffset;
+	uint32_t	pocketCount, pocketOffset;
+	uint32_t	bricksOffset;					// 0이면 벽돌 없음
+	uint32_t	rulesOffset;
+};
+
+#pragma pack(pop)
+
+// 메모리 맵으로 연 레벨 파일, 반환되는 포인터는 close() 전까지 유효
+class CLevelFile {
+public:
+	CLevelFile(void);
+	~CLevelFile(void);
+
+	bool open(const char* path);
+	void close(void);
+	bool isOpen(void) const { return m_pData != NULL; }
+
+	const LevelHeader& getHeader(void) const { return *(const LevelHeader*)m_pData; }
+	const LevelMaterial* getMaterials(void) const { return at<LevelMaterial>(getHeader().materialOffset); }
+	const LevelWall* getWalls(void) const { return at<LevelWall>(getHeader().wallOffset); }
+	const LevelBall* getBalls(void) const { return at<LevelBall>(getHeader().ballOffset); }
+	const LevelPocket* getPockets(void) const { return at<LevelPocket>(getHeader().pocketOffset); }
+	const LevelBricks* getBricks(void) const { return getHeader().bricksOffset ? at<LevelBricks>(getHeader().bricksOffset) : NULL; }
+	const unsigned char* getBrickHitPoints(void) const { return getBricks() ? at<unsigned char>(getBricks()->hitPointsOffset) : NULL; }
+	const LevelRules& getRules(void) const { return *at<LevelRules>(getHeader().rulesOffset); }
+
+private:
+	CLevelFile(const CLevelFile&);
+	CLevelFile& operator=(const CLevelFile&);
+
+	template<typename T> const T* at(uint32_t offset) const { return (const T*)(m_pData + offset); }
+	bool validate(void) const;
+	bool inside(uint32_t offset, size_t count, size_t size) const;
+
+	const unsigned char*	m_pData;
+	size_t					m_size;
+#ifdef _WIN32
+	void*					m_hFile;
+	void*					m_hMapping;
+#else
+	int						m_fd;
+#endif
+};
+
+// bench/나 server/의 콘솔 도구가 쓰는 기본 레벨, 실행 파일이 있는 폴더의 ../levels/name
+// 작업 폴더와 상관없이 찾음, 실행 파일 경로를 모르면 작업 폴더 기준
+std::string getToolLevelPath(const char* name);
+
+#endif // __levelFormatH__
@@ -0,0 +1,418 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: metrics.cpp
+//
+// Desc: Metric registry, text exposition format and the local HTTP
+//       endpoint of metrics.h (winsock on Windows, BSD sockets elsewhere).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef _WIN32
+#include <winsock2.h>		// windows.h보다 먼저
+typedef SOCKET socket_t;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+typedef int socket_t;
+#define INVALID_SOCKET (-1)
+#define closesocket close
+#endif
+
+#include "metrics.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define ACCEPT_WAIT_MS 100			// 종료 플래그를 확인하는 간격
+#define REQUEST_TIMEOUT_MS 1000		// 요청을 끝까지 보내지 않는 연결을 끊음
+#define MAX_REQUEST 2048
+
+// -----------------------------------------------------------------------------
+// 지표
+// -----------------------------------------------------------------------------
+
+uint64_t CCounter::get(void) const
+{
+	uint64_t total = 0;
+	for (int i = 0; i < METRIC_SHARDS; i++)
+		total += m_shards[i].value.load(std::memory_order_relaxed);
+	return total;
+}
+
+CHistogram::CHistogram(const double* pBounds, int count)
+{
+	m_boundCount = count;
+	for (int i = 0; i < count; i++)
+		m_bounds[i] = pBounds[i];
+	for (int i = 0; i < METRIC_SHARDS; i++) {
+		for (int j = 0; j <= METRIC_MAX_BUCKETS; j++)
+			m_shards[i].buckets[j] = 0;
+		m_shards[i].sum = 0;
+	}
+}
+
+void CHistogram::read(uint64_t* pBuckets, double& sum) const
+{
+	sum = 0;
+	for (int j = 0; j <= m_boundCount; j++)
+		pBuckets[j] = 0;
+	for (int i = 0; i < METRIC_SHARDS; i++) {
+		const Shard& s = m_shards[i];
+		for (int j = 0; j <= m_boundCount; j++)
+			pBuckets[j] += s.buckets[j].load(std::memory_order_relaxed);
+		sum += s.sum.load(std::memory_order_relaxed);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// CMetrics
+// -----------------------------------------------------------------------------
+
+static bool isMetricName(const char* name)
+{
+	if (name == NULL || name[0] == '\0' || (name[0] >= '0' && name[0] <= '9'))
+		return false;
+	for (const char* p = name; *p != '\0'; p++) {
+		char c = *p;
+		if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':'))
+			return false;
+	}
+	return true;
+}
+
+// m_mutex를 잡은 채로
+bool CMetrics::canAdd(const char* name) const
+{
+	if (!isMetricName(name))
+		return false;
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		if (m_entries[i]->name == name)
+			return false;
+	}
+	return true;
+}
+
+CCounter* CMetrics::addCounter(const char* name, const char* help)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!canAdd(name))
+		return NULL;
+	std::unique_ptr<Entry> pEntry(new Entry());
+	pEntry->name = name;
+	pEntry->help = help != NULL ? help : "";
+	pEntry->pCounter.reset(new CCounter());
+	CCounter* pCounter = pEntry->pCounter.get();
+	m_entries.push_back(std::move(pEntry));
+	return pCounter;
+}
+
+CGauge* CMetrics::addGauge(const char* name, const char* help)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!canAdd(name))
+		return NULL;
+	std::unique_ptr<Entry> pEntry(new Entry());
+	pEntry->name = name;
+	pEntry->help = help != NULL ? help : "";
+	pEntry->pGauge.reset(new CGauge());
+	CGauge* pGauge = pEntry->pGauge.get();
+	m_entries.push_back(std::move(pEntry));
+	return pGauge;
+}
+
+CHistogram* CMetrics::addHistogram(const char* name, const char* help, const double* pBounds, int count)
+{
+	if (pBounds == NULL || count < 1 || count > METRIC_MAX_BUCKETS)
+		return NULL;
+	for (int i = 1; i < count; i++) {
+		if (!(pBounds[i] > pBounds[i - 1]))
+			return NULL;
+	}
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!canAdd(name))
+		return NULL;
+	std::unique_ptr<Entry> pEntry(new Entry());
+	pEntry->name = name;
+	pEntry->help = help != NULL ? help : "";
+	pEntry->pHistogram.reset(new CHistogram(pBounds, count));
+	CHistogram* pHistogram = pEntry->pHistogram.get();
+	m_entries.push_back(std::move(pEntry));
+	return pHistogram;
+}
+
+// 형식이 정한 +Inf, -Inf, NaN 표기, 나머지는 다시 읽어도 같은 값이 되는 짧은 쪽 (0.025 등)
+static void appendValue(std::string& out, double value)
+{
+	char buf[32];
+	if (std::isnan(value))
+		out += "NaN";
+	else if (std::isinf(value))
+		out += value > 0 ? "+Inf" : "-Inf";
+	else {
+		snprintf(buf, sizeof(buf), "%.15g", value);
+		if (strtod(buf, NULL) != value)
+			snprintf(buf, sizeof(buf), "%.17g", value);
+		out += buf;
+	}
+}
+
+static void appendCount(std::string& out, uint64_t value)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+	out += buf;
+}
+
+// 설명의 \와 줄바꿈은 형식에 맞게 이스케이프
+static void appendHeader(std::string& out, const std::string& name, const std::string& help, const char* type)
+{
+	out += "# HELP ";
+	out += name;
+	out += ' ';
+	for (size_t i = 0; i < help.size(); i++) {
+		if (help[i] == '\\')
+			out += "\\\\";
+		else if (help[i] == '\n')
+			out += "\\n";
+		else
+			out += help[i];
+	}
+	out += "\n# TYPE ";
+	out += name;
+	out += ' ';
+	out += type;
+	out += '\n';
+}
+
+void CMetrics::write(std::string& out) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < m_entries.size(); i++) {
+		const Entry& e = *m_entries[i];
+		if (e.pCounter) {
+			appendHeader(out, e.name, e.help, "counter");
+			out += e.name;
+			out += ' ';
+			appendCount(out, e.pCounter->get());
+			out += '\n';
+		}
+		else if (e.pGauge) {
+			appendHeader(out, e.name, e.help, "gauge");
+			out += e.name;
+			out += ' ';
+			appendValue(out, e.pGauge->get());
+			out += '\n';
+		}
+		else {
+			// 버킷은 경계 이하 값의 누적 개수, +Inf가 전체 개수
+			const CHistogram& h = *e.pHistogram;
+			uint64_t buckets[METRIC_MAX_BUCKETS + 1];
+			double sum;
+			h.read(buckets, sum);
+			appendHeader(out, e.name, e.help, "histogram");
+			uint64_t total = 0;
+			for (int j = 0; j <= h.getBoundCount(); j++) {
+				total += buckets[j];
+				out += e.name;
+				out += "_bucket{le=\"";
+				if (j < h.getBoundCount())
+					appendValue(out, h.getBound(j));
+				else
+					out += "+Inf";
+				out += "\"} ";
+				appendCount(out, total);
+				out += '\n';
+			}
+			out += e.name;
+			out += "_sum ";
+			appendValue(out, sum);
+			out += '\n';
+			out += e.name;
+			out += "_count ";
+			appendCount(out, total);
+			out += '\n';
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// CMetricsServer
+// -----------------------------------------------------------------------------
+
+CMetricsServer::CMetricsServer(void)
+{
+	m_pMetrics = NULL;
+	m_listen = (uintptr_t)INVALID_SOCKET;
+	m_running = false;
+	m_quit = false;
+	m_requests = 0;
+}
+
+CMetricsServer::~CMetricsServer(void)
+{
+	stop();
+}
+
+bool CMetricsServer::start(const CMetrics& metrics, int port)
+{
+	stop();
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+		return false;
+#endif
+	socket_t s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s == INVALID_SOCKET) {
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return false;
+	}
+#ifndef _WIN32
+	int on = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));		// 다시 켤 때 TIME_WAIT에 막히지 않게
+#endif
+
+	// 이 컴퓨터에서만 읽을 수 있게
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons((unsigned short)port);
+	if (bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, 8) != 0) {
+		closesocket(s);
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return false;
+	}
+
+	m_pMetrics = &metrics;
+	m_listen = (uintptr_t)s;
+	m_quit = false;
+	m_running = true;
+	m_thread = std::thread(&CMetricsServer::serverMain, this);
+	return true;
+}
+
+void CMetricsServer::stop(void)
+{
+	if (!m_running)
+		return;
+	m_quit = true;
+	m_thread.join();
+	closesocket((socket_t)m_listen);
+	m_listen = (uintptr_t)INVALID_SOCKET;
+	m_running = false;
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+// 연결을 기다리다가 ACCEPT_WAIT_MS마다 종료 플래그를 확인
+void CMetricsServer::serverMain(void)
+{
+	socket_t listenSocket = (socket_t)m_listen;
+	while (!m_quit) {
+		fd_set set;
+		FD_ZERO(&set);
+		FD_SET(listenSocket, &set);
+		struct timeval wait;
+		wait.tv_sec = 0;
+		wait.tv_usec = ACCEPT_WAIT_MS * 1000;
+		if (select((int)listenSocket + 1, &set, NULL, NULL, &wait) <= 0)
+			continue;
+		socket_t client = accept(listenSocket, NULL, NULL);
+		if (client == INVALID_SOCKET)
+			continue;
+		serve((uintptr_t)client);
+		closesocket(client);
+	}
+}
+
+// 요청 줄만 보고 답한 뒤 연결을 닫음 (HTTP/1.0)
+void CMetricsServer::serve(uintptr_t client)
+{
+	socket_t s = (socket_t)client;
+#ifdef _WIN32
+	DWORD timeout = REQUEST_TIMEOUT_MS;
+#else
+	struct timeval timeout;
+	timeout.tv_sec = REQUEST_TIMEOUT_MS / 1000;
+	timeout.tv_usec = (REQUEST_TIMEOUT_MS % 1000) * 1000;
+#endif
+	setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+
+	// 헤더 끝까지 읽음, 본문이 있는 요청은 받지 않음
+	char request[MAX_REQUEST + 1];
+	int length = 0;
+	while (length < MAX_REQUEST) {
+		int got = (int)recv(s, request + length, MAX_REQUEST - length, 0);
+		if (got <= 0)
+			return;
+		length += got;
+		request[length] = '\0';
+		if (strstr(request, "\r\n\r\n") != NULL || strstr(request, "\n\n") != NULL)
+			break;
+	}
+	request[length] = '\0';
+
+	const char* status = "200 OK";
+	bool head = strncmp(request, "HEAD ", 5) == 0;
+	const char* path = head ? request + 5 : request + 4;
+	m_body.clear();
+	if (!head && strncmp(request, "GET ", 4) != 0) {
+		status = "405 Method Not Allowed";
+		m_body = "only GET\n";
+	}
+	else if ((strncmp(path, "/metrics", 8) == 0 && (path[8] == ' ' || path[8] == '?')) ||
+		strncmp(path, "/ ", 2) == 0)
+		m_pMetrics->write(m_body);
+	else {
+		status = "404 Not Found";
+		m_body = "try /metrics\n";
+	}
+	m_requests.fetch_add(1, std::memory_order_relaxed);
+
+	char header[256];
+	snprintf(header, sizeof(header),
+		"HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+		"Content-Length: %u\r\nConnection: close\r\n\r\n", status, (unsigned int)m_body.size());
+	m_response = header;
+	if (!head)
+		m_response += m_body;
+
+	size_t sent = 0;
+	while (sent < m_response.size()) {
+		int n = (int)send(s, m_response.data() + sent, (int)(m_response.size() - sent), 0);
+		if (n <= 0)
+			break;
+		sent += (size_t)n;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool registerGameMetrics(CMetrics& metrics, GameMetrics& game)
+{
+	// 샷 하나는 보통 몇 초 (PHYSICS_HZ 120)
+	static const double shotStepBounds[] = { 60, 120, 240, 360, 480, 720, 960, 1440, 2400, 3600 };
+	game.steps = metrics.addCounter("vlego_game_steps_total", "Physics steps simulated.");
+	game.contacts = metrics.addCounter("vlego_game_contacts_total", "Ball-ball contacts resolved.");
+	game.bricks = metrics.addCounter("vlego_game_bricks_broken_total", "Bricks broken.");
+	game.pocketed = metrics.addCounter("vlego_game_balls_pocketed_total", "Balls that fell into a pocket.");
+	game.shots = metrics.addCounter("vlego_game_shots_total", "Shots struck.");
+	game.turns = metrics.addCounter("vlego_game_turns_total", "Turns scored after every ball stopped.");
+	game.points = metrics.addCounter("vlego_game_points_won_total", "Points won at turn ends.");
+	game.pointsLost = metrics.addCounter("vlego_game_points_lost_total", "Points lost at turn ends (carom penalties).");
+	game.shotSteps = metrics.addHistogram("vlego_game_shot_steps", "Physics steps from strike to turn end.",
+		shotStepBounds, (int)(sizeof(shotStepBounds) / sizeof(shotStepBounds[0])));
+	return game.steps != NULL && game.contacts != NULL && game.bricks != NULL && game.pocketed != NULL &&
+		game.shots != NULL && game.turns != NULL && game.points != NULL && game.pointsLost != NULL &&
+		game.shotSteps != NULL;
+}
@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: metrics.h
+//
+// Desc: Live counters, gauges and histograms of a running game or server
+//       (steps, contacts, turns, frame times, queue depths), served as
+//       Prometheus text on a local port for watching many tables at once:
+//
+//         curl http://127.0.0.1:9108/metrics
+//
+//       Metrics are registered once at setup and never removed; updating
+//       one never locks and never allocates. Counters and histograms keep
+//       one slot per thread, summed only when the metrics are written, so
+//       threads that update the same metric do not fight over a cache line
+//       and need no locked instruction: the first METRIC_SHARDS - 1
+//       threads each own a slot, later threads share the last one with
+//       atomic adds.
+//       Gauges are a single value (set, or add for depths).
+//       A histogram read while it is being updated may have a _sum a few
+//       observations ahead of or behind its buckets.
+//
+//       CMetricsServer answers GET /metrics on 127.0.0.1 from its own
+//       thread, one connection at a time. GameMetrics is the set a CGame
+//       updates itself (CGame::setMetrics).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __metricsH__
+#define __metricsH__
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define METRIC_SHARDS 16			// 스레드별 칸 수, 마지막 칸은 나머지 스레드가 같이 씀
+#define METRIC_MAX_BUCKETS 16		// 히스토그램 경계 수 (+Inf 제외)
+#define METRICS_PORT 9108			// 기본 포트
+
+// 이 스레드가 쓰는 칸, 처음 갱신할 때 차례로 정해짐
+inline int metricShard(void)
+{
+	static std::atomic<int> next(0);
+	thread_local int shard = -1;
+	if (shard < 0) {
+		int index = next.fetch_add(1, std::memory_order_relaxed);
+		shard = index < METRIC_SHARDS - 1 ? index : METRIC_SHARDS - 1;
+	}
+	return shard;
+}
+
+// 혼자 쓰는 칸은 읽고 쓰기만, 같이 쓰는 칸만 lock 명령
+inline void metricAdd(std::atomic<uint64_t>& value, int shard, uint64_t n)
+{
+	if (shard < METRIC_SHARDS - 1)
+		value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+	else
+		value.fetch_add(n, std::memory_order_relaxed);
+}
+
+// 늘어나기만 하는 값
+class CCounter {
+public:
+	CCounter(void)
+	{
+		for (int i = 0; i < METRIC_SHARDS; i++)
+			m_shards[i].value = 0;
+	}
+
+	void add(uint64_t n = 1)
+	{
+		int shard = metricShard();
+		metricAdd(m_shards[shard].value, shard, n);
+	}
+	uint64_t get(void) const;
+
+private:
+	CCounter(const CCounter&);
+	CCounter& operator=(const CCounter&);
+
+	// 칸 사이를 캐시 줄 하나 이상 띄워, 시작 주소가 맞지 않아도 두 칸이 한 줄에 들지 않음
+	struct Shard {
+		std::atomic<uint64_t>	value;
+		char					pad[64];
+	};
+	Shard	m_shards[METRIC_SHARDS];
+};
+
+// 마지막으로 정한 값, 큐 깊이처럼 여러 곳에서 더하고 빼도 됨
+class CGauge {
+public:
+	CGauge(void) : m_value(0) {}
+
+	void set(double value) { m_value.store(value, std::memory_order_relaxed); }
+	void add(double delta)
+	{
+		double value = m_value.load(std::memory_order_relaxed);
+		while (!m_value.compare_exchange_weak(value, value + delta, std::memory_order_relaxed))
+			;
+	}
+	double get(void) const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+	CGauge(const CGauge&);
+	CGauge& operator=(const CGauge&);
+
+	std::atomic<double>	m_value;
+};
+
+// 값이 들어간 구간별 개수와 합, 구간 경계는 등록할 때 정함 (오름차순)
+class CHistogram {
+public:
+	CHistogram(const double* pBounds, int count);
+
+	// 경계가 적으므로 차례로 찾음
+	void observe(double value)
+	{
+		int i = 0;
+		while (i < m_boundCount && value > m_bounds[i])
+			i++;
+		int shard = metricShard();
+		Shard& s = m_shards[shard];
+		metricAdd(s.buckets[i], shard, 1);
+		double sum = s.sum.load(std::memory_order_relaxed);
+		if (shard < METRIC_SHARDS - 1)
+			s.sum.store(sum + value, std::memory_order_relaxed);
+		else {
+			while (!s.sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+				;
+		}
+	}
+
+	int getBoundCount(void) const { return m_boundCount; }
+	double getBound(int index) const { return m_bounds[index]; }
+	// 구간별 개수 (getBoundCount() + 1개, 마지막은 경계보다 큰 값, 누적 아님)와 합
+	void read(uint64_t* pBuckets, double& sum) const;
+
+private:
+	CHistogram(const CHistogram&);
+	CHistogram& operator=(const CHistogram&);
+
+	struct Shard {
+		std::atomic<uint64_t>	buckets[METRIC_MAX_BUCKETS + 1];
+		std::atomic<double>		sum;
+		char					pad[64];
+	};
+	int		m_boundCount;
+	double	m_bounds[METRIC_MAX_BUCKETS];
+	Shard	m_shards[METRIC_SHARDS];
+};
+
+// 이름과 설명을 붙여 지표를 모아 두고 text exposition format으로 씀
+class CMetrics {
+public:
+	CMetrics(void) {}
+
+	// 설정할 때 등록, 받은 포인터는 CMetrics가 없어질 때까지 유효
+	// 이름이 [a-zA-Z_:][a-zA-Z0-9_:]* 가 아니거나 이미 있으면 NULL
+	CCounter* addCounter(const char* name, const char* help);
+	CGauge* addGauge(const char* name, const char* help);
+	// 경계가 없거나 METRIC_MAX_BUCKETS보다 많거나 오름차순이 아니어도 NULL
+	CHistogram* addHistogram(const char* name, const char* help, const double* pBounds, int count);
+
+	// 모든 지표를 등록한 순서대로 out 뒤에 붙임 (version 0.0.4)
+	void write(std::string& out) const;
+
+private:
+	CMetrics(const CMetrics&);
+	CMetrics& operator=(const CMetrics&);
+
+	struct Entry {
+		std::string		name;
+		std::string		help;
+		std::unique_ptr<CCounter>	pCounter;
+		std::unique_ptr<CGauge>		pGauge;
+		std::unique_ptr<CHistogram>	pHistogram;
+	};
+	bool canAdd(const char* name) const;
+
+	std::vector<std::unique_ptr<Entry> >	m_entries;
+	mutable std::mutex	m_mutex;		// 등록과 write()만, 갱신은 쓰지 않음
+};
+
+// 127.0.0.1에서 GET /metrics에 CMetrics::write()의 내용으로 답하는 스레드
+class CMetricsServer {
+public:
+	CMetricsServer(void);
+	~CMetricsServer(void);
+
+	// 포트를 잡지 못하면 false (다른 프로그램이 쓰는 중 등)
+	bool start(const CMetrics& metrics, int port = METRICS_PORT);
+	void stop(void);
+	bool isRunning(void) const { return m_running; }
+	long long getRequestCount(void) const { return m_requests.load(std::memory_order_relaxed); }
+
+private:
+	CMetricsServer(const CMetricsServer&);
+	CMetricsServer& operator=(const CMetricsServer&);
+
+	void serverMain(void);
+	void serve(uintptr_t client);
+
+	const CMetrics*		m_pMetrics;
+	uintptr_t			m_listen;		// SOCKET 또는 fd
+	bool				m_running;
+	std::atomic<bool>	m_quit;
+	std::atomic<long long>	m_requests;
+	std::thread			m_thread;
+	std::string			m_body;			// 응답마다 다시 씀
+	std::string			m_response;
+};
+
+// CGame이 진행하면서 올리는 지표 (CGame::setMetrics), registerGameMetrics()로 모두 채움
+// 서버는 모든 경기가 같은 지표를 나눠 씀
+struct GameMetrics {
+	CCounter*	steps;			// step()
+	CCounter*	contacts;		// 공끼리 풀이한 접촉
+	CCounter*	bricks;			// 깨진 벽돌
+	CCounter*	pocketed;		// 포켓에 빠진 공
+	CCounter*	shots;			// strike()
+	CCounter*	turns;			// 공이 모두 멈춰 점수를 매김
+	CCounter*	points;			// 턴마다 얻은 점수
+	CCounter*	pointsLost;		// 턴마다 잃은 점수 (4구의 감점)
+	CHistogram*	shotSteps;		// 샷이 멈출 때까지 걸린 스텝
+};
+
+// GameMetrics의 지표를 vlego_game_* 이름으로 등록, 하나라도 실패하면 (이미 등록함 등) false
+bool registerGameMetrics(CMetrics& metrics, GameMetrics& game);
+
+#endif // __metricsH__
@@ -0,0 +1,199 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: particles.cpp
+//
+// Desc: SoA particle pool with an SSE update loop (scalar where
+//       vecmath.h has no SSE, e.g. ARM or VECMATH_NO_SIMD).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "particles.h"
+#include "vecmath.h"		// VECMATH_SSE, <xmmintrin.h>
+#include <math.h>
+#include <stddef.h>
+
+CParticlePool::CParticlePool(void)
+{
+	m_capacity = m_highWater = m_alive = 0;
+	m_seed = 12345;
+	m_pBlock = NULL;
+	m_px = m_py = m_pz = NULL;
+	m_vx = m_vy = m_vz = NULL;
+	m_life = m_invMaxLife = NULL;
+	m_freeList = NULL;
+	m_freeCount = 0;
+}
+
+CParticlePool::~CParticlePool(void)
+{
+	destroy();
+}
+
+bool CParticlePool::create(int capacity)
+{
+	destroy();
+	capacity = (capacity + 3) & ~3;
+
+	// 배열 8개를 한 덩어리로 할당, float 3개까지 밀어 16바이트에 맞춤
+	m_pBlock = new float[capacity * 8 + 3];
+	float* block = m_pBlock;
+	while (((size_t)block & 15) != 0)
+		block++;
+	m_px = block;
+	m_py = block + capacity;
+	m_pz = block + capacity * 2;
+	m_vx = block + capacity * 3;
+	m_vy = block + capacity * 4;
+	m_vz = block + capacity * 5;
+	m_life = block + capacity * 6;
+	m_invMaxLife = block + capacity * 7;
+
+	m_freeList = new int[capacity];
+	m_capacity = capacity;
+	clear();
+	return true;
+}
+
+void CParticlePool::destroy(void)
+{
+	delete[] m_pBlock;
+	delete[] m_freeList;
+	m_pBlock = NULL;
+	m_px = m_py = m_pz = NULL;
+	m_vx = m_vy = m_vz = NULL;
+	m_life = m_invMaxLife = NULL;
+	m_freeList = NULL;
+	m_capacity = m_highWater = m_alive = m_freeCount = 0;
+}
+
+void CParticlePool::clear(void)
+{
+	for (int i = 0; i < m_capacity; i++) {
+		m_px[i] = m_py[i] = m_pz[i] = 0;
+		m_vx[i] = m_vy[i] = m_vz[i] = 0;
+		m_life[i] = 0;
+		m_invMaxLife[i] = 0;
+	}
+	// 앞쪽 칸부터 쓰이도록 거꾸로 쌓음
+	for (int i = 0; i < m_capacity; i++)
+		m_freeList[i] = m_capacity - 1 - i;
+	m_freeCount = m_capacity;
+	m_highWater = 0;
+	m_alive = 0;
+}
+
+int CParticlePool::spawn(float x, float y, float z, float vx, float vy, float vz, float life)
+{
+	if (m_freeCount == 0 || life <= 0)
+		return -1;
+
+	int i = m_freeList[--m_freeCount];
+	m_px[i] = x;	m_py[i] = y;	m_pz[i] = z;
+	m_vx[i] = vx;	m_vy[i] = vy;	m_vz[i] = vz;
+	m_life[i] = life;
+	m_invMaxLife[i] = 1.0f / life;
+
+	if (i >= m_highWater)
+		m_highWater = (i + 4) & ~3;
+	m_alive++;
+	return i;
+}
+
+void CParticlePool::emitBurst(float x, float y, float z, float nx, float nz, int count, float speed, float life)
+{
+	for (int n = 0; n < count; n++) {
+		// 간단한 LCG, rand()의 전역 상태를 건드리지 않음
+		m_seed = m_seed * 1664525u + 1013904223u;
+		float a = ((m_seed >> 8) & 0xffff) / 65535.0f * 2 - 1;
+		m_seed = m_seed * 1664525u + 1013904223u;
+		float b = ((m_seed >> 8) & 0xffff) / 65535.0f;
+		m_seed = m_seed * 1664525u + 1013904223u;
+		float c = ((m_seed >> 8) & 0xffff) / 65535.0f;
+
+		// 법선 방향 + 접선 방향으로 퍼짐, 위로 조금 튐
+		float tx = -nz, tz = nx;
+		float s = speed * (0.5f + 0.5f * c);
+		float vx = (nx * b + tx * a) * s;
+		float vz = (nz * b + tz * a) * s;
+		float vy = (0.3f + b) * s;
+		if (spawn(x, y, z, vx, vy, vz, life * (0.6f + 0.4f * c)) < 0)
+			break;
+	}
+}
+
+#if VECMATH_SSE
+void CParticlePool::update(float timeDiff, float gravity, float drag)
+{
+	const __m128 dt = _mm_set1_ps(timeDiff);
+	const __m128 dv = _mm_set1_ps(-gravity * timeDiff);
+	const __m128 damp = _mm_set1_ps(1.0f - drag * timeDiff);
+	const __m128 zero = _mm_setzero_ps();
+
+	int newHighWater = 0;
+	for (int i = 0; i < m_highWater; i += 4) {
+		__m128 life = _mm_load_ps(m_life + i);
+		__m128 alive = _mm_cmpgt_ps(life, zero);
+		int wasAlive = _mm_movemask_ps(alive);
+		if (wasAlive == 0)
+			continue;
+
+		__m128 vx = _mm_mul_ps(_mm_load_ps(m_vx + i), damp);
+		__m128 vy = _mm_add_ps(_mm_mul_ps(_mm_load_ps(m_vy + i), damp), dv);
+		__m128 vz = _mm_mul_ps(_mm_load_ps(m_vz + i), damp);
+
+		_mm_store_ps(m_vx + i, vx);
+		_mm_store_ps(m_vy + i, vy);
+		_mm_store_ps(m_vz + i, vz);
+		_mm_store_ps(m_px + i, _mm_add_ps(_mm_load_ps(m_px + i), _mm_mul_ps(vx, dt)));
+		_mm_store_ps(m_py + i, _mm_add_ps(_mm_load_ps(m_py + i), _mm_mul_ps(vy, dt)));
+		_mm_store_ps(m_pz + i, _mm_add_ps(_mm_load_ps(m_pz + i), _mm_mul_ps(vz, dt)));
+
+		// 죽은 칸의 수명은 0에 머무름
+		life = _mm_and_ps(_mm_sub_ps(life, dt), alive);
+		_mm_store_ps(m_life + i, life);
+
+		// 이번에 수명이 다한 칸을 free list로
+		int died = wasAlive & ~_mm_movemask_ps(_mm_cmpgt_ps(life, zero));
+		for (int k = 0; k < 4; k++) {
+			if (died & (1 << k)) {
+				m_life[i + k] = 0;
+				m_freeList[m_freeCount++] = i + k;
+				m_alive--;
+			}
+		}
+		if (wasAlive & ~died)
+			newHighWater = i + 4;
+	}
+	m_highWater = newHighWater;
+}
+#else
+// SSE 경로와 같은 계산을 한 칸씩
+void CParticlePool::update(float timeDiff, float gravity, float drag)
+{
+	const float dv = -gravity * timeDiff;
+	const float damp = 1.0f - drag * timeDiff;
+
+	int newHighWater = 0;
+	for (int i = 0; i < m_highWater; i++) {
+		if (!(m_life[i] > 0))
+			continue;
+
+		m_vx[i] *= damp;
+		m_vy[i] = m_vy[i] * damp + dv;
+		m_vz[i] *= damp;
+		m_px[i] += m_vx[i] * timeDiff;
+		m_py[i] += m_vy[i] * timeDiff;
+		m_pz[i] += m_vz[i] * timeDiff;
+
+		m_life[i] -= timeDiff;
+		if (m_life[i] > 0)
+			newHighWater = (i + 4) & ~3;
+		else {
+			m_life[i] = 0;
+			m_freeList[m_freeCount++] = i;
+			m_alive--;
+		}
+	}
+	m_highWater = newHighWater;
+}
+#endif
@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: particles.h
+//
+// Desc: Fixed-capacity particle pool for impact and brick-break effects.
+//       Particles are stored as structure-of-arrays so the update runs four
+//       particles per SSE instruction where vecmath.h finds SSE, one at a
+//       time in plain C++ elsewhere. All memory is allocated once in
+//       create(); dead slots go on a free list and are reused by spawn(),
+//       so the game loop never touches the heap.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __particlesH__
+#define __particlesH__
+
+class CParticlePool {
+public:
+	CParticlePool(void);
+	~CParticlePool(void);
+
+	bool create(int capacity);
+	void destroy(void);
+
+	// 빈 칸이 없으면 -1
+	int spawn(float x, float y, float z, float vx, float vy, float vz, float life);
+
+	// (x, y, z)에서 법선 (nx, nz) 쪽 반구로 count개를 흩뿌림
+	void emitBurst(float x, float y, float z, float nx, float nz, int count, float speed, float life);
+
+	// 중력, 공기 저항, 수명 감소를 적용하고 수명이 다한 칸은 free list로 돌려보냄
+	void update(float timeDiff, float gravity, float drag);
+
+	void clear(void);
+
+	int getCapacity(void) const { return m_capacity; }
+	int getAliveCount(void) const { return m_alive; }
+
+	// 살아있는 입자마다 f(x, y, z, 남은 수명 비율 0~1) 호출
+	template<typename F> void forEachAlive(F f) const
+	{
+		for (int i = 0; i < m_highWater; i++) {
+			if (m_life[i] > 0)
+				f(m_px[i], m_py[i], m_pz[i], m_life[i] * m_invMaxLife[i]);
+		}
+	}
+
+private:
+	CParticlePool(const CParticlePool&);
+	CParticlePool& operator=(const CParticlePool&);
+
+	int			m_capacity;		// 4의 배수
+	int			m_highWater;	// 한 번이라도 쓰인 칸의 끝, update는 여기까지만 돎
+	int			m_alive;
+	unsigned	m_seed;
+
+	// SoA, 16바이트 정렬, 8개 배열이 m_pBlock 한 덩어리 안에 있음
+	float*		m_pBlock;
+	float*		m_px;
+	float*		m_py;
+	float*		m_pz;
+	float*		m_vx;
+	float*		m_vy;
+	float*		m_vz;
+	float*		m_life;
+	float*		m_invMaxLife;
+
+	int*		m_freeList;		// 비어있는 칸 번호 스택
+	int			m_freeCount;
+};
+
+#endif // __particlesH__
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physics.cpp
+//
+// Desc: Ball, wall and stick collision and integration.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "physics.h"
+#include <math.h>
+
+template<typename S>
+bool collideBalls(BallBodyT<S>& a, BallBodyT<S>& b, S radius, typename NonDeduced<ContactT<S> >::Type* pContact)
+{
+	if (!ballsOverlap(a, b, radius))
+		return false;
+
+	// Calculate relative velocity
+	S relVelX = b.vx - a.vx;
+	S relVelZ = b.vz - a.vz;
+	// Calculate the normal vector at the collision point
+	S nx = b.x - a.x;
+	S nz = b.z - a.z;
+	S len = scalarSqrt(nx * nx + nz * nz);
+	if (len > scalar<S>(0)) {
+		nx /= len;
+		nz /= len;
+	}
+	// Calculate impulse based on the normal and relative velocity
+	S impulse = relVelX * nx + relVelZ * nz;
+	// Update velocities
+	a.vx += impulse * nx;
+	a.vz += impulse * nz;
+	b.vx -= impulse * nx;
+	b.vz -= impulse * nz;
+
+	if (pContact != NULL) {
+		// 효과는 접선 방향으로 퍼지게
+		pContact->x = (a.x + b.x) * scalar<S>(0.5);
+		pContact->z = (a.z + b.z) * scalar<S>(0.5);
+		pContact->normalX = -nz;
+		pContact->normalZ = nx;
+		pContact->speed = -impulse;
+	}
+	return true;
+}
+
+template<typename S>
+void integrateBall(BallBodyT<S>& ball, S timeDiff, S decreaseRate)
+{
+	const S zero = scalar<S>(0);
+	const S half = scalar<S>(0.5);
+	const S minSpeed = scalar<S>(0.0001);
+	const S move = scalar<S>(PHYSICS_TIME_SCALE);
+	const S slide = scalar<S>(BALL_SLIDE_DECEL);
+	// (1 - decreaseRate)는 아주 작으므로 400을 먼저 곱함 (고정소수점에서 0이 되지 않게)
+	const S roll = (scalar<S>(1) - decreaseRate) * scalar<S>(400);
+
+	// 보간용으로 이번 갱신 전 위치를 저장
+	ball.prevX = ball.x;
+	ball.prevZ = ball.z;
+
+	S t = timeDiff;
+
+	// 미끄러짐: 바닥 접점의 속도 u = v + w x r의 방향은 변하지 않으므로 마찰력이 일정함
+	// u는 v의 7/2배 빠르기로 줄어 2|u| / (7 slide) 뒤에 0이 되고, 그때부터 구름
+	S ux = ball.vx + ball.wz;
+	S uz = ball.vz - ball.wx;
+	S u = scalarSqrt(ux * ux + uz * uz);
+	if (u > minSpeed) {
+		S dirX = ux / u, dirZ = uz / u;
+		S slideTime = u * scalar<S>(2.0 / 7.0) / slide;
+		S h = slideTime < t ? slideTime : t;
+		S dv = slide * h;
+		ball.x += move * h * (ball.vx - half * dv * dirX);
+		ball.z += move * h * (ball.vz - half * dv * dirZ);
+		ball.vx -= dv * dirX;
+		ball.vz -= dv * dirZ;
+		ball.wx += scalar<S>(2.5) * dv * dirZ;		// 속 찬 공, 각운동량 변화는 선운동량의 5/2배
+		ball.wz -= scalar<S>(2.5) * dv * dirX;
+		t -= h;
+	}
+
+	// 구름: 구름 저항으로 일정하게 감속, 멈추는 시각을 넘으면 그 자리에서 멈춤
+	if (t > zero) {
+		S v = scalarSqrt(ball.vx * ball.vx + ball.vz * ball.vz);
+		if (v > minSpeed) {
+			S dirX = ball.vx / v, dirZ = ball.vz / v;
+			S h = t;
+			bool stops = roll * t >= v;
+			if (stops)
+				h = v / roll;
+			S dv = roll * h;
+			ball.x += move * h * (ball.vx - half * dv * dirX);
+			ball.z += move * h * (ball.vz - half * dv * dirZ);
+			if (stops) {
+				ball.vx = ball.vz = zero;
+			}
+			else {
+				ball.vx -= dv * dirX;
+				ball.vz -= dv * dirZ;
+			}
+		}
+		else {
+			ball.vx = ball.vz = zero;
+		}
+		ball.wx = ball.vz;
+		ball.wz = -ball.vx;
+	}
+
+	// 제자리 회전은 바닥과의 마찰로 따로 줄어듦
+	S spin = scalar<S>(BALL_SPIN_DECEL) * timeDiff;
+	if (ball.wy > spin)
+		ball.wy -= spin;
+	else if (ball.wy < -spin)
+		ball.wy += spin;
+	else
+		ball.wy = zero;
+}
+
+template<typename S>
+bool collideWall(const WallBodyT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact)
+{
+	if (wall.width > wall.depth)											// 가로방향 벽일 때
+		return collideAxisWall<WALL_ALONG_X>(wall, ball, radius, restitution, pContact);
+	return collideAxisWall<WALL_ALONG_Z>(wall, ball, radius, restitution, pContact);
+}
+
+template<typename S>
+bool collideSegmentWall(const SegmentWallT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact)
+{
+	const S zero = scalar<S>(0), one = scalar<S>(1), two = scalar<S>(2);
+
+	// 선분 위에서 공 중심과 가장 가까운 점
+	S ex = wall.bx - wall.ax, ez = wall.bz - wall.az;
+	S lenSq = ex * ex + ez * ez;
+	S t = lenSq > zero ? ((ball.x - wall.ax) * ex + (ball.z - wall.az) * ez) / lenSq : zero;
+	if (t < zero) t = zero;
+	if (t > one) t = one;
+	S cx = wall.ax + ex * t, cz = wall.az + ez * t;
+
+	S nx = ball.x - cx, nz = ball.z - cz;
+	S distSq = nx * nx + nz * nz;
+	S reach = radius + wall.halfThickness;
+	if (distSq >= reach * reach || distSq == zero)
+		return false;
+
+	S dist = scalarSqrt(distSq);
+	nx /= dist;
+	nz /= dist;
+	S vn = ball.vx * nx + ball.vz * nz;
+	if (vn >= zero)																// 벽에서 멀어지는 중
+		return false;
+
+	ball.vx = restitution * (ball.vx - two * vn * nx);
+	ball.vz = restitution * (ball.vz - two * vn * nz);
+
+	if (pContact != NULL) {
+		pContact->x = ball.x - nx * radius;
+		pContact->z = ball.z - nz * radius;
+		pContact->normalX = nx;
+		pContact->normalZ = nz;
+		pContact->speed = -vn;
+	}
+	return true;
+}
+
+// 게임은 float, double과 Fixed는 벤치마크와 정확도 비교용
+#define INSTANTIATE_PHYSICS(S) \
+	template bool collideBalls<S>(BallBodyT<S>&, BallBodyT<S>&, S, ContactT<S>*); \
+	template void integrateBall<S>(BallBodyT<S>&, S, S); \
+	template bool collideWall<S>(const WallBodyT<S>&, BallBodyT<S>&, S, S, ContactT<S>*); \
+	template bool collideSegmentWall<S>(const SegmentWallT<S>&, BallBodyT<S>&, S, S, ContactT<S>*);
+
+INSTANTIATE_PHYSICS(float)
+INSTANTIATE_PHYSICS(double)
+INSTANTIATE_PHYSICS(Fixed)
+
+Capsule stickCapsule(const StickBody& stick, float x, float z)
+{
+	// 원기둥은 로컬 z축 방향, Y축 회전 후 (sin, cos) 방향이 됨
+	float ux = sinf(stick.angle) * stick.length / 2;
+	float uz = cosf(stick.angle) * stick.length / 2;
+	Capsule capsule = { x - ux, z - uz, x + ux, z + uz, stick.radius };
+	return capsule;
+}
+
+void integrateStick(StickBody& stick, float timeDiff)
+{
+	// 보간용으로 이번 갱신 전 위치를 저장
+	stick.prevX = stick.x;
+	stick.prevZ = stick.z;
+
+	if (fabsf(stick.vx) > 0.01f || fabsf(stick.vz) > 0.01f) {
+		stick.x += PHYSICS_TIME_SCALE * timeDiff * stick.vx;
+		stick.z += PHYSICS_TIME_SCALE * timeDiff * stick.vz;
+	}
+	else {
+		stick.vx = stick.vz = 0;
+	}
+}
+
+bool collideStick(StickBody& stick, BallBody& ball, float radius)
+{
+	// 이번 스텝 동안 당구채와 공이 움직인 궤적을 통째로 검사해서 처음 닿는 순간을 찾음
+	CapsuleHit hit;
+	if (!sweepCapsuleCircle(stickCapsule(stick, stick.prevX, stick.prevZ), stick.x - stick.prevX, stick.z - stick.prevZ,
+		ball.prevX, ball.prevZ, ball.x - ball.prevX, ball.z - ball.prevZ, radius, &hit))
+		return false;
+
+	// 접촉 법선 방향으로 당구채의 속도를 전달, 비껴 맞으면 비스듬히 나감
+	if (!resolveCapsuleHit(stickCapsule(stick, stick.x, stick.z), hit, stick.vx, stick.vz, 0.0f, 0.0f, &ball.vx, &ball.vz))
+		return false;
+
+	// 당구채는 닿은 자리에서 멈춤
+	stick.x = stick.prevX + (stick.x - stick.prevX) * hit.t;
+	stick.z = stick.prevZ + (stick.z - stick.prevZ) * hit.t;
+	stick.vx = stick.vz = 0;
+	return true;
+}
+
+void applyCueSpin(BallBody& ball, float side, float height)
+{
+	// 나가는 방향 d의 오른쪽 s = (dz, -dx)를 축으로 도는 성분과 수직축 성분
+	// 당점 높이 b에서 준 충격량 J가 만드는 회전은 5/2 J b, J = 공의 속도
+	float speed = sqrtf(ball.vx * ball.vx + ball.vz * ball.vz);
+	ball.wx = 2.5f * height * ball.vz;
+	ball.wz = -2.5f * height * ball.vx;
+	ball.wy = -2.5f * side * speed;
+}
@@ -0,0 +1,249 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: physics.h
+//
+// Desc: Table physics shared by CSphere, CWall and CStick. The bodies are
+//       plain structs with no Direct3D dependency, so the same code runs
+//       in the game and in the console benchmarks under bench/.
+//
+//       Ball and wall code is templated on the scalar type (see scalar.h);
+//       every argument must use the same type, so precisions are never
+//       mixed. physics.cpp instantiates float, double and Fixed. The game
+//       uses the float typedefs below; the cue stick is float only.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __physicsH__
+#define __physicsH__
+
+#include "capsule.h"
+#include "scalar.h"
+#include <stddef.h>
+
+// 속도 1이 1초 동안 움직이는 거리
+#define PHYSICS_TIME_SCALE 3.3f
+// 미끄러지는 공과 천 사이의 마찰로 줄어드는 속도, timeDiff 1당
+#define BALL_SLIDE_DECEL 9.0
+// 제자리 회전(좌우 당점)이 천과의 마찰로 줄어드는 속도, timeDiff 1당
+#define BALL_SPIN_DECEL 2.0
+
+template<typename S>
+struct BallBodyT {
+	S		x, y, z;
+	S		prevX, prevZ;		// 직전 갱신 때의 위치, 보간과 궤적 검사에 씀
+	S		vx, vz;
+	// 각속도 x 반지름 (공 표면의 속도), 구를 때는 wx = vz, wz = -vx
+	// wy는 수직축 회전(좌우 당점), 공끼리 부딪힐 때 던짐(throw)을 만듦
+	S		wx, wy, wz;
+};
+
+// 축에 정렬된 직육면체 벽, (x, z)는 중심
+template<typename S>
+struct WallBodyT {
+	S		x, z;
+	S		width, depth;
+};
+
+// 충돌 효과용 접촉 정보
+template<typename S>
+struct ContactT {
+	S		x, z;				// 접촉 지점
+	S		normalX, normalZ;	// 튕겨 나가는 방향
+	S		speed;				// 법선 방향으로 다가오던 속도, 멀어지는 중이면 0 이하
+};
+
+// (ax, az)-(bx, bz) 선분에 두께를 준 벽, 사용자 테이블의 비스듬한 쿠션용
+template<typename S>
+struct SegmentWallT {
+	S		ax, az;
+	S		bx, bz;
+	S		halfThickness;
+};
+
+// 네 쿠션이 만드는 직사각형 안쪽 (쿠션 면 사이)
+template<typename S>
+struct TableRectT {
+	S		minX, maxX;
+	S		minZ, maxZ;
+};
+
+// 포켓, 공 중심이 radius 안에 들어오면 빠짐
+template<typename S>
+struct PocketT {
+	S		x, z;
+	S		radius;
+};
+
+typedef BallBodyT<float>	BallBody;
+typedef WallBodyT<float>	WallBody;
+typedef ContactT<float>		Contact;
+typedef SegmentWallT<float>	SegmentWall;
+typedef TableRectT<float>	TableRect;
+typedef PocketT<float>		Pocket;
+
+// 당구채, 로컬 z축 방향의 원기둥을 Y축으로 angle만큼 돌린 것
+struct StickBody {
+	float	x, y, z;
+	float	prevX, prevZ;
+	float	vx, vz;
+	float	angle;
+	float	length;
+	float	radius;				// 충돌용 캡슐 반지름
+};
+
+// NULL을 넘겨도 S를 다른 인자에서 정하도록 함
+template<typename T>
+struct NonDeduced { typedef T Type; };
+
+template<typename S>
+inline bool ballsOverlap(const BallBodyT<S>& a, const BallBodyT<S>& b, S radius)
+{
+	S dx = a.x - b.x;
+	S dz = a.z - b.z;
+	return dx * dx + dz * dz < scalar<S>(4) * radius * radius;
+}
+template<typename S>
+inline bool ballInPocket(const PocketT<S>& pocket, const BallBodyT<S>& ball)
+{
+	S dx = ball.x - pocket.x;
+	S dz = ball.z - pocket.z;
+	return dx * dx + dz * dz < pocket.radius * pocket.radius;
+}
+// 겹쳐 있으면 법선 방향 상대 속도를 주고받음, pContact는 NULL 가능
+template<typename S>
+bool collideBalls(BallBodyT<S>& a, BallBodyT<S>& b, S radius, typename NonDeduced<ContactT<S> >::Type* pContact);
+// 한 스텝 이동하고 감속, 미끄러짐 -> 구름 -> 정지를 닫힌 식으로 풀어 timeDiff 크기와 상관없이 정확함
+// decreaseRate는 원래 프레임당 감속률, 속도 1일 때의 감속이 같도록 구름 저항으로 씀
+template<typename S>
+void integrateBall(BallBodyT<S>& ball, S timeDiff, S decreaseRate);
+
+template<typename S>
+inline bool wallOverlaps(const WallBodyT<S>& wall, const BallBodyT<S>& ball, S radius)
+{
+	const S half = scalar<S>(0.5);
+	return scalarAbs(ball.x - wall.x) < wall.width * half + radius && scalarAbs(ball.z - wall.z) < wall.depth * half + radius;
+}
+// 벽을 향해 움직이는 공만 반사, 반사했으면 true
+// 벽 방향을 모를 때 쓰는 일반 경로, 방향을 아는 벽은 collideAxisWall<>을 씀
+template<typename S>
+bool collideWall(const WallBodyT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact);
+
+// 벽 모양, 방향은 벽이 길게 놓인 축
+enum WallShape {
+	WALL_ALONG_X,		// 가로 벽 (width > depth), z 방향으로 튕김
+	WALL_ALONG_Z,		// 세로 벽, x 방향으로 튕김
+	WALL_SEGMENT,		// 임의 방향의 선분 벽 (SegmentWallT)
+};
+
+// 방향이 정해진 벽, 실행 중에 width와 depth를 비교하지 않음
+template<WallShape Shape>
+struct AxisWall;
+
+template<>
+struct AxisWall<WALL_ALONG_X> {
+	template<typename S>
+	static bool collide(const WallBodyT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact)
+	{
+		const S zero = scalar<S>(0);
+		if (!wallOverlaps(wall, ball, radius) || ball.vz * (wall.z - ball.z) <= zero)
+			return false;
+
+		S nz = ball.z < wall.z ? scalar<S>(-1) : scalar<S>(1);
+		if (pContact != NULL) {
+			pContact->x = ball.x;
+			pContact->z = ball.z - nz * radius;
+			pContact->normalX = zero;
+			pContact->normalZ = nz;
+			pContact->speed = scalarAbs(ball.vz);
+		}
+		ball.vx = restitution * ball.vx;
+		ball.vz = -restitution * ball.vz;
+		return true;
+	}
+};
+
+template<>
+struct AxisWall<WALL_ALONG_Z> {
+	template<typename S>
+	static bool collide(const WallBodyT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact)
+	{
+		const S zero = scalar<S>(0);
+		if (!wallOverlaps(wall, ball, radius) || ball.vx * (wall.x - ball.x) <= zero)
+			return false;
+
+		S nx = ball.x < wall.x ? scalar<S>(-1) : scalar<S>(1);
+		if (pContact != NULL) {
+			pContact->x = ball.x - nx * radius;
+			pContact->z = ball.z;
+			pContact->normalX = nx;
+			pContact->normalZ = zero;
+			pContact->speed = scalarAbs(ball.vx);
+		}
+		ball.vx = -restitution * ball.vx;
+		ball.vz = restitution * ball.vz;
+		return true;
+	}
+};
+
+template<WallShape Shape, typename S>
+inline bool collideAxisWall(const WallBodyT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact)
+{
+	return AxisWall<Shape>::collide(wall, ball, radius, restitution, pContact);
+}
+
+// 선분 법선 방향으로 반사, 축 방향 벽과 같이 속도 전체에 restitution을 곱함
+template<typename S>
+bool collideSegmentWall(const SegmentWallT<S>& wall, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContact);
+
+// 직사각형 테이블 전용, 네 벽을 비교와 곱셈만으로 한번에 처리
+// 바깥 벽을 향해 움직이는 축만 반사하므로 네 벽에 collideAxisWall<>을 부른 결과와 같음
+// pContacts는 NULL이거나 2칸 (모서리에서는 두 벽에 동시에 닿음), 닿은 벽 수를 돌려줌
+template<typename S>
+inline int collideTableRect(const TableRectT<S>& rect, BallBodyT<S>& ball, S radius, S restitution, typename NonDeduced<ContactT<S> >::Type* pContacts)
+{
+	const S zero = scalar<S>(0), one = scalar<S>(1);
+	bool hitMinX = ball.x < rect.minX + radius && ball.vx < zero;
+	bool hitMaxX = ball.x > rect.maxX - radius && ball.vx > zero;
+	bool hitMinZ = ball.z < rect.minZ + radius && ball.vz < zero;
+	bool hitMaxZ = ball.z > rect.maxZ - radius && ball.vz > zero;
+	bool hitX = hitMinX | hitMaxX;		// 세로 벽 (WALL_ALONG_Z)
+	bool hitZ = hitMinZ | hitMaxZ;		// 가로 벽 (WALL_ALONG_X)
+
+	// 세로 벽은 (-e, e), 가로 벽은 (e, -e)를 곱함, 둘 다면 곱이 됨
+	S e = restitution;
+	S scaleX = (hitX ? -e : one) * (hitZ ? e : one);
+	S scaleZ = (hitZ ? -e : one) * (hitX ? e : one);
+
+	int count = 0;
+	if (pContacts != NULL && (hitX | hitZ)) {
+		// 기본 테이블의 벽 순서(가로 벽 먼저)대로 알림
+		if (hitZ) {
+			S nz = hitMinZ ? one : -one;
+			ContactT<S> c = { ball.x, ball.z - nz * radius, zero, nz, scalarAbs(ball.vz) };
+			pContacts[count++] = c;
+		}
+		if (hitX) {
+			S nx = hitMinX ? one : -one;
+			ContactT<S> c = { ball.x - nx * radius, ball.z, nx, zero, scalarAbs(ball.vx) * (hitZ ? e : one) };
+			pContacts[count++] = c;
+		}
+	}
+	else {
+		count = (int)hitX + (int)hitZ;
+	}
+
+	ball.vx *= scaleX;
+	ball.vz *= scaleZ;
+	return count;
+}
+
+// 당구채 중심이 (x, z)일 때의 충돌용 캡슐
+Capsule stickCapsule(const StickBody& stick, float x, float z);
+void integrateStick(StickBody& stick, float timeDiff);
+// 이번 스텝의 궤적으로 처음 닿는 순간을 찾아 공에 속도를 전달하고 당구채를 그 자리에 세움
+bool collideStick(StickBody& stick, BallBody& ball, float radius);
+// 당구채에 맞아 나가는 공의 회전, side와 height는 당점 (공 중심에서 반지름 단위, 오른쪽과 위가 +)
+// height 0.4가 처음부터 구르는 당점, 더 위는 밀어치기, 아래는 끌어치기
+void applyCueSpin(BallBody& ball, float side, float height);
+
+#endif // __physicsH__
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: scalar.h
+//
+// Desc: Scalar precision policies for the physics templates in physics.h:
+//       float (the game), double, and Fixed, a Q16.16 fixed-point number
+//       that gives bit-identical results on every platform. Constants go
+//       through scalar<S>() so they are converted once, at compile time,
+//       and physics code never mixes precisions.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __scalarH__
+#define __scalarH__
+
+#include <math.h>
+#include <stdint.h>
+
+// Q16.16 고정소수점, 범위 약 ±32768, 해상도 1/65536
+// 다른 타입과는 명시적으로만 바뀜 (fromDouble, toDouble)
+struct Fixed {
+	int32_t raw;
+
+	static const int FRACTION_BITS = 16;
+	static const int32_t ONE = 1 << FRACTION_BITS;
+
+	static constexpr Fixed fromRaw(int32_t raw) { return Fixed{ raw }; }
+	static constexpr Fixed fromDouble(double v)
+	{
+		return Fixed{ (int32_t)(v * ONE + (v < 0 ? -0.5 : 0.5)) };
+	}
+	constexpr double toDouble(void) const { return (double)raw / ONE; }
+
+	constexpr Fixed operator+(Fixed b) const { return Fixed{ raw + b.raw }; }
+	constexpr Fixed operator-(Fixed b) const { return Fixed{ raw - b.raw }; }
+	constexpr Fixed operator-(void) const { return Fixed{ -raw }; }
+	constexpr Fixed operator*(Fixed b) const { return Fixed{ (int32_t)(((int64_t)raw * b.raw) >> FRACTION_BITS) }; }
+	constexpr Fixed operator/(Fixed b) const { return Fixed{ (int32_t)(((int64_t)raw << FRACTION_BITS) / b.raw) }; }
+	Fixed& operator+=(Fixed b) { raw += b.raw; return *this; }
+	Fixed& operator-=(Fixed b) { raw -= b.raw; return *this; }
+	Fixed& operator*=(Fixed b) { *this = *this * b; return *this; }
+	Fixed& operator/=(Fixed b) { *this = *this / b; return *this; }
+
+	constexpr bool operator<(Fixed b) const { return raw < b.raw; }
+	constexpr bool operator>(Fixed b) const { return raw > b.raw; }
+	constexpr bool operator<=(Fixed b) const { return raw <= b.raw; }
+	constexpr bool operator>=(Fixed b) const { return raw >= b.raw; }
+	constexpr bool operator==(Fixed b) const { return raw == b.raw; }
+	constexpr bool operator!=(Fixed b) const { return raw != b.raw; }
+};
+
+// 상수 변환, 인자가 리터럴이면 컴파일 때 계산됨
+template<typename S>
+constexpr S scalar(double v) { return static_cast<S>(v); }
+template<>
+constexpr Fixed scalar<Fixed>(double v) { return Fixed::fromDouble(v); }
+
+// 화면 출력, 비교 등 경계에서만 씀
+inline double scalarToDouble(float v) { return v; }
+inline double scalarToDouble(double v) { return v; }
+inline double scalarToDouble(Fixed v) { return v.toDouble(); }
+
+inline float scalarSqrt(float v) { return sqrtf(v); }
+inline double scalarSqrt(double v) { return sqrt(v); }
+// 정수 제곱근, 부동소수점을 거치지 않음
+inline Fixed scalarSqrt(Fixed v)
+{
+	if (v.raw <= 0)
+		return Fixed::fromRaw(0);
+	uint64_t n = (uint64_t)v.raw << Fixed::FRACTION_BITS;
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+	while (bit > n)
+		bit >>= 2;
+	while (bit != 0) {
+		if (n >= root + bit) {
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return Fixed::fromRaw((int32_t)root);
+}
+
+inline float scalarAbs(float v) { return fabsf(v); }
+inline double scalarAbs(double v) { return fabs(v); }
+inline Fixed scalarAbs(Fixed v) { return v.raw < 0 ? -v : v; }
+
+#endif // __scalarH__
@@ -0,0 +1,405 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: botClient.cpp
+//
+// Desc: Load generator for gameServer. Opens one connection per match
+//       and plays every match with a bot that aims the way replayHarness
+//       does (toward a random other ball, random power and cue tip). A
+//       finished match, or one that reached --turns shots, is replaced
+//       by a new one on the same connection. All bots share one epoll set
+//       on one thread. Reports as CSV:
+//         turns_per_sec       shots answered per second, all matches
+//         turn_ms_p50 .. max  time from sending a shot to its turn reply
+//         lag_ms_p50, p99     the same minus the shot's own game time
+//                             (steps / PHYSICS_HZ), the delay the server
+//                             adds when it runs shots in real time; not
+//                             meaningful against gameServer --fast
+//         server_cpu_util     server CPU seconds per wall second during
+//                             the run (from the stats command), in cores
+//         matches_per_core    matches / server_cpu_util, how many matches
+//                             at this pace one core can host
+//         turns_per_core_sec  turns per server CPU second
+//       The bots and the server should not share cores for the CPU
+//       numbers to mean anything. Linux only (epoll). Console program:
+//
+//         g++ -O2 -std=c++14 -I.. botClient.cpp -o botClient
+//
+//       Usage:
+//         botClient [--host A] [--port P] [--matches N] [--seconds S] [--turns K] [--seed S]
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "game.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#define DEFAULT_PORT 7777
+#define MAX_EVENTS 256
+#define DRAIN_SECONDS 60		// 끝난 뒤 답이 남은 샷을 기다리는 최대 시간
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point t0)
+{
+	return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+static float frand(void) { return rand() / (float)RAND_MAX; }
+
+static void raiseFileLimit(void)
+{
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+}
+
+static int connectTo(const char* host, int port, bool blocking)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | (blocking ? 0 : SOCK_NONBLOCK), 0);
+	if (fd < 0)
+		return -1;
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((unsigned short)port);
+	if (inet_pton(AF_INET, host, &addr.sin_addr) != 1 ||
+		(connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 && errno != EINPROGRESS)) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// stats 명령의 답, 따로 연결해서 막히는 방식으로 물어봄
+struct ServerStats {
+	int			threads;
+	int			matches;
+	long long	turns;
+	double		cpuSeconds;
+};
+
+static bool queryStats(const char* host, int port, ServerStats* pStats)
+{
+	int fd = connectTo(host, port, true);
+	if (fd < 0)
+		return false;
+	const char cmd[] = "stats\nquit\n";
+	bool ok = send(fd, cmd, sizeof(cmd) - 1, MSG_NOSIGNAL) == (ssize_t)(sizeof(cmd) - 1);
+	std::string line;
+	char c;
+	while (ok && recv(fd, &c, 1, 0) == 1 && c != '\n')
+		line += c;
+	close(fd);
+	return ok && sscanf(line.c_str(), "stats %d %d %lld %lf", &pStats->threads, &pStats->matches,
+		&pStats->turns, &pStats->cpuSeconds) == 4;
+}
+
+// -----------------------------------------------------------------------------
+// 봇 하나 = 연결 하나 = 진행 중인 경기 하나
+// -----------------------------------------------------------------------------
+
+struct Bot {
+	int				fd;
+	std::string		in, out;
+	bool			dead;
+	int				turns;			// 이번 경기에서 친 샷
+	bool			waiting;		// 답을 기다리는 샷이 있음
+	Clock::time_point sentAt;
+	std::vector<float> ballX, ballZ;
+	int				current;		// 칠 공 (목록 번호)
+};
+
+struct Totals {
+	long long		matches;		// 끝까지 (또는 --turns까지) 친 경기
+	long long		turns;
+	long long		errors;
+	double			gameSeconds;	// 샷마다 걸린 게임 시간의 합
+	std::vector<double> turnMs;
+	std::vector<double> lagMs;
+};
+
+// "match ..." / "turn ..." 줄의 상태를 읽음, 끝난 경기면 true
+static bool parseState(Bot& bot, const char* pLine, int* pSteps)
+{
+	int id, player, score1, score2, over, balls, n = 0;
+	if (sscanf(pLine, "%*s %d %d %d %d %d %d %d %d%n", &id, &player, &score1, &score2, &bot.current,
+		pSteps, &over, &balls, &n) != 8)
+		return true;
+	pLine += n;
+	bot.ballX.resize(balls);
+	bot.ballZ.resize(balls);
+	for (int i = 0; i < balls; i++) {
+		int ballId;
+		if (sscanf(pLine, " %d %f %f%n", &ballId, &bot.ballX[i], &bot.ballZ[i], &n) != 3)
+			return true;
+		pLine += n;
+	}
+	return over != 0 || balls < 2;
+}
+
+// replayHarness의 generateShot()처럼 다른 공 하나를 향해 임의의 힘으로
+static void sendShot(Bot& bot)
+{
+	int count = (int)bot.ballX.size();
+	int other;
+	do {
+		other = rand() % count;
+	} while (other == bot.current);
+
+	float wx = bot.ballX[bot.current], wz = bot.ballZ[bot.current];
+	float dx = bot.ballX[other] - wx, dz = bot.ballZ[other] - wz;
+	float len = sqrtf(dx * dx + dz * dz);
+	float power = 0.5f + 3.5f * frand();
+	float spread = 0.15f * (frand() - 0.5f);
+	float tx = wx + (dx / len + spread * -dz / len) * power;
+	float tz = wz + (dz / len + spread * dx / len) * power;
+
+	char buf[96];
+	snprintf(buf, sizeof(buf), "shot %.4f %.4f %d %d\n", tx, tz, rand() % 7 - 3, rand() % 7 - 3);
+	bot.out += buf;
+	bot.waiting = true;
+	bot.sentAt = Clock::now();
+}
+
+static void flush(Bot& bot)
+{
+	while (!bot.out.empty()) {
+		ssize_t n = send(bot.fd, bot.out.data(), bot.out.size(), MSG_NOSIGNAL);
+		if (n > 0) {
+			bot.out.erase(0, (size_t)n);
+			continue;
+		}
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+			bot.dead = true;
+		break;
+	}
+}
+
+static void handleLine(Bot& bot, const char* pLine, bool running, int maxTurns, Totals& totals)
+{
+	int steps = 0;
+	bool over;
+	if (strncmp(pLine, "ack ", 4) == 0)
+		return;		// 예측하지 않으므로 쓰지 않음
+	if (strncmp(pLine, "match ", 6) == 0) {
+		bot.turns = 0;
+		over = parseState(bot, pLine, &steps);
+	}
+	else if (strncmp(pLine, "turn ", 5) == 0) {
+		double ms = secondsSince(bot.sentAt) * 1000;
+		bot.waiting = false;
+		over = parseState(bot, pLine, &steps);
+		bot.turns++;
+		totals.turns++;
+		totals.gameSeconds += (double)steps / PHYSICS_HZ;
+		totals.turnMs.push_back(ms);
+		totals.lagMs.push_back(ms - 1000.0 * steps / PHYSICS_HZ);
+	}
+	else {
+		// 바쁠 때 친 샷 등, 이번 샷은 버리고 새 경기로
+		totals.errors++;
+		bot.waiting = false;
+		over = true;
+	}
+
+	if (!running)
+		return;
+	if (over || bot.turns >= maxTurns) {
+		if (bot.turns > 0)
+			totals.matches++;
+		bot.out += "new\n";
+		bot.waiting = true;
+		bot.sentAt = Clock::now();
+	}
+	else {
+		sendShot(bot);
+	}
+}
+
+static double percentile(std::vector<double>& v, double p)
+{
+	if (v.empty())
+		return 0;
+	size_t k = (size_t)(p * (v.size() - 1));
+	std::nth_element(v.begin(), v.begin() + k, v.end());
+	return v[k];
+}
+
+int main(int argc, char* argv[])
+{
+	const char* host = "127.0.0.1";
+	int port = DEFAULT_PORT;
+	int matches = 1000;
+	double seconds = 20;
+	int maxTurns = 20;
+	unsigned int seed = 1;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--host") == 0 && i + 1 < argc)
+			host = argv[++i];
+		else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+			port = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc)
+			matches = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+			seconds = atof(argv[++i]);
+		else if (strcmp(argv[i], "--turns") == 0 && i + 1 < argc)
+			maxTurns = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = (unsigned int)atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--host A] [--port P] [--matches N] [--seconds S] [--turns K] [--seed S]\n", argv[0]);
+			return 2;
+		}
+	}
+	srand(seed);
+	raiseFileLimit();
+
+	ServerStats before;
+	if (!queryStats(host, port, &before)) {
+		fprintf(stderr, "cannot reach server %s:%d\n", host, port);
+		return 1;
+	}
+
+	int epoll = epoll_create1(0);
+	std::vector<Bot> bots(matches);
+	for (int i = 0; i < matches; i++) {
+		Bot& bot = bots[i];
+		bot.fd = connectTo(host, port, false);
+		bot.dead = bot.fd < 0;
+		bot.turns = 0;
+		bot.current = 0;
+		if (bot.dead)
+			continue;
+		bot.out = "new\n";
+		bot.waiting = true;
+		bot.sentAt = Clock::now();
+		struct epoll_event ev;
+		ev.events = EPOLLIN | EPOLLOUT;		// 연결되면 EPOLLOUT으로 "new"를 보냄
+		ev.data.u32 = (uint32_t)i;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, bot.fd, &ev);
+	}
+
+	Totals totals = { 0, 0, 0, 0, std::vector<double>(), std::vector<double>() };
+	totals.turnMs.reserve(1 << 16);
+	totals.lagMs.reserve(1 << 16);
+	struct epoll_event events[MAX_EVENTS];
+	Clock::time_point start = Clock::now();
+	char buf[4096];
+
+	for (;;) {
+		double elapsed = secondsSince(start);
+		bool running = elapsed < seconds;
+		if (!running) {
+			// 새 샷은 보내지 않고, 보낸 샷의 답만 기다림
+			bool pending = false;
+			for (size_t i = 0; i < bots.size() && !pending; i++)
+				pending = !bots[i].dead && bots[i].waiting;
+			if (!pending || elapsed > seconds + DRAIN_SECONDS)
+				break;
+		}
+
+		int n = epoll_wait(epoll, events, MAX_EVENTS, 100);
+		for (int e = 0; e < n; e++) {
+			Bot& bot = bots[events[e].data.u32];
+			if (bot.dead)
+				continue;
+			if (events[e].events & (EPOLLERR | EPOLLHUP))
+				bot.dead = true;
+			if (!bot.dead && (events[e].events & EPOLLIN)) {
+				for (;;) {
+					ssize_t got = recv(bot.fd, buf, sizeof(buf), 0);
+					if (got > 0) {
+						bot.in.append(buf, (size_t)got);
+						continue;
+					}
+					if (got < 0 && errno == EINTR)
+						continue;
+					if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+						bot.dead = true;
+					break;
+				}
+				size_t lineStart = 0, end;
+				while ((end = bot.in.find('\n', lineStart)) != std::string::npos) {
+					bot.in[end] = '\0';
+					handleLine(bot, bot.in.c_str() + lineStart, running, maxTurns, totals);
+					lineStart = end + 1;
+				}
+				bot.in.erase(0, lineStart);
+			}
+			if (!bot.dead)
+				flush(bot);
+
+			// 보낼 것이 남았을 때만 EPOLLOUT
+			struct epoll_event ev;
+			ev.events = EPOLLIN | (bot.out.empty() ? 0 : (uint32_t)EPOLLOUT);
+			ev.data.u32 = events[e].data.u32;
+			if (bot.dead) {
+				epoll_ctl(epoll, EPOLL_CTL_DEL, bot.fd, NULL);
+				bot.waiting = false;
+			}
+			else
+				epoll_ctl(epoll, EPOLL_CTL_MOD, bot.fd, &ev);
+		}
+	}
+	double wall = secondsSince(start);
+
+	int alive = 0;
+	for (size_t i = 0; i < bots.size(); i++) {
+		if (!bots[i].dead)
+			alive++;
+		if (bots[i].fd >= 0)
+			close(bots[i].fd);
+	}
+	close(epoll);
+
+	ServerStats after;
+	bool haveServer = queryStats(host, port, &after);
+	double cpu = haveServer ? after.cpuSeconds - before.cpuSeconds : 0;
+	double util = cpu / wall;
+
+	printf("metric,value\n");
+	printf("matches,%d\n", matches);
+	printf("connections_alive,%d\n", alive);
+	printf("seconds,%.2f\n", wall);
+	printf("matches_completed,%lld\n", totals.matches);
+	printf("turns,%lld\n", totals.turns);
+	printf("errors,%lld\n", totals.errors);
+	printf("turns_per_sec,%.1f\n", totals.turns / wall);
+	printf("shot_game_seconds_mean,%.3f\n", totals.turns > 0 ? totals.gameSeconds / totals.turns : 0.0);
+	printf("turn_ms_p50,%.2f\n", percentile(totals.turnMs, 0.50));
+	printf("turn_ms_p90,%.2f\n", percentile(totals.turnMs, 0.90));
+	printf("turn_ms_p99,%.2f\n", percentile(totals.turnMs, 0.99));
+	printf("turn_ms_max,%.2f\n", percentile(totals.turnMs, 1.0));
+	printf("lag_ms_p50,%.2f\n", percentile(totals.lagMs, 0.50));
+	printf("lag_ms_p99,%.2f\n", percentile(totals.lagMs, 0.99));
+	if (haveServer) {
+		printf("server_threads,%d\n", after.threads);
+		printf("server_cpu_seconds,%.3f\n", cpu);
+		printf("server_cpu_util,%.3f\n", util);
+		printf("matches_per_core,%.0f\n", util > 0 ? matches / util : 0.0);
+		printf("turns_per_core_sec,%.0f\n", cpu > 0 ? totals.turns / cpu : 0.0);
+	}
+	return 0;
+}
@@ -0,0 +1,599 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: gameServer.cpp
+//
+// Desc: Headless game server hosting many matches at once. Every
+//       connection plays one CMatch with the line protocol in match.h.
+//       Matches are sharded over a fixed pool of threads (CWorkerPool):
+//       each thread has its own epoll set and its own listening socket on
+//       the same port (SO_REUSEPORT), so the kernel spreads connections
+//       over the shards and a match is only ever touched by one thread,
+//       without locks. A shard steps only the matches whose shot is still
+//       moving; a table at rest costs nothing until its next shot.
+//       By default shots run at the game's own pace (PHYSICS_HZ steps per
+//       second, the client animates in the meantime). --fast runs them as
+//       fast as possible, FAST_SLICE steps per match at a time so a long
+//       shot does not hold up the others, for throughput tests.
+//       --log writes every match's shots, contacts, turns and scores to one
+//       event log (eventLog.h); each shard thread fills its own ring, so
+//       the shards still never lock each other.
+//       --metrics serves live counters (steps, contacts, turns, open and
+//       moving matches, send queue, allocations, step batch times) as
+//       Prometheus text on http://127.0.0.1:P/metrics (metrics.h). They are
+//       kept whether or not the endpoint is on.
+//       Linux only (epoll). Console program:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. gameServer.cpp match.cpp ../allocHook.cpp ../eventLog.cpp ../metrics.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o gameServer
+//
+//       Usage:
+//         gameServer [--port P] [--threads T] [--level file.lvl] [--fast] [--log file.events] [--metrics P]
+//
+//       The default level is ../levels/default.lvl next to the executable.
+//
+//       Ctrl+C stops it and prints CSV: shard,metric,value
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "match.h"
+#include "allocHook.h"
+#include "eventLog.h"
+#include "metrics.h"
+#include "workerPool.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <errno.h>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#define DEFAULT_PORT 7777
+#define MAX_EVENTS 256
+#define FAST_SLICE 60			// --fast에서 경기마다 한 번에 진행하는 스텝
+#define MAX_LINE 256			// 줄바꿈 없이 이보다 길게 오면 연결을 끊음
+#define IDLE_WAIT_MS 100		// 움직이는 경기가 없을 때 종료 플래그를 확인하는 간격
+
+typedef std::chrono::steady_clock Clock;
+static const Clock::duration TICK = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / PHYSICS_HZ));
+
+static std::atomic<bool> g_quit(false);
+// stats 명령용, 모든 샤드의 합
+static std::atomic<int> g_nextMatchId(1);
+static std::atomic<int> g_openMatches(0);
+static std::atomic<long long> g_turns(0);
+static int g_threads = 1;
+static CEventLog g_eventLog;		// --log, 샤드마다 링 하나
+
+// 모든 샤드가 같이 쓰는 지표, main()에서 등록
+struct ServerMetrics {
+	CCounter*	connections;
+	CCounter*	allocations;		// operator new
+	CGauge*		openMatches;
+	CGauge*		movingMatches;		// 샷이 진행 중이라 스텝을 기다리는 경기
+	CGauge*		sendQueueBytes;		// 보내지 못하고 쌓인 응답
+	CHistogram*	stepBatchMs;		// stepMoving() 한 번
+};
+static CMetrics g_metrics;
+static GameMetrics g_gameMetrics;
+static ServerMetrics g_serverMetrics;
+static CCounter* g_pAllocations = NULL;
+
+// 할당 수를 지표로 (allocHook.cpp), 샤드마다 다른 칸에 더하므로 서로 막지 않음
+static void countAllocation(void)
+{
+	g_pAllocations->add();
+}
+
+static void onSignal(int)
+{
+	g_quit = true;
+}
+
+static double processCpuSeconds(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+static double threadCpuSeconds(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 경기 수천 개는 연결도 수천 개이므로 파일 개수 제한을 최대로 올림
+static void raiseFileLimit(void)
+{
+	struct rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// 샤드: 스레드 하나가 맡는 연결과 경기
+// -----------------------------------------------------------------------------
+
+struct Connection {
+	int				fd;
+	CMatch			match;
+	std::string		in, out;
+	bool			writing;		// EPOLLOUT 등록 여부
+	bool			dead;			// 이번 루프 끝에서 닫음
+	size_t			queued;			// sendQueueBytes에 더해 둔 out 크기
+};
+
+class CShard {
+public:
+	struct Stats {
+		long long	accepted;
+		long long	matches;
+		long long	turns;
+		long long	steps;
+		double		cpuSeconds;
+	};
+
+	CShard(void);
+	~CShard(void);
+
+	bool open(int port);
+	void loop(const CLevelFile& level, bool fast);
+	const Stats& getStats(void) const { return m_stats; }
+
+private:
+	CShard(const CShard&);
+	CShard& operator=(const CShard&);
+
+	void acceptAll(void);
+	void readAll(Connection* pConn);
+	void handleLine(Connection* pConn, const char* pLine);
+	void flush(Connection* pConn);
+	void stepMoving(int steps);
+	void kill(Connection* pConn);
+	void reap(void);
+
+	int				m_epoll;
+	int				m_listen;
+	const CLevelFile* m_pLevel;
+	std::unordered_map<int, std::unique_ptr<Connection> > m_connections;
+	std::vector<Connection*> m_moving;		// 샷이 진행 중인 경기
+	std::vector<Connection*> m_dead;		// 이번 루프에서 끊긴 연결
+	CEventLogListener m_events;			// --log일 때 이 샤드의 경기가 모두 씀
+	Clock::time_point m_nextTick;
+	Stats			m_stats;
+};
+
+CShard::CShard(void)
+{
+	m_epoll = m_listen = -1;
+	m_pLevel = NULL;
+	m_events.attach(&g_eventLog);
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+CShard::~CShard(void)
+{
+	for (auto it = m_connections.begin(); it != m_connections.end(); ++it)
+		close(it->first);
+	if (m_listen >= 0)
+		close(m_listen);
+	if (m_epoll >= 0)
+		close(m_epoll);
+}
+
+bool CShard::open(int port)
+{
+	m_epoll = epoll_create1(0);
+	m_listen = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	if (m_epoll < 0 || m_listen < 0)
+		return false;
+
+	// 샤드마다 같은 포트로 listen, 커널이 새 연결을 나눠 줌
+	int on = 1;
+	setsockopt(m_listen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if (setsockopt(m_listen, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0)
+		return false;
+
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons((unsigned short)port);
+	if (bind(m_listen, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(m_listen, SOMAXCONN) != 0)
+		return false;
+
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;		// NULL이면 listen 소켓
+	return epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listen, &ev) == 0;
+}
+
+void CShard::loop(const CLevelFile& level, bool fast)
+{
+	struct epoll_event events[MAX_EVENTS];
+	m_pLevel = &level;
+	m_nextTick = Clock::now();
+
+	while (!g_quit) {
+		int timeout = IDLE_WAIT_MS;
+		if (!m_moving.empty()) {
+			if (fast)
+				timeout = 0;
+			else {
+				// 다음 틱까지 기다림, 밀리초 단위이므로 올림
+				long long us = std::chrono::duration_cast<std::chrono::microseconds>(m_nextTick - Clock::now()).count();
+				timeout = us > 0 ? (int)((us + 999) / 1000) : 0;
+			}
+		}
+
+		int n = epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
+		for (int i = 0; i < n; i++) {
+			Connection* pConn = (Connection*)events[i].data.ptr;
+			if (pConn == NULL) {
+				acceptAll();
+				continue;
+			}
+			if (events[i].events & (EPOLLERR | EPOLLHUP))
+				kill(pConn);
+			if (!pConn->dead && (events[i].events & EPOLLIN))
+				readAll(pConn);
+			if (!pConn->dead && (events[i].events & EPOLLOUT))
+				flush(pConn);
+		}
+
+		if (!m_moving.empty()) {
+			if (fast)
+				stepMoving(FAST_SLICE);
+			else {
+				// CGame::advance()처럼 늦어진 만큼 따라잡되 MAX_PHYSICS_STEPS까지만
+				Clock::time_point now = Clock::now();
+				int due = 0;
+				while (m_nextTick <= now && due < MAX_PHYSICS_STEPS) {
+					m_nextTick += TICK;
+					due++;
+				}
+				if (m_nextTick <= now)
+					m_nextTick = now + TICK;
+				if (due > 0)
+					stepMoving(due);
+			}
+		}
+		reap();
+	}
+	m_stats.cpuSeconds = threadCpuSeconds();
+}
+
+void CShard::acceptAll(void)
+{
+	for (;;) {
+		int fd = accept4(m_listen, NULL, NULL, SOCK_NONBLOCK);
+		if (fd < 0)
+			return;		// EAGAIN, 또는 다른 샤드가 먼저 가져감
+		int on = 1;
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+		std::unique_ptr<Connection> pConn(new Connection());
+		pConn->fd = fd;
+		pConn->writing = false;
+		pConn->dead = false;
+		pConn->queued = 0;
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.ptr = pConn.get();
+		if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &ev) != 0) {
+			close(fd);
+			continue;
+		}
+		m_connections[fd] = std::move(pConn);
+		m_stats.accepted++;
+		g_serverMetrics.connections->add();
+	}
+}
+
+void CShard::readAll(Connection* pConn)
+{
+	char buf[4096];
+	for (;;) {
+		ssize_t got = recv(pConn->fd, buf, sizeof(buf), 0);
+		if (got > 0) {
+			pConn->in.append(buf, (size_t)got);
+			continue;
+		}
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+			kill(pConn);
+		break;
+	}
+
+	size_t start = 0;
+	for (;;) {
+		size_t end = pConn->in.find('\n', start);
+		if (end == std::string::npos)
+			break;
+		pConn->in[end] = '\0';
+		handleLine(pConn, pConn->in.c_str() + start);
+		start = end + 1;
+	}
+	pConn->in.erase(0, start);
+	if (pConn->in.size() > MAX_LINE)
+		kill(pConn);
+	flush(pConn);
+}
+
+void CShard::handleLine(Connection* pConn, const char* pLine)
+{
+	char word[16];
+	if (sscanf(pLine, "%15s", word) != 1)
+		return;
+
+	CMatch& match = pConn->match;
+	m_events.setMatch(match.getId());
+	if (strcmp(word, "new") == 0) {
+		if (match.isMoving()) {
+			pConn->out += "error busy\n";
+			return;
+		}
+		bool first = !match.isStarted();
+		if (!match.start(g_nextMatchId++, *m_pLevel)) {
+			pConn->out += "error level\n";
+			return;
+		}
+		if (first) {
+			g_openMatches++;
+			g_serverMetrics.openMatches->add(1);
+		}
+		if (g_eventLog.isRunning())
+			match.setListener(&m_events);
+		match.setMetrics(&g_gameMetrics);
+		m_stats.matches++;
+		match.writeState(pConn->out, "match");
+	}
+	else if (strcmp(word, "shot") == 0) {
+		float x, z;
+		int right, up;
+		if (sscanf(pLine, "%*s %f %f %d %d", &x, &z, &right, &up) != 4)
+			pConn->out += "error command\n";
+		else if (!match.isStarted())
+			pConn->out += "error nomatch\n";
+		else if (!match.shoot(x, z, right, up))
+			pConn->out += "error busy\n";
+		else {
+			match.writeAck(pConn->out);
+			if (m_moving.empty())
+				m_nextTick = Clock::now() + TICK;
+			m_moving.push_back(pConn);
+			g_serverMetrics.movingMatches->add(1);
+		}
+	}
+	else if (strcmp(word, "stats") == 0) {
+		char buf[128];
+		snprintf(buf, sizeof(buf), "stats %d %d %lld %.3f\n", g_threads, g_openMatches.load(), g_turns.load(), processCpuSeconds());
+		pConn->out += buf;
+	}
+	else if (strcmp(word, "quit") == 0) {
+		kill(pConn);
+	}
+	else {
+		pConn->out += "error command\n";
+	}
+}
+
+// 보낼 수 있는 만큼 보내고, 남으면 EPOLLOUT을 기다림
+void CShard::flush(Connection* pConn)
+{
+	size_t sent = 0;
+	while (sent < pConn->out.size()) {
+		ssize_t n = send(pConn->fd, pConn->out.data() + sent, pConn->out.size() - sent, MSG_NOSIGNAL);
+		if (n > 0) {
+			sent += (size_t)n;
+			continue;
+		}
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+			kill(pConn);
+		break;
+	}
+	pConn->out.erase(0, sent);
+	if (pConn->out.size() != pConn->queued) {
+		g_serverMetrics.sendQueueBytes->add((double)pConn->out.size() - (double)pConn->queued);
+		pConn->queued = pConn->out.size();
+	}
+
+	bool writing = !pConn->out.empty() && !pConn->dead;
+	if (writing != pConn->writing) {
+		struct epoll_event ev;
+		ev.events = EPOLLIN | (writing ? (uint32_t)EPOLLOUT : 0);
+		ev.data.ptr = pConn;
+		epoll_ctl(m_epoll, EPOLL_CTL_MOD, pConn->fd, &ev);
+		pConn->writing = writing;
+	}
+}
+
+// 움직이는 경기만 진행, 멈춘 경기는 결과를 보내고 목록에서 뺌
+void CShard::stepMoving(int steps)
+{
+	Clock::time_point start = Clock::now();
+	for (size_t i = 0; i < m_moving.size();) {
+		Connection* pConn = m_moving[i];
+		CMatch& match = pConn->match;
+		int before = match.getShotSteps();
+		m_events.setMatch(match.getId());
+		bool stopped = pConn->dead || match.simulate(steps);
+		m_stats.steps += match.getShotSteps() - before;
+		if (!stopped) {
+			i++;
+			continue;
+		}
+		if (!pConn->dead) {
+			match.writeState(pConn->out, "turn");
+			flush(pConn);
+			m_stats.turns++;
+			g_turns++;
+		}
+		m_moving[i] = m_moving.back();
+		m_moving.pop_back();
+		g_serverMetrics.movingMatches->add(-1);
+	}
+	g_serverMetrics.stepBatchMs->observe(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+}
+
+void CShard::kill(Connection* pConn)
+{
+	if (!pConn->dead) {
+		pConn->dead = true;
+		m_dead.push_back(pConn);
+	}
+}
+
+// 끊긴 연결은 루프 끝에서 한꺼번에 닫음, 처리 중인 포인터가 중간에 사라지지 않게
+void CShard::reap(void)
+{
+	for (size_t i = 0; i < m_dead.size(); i++) {
+		Connection* pConn = m_dead[i];
+		for (size_t j = 0; j < m_moving.size(); j++) {
+			if (m_moving[j] == pConn) {
+				m_moving[j] = m_moving.back();
+				m_moving.pop_back();
+				g_serverMetrics.movingMatches->add(-1);
+				break;
+			}
+		}
+		if (pConn->match.isStarted()) {
+			g_openMatches--;
+			g_serverMetrics.openMatches->add(-1);
+		}
+		if (pConn->queued > 0)
+			g_serverMetrics.sendQueueBytes->add(-(double)pConn->queued);
+		close(pConn->fd);		// epoll에서도 빠짐
+		m_connections.erase(pConn->fd);
+	}
+	m_dead.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+	int port = DEFAULT_PORT;
+	int threads = 1;
+	std::string defaultLevel = getToolLevelPath("default.lvl");
+	const char* levelPath = defaultLevel.c_str();
+	bool fast = false;
+	const char* logPath = NULL;
+	int metricsPort = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--port") == 0 && i + 1 < argc)
+			port = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (strcmp(argv[i], "--fast") == 0)
+			fast = true;
+		else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc)
+			logPath = argv[++i];
+		else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+			metricsPort = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--port P] [--threads T] [--level file.lvl] [--fast] [--log file.events] [--metrics P]\n", argv[0]);
+			return 2;
+		}
+	}
+	if (threads < 1)
+		threads = 1;
+	g_threads = threads;
+
+	// 샤드가 돌기 전에 모두 등록, 그 뒤로는 포인터로 더하기만 함
+	static const double batchBounds[] = { 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 25, 50 };
+	ServerMetrics& sm = g_serverMetrics;
+	sm.connections = g_metrics.addCounter("vlego_server_connections_total", "Connections accepted.");
+	sm.allocations = g_metrics.addCounter("vlego_server_allocations_total", "Heap allocations (operator new) of the whole process.");
+	sm.openMatches = g_metrics.addGauge("vlego_server_open_matches", "Connections with a started match.");
+	sm.movingMatches = g_metrics.addGauge("vlego_server_moving_matches", "Matches whose shot is still being stepped.");
+	sm.sendQueueBytes = g_metrics.addGauge("vlego_server_send_queue_bytes", "Replies waiting for a slow client.");
+	sm.stepBatchMs = g_metrics.addHistogram("vlego_server_step_batch_ms", "Time a shard spends stepping its moving matches once.",
+		batchBounds, (int)(sizeof(batchBounds) / sizeof(batchBounds[0])));
+	registerGameMetrics(g_metrics, g_gameMetrics);
+	g_pAllocations = sm.allocations;
+	setAllocHook(countAllocation);		// 등록 전의 할당은 세지 않음
+
+	CLevelFile level;
+	if (!level.open(levelPath)) {
+		fprintf(stderr, "cannot open level %s\n", levelPath);
+		return 1;
+	}
+	// 경기마다 loadLevel()을 하므로 여기서 한 번 확인
+	CMatch probe;
+	if (!probe.start(1, level)) {
+		fprintf(stderr, "unsupported level %s\n", levelPath);
+		return 1;
+	}
+
+	if (logPath != NULL && !g_eventLog.start(logPath)) {
+		fprintf(stderr, "cannot open %s\n", logPath);
+		return 1;
+	}
+	CMetricsServer metricsServer;
+	if (metricsPort > 0 && !metricsServer.start(g_metrics, metricsPort)) {
+		fprintf(stderr, "cannot serve metrics on port %d\n", metricsPort);
+		return 1;
+	}
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+	raiseFileLimit();
+
+	std::vector<CShard> shards(threads);
+	for (int i = 0; i < threads; i++) {
+		if (!shards[i].open(port)) {
+			fprintf(stderr, "cannot listen on port %d: %s\n", port, strerror(errno));
+			return 1;
+		}
+	}
+	fprintf(stderr, "listening on port %d, %d threads%s\n", port, threads, fast ? ", fast" : "");
+	if (metricsServer.isRunning())
+		fprintf(stderr, "metrics on http://127.0.0.1:%d/metrics\n", metricsPort);
+
+	// 샤드 루프는 g_quit까지 돌아가므로 run() 한 번이 서버 전체
+	CWorkerPool pool;
+	pool.start(threads);
+	pool.run([&](int thread) { shards[thread].loop(level, fast); });
+	pool.stop();
+	g_eventLog.stop();
+	metricsServer.stop();
+
+	printf("shard,metric,value\n");
+	for (int i = 0; i < threads; i++) {
+		const CShard::Stats& s = shards[i].getStats();
+		printf("%d,connections,%lld\n", i, s.accepted);
+		printf("%d,matches,%lld\n", i, s.matches);
+		printf("%d,turns,%lld\n", i, s.turns);
+		printf("%d,steps,%lld\n", i, s.steps);
+		printf("%d,cpu_seconds,%.3f\n", i, s.cpuSeconds);
+	}
+	if (logPath != NULL) {
+		CEventLog::Stats e = g_eventLog.getStats();
+		printf("all,events_logged,%lld\n", e.logged);
+		printf("all,events_dropped,%lld\n", e.dropped);
+		printf("all,events_written,%lld\n", e.written);
+	}
+	return 0;
+}
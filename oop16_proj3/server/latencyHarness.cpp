@@ -0,0 +1,496 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: latencyHarness.cpp
+//
+// Desc: Plays predicted matches (CPredictedMatch) against a running
+//       gameServer through a proxy on loopback that holds every byte back
+//       by --delay ms (plus up to --jitter ms, order kept) in each
+//       direction. Clients run their tables in real time at PHYSICS_HZ
+//       the way the window would. --noise makes the clients guess the
+//       target a little wrong, so every ack forces a rollback. Reports
+//       as CSV:
+//         ack_ms_p50, p99       strike to ack, how long the cue ball would
+//                               sit still without prediction
+//         turn_wait_ms_p50, p99 local shot settled to server turn arriving
+//         rollbacks, rollback_steps_mean, rollback_us_mean, rollback_us_max
+//         corrections, worst_correction   settled tables that still
+//                               differed from the server and were replaced
+//       Linux only (epoll). Start gameServer with the same level first:
+//
+//         g++ -O2 -std=c++14 -pthread -I.. latencyHarness.cpp predictedMatch.cpp match.cpp ../game.cpp ../physics.cpp ../capsule.cpp ../contactSolver.cpp ../workerPool.cpp ../brickField.cpp ../levelFormat.cpp ../snapshotRing.cpp -o latencyHarness
+//
+//       Usage:
+//         latencyHarness [--server-port P] [--proxy-port P] [--delay ms] [--jitter ms]
+//                        [--matches N] [--shots K] [--noise d] [--level file.lvl] [--seed S]
+//
+//       The default level is ../levels/default.lvl next to the executable.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "predictedMatch.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <errno.h>
+#include <fcntl.h>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define MAX_EVENTS 64
+#define MAX_WAIT_SECONDS 120	// 이 안에 끝나지 않으면 포기
+
+typedef std::chrono::steady_clock Clock;
+
+static double msSince(Clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+static float frand(void) { return rand() / (float)RAND_MAX; }
+
+static int listenOn(int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	int on = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons((unsigned short)port);
+	if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+// 막히는 방식으로 연결한 뒤 논블로킹으로 바꿈
+static int connectLoopback(int port)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons((unsigned short)port);
+	if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+		if (fd >= 0)
+			close(fd);
+		return -1;
+	}
+	int on = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+// -----------------------------------------------------------------------------
+// 지연 프록시: 받은 바이트를 정해진 시각까지 잡아 두었다가 순서대로 넘김
+// -----------------------------------------------------------------------------
+
+class CDelayProxy {
+public:
+	CDelayProxy(int delayMs, int jitterMs)
+		: m_delayMs(delayMs), m_jitterMs(jitterMs), m_quit(false), m_listen(-1), m_serverPort(0), m_epoll(-1), m_random(1) {}
+	~CDelayProxy(void) { stop(); }
+
+	bool start(int proxyPort, int serverPort);
+	void stop(void);
+
+private:
+	struct Chunk {
+		Clock::time_point	due;
+		std::string			bytes;
+	};
+	// 한 방향, from에서 읽어 to로 보냄
+	struct Pipe {
+		int					from, to;
+		std::deque<Chunk>	queue;
+		Clock::time_point	lastDue;	// 지터가 있어도 순서를 지키도록
+	};
+
+	void run(void);
+	void pump(Pipe& pipe);
+	void deliver(Pipe& pipe, Clock::time_point now);
+
+	int							m_delayMs, m_jitterMs;
+	std::atomic<bool>			m_quit;
+	int							m_listen;
+	int							m_serverPort;
+	int							m_epoll;
+	std::minstd_rand			m_random;		// 클라이언트 쪽 rand()와 섞이지 않게 따로
+	std::vector<std::unique_ptr<Pipe> > m_pipes;
+	std::thread					m_thread;
+};
+
+bool CDelayProxy::start(int proxyPort, int serverPort)
+{
+	m_listen = listenOn(proxyPort);
+	m_serverPort = serverPort;
+	m_epoll = epoll_create1(0);
+	if (m_listen < 0 || m_epoll < 0)
+		return false;
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.ptr = NULL;
+	epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listen, &ev);
+	m_thread = std::thread(&CDelayProxy::run, this);
+	return true;
+}
+
+void CDelayProxy::stop(void)
+{
+	m_quit = true;
+	if (m_thread.joinable())
+		m_thread.join();
+	for (size_t i = 0; i < m_pipes.size(); i++)
+		close(m_pipes[i]->from);		// 두 방향이 fd를 하나씩 나눠 가짐
+	m_pipes.clear();
+	if (m_listen >= 0)
+		close(m_listen);
+	if (m_epoll >= 0)
+		close(m_epoll);
+	m_listen = m_epoll = -1;
+}
+
+void CDelayProxy::run(void)
+{
+	struct epoll_event events[MAX_EVENTS];
+	while (!m_quit) {
+		// 가장 먼저 넘길 조각까지만 기다림
+		Clock::time_point now = Clock::now();
+		int timeout = 10;
+		for (size_t i = 0; i < m_pipes.size(); i++) {
+			if (m_pipes[i]->queue.empty())
+				continue;
+			long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(m_pipes[i]->queue.front().due - now).count();
+			timeout = std::max(0, std::min(timeout, (int)ms));
+		}
+
+		int n = epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
+		for (int e = 0; e < n; e++) {
+			Pipe* pPipe = (Pipe*)events[e].data.ptr;
+			if (pPipe != NULL) {
+				pump(*pPipe);
+				continue;
+			}
+			int client;
+			while ((client = accept4(m_listen, NULL, NULL, SOCK_NONBLOCK)) >= 0) {
+				int server = connectLoopback(m_serverPort);
+				if (server < 0) {
+					close(client);
+					continue;
+				}
+				int on = 1;
+				setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+				for (int k = 0; k < 2; k++) {
+					std::unique_ptr<Pipe> pipe(new Pipe());
+					pipe->from = k == 0 ? client : server;
+					pipe->to = k == 0 ? server : client;
+					pipe->lastDue = Clock::now();
+					struct epoll_event ev;
+					ev.events = EPOLLIN;
+					ev.data.ptr = pipe.get();
+					epoll_ctl(m_epoll, EPOLL_CTL_ADD, pipe->from, &ev);
+					m_pipes.push_back(std::move(pipe));
+				}
+			}
+		}
+
+		now = Clock::now();
+		for (size_t i = 0; i < m_pipes.size(); i++)
+			deliver(*m_pipes[i], now);
+	}
+}
+
+void CDelayProxy::pump(Pipe& pipe)
+{
+	char buf[4096];
+	ssize_t got;
+	while ((got = recv(pipe.from, buf, sizeof(buf), 0)) > 0) {
+		int jitter = m_jitterMs > 0 ? (int)(m_random() % (m_jitterMs + 1)) : 0;
+		Clock::time_point due = Clock::now() + std::chrono::milliseconds(m_delayMs + jitter);
+		if (due < pipe.lastDue)
+			due = pipe.lastDue;
+		pipe.lastDue = due;
+		Chunk chunk = { due, std::string(buf, (size_t)got) };
+		pipe.queue.push_back(chunk);
+	}
+	if (got == 0)
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, pipe.from, NULL);		// 닫힘, 더 읽을 것 없음
+}
+
+void CDelayProxy::deliver(Pipe& pipe, Clock::time_point now)
+{
+	while (!pipe.queue.empty() && pipe.queue.front().due <= now) {
+		std::string& bytes = pipe.queue.front().bytes;
+		ssize_t n = send(pipe.to, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+		if (n <= 0)
+			return;		// 다음 루프에서 다시
+		bytes.erase(0, (size_t)n);
+		if (!bytes.empty())
+			return;
+		pipe.queue.pop_front();
+	}
+}
+
+// -----------------------------------------------------------------------------
+// 예측하는 클라이언트
+// -----------------------------------------------------------------------------
+
+struct Client {
+	int					fd;
+	CPredictedMatch		match;
+	std::string			in, out;
+	bool				started;
+	bool				done;
+	int					shots;
+	Clock::time_point	struckAt;
+	Clock::time_point	settledAt;		// 로컬 샷이 멈춘 때
+	bool				acked;
+	bool				localDone;
+};
+
+struct Samples {
+	std::vector<double>	ackMs;
+	std::vector<double>	turnWaitMs;
+};
+
+// replayHarness의 generateShot()처럼 다른 공 하나를 향해
+static void shoot(Client& client)
+{
+	const CGame& game = client.match.getMatch().getGame();
+	const BallBody& white = game.getBall(game.getCurrentBall());
+	int other;
+	do {
+		other = rand() % game.getBallCount();
+	} while (other == game.getCurrentBall());
+	const BallBody& aimAt = game.getBall(other);
+
+	float dx = aimAt.x - white.x, dz = aimAt.z - white.z;
+	float len = sqrtf(dx * dx + dz * dz);
+	float power = 0.5f + 3.5f * frand();
+	float spread = 0.15f * (frand() - 0.5f);
+	float tx = white.x + (dx / len + spread * -dz / len) * power;
+	float tz = white.z + (dz / len + spread * dx / len) * power;
+	if (client.match.shoot(tx, tz, rand() % 7 - 3, rand() % 7 - 3, client.out)) {
+		client.shots++;
+		client.struckAt = Clock::now();
+		client.acked = false;
+		client.localDone = false;
+	}
+}
+
+static void flush(Client& client)
+{
+	while (!client.out.empty()) {
+		ssize_t n = send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+		if (n <= 0)
+			return;
+		client.out.erase(0, (size_t)n);
+	}
+}
+
+static void handleLine(Client& client, const char* pLine, const CLevelFile& level, Samples& samples)
+{
+	if (strncmp(pLine, "match ", 6) == 0) {
+		client.started = client.match.start(level, pLine);
+		client.done = !client.started;
+		return;
+	}
+	if (strncmp(pLine, "ack ", 4) == 0 && !client.acked) {
+		client.acked = true;
+		samples.ackMs.push_back(msSince(client.struckAt));
+	}
+	else if (strncmp(pLine, "turn ", 5) == 0 && client.localDone) {
+		samples.turnWaitMs.push_back(msSince(client.settledAt));
+	}
+	if (!client.match.onServerLine(pLine))
+		client.done = true;		// error 등
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+	if (v.empty())
+		return 0;
+	std::sort(v.begin(), v.end());
+	return v[(size_t)(p * (v.size() - 1))];
+}
+
+int main(int argc, char* argv[])
+{
+	int serverPort = 7777;
+	int proxyPort = 7778;
+	int delayMs = 50;
+	int jitterMs = 0;
+	int matches = 8;
+	int maxShots = 5;
+	float noise = 0;
+	std::string defaultLevel = getToolLevelPath("default.lvl");
+	const char* levelPath = defaultLevel.c_str();
+	unsigned int seed = 1;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--server-port") == 0 && i + 1 < argc)
+			serverPort = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--proxy-port") == 0 && i + 1 < argc)
+			proxyPort = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc)
+			delayMs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc)
+			jitterMs = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc)
+			matches = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--shots") == 0 && i + 1 < argc)
+			maxShots = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc)
+			noise = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc)
+			levelPath = argv[++i];
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = (unsigned int)atoi(argv[++i]);
+		else {
+			fprintf(stderr, "usage: %s [--server-port P] [--proxy-port P] [--delay ms] [--jitter ms] "
+				"[--matches N] [--shots K] [--noise d] [--level file.lvl] [--seed S]\n", argv[0]);
+			return 2;
+		}
+	}
+	srand(seed);
+
+	CLevelFile level;
+	if (!level.open(levelPath)) {
+		fprintf(stderr, "cannot open level %s\n", levelPath);
+		return 1;
+	}
+
+	CDelayProxy proxy(delayMs, jitterMs);
+	if (!proxy.start(proxyPort, serverPort)) {
+		fprintf(stderr, "cannot listen on port %d\n", proxyPort);
+		return 1;
+	}
+
+	int epoll = epoll_create1(0);
+	std::vector<Client> clients(matches);
+	for (int i = 0; i < matches; i++) {
+		Client& c = clients[i];
+		c.fd = connectLoopback(proxyPort);
+		c.started = c.acked = c.localDone = false;
+		c.done = c.fd < 0;
+		c.shots = 0;
+		c.match.setInputNoise(noise);
+		if (c.done)
+			continue;
+		c.out = "new\n";
+		flush(c);
+		struct epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u32 = (uint32_t)i;
+		epoll_ctl(epoll, EPOLL_CTL_ADD, c.fd, &ev);
+	}
+
+	// 창의 프레임 대신 PHYSICS_HZ 틱마다 모든 테이블을 한 스텝씩
+	const Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / PHYSICS_HZ));
+	Clock::time_point start = Clock::now();
+	Clock::time_point nextTick = start + tick;
+	Samples samples;
+	struct epoll_event events[MAX_EVENTS];
+	char buf[4096];
+
+	for (;;) {
+		bool all = true;
+		for (size_t i = 0; i < clients.size() && all; i++)
+			all = clients[i].done;
+		if (all || msSince(start) > MAX_WAIT_SECONDS * 1000.0)
+			break;
+
+		long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(nextTick - Clock::now()).count();
+		int n = epoll_wait(epoll, events, MAX_EVENTS, ms > 0 ? (int)ms : 0);
+		for (int e = 0; e < n; e++) {
+			Client& c = clients[events[e].data.u32];
+			ssize_t got;
+			while ((got = recv(c.fd, buf, sizeof(buf), 0)) > 0)
+				c.in.append(buf, (size_t)got);
+			if (got == 0)
+				c.done = true;
+			size_t lineStart = 0, end;
+			while ((end = c.in.find('\n', lineStart)) != std::string::npos) {
+				c.in[end] = '\0';
+				handleLine(c, c.in.c_str() + lineStart, level, samples);
+				lineStart = end + 1;
+			}
+			c.in.erase(0, lineStart);
+		}
+
+		while (Clock::now() >= nextTick) {
+			nextTick += tick;
+			for (size_t i = 0; i < clients.size(); i++) {
+				Client& c = clients[i];
+				if (c.done || !c.started)
+					continue;
+				c.match.step(1);
+				if (c.shots > 0 && !c.localDone && !c.match.getMatch().isMoving()) {
+					c.localDone = true;
+					c.settledAt = Clock::now();
+				}
+				if (c.match.isSettled()) {
+					if (c.shots >= maxShots || c.match.getMatch().isOver())
+						c.done = true;
+					else
+						shoot(c);
+				}
+				flush(c);
+			}
+		}
+	}
+	proxy.stop();
+
+	long long shots = 0, rollbacks = 0, steps = 0, corrections = 0;
+	double rollbackSeconds = 0, worstRollback = 0;
+	float worstCorrection = 0;
+	for (size_t i = 0; i < clients.size(); i++) {
+		const CPredictedMatch::Stats& s = clients[i].match.getStats();
+		shots += s.shots;
+		rollbacks += s.rollbacks;
+		steps += s.resimulatedSteps;
+		rollbackSeconds += s.rollbackSeconds;
+		worstRollback = std::max(worstRollback, s.worstRollbackSeconds);
+		corrections += s.corrections;
+		worstCorrection = std::max(worstCorrection, s.worstCorrection);
+		if (clients[i].fd >= 0)
+			close(clients[i].fd);
+	}
+	close(epoll);
+
+	printf("metric,value\n");
+	printf("delay_ms,%d\n", delayMs);
+	printf("jitter_ms,%d\n", jitterMs);
+	printf("matches,%d\n", matches);
+	printf("shots,%lld\n", shots);
+	printf("ack_ms_p50,%.2f\n", percentile(samples.ackMs, 0.50));
+	printf("ack_ms_p99,%.2f\n", percentile(samples.ackMs, 0.99));
+	printf("turn_wait_ms_p50,%.2f\n", percentile(samples.turnWaitMs, 0.50));
+	printf("turn_wait_ms_p99,%.2f\n", percentile(samples.turnWaitMs, 0.99));
+	printf("rollbacks,%lld\n", rollbacks);
+	printf("rollback_steps_mean,%.1f\n", rollbacks > 0 ? (double)steps / rollbacks : 0.0);
+	printf("rollback_us_mean,%.1f\n", rollbacks > 0 ? rollbackSeconds * 1e6 / rollbacks : 0.0);
+	printf("rollback_us_max,%.1f\n", worstRollback * 1e6);
+	printf("corrections,%lld\n", corrections);
+	printf("worst_correction,%.5f\n", worstCorrection);
+	return 0;
+}
@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: match.cpp
+//
+// Desc: CGame behind the server's line protocol.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "match.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#define CAROM_MAX_SCORE 100		// 4구는 끝이 없으므로 점수가 0..100을 벗어나면 끝냄
+
+CMatch::CMatch(void)
+{
+	m_id = 0;
+	m_moving = false;
+	m_shotSteps = 0;
+	m_shotX = m_shotZ = 0;
+	m_shotRight = m_shotUp = 0;
+}
+
+bool CMatch::start(int id, const CLevelFile& level)
+{
+	m_game = CGame();
+	if (!m_game.loadLevel(level))
+		return false;
+	m_game.setStick(7, 0.1f);		// Setup()의 당구채
+	m_id = id;
+	m_moving = false;
+	m_shotSteps = 0;
+	return true;
+}
+
+bool CMatch::shoot(float targetX, float targetZ, int tipRight, int tipUp)
+{
+	if (m_id == 0 || m_moving || m_game.isAnimating() || isOver())
+		return false;
+
+	m_game.moveTip(tipRight - (int)floorf(m_game.getTipSide() / TIP_STEP + 0.5f),
+		tipUp - (int)floorf(m_game.getTipHeight() / TIP_STEP + 0.5f));
+	m_game.aimAt(targetX, targetZ);
+	if (!m_game.strike())
+		return false;
+	m_moving = true;
+	m_shotSteps = 0;
+	m_shotX = targetX;
+	m_shotZ = targetZ;
+	// 당점은 원 밖이면 옮겨지지 않으므로 실제로 놓인 자리
+	m_shotRight = (int)floorf(m_game.getTipSide() / TIP_STEP + 0.5f);
+	m_shotUp = (int)floorf(m_game.getTipHeight() / TIP_STEP + 0.5f);
+	return true;
+}
+
+bool CMatch::simulate(int maxSteps)
+{
+	for (int i = 0; i < maxSteps && m_game.isAnimating(); i++) {
+		m_game.step(PHYSICS_STEP);
+		m_shotSteps++;
+	}
+	m_moving = m_game.isAnimating();
+	return !m_moving;
+}
+
+bool CMatch::isOver(void) const
+{
+	if (m_game.getRules().mode == MODE_POOL)
+		return m_game.isGameOver();
+	for (int p = 1; p <= 2; p++) {
+		if (m_game.getScore(p) <= 0 || m_game.getScore(p) >= CAROM_MAX_SCORE)
+			return true;
+	}
+	return false;
+}
+
+void CMatch::writeState(std::string& out, const char* pTag) const
+{
+	char buf[96];
+	snprintf(buf, sizeof(buf), "%s %d %d %d %d %d %d %d %d", pTag, m_id, m_game.getCurrentPlayer(),
+		m_game.getScore(1), m_game.getScore(2), m_game.getCurrentBall(), m_shotSteps, isOver() ? 1 : 0,
+		m_game.getBallCount());
+	out += buf;
+	for (int i = 0; i < m_game.getBallCount(); i++) {
+		const BallBody& b = m_game.getBall(i);
+		snprintf(buf, sizeof(buf), " %d %a %a", m_game.getBallId(i), b.x, b.z);
+		out += buf;
+	}
+	out += '\n';
+}
+
+void CMatch::writeAck(std::string& out) const
+{
+	char buf[96];
+	snprintf(buf, sizeof(buf), "ack %a %a %d %d\n", m_shotX, m_shotZ, m_shotRight, m_shotUp);
+	out += buf;
+}
+
+bool CMatch::readState(const char* pLine, State& state)
+{
+	int over, balls, n = 0;
+	if (sscanf(pLine, "%*s %d %d %d %d %d %d %d %d%n", &state.id, &state.player, &state.score1, &state.score2,
+		&state.current, &state.steps, &over, &balls, &n) != 8 || balls < 0)
+		return false;
+	state.over = over != 0;
+	state.ballIds.resize(balls);
+	state.x.resize(balls);
+	state.z.resize(balls);
+	pLine += n;
+	for (int i = 0; i < balls; i++) {
+		if (sscanf(pLine, " %d %f %f%n", &state.ballIds[i], &state.x[i], &state.z[i], &n) != 3)
+			return false;
+		pLine += n;
+	}
+	return true;
+}
+
+bool CMatch::matchesState(const State& state) const
+{
+	if (m_moving || state.player != m_game.getCurrentPlayer() || state.current != m_game.getCurrentBall() ||
+		state.score1 != m_game.getScore(1) || state.score2 != m_game.getScore(2) ||
+		(int)state.ballIds.size() != m_game.getBallCount())
+		return false;
+	for (int i = 0; i < m_game.getBallCount(); i++) {
+		const BallBody& b = m_game.getBall(i);
+		if (state.ballIds[i] != m_game.getBallId(i) || state.x[i] != b.x || state.z[i] != b.z)
+			return false;
+	}
+	return true;
+}
+
+void CMatch::adoptState(const State& state)
+{
+	m_game.saveState(m_scratch);
+	int count = (int)state.ballIds.size();
+	BallBody zero;
+	memset(&zero, 0, sizeof(zero));
+	m_scratch.balls.assign(count, zero);
+	m_scratch.ballIds = state.ballIds;
+	m_scratch.isHit.assign(count, 0);
+	m_scratch.contacts.clear();
+	for (int i = 0; i < count; i++) {
+		BallBody& b = m_scratch.balls[i];
+		b.x = b.prevX = state.x[i];
+		b.z = b.prevZ = state.z[i];
+		b.y = BALL_RADIUS;
+	}
+	m_scratch.stickMoving = false;
+	m_scratch.newTurn = false;
+	m_scratch.score1 = state.score1;
+	m_scratch.score2 = state.score2;
+	m_scratch.currentPlayer = state.player;
+	m_scratch.currentBall = state.current;
+	m_game.restoreState(m_scratch);
+	m_moving = false;
+	m_shotSteps = state.steps;
+}
+
+void CMatch::saveState(Snapshot& s) const
+{
+	m_game.saveState(s.game);
+	s.moving = m_moving;
+	s.shotSteps = m_shotSteps;
+}
+
+void CMatch::restoreState(const Snapshot& s)
+{
+	m_game.restoreState(s.game);
+	m_moving = s.moving;
+	m_shotSteps = s.shotSteps;
+}
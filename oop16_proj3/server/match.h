@@ -0,0 +1,104 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: match.h
+//
+// Desc: One match hosted by the game server: a CGame loaded from the
+//       server's level plus the text protocol around it. The game is the
+//       same hot-seat game as the window (both players on one client),
+//       driven through aimAt()/moveTip()/strike() instead of the mouse.
+//
+//       Protocol, one command per line in each direction:
+//
+//         client                             server
+//         new                                match <state>
+//         shot <x> <z> <tipRight> <tipUp>    ack <x> <z> <tipRight> <tipUp>   (at once)
+//                                            turn <state>   (when the shot stops)
+//         stats                              stats <threads> <matches> <turns> <cpuSeconds>
+//         quit                               (closes the connection)
+//         anything else, or shot while the balls move:  error <reason>
+//
+//       shot puts the blue target ball at (x, z), moves the cue tip to
+//       (tipRight, tipUp) arrow key presses from the center and strikes.
+//       ack echoes the input the server actually used, so a client that
+//       predicts the shot (CPredictedMatch) can tell whether its guess was
+//       right. Positions are written with %a so they read back bit exact.
+//       <state> is
+//
+//         <matchId> <player> <score1> <score2> <current> <steps> <over> <balls> {<id> <x> <z>}
+//
+//       current is the index in the ball list of the ball to shoot next,
+//       steps the physics steps the last shot took (0 for a new match) and
+//       over 1 when the game has ended.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __matchH__
+#define __matchH__
+
+#include "game.h"
+#include <string>
+#include <vector>
+
+class CMatch {
+public:
+	// 되감기용 전체 상태
+	struct Snapshot {
+		CGame::Snapshot	game;
+		bool			moving;
+		int				shotSteps;
+	};
+
+	// "match", "turn" 줄을 읽은 결과
+	struct State {
+		int		id, player, score1, score2, current, steps;
+		bool	over;
+		std::vector<int>	ballIds;
+		std::vector<float>	x, z;
+	};
+
+	CMatch(void);
+
+	// 새 경기, 레벨을 읽지 못하면 false
+	bool start(int id, const CLevelFile& level);
+	bool isStarted(void) const { return m_id != 0; }
+	// 공이 모두 멈춰 있을 때만 받음
+	bool shoot(float targetX, float targetZ, int tipRight, int tipUp);
+	// 샷을 최대 maxSteps 스텝 진행, 모두 멈췄으면 true
+	bool simulate(int maxSteps);
+	bool isMoving(void) const { return m_moving; }
+	bool isOver(void) const;
+
+	// "<tag> <state>\n"을 out 뒤에 붙임
+	void writeState(std::string& out, const char* pTag) const;
+	// 마지막 shoot()이 실제로 쓴 입력을 "ack ..." 줄로 붙임
+	void writeAck(std::string& out) const;
+	// 태그 다음부터 읽음, 형식이 틀리면 false
+	static bool readState(const char* pLine, State& state);
+	// 멈춰 있는 테이블이 state와 비트까지 같은지
+	bool matchesState(const State& state) const;
+	// 서버가 보낸 결과로 맞춤, 공은 멈춘 채로 놓임
+	void adoptState(const State& state);
+
+	void saveState(Snapshot& snapshot) const;
+	void restoreState(const Snapshot& snapshot);
+
+	// 충돌, 샷, 턴을 알려 줌 (사건 기록), start()는 리스너를 비우므로 그 뒤에
+	void setListener(CGameListener* pListener) { m_game.setListener(pListener); }
+	// 스텝, 샷, 턴 지표 (metrics.h), 리스너처럼 start() 뒤에
+	void setMetrics(const GameMetrics* pMetrics) { m_game.setMetrics(pMetrics); }
+
+	int getId(void) const { return m_id; }
+	int getShotSteps(void) const { return m_shotSteps; }
+	const CGame& getGame(void) const { return m_game; }
+
+private:
+	CGame	m_game;
+	int		m_id;			// 0이면 아직 시작 안 함
+	bool	m_moving;		// 샷이 끝나지 않음
+	int		m_shotSteps;	// 마지막 샷에 걸린 스텝
+	float	m_shotX, m_shotZ;	// 마지막 샷의 입력
+	int		m_shotRight, m_shotUp;
+	CGame::Snapshot m_scratch;	// adoptState()에서 다시 씀
+};
+
+#endif // __matchH__
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: predictedMatch.cpp
+//
+// Desc: Local prediction, rollback on a different ack, correction on a
+//       different turn result.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "predictedMatch.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef std::chrono::steady_clock Clock;
+
+CPredictedMatch::CPredictedMatch(void)
+{
+	m_waitingAck = m_waitingTurn = m_turnArrived = false;
+	m_predictedSteps = 0;
+	m_inputNoise = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_guessAck.reserve(96);
+}
+
+bool CPredictedMatch::start(const CLevelFile& level, const char* pMatchLine)
+{
+	CMatch::State state;
+	if (!CMatch::readState(pMatchLine, state) || !m_match.start(state.id, level))
+		return false;
+	// 같은 레벨이면 처음 배치는 같음, 다르면 서버 쪽을 따름
+	if (!m_match.matchesState(state))
+		m_match.adoptState(state);
+	m_waitingAck = m_waitingTurn = m_turnArrived = false;
+	return true;
+}
+
+bool CPredictedMatch::shoot(float targetX, float targetZ, int tipRight, int tipUp, std::string& out)
+{
+	if (!isSettled())
+		return false;
+
+	m_match.saveState(m_beforeShot);
+	float guessX = targetX, guessZ = targetZ;
+	if (m_inputNoise > 0) {
+		guessX += m_inputNoise * (2 * (rand() / (float)RAND_MAX) - 1);
+		guessZ += m_inputNoise * (2 * (rand() / (float)RAND_MAX) - 1);
+	}
+	if (!m_match.shoot(guessX, guessZ, tipRight, tipUp))
+		return false;
+	m_guessAck.clear();
+	m_match.writeAck(m_guessAck);
+
+	// %a로 보내므로 서버는 같은 float를 읽음
+	char buf[96];
+	snprintf(buf, sizeof(buf), "shot %a %a %d %d\n", targetX, targetZ, tipRight, tipUp);
+	out += buf;
+
+	m_waitingAck = m_waitingTurn = true;
+	m_turnArrived = false;
+	m_predictedSteps = 0;
+	m_stats.shots++;
+	return true;
+}
+
+void CPredictedMatch::step(int steps)
+{
+	if (m_match.isMoving()) {
+		m_match.simulate(steps);
+		m_predictedSteps += steps;
+	}
+	if (m_turnArrived && !m_match.isMoving())
+		reconcile();
+}
+
+bool CPredictedMatch::onServerLine(const char* pLine)
+{
+	if (strncmp(pLine, "ack ", 4) == 0) {
+		m_waitingAck = false;
+		// writeAck()은 줄바꿈까지 씀
+		size_t len = strlen(pLine);
+		if (m_guessAck.compare(0, m_guessAck.size() - 1, pLine, len) != 0) {
+			float x, z;
+			int right, up;
+			if (sscanf(pLine, "ack %f %f %d %d", &x, &z, &right, &up) == 4)
+				rollback(x, z, right, up);
+		}
+		return true;
+	}
+	if (strncmp(pLine, "turn ", 5) == 0) {
+		if (!CMatch::readState(pLine, m_serverTurn))
+			return false;
+		m_turnArrived = true;
+		if (!m_match.isMoving())
+			reconcile();
+		return true;
+	}
+	return false;
+}
+
+// 샷 직전으로 돌아가 서버가 쓴 입력으로 지금까지의 스텝을 한번에 다시 진행
+void CPredictedMatch::rollback(float targetX, float targetZ, int tipRight, int tipUp)
+{
+	Clock::time_point t0 = Clock::now();
+	m_match.restoreState(m_beforeShot);
+	if (m_match.shoot(targetX, targetZ, tipRight, tipUp))
+		m_match.simulate(m_predictedSteps);
+	double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+	m_stats.rollbacks++;
+	m_stats.resimulatedSteps += m_predictedSteps;
+	m_stats.rollbackSeconds += seconds;
+	if (seconds > m_stats.worstRollbackSeconds)
+		m_stats.worstRollbackSeconds = seconds;
+}
+
+// 로컬 샷이 끝난 뒤 서버 결과와 비교, 다르면 서버 쪽으로 맞춤
+void CPredictedMatch::reconcile(void)
+{
+	m_turnArrived = false;
+	m_waitingTurn = false;
+	if (m_match.matchesState(m_serverTurn))
+		return;
+
+	const CGame& game = m_match.getGame();
+	float worst = 0;
+	for (size_t i = 0; i < m_serverTurn.ballIds.size(); i++) {
+		for (int j = 0; j < game.getBallCount(); j++) {
+			if (game.getBallId(j) != m_serverTurn.ballIds[i])
+				continue;
+			float dx = game.getBall(j).x - m_serverTurn.x[i];
+			float dz = game.getBall(j).z - m_serverTurn.z[i];
+			float d = sqrtf(dx * dx + dz * dz);
+			if (d > worst)
+				worst = d;
+		}
+	}
+	m_match.adoptState(m_serverTurn);
+	m_stats.corrections++;
+	if (worst > m_stats.worstCorrection)
+		m_stats.worstCorrection = worst;
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: predictedMatch.h
+//
+// Desc: Client side of a networked match with prediction. Without it the
+//       shooter sees nothing move for a round trip after VK_SPACE, until
+//       the authoritative server answers. shoot() saves the table, sends
+//       the shot and starts running it locally right away with the same
+//       CMatch code the server runs. When the server's ack comes back with
+//       the input it really used and that differs from the guess, the
+//       table is rolled back to the save and the shot re-run with the
+//       server's input up to the step the client had reached, all inside
+//       one call. When the server's turn arrives, the settled table is
+//       compared bit for bit, and any difference left (a desync) is
+//       corrected by taking the server's table.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __predictedMatchH__
+#define __predictedMatchH__
+
+#include "match.h"
+
+class CPredictedMatch {
+public:
+	struct Stats {
+		long long	shots;
+		long long	rollbacks;			// ack의 입력이 예측과 달라 다시 푼 횟수
+		long long	resimulatedSteps;	// 되감은 뒤 다시 진행한 스텝 합
+		double		rollbackSeconds;	// 되감고 다시 진행하는 데 걸린 시간 합
+		double		worstRollbackSeconds;
+		long long	corrections;		// 멈춘 결과가 서버와 달라 서버 상태로 맞춘 횟수
+		float		worstCorrection;	// 그때 공이 옮겨진 최대 거리
+	};
+
+	CPredictedMatch(void);
+
+	// 서버의 "match" 줄을 받아 같은 레벨로 새 경기를 시작
+	bool start(const CLevelFile& level, const char* pMatchLine);
+	// 로컬 입력, 서버로 보낼 "shot" 줄을 out에 붙이고 곧바로 예측을 시작
+	bool shoot(float targetX, float targetZ, int tipRight, int tipUp, std::string& out);
+	// 실시간으로 진행 (창에서는 프레임마다 CGame::advance()가 하는 일)
+	void step(int steps);
+	// 서버에서 온 "ack", "turn" 줄, 다른 줄이면 false
+	bool onServerLine(const char* pLine);
+	// 로컬 샷이 끝났고 서버 결과와도 맞춰 봄, 다음 샷을 칠 수 있음
+	bool isSettled(void) const { return !m_match.isMoving() && !m_waitingAck && !m_waitingTurn; }
+
+	const CMatch& getMatch(void) const { return m_match; }
+	const Stats& getStats(void) const { return m_stats; }
+
+	// 시험용, 예측에 쓰는 목표 위치를 이만큼까지 흔듦 (서버는 보낸 값을 씀)
+	void setInputNoise(float noise) { m_inputNoise = noise; }
+
+private:
+	void rollback(float targetX, float targetZ, int tipRight, int tipUp);
+	void reconcile(void);
+
+	CMatch				m_match;
+	CMatch::Snapshot	m_beforeShot;		// shoot() 직전
+	CMatch::State		m_serverTurn;
+	bool				m_waitingAck;
+	bool				m_waitingTurn;
+	bool				m_turnArrived;		// 로컬 샷이 끝나기 전에 온 결과
+	int					m_predictedSteps;	// shoot() 이후 진행한 스텝
+	std::string			m_guessAck;			// 예측에 쓴 입력을 ack 줄로 쓴 것
+	float				m_inputNoise;
+	Stats				m_stats;
+};
+
+#endif // __predictedMatchH__
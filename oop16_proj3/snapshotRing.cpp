@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: snapshotRing.cpp
+//
+// Desc: Slot bookkeeping of the rewind history ring.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "snapshotRing.h"
+
+CSnapshotRing::CSnapshotRing(void)
+{
+	m_slots = 0;
+	m_slotSize = 0;
+	m_head = 0;
+	m_count = 0;
+}
+
+void CSnapshotRing::create(int slots, size_t slotSize)
+{
+	m_slots = slots;
+	m_slotSize = slotSize;
+	m_data.assign((size_t)slots * slotSize, 0);
+	m_steps.assign(slots, 0);
+	m_boundaries.assign(slots, 0);
+	m_head = 0;
+	m_count = 0;
+}
+
+void* CSnapshotRing::push(unsigned int step, bool boundary)
+{
+	int i = m_head;
+	m_head = m_head + 1 == m_slots ? 0 : m_head + 1;
+	if (m_count < m_slots)
+		m_count++;
+	m_steps[i] = step;
+	m_boundaries[i] = boundary;
+	return &m_data[i * m_slotSize];
+}
+
+void CSnapshotRing::dropNewest(int count)
+{
+	if (count > m_count)
+		count = m_count;
+	m_head -= count;
+	if (m_head < 0)
+		m_head += m_slots;
+	m_count -= count;
+}
@@ -0,0 +1,55 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: snapshotRing.h
+//
+// Desc: Fixed-memory ring of equally sized byte slots for rewind history.
+//       All slots are allocated once by create(); push() hands out the
+//       oldest slot to overwrite, so recording costs only the copy the
+//       caller does into it. Each slot remembers the step it was taken at
+//       and whether it marks a turn boundary (see CGame::takeBack()).
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __snapshotRingH__
+#define __snapshotRingH__
+
+#include <stddef.h>
+#include <vector>
+
+class CSnapshotRing {
+public:
+	CSnapshotRing(void);
+
+	// slots칸, 칸마다 slotSize 바이트를 한번에 잡고 기록은 비움
+	void create(int slots, size_t slotSize);
+	void clear(void) { m_count = 0; }
+	int getSlots(void) const { return m_slots; }
+	size_t getSlotSize(void) const { return m_slotSize; }
+	int getCount(void) const { return m_count; }
+
+	// 새 기록을 채울 칸, 가득 찼으면 가장 오래된 칸을 돌려줌
+	void* push(unsigned int step, bool boundary);
+	// back번째 전 기록, 0이 가장 최근
+	const void* get(int back) const { return &m_data[slotIndex(back) * m_slotSize]; }
+	unsigned int getStep(int back) const { return m_steps[slotIndex(back)]; }
+	bool isBoundary(int back) const { return m_boundaries[slotIndex(back)] != 0; }
+	// 가장 최근 기록 count개를 버림
+	void dropNewest(int count);
+
+private:
+	int slotIndex(int back) const
+	{
+		int i = m_head - 1 - back;
+		return i < 0 ? i + m_slots : i;
+	}
+
+	std::vector<unsigned char>	m_data;			// m_slots * m_slotSize
+	std::vector<unsigned int>	m_steps;
+	std::vector<unsigned char>	m_boundaries;
+	int		m_slots;
+	size_t	m_slotSize;
+	int		m_head;			// 다음에 채울 칸
+	int		m_count;
+};
+
+#endif // __snapshotRingH__
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: table.h
+//
+// Desc: Table geometry as constexpr data. The four cushions of the default
+//       table, their WallBody boxes, the playing rectangle between them
+//       and the six pool pockets are all derived from one TableGeometry at compile time, so the
+//       renderer, CGame and the benchmarks agree without repeated literals.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __tableH__
+#define __tableH__
+
+#include "physics.h"
+
+struct TableGeometry {
+	float	width, depth;			// 쿠션 안쪽 바닥 크기
+	float	cushionThickness;
+	float	cushionHeight;
+
+	// 0, 1: 위/아래 가로 벽, 2, 3: 오른쪽/왼쪽 세로 벽 (세로 벽이 모서리를 덮음)
+	constexpr WallBody cushion(int index) const
+	{
+		return index < 2
+			? WallBody{ 0, (index == 0 ? 1 : -1) * (depth + cushionThickness) / 2, width, cushionThickness }
+			: WallBody{ (index == 2 ? 1 : -1) * (width + cushionThickness) / 2, 0, cushionThickness, depth + 2 * cushionThickness };
+	}
+
+	constexpr TableRect inner(void) const
+	{
+		return TableRect{ -width / 2, width / 2, -depth / 2, depth / 2 };
+	}
+
+	// 0~3: 네 모서리, 4, 5: 긴 쿠션 가운데, 중심은 쿠션 면 위에 둠
+	// 쿠션에 닿은 공 중심이 포켓 안에 들어오도록 radius는 공 반지름보다 충분히 커야 함
+	constexpr Pocket pocket(int index, float radius) const
+	{
+		return index < 4
+			? Pocket{ (index & 1 ? 1 : -1) * width / 2, (index & 2 ? 1 : -1) * depth / 2, radius }
+			: Pocket{ 0, (index == 4 ? 1 : -1) * depth / 2, radius };
+	}
+};
+
+// 9 x 6 바닥에 두께 0.12, 높이 0.3의 쿠션
+constexpr TableGeometry DEFAULT_TABLE = { 9.0f, 6.0f, 0.12f, 0.3f };
+constexpr int TABLE_CUSHIONS = 4;
+constexpr int TABLE_POCKETS = 6;
+
+static_assert(DEFAULT_TABLE.cushion(2).x - DEFAULT_TABLE.cushion(2).width / 2 == DEFAULT_TABLE.inner().maxX,
+	"cushion face must be the edge of the playing area");
+
+#endif // __tableH__
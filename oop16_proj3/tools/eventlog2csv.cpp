@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: eventlog2csv.cpp
+//
+// Desc: Converts a binary event log (eventLog.h), written by the game as
+//       lastgame.events or by gameServer --log, into CSV. Records of all
+//       threads are merged into one timeline by time.
+//
+//         g++ -O2 -std=c++14 -I.. eventlog2csv.cpp -o eventlog2csv
+//         cl /O2 /EHsc /I.. eventlog2csv.cpp
+//
+//         eventlog2csv lastgame.events > lastgame.csv
+//
+//       Columns, empty where the event has no such field:
+//
+//         time_ms   since the log started
+//         thread    ring (logging thread) number
+//         match     server match id, 0 in the window
+//         event     shot, contact, brick, pocket, turn_end, score,
+//                   frame_spike, dropped
+//         player    shot: who shot, turn_end: who shoots next,
+//                   score: whose score changed
+//         ball      pocket: ball id
+//         x, z      shot: target, contact/brick/pocket: position
+//         speed     contact: impact speed
+//         tip_side, tip_height   shot: cue tip offset
+//         score1, score2         turn_end: scores after the turn
+//         delta, score           score: change and new score
+//         steps     turn_end: physics steps the shot took
+//         frame_ms, limit_ms     frame_spike
+//         count     dropped: records lost since the previous one
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "eventLog.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static const char* eventName(int type)
+{
+	switch (type) {
+	case EVENT_SHOT:		return "shot";
+	case EVENT_CONTACT:		return "contact";
+	case EVENT_BRICK:		return "brick";
+	case EVENT_POCKET:		return "pocket";
+	case EVENT_TURN_END:	return "turn_end";
+	case EVENT_SCORE:		return "score";
+	case EVENT_FRAME_SPIKE:	return "frame_spike";
+	case EVENT_DROPPED:		return "dropped";
+	}
+	return "unknown";
+}
+
+// %g는 점수 같은 정수를 소수점 없이 씀
+static void writeEvent(FILE* out, const LogEvent& e)
+{
+	// player,ball,x,z,speed,tip_side,tip_height,score1,score2,delta,score,steps,frame_ms,limit_ms,count
+	const float* f = e.f;
+	fprintf(out, "%.3f,%d,%d,%s,", e.time / 1e6, e.thread, e.match, eventName(e.type));
+	switch (e.type) {
+	case EVENT_SHOT:
+		fprintf(out, "%d,,%g,%g,,%g,%g,,,,,,,,\n", e.i0, f[0], f[1], f[2], f[3]);
+		break;
+	case EVENT_CONTACT:
+		fprintf(out, ",,%g,%g,%g,,,,,,,,,,\n", f[0], f[1], f[2]);
+		break;
+	case EVENT_BRICK:
+		fprintf(out, ",,%g,%g,,,,,,,,,,,\n", f[0], f[1]);
+		break;
+	case EVENT_POCKET:
+		fprintf(out, ",%d,%g,%g,,,,,,,,,,,\n", e.i0, f[0], f[1]);
+		break;
+	case EVENT_TURN_END:
+		fprintf(out, "%d,,,,,,,%g,%g,,,%g,,,\n", e.i0, f[0], f[1], f[2]);
+		break;
+	case EVENT_SCORE:
+		fprintf(out, "%d,,,,,,,,,%g,%g,,,,\n", e.i0, f[0], f[1]);
+		break;
+	case EVENT_FRAME_SPIKE:
+		fprintf(out, ",,,,,,,,,,,,%.2f,%.2f,\n", f[0], f[1]);
+		break;
+	case EVENT_DROPPED:
+		fprintf(out, ",,,,,,,,,,,,,,%g\n", f[0]);
+		break;
+	default:
+		fprintf(out, ",,,,,,,,,,,,,,\n");
+		break;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <file.events>\n", argv[0]);
+		return 2;
+	}
+	FILE* fp = fopen(argv[1], "rb");
+	if (fp == NULL) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	EventLogHeader h;
+	if (fread(&h, sizeof(h), 1, fp) != 1 || h.magic != EVENTLOG_MAGIC) {
+		fprintf(stderr, "%s: not an event log\n", argv[1]);
+		fclose(fp);
+		return 1;
+	}
+	if (h.version != EVENTLOG_VERSION || h.eventSize != sizeof(LogEvent) || h.headerSize < sizeof(h)) {
+		fprintf(stderr, "%s: unsupported version %d (record size %u)\n", argv[1], h.version, h.eventSize);
+		fclose(fp);
+		return 1;
+	}
+	fseek(fp, h.headerSize, SEEK_SET);
+
+	// 링마다 모아서 쓰므로 스레드 사이의 순서는 시간으로 다시 맞춤
+	std::vector<LogEvent> events;
+	LogEvent chunk[1024];
+	size_t n;
+	while ((n = fread(chunk, sizeof(LogEvent), 1024, fp)) > 0)
+		events.insert(events.end(), chunk, chunk + n);
+	fclose(fp);
+	std::stable_sort(events.begin(), events.end(),
+		[](const LogEvent& a, const LogEvent& b) { return a.time < b.time; });
+
+	printf("time_ms,thread,match,event,player,ball,x,z,speed,tip_side,tip_height,score1,score2,delta,score,steps,frame_ms,limit_ms,count\n");
+	for (size_t i = 0; i < events.size(); i++)
+		writeEvent(stdout, events[i]);
+	return 0;
+}
@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: levelconv.cpp
+//
+// Desc: Converts a readable text level into the binary .lvl format that
+//       the game memory-maps (see levelFormat.h).
+//
+//         g++ -O2 -std=c++14 -I.. levelconv.cpp -o levelconv
+//         cl /O2 /EHsc /I.. levelconv.cpp
+//
+//         levelconv ../levels/default.txt ../levels/default.lvl
+//
+//       Text format, one statement per line, '#' starts a comment:
+//
+//         material <name> <r> <g> <b>
+//         table    <x> <y> <z> <width> <height> <depth> <material>
+//         wall     <x> <y> <z> <width> <height> <depth> <material>
+//         ball     <x> <z> <material>
+//         pocket   <x> <z> <radius>
+//         bricks   <minX> <minZ> <cellWidth> <cellDepth> <cols> <rows>
+//         row      <hit points per brick, one digit each, '.' = empty>
+//         rule     <decrease_rate|wall_restitution|start_score|score_step> <value>
+//         rule     mode <carom|pool>
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "levelFormat.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+
+struct NamedMaterial {
+	std::string		name;
+	LevelMaterial	color;
+};
+
+static bool fail(int line, const char* msg)
+{
+	fprintf(stderr, "line %d: %s\n", line, msg);
+	return false;
+}
+
+static int findMaterial(const std::vector<NamedMaterial>& materials, const std::string& name)
+{
+	for (size_t i = 0; i < materials.size(); i++) {
+		if (materials[i].name == name)
+			return (int)i;
+	}
+	return -1;
+}
+
+static size_t align4(size_t n) { return (n + 3) & ~(size_t)3; }
+
+int main(int argc, char** argv)
+{
+	if (argc != 3) {
+		fprintf(stderr, "usage: levelconv <input.txt> <output.lvl>\n");
+		return 1;
+	}
+
+	std::ifstream in(argv[1]);
+	if (!in) {
+		fprintf(stderr, "cannot open %s\n", argv[1]);
+		return 1;
+	}
+
+	std::vector<NamedMaterial> materials;
+	std::vector<LevelWall> walls(1);	// 0번은 테이블 바닥
+	std::vector<LevelBall> balls;
+	std::vector<LevelPocket> pockets;
+	std::vector<unsigned char> hitPoints;
+	LevelBricks bricks;
+	bool hasTable = false, hasBricks = false;
+	int brickRow = 0;
+
+	LevelRules rules;
+	rules.decreaseRate = 0.9982f;
+	rules.wallRestitution = 0.7f;
+	rules.startScore = 50;
+	rules.scoreStep = 10;
+	rules.mode = LEVEL_MODE_CAROM;
+
+	std::string text;
+	int lineNo = 0;
+	bool ok = true;
+	while (ok && std::getline(in, text)) {
+		lineNo++;
+		size_t hash = text.find_first_of("#\r");
+		if (hash != std::string::npos)
+			text.erase(hash);
+
+		std::istringstream line(text);
+		std::string cmd;
+		if (!(line >> cmd))
+			continue;
+
+		if (cmd == "material") {
+			NamedMaterial m;
+			m.color.a = 1.0f;
+			if (!(line >> m.name >> m.color.r >> m.color.g >> m.color.b))
+				ok = fail(lineNo, "material <name> <r> <g> <b>");
+			else if (findMaterial(materials, m.name) >= 0)
+				ok = fail(lineNo, "duplicate material");
+			else
+				materials.push_back(m);
+		}
+		else if (cmd == "table" || cmd == "wall") {
+			LevelWall w;
+			std::string mtrl;
+			if (!(line >> w.x >> w.y >> w.z >> w.width >> w.height >> w.depth >> mtrl)) {
+				ok = fail(lineNo, "wall <x> <y> <z> <width> <height> <depth> <material>");
+				continue;
+			}
+			int index = findMaterial(materials, mtrl);
+			if (index < 0) {
+				ok = fail(lineNo, "unknown material");
+				continue;
+			}
+			w.material = (uint32_t)index;
+			if (cmd == "table") {
+				walls[0] = w;
+				hasTable = true;
+			}
+			else
+				walls.push_back(w);
+		}
+		else if (cmd == "ball") {
+			LevelBall b;
+			std::string mtrl;
+			if (!(line >> b.x >> b.z >> mtrl)) {
+				ok = fail(lineNo, "ball <x> <z> <material>");
+				continue;
+			}
+			int index = findMaterial(materials, mtrl);
+			if (index < 0) {
+				ok = fail(lineNo, "unknown material");
+				continue;
+			}
+			b.material = (uint32_t)index;
+			balls.push_back(b);
+		}
+		else if (cmd == "pocket") {
+			LevelPocket p;
+			if (!(line >> p.x >> p.z >> p.radius) || p.radius <= 0)
+				ok = fail(lineNo, "pocket <x> <z> <radius>");
+			else
+				pockets.push_back(p);
+		}
+		else if (cmd == "bricks") {
+			if (!(line >> bricks.minX >> bricks.minZ >> bricks.cellWidth >> bricks.cellDepth >> bricks.cols >> bricks.rows)
+				|| bricks.cols == 0 || bricks.rows == 0 || bricks.cols > 0xffff || bricks.rows > 0xffff) {
+				ok = fail(lineNo, "bricks <minX> <minZ> <cellWidth> <cellDepth> <cols> <rows>");
+				continue;
+			}
+			hitPoints.assign((size_t)bricks.cols * bricks.rows, 0);
+			hasBricks = true;
+			brickRow = 0;
+		}
+		else if (cmd == "row") {
+			std::string cells;
+			line >> cells;
+			if (!hasBricks)
+				ok = fail(lineNo, "row before bricks");
+			else if (brickRow >= (int)bricks.rows)
+				ok = fail(lineNo, "too many rows");
+			else if (cells.size() != bricks.cols)
+				ok = fail(lineNo, "row length does not match cols");
+			else {
+				for (size_t c = 0; c < cells.size(); c++) {
+					char ch = cells[c];
+					if (ch == '.')
+						continue;
+					if (ch < '0' || ch > '9') {
+						ok = fail(lineNo, "row cells must be digits or '.'");
+						break;
+					}
+					hitPoints[(size_t)brickRow * bricks.cols + c] = (unsigned char)(ch - '0');
+				}
+				brickRow++;
+			}
+		}
+		else if (cmd == "rule") {
+			std::string key;
+			double value;
+			if ((line >> key) && key == "mode") {
+				std::string mode;
+				line >> mode;
+				if (mode == "carom") rules.mode = LEVEL_MODE_CAROM;
+				else if (mode == "pool") rules.mode = LEVEL_MODE_POOL;
+				else ok = fail(lineNo, "rule mode <carom|pool>");
+			}
+			else if (!(line >> value))
+				ok = fail(lineNo, "rule <name> <value>");
+			else if (key == "decrease_rate") rules.decreaseRate = (float)value;
+			else if (key == "wall_restitution") rules.wallRestitution = (float)value;
+			else if (key == "start_score") rules.startScore = (int32_t)value;
+			else if (key == "score_step") rules.scoreStep = (int32_t)value;
+			else ok = fail(lineNo, "unknown rule");
+		}
+		else
+			ok = fail(lineNo, "unknown statement");
+	}
+	if (!ok)
+		return 1;
+	if (!hasTable) {
+		fprintf(stderr, "missing table\n");
+		return 1;
+	}
+
+	// 섹션 배치: header | materials | walls | balls | pockets | rules | bricks | hit points
+	LevelHeader h;
+	memset(&h, 0, sizeof(h));
+	h.magic = LEVEL_MAGIC;
+	h.version = LEVEL_VERSION;
+	h.headerSize = sizeof(LevelHeader);
+
+	size_t offset = sizeof(LevelHeader);
+	h.materialCount = (uint32_t)materials.size();
+	h.materialOffset = (uint32_t)offset;
+	offset += materials.size() * sizeof(LevelMaterial);
+	h.wallCount = (uint32_t)walls.size();
+	h.wallOffset = (uint32_t)offset;
+	offset += walls.size() * sizeof(LevelWall);
+	h.ballCount = (uint32_t)balls.size();
+	h.ballOffset = (uint32_t)offset;
+	offset += balls.size() * sizeof(LevelBall);
+	h.pocketCount = (uint32_t)pockets.size();
+	h.pocketOffset = (uint32_t)offset;
+	offset += pockets.size() * sizeof(LevelPocket);
+	h.rulesOffset = (uint32_t)offset;
+	offset += sizeof(LevelRules);
+	if (hasBricks) {
+		h.bricksOffset = (uint32_t)offset;
+		offset += sizeof(LevelBricks);
+		bricks.hitPointsOffset = (uint32_t)offset;
+		offset += align4(hitPoints.size());
+	}
+	h.fileSize = (uint32_t)offset;
+
+	std::vector<unsigned char> out(offset, 0);
+	memcpy(&out[0], &h, sizeof(h));
+	for (size_t i = 0; i < materials.size(); i++)
+		memcpy(&out[h.materialOffset + i * sizeof(LevelMaterial)], &materials[i].color, sizeof(LevelMaterial));
+	memcpy(&out[h.wallOffset], &walls[0], walls.size() * sizeof(LevelWall));
+	if (!balls.empty())
+		memcpy(&out[h.ballOffset], &balls[0], balls.size() * sizeof(LevelBall));
+	if (!pockets.empty())
+		memcpy(&out[h.pocketOffset], &pockets[0], pockets.size() * sizeof(LevelPocket));
+	memcpy(&out[h.rulesOffset], &rules, sizeof(rules));
+	if (hasBricks) {
+		memcpy(&out[h.bricksOffset], &bricks, sizeof(bricks));
+		memcpy(&out[bricks.hitPointsOffset], &hitPoints[0], hitPoints.size());
+	}
+
+	FILE* fp = fopen(argv[2], "wb");
+	if (fp == NULL || fwrite(&out[0], 1, out.size(), fp) != out.size()) {
+		fprintf(stderr, "cannot write %s\n", argv[2]);
+		if (fp) fclose(fp);
+		return 1;
+	}
+	fclose(fp);
+
+	printf("%s: %u materials, %u walls, %u balls, %u pockets, %s, %u bytes\n", argv[2], h.materialCount, h.wallCount,
+		h.ballCount, h.pocketCount, hasBricks ? "bricks" : "no bricks", h.fileSize);
+	return 0;
+}
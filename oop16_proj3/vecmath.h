@@ -0,0 +1,268 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: vecmath.h
+//
+// Desc: Vec2/Vec3/Vec4/Mat4 for game code, used instead of D3DXVECTOR3/
+//       D3DXMATRIX so the same code builds on Linux. Conventions follow
+//       D3DX: row vectors (v * M), row-major storage, left-handed
+//       matrices, so a Mat4 has exactly the memory layout of a D3DXMATRIX
+//       (see the d3d::toD3DX shims in d3dUtility.h).
+//
+//       Mat4 products and point transforms use SSE on x86/x64 and NEON on
+//       ARM, scalar code elsewhere or when VECMATH_NO_SIMD is defined.
+//       Loads and stores are unaligned so a Mat4 can sit anywhere,
+//       including inside std::vector on 32-bit Windows.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __vecmathH__
+#define __vecmathH__
+
+#include <math.h>
+
+#if !defined(VECMATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define VECMATH_SSE 1
+#include <xmmintrin.h>
+#elif !defined(VECMATH_NO_SIMD) && (defined(__ARM_NEON) || defined(_M_ARM) || defined(_M_ARM64))
+#define VECMATH_NEON 1
+#include <arm_neon.h>
+#endif
+
+struct Vec2 {
+	float x, y;
+
+	constexpr Vec2(void) : x(0), y(0) {}
+	constexpr Vec2(float x_, float y_) : x(x_), y(y_) {}
+
+	constexpr Vec2 operator+(const Vec2& v) const { return Vec2(x + v.x, y + v.y); }
+	constexpr Vec2 operator-(const Vec2& v) const { return Vec2(x - v.x, y - v.y); }
+	constexpr Vec2 operator-(void) const { return Vec2(-x, -y); }
+	constexpr Vec2 operator*(float s) const { return Vec2(x * s, y * s); }
+	constexpr Vec2 operator/(float s) const { return Vec2(x / s, y / s); }
+	Vec2& operator+=(const Vec2& v) { x += v.x; y += v.y; return *this; }
+	Vec2& operator-=(const Vec2& v) { x -= v.x; y -= v.y; return *this; }
+	Vec2& operator*=(float s) { x *= s; y *= s; return *this; }
+	Vec2& operator/=(float s) { x /= s; y /= s; return *this; }
+};
+
+struct Vec3 {
+	float x, y, z;
+
+	constexpr Vec3(void) : x(0), y(0), z(0) {}
+	constexpr Vec3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+
+	constexpr Vec3 operator+(const Vec3& v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+	constexpr Vec3 operator-(const Vec3& v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+	constexpr Vec3 operator-(void) const { return Vec3(-x, -y, -z); }
+	constexpr Vec3 operator*(float s) const { return Vec3(x * s, y * s, z * s); }
+	constexpr Vec3 operator/(float s) const { return Vec3(x / s, y / s, z / s); }
+	Vec3& operator+=(const Vec3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+	Vec3& operator-=(const Vec3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+	Vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+	Vec3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+};
+
+struct Vec4 {
+	float x, y, z, w;
+
+	constexpr Vec4(void) : x(0), y(0), z(0), w(0) {}
+	constexpr Vec4(float x_, float y_, float z_, float w_) : x(x_), y(y_), z(z_), w(w_) {}
+	constexpr Vec4(const Vec3& v, float w_) : x(v.x), y(v.y), z(v.z), w(w_) {}
+
+	constexpr Vec4 operator+(const Vec4& v) const { return Vec4(x + v.x, y + v.y, z + v.z, w + v.w); }
+	constexpr Vec4 operator-(const Vec4& v) const { return Vec4(x - v.x, y - v.y, z - v.z, w - v.w); }
+	constexpr Vec4 operator*(float s) const { return Vec4(x * s, y * s, z * s, w * s); }
+};
+
+constexpr float dot(const Vec2& a, const Vec2& b) { return a.x * b.x + a.y * b.y; }
+constexpr float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr float dot(const Vec4& a, const Vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+constexpr Vec3 cross(const Vec3& a, const Vec3& b)
+{
+	return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+
+inline float length(const Vec2& v) { return sqrtf(dot(v, v)); }
+inline float length(const Vec3& v) { return sqrtf(dot(v, v)); }
+
+// 길이가 0이면 그대로 돌려줌 (D3DXVec3Normalize와 같음)
+inline Vec2 normalize(const Vec2& v)
+{
+	float len = length(v);
+	return len > 0 ? v / len : v;
+}
+inline Vec3 normalize(const Vec3& v)
+{
+	float len = length(v);
+	return len > 0 ? v / len : v;
+}
+
+struct Mat4 {
+	float m[4][4];
+
+	// 단위 행렬
+	constexpr Mat4(void)
+		: m{ { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } } {}
+	constexpr Mat4(float _11, float _12, float _13, float _14,
+		float _21, float _22, float _23, float _24,
+		float _31, float _32, float _33, float _34,
+		float _41, float _42, float _43, float _44)
+		: m{ { _11, _12, _13, _14 }, { _21, _22, _23, _24 }, { _31, _32, _33, _34 }, { _41, _42, _43, _44 } } {}
+
+	static constexpr Mat4 identity(void) { return Mat4(); }
+	static constexpr Mat4 translation(float x, float y, float z)
+	{
+		return Mat4(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, x, y, z, 1);
+	}
+	static constexpr Mat4 scaling(float x, float y, float z)
+	{
+		return Mat4(x, 0, 0, 0, 0, y, 0, 0, 0, 0, z, 0, 0, 0, 0, 1);
+	}
+	static Mat4 rotationX(float angle)
+	{
+		float c = cosf(angle), s = sinf(angle);
+		return Mat4(1, 0, 0, 0, 0, c, s, 0, 0, -s, c, 0, 0, 0, 0, 1);
+	}
+	static Mat4 rotationY(float angle)
+	{
+		float c = cosf(angle), s = sinf(angle);
+		return Mat4(c, 0, -s, 0, 0, 1, 0, 0, s, 0, c, 0, 0, 0, 0, 1);
+	}
+	// D3DXMatrixLookAtLH
+	static Mat4 lookAtLH(const Vec3& eye, const Vec3& at, const Vec3& up)
+	{
+		Vec3 zAxis = normalize(at - eye);
+		Vec3 xAxis = normalize(cross(up, zAxis));
+		Vec3 yAxis = cross(zAxis, xAxis);
+		return Mat4(xAxis.x, yAxis.x, zAxis.x, 0,
+			xAxis.y, yAxis.y, zAxis.y, 0,
+			xAxis.z, yAxis.z, zAxis.z, 0,
+			-dot(xAxis, eye), -dot(yAxis, eye), -dot(zAxis, eye), 1);
+	}
+	// D3DXMatrixPerspectiveFovLH
+	static Mat4 perspectiveFovLH(float fovY, float aspect, float zn, float zf)
+	{
+		float yScale = 1.0f / tanf(fovY / 2);
+		float xScale = yScale / aspect;
+		float q = zf / (zf - zn);
+		return Mat4(xScale, 0, 0, 0, 0, yScale, 0, 0, 0, 0, q, 1, 0, 0, -zn * q, 0);
+	}
+
+	Mat4& operator*=(const Mat4& b);
+};
+
+// this * b, D3DXMatrixMultiply와 같은 순서
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+	Mat4 r;
+#if defined(VECMATH_SSE)
+	__m128 b0 = _mm_loadu_ps(b.m[0]), b1 = _mm_loadu_ps(b.m[1]);
+	__m128 b2 = _mm_loadu_ps(b.m[2]), b3 = _mm_loadu_ps(b.m[3]);
+	for (int i = 0; i < 4; i++) {
+		__m128 row = _mm_mul_ps(_mm_set1_ps(a.m[i][0]), b0);
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][1]), b1));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][2]), b2));
+		row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.m[i][3]), b3));
+		_mm_storeu_ps(r.m[i], row);
+	}
+#elif defined(VECMATH_NEON)
+	float32x4_t b0 = vld1q_f32(b.m[0]), b1 = vld1q_f32(b.m[1]);
+	float32x4_t b2 = vld1q_f32(b.m[2]), b3 = vld1q_f32(b.m[3]);
+	for (int i = 0; i < 4; i++) {
+		float32x4_t row = vmulq_n_f32(b0, a.m[i][0]);
+		row = vmlaq_n_f32(row, b1, a.m[i][1]);
+		row = vmlaq_n_f32(row, b2, a.m[i][2]);
+		row = vmlaq_n_f32(row, b3, a.m[i][3]);
+		vst1q_f32(r.m[i], row);
+	}
+#else
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			r.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+	}
+#endif
+	return r;
+}
+
+inline Mat4& Mat4::operator*=(const Mat4& b)
+{
+	*this = *this * b;
+	return *this;
+}
+
+// (x, y, z, w) * M
+inline Vec4 transform(const Vec4& v, const Mat4& mat)
+{
+#if defined(VECMATH_SSE)
+	__m128 r = _mm_mul_ps(_mm_set1_ps(v.x), _mm_loadu_ps(mat.m[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.y), _mm_loadu_ps(mat.m[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.z), _mm_loadu_ps(mat.m[2])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.w), _mm_loadu_ps(mat.m[3])));
+	Vec4 out;
+	_mm_storeu_ps(&out.x, r);
+	return out;
+#elif defined(VECMATH_NEON)
+	float32x4_t r = vmulq_n_f32(vld1q_f32(mat.m[0]), v.x);
+	r = vmlaq_n_f32(r, vld1q_f32(mat.m[1]), v.y);
+	r = vmlaq_n_f32(r, vld1q_f32(mat.m[2]), v.z);
+	r = vmlaq_n_f32(r, vld1q_f32(mat.m[3]), v.w);
+	Vec4 out;
+	vst1q_f32(&out.x, r);
+	return out;
+#else
+	return Vec4(v.x * mat.m[0][0] + v.y * mat.m[1][0] + v.z * mat.m[2][0] + v.w * mat.m[3][0],
+		v.x * mat.m[0][1] + v.y * mat.m[1][1] + v.z * mat.m[2][1] + v.w * mat.m[3][1],
+		v.x * mat.m[0][2] + v.y * mat.m[1][2] + v.z * mat.m[2][2] + v.w * mat.m[3][2],
+		v.x * mat.m[0][3] + v.y * mat.m[1][3] + v.z * mat.m[2][3] + v.w * mat.m[3][3]);
+#endif
+}
+
+// 점 변환 (w = 1, 결과를 w로 나눔), D3DXVec3TransformCoord와 같음
+inline Vec3 transformCoord(const Vec3& v, const Mat4& mat)
+{
+	Vec4 r = transform(Vec4(v, 1.0f), mat);
+	float invW = r.w != 0 ? 1.0f / r.w : 0.0f;
+	return Vec3(r.x * invW, r.y * invW, r.z * invW);
+}
+
+// 방향 변환 (w = 0, 이동 무시), D3DXVec3TransformNormal과 같음
+inline Vec3 transformNormal(const Vec3& v, const Mat4& mat)
+{
+	Vec4 r = transform(Vec4(v, 0.0f), mat);
+	return Vec3(r.x, r.y, r.z);
+}
+
+// 여러 점을 한번에 변환, 행렬 행을 레지스터에 올려 둔 채로 돌림
+inline void transformCoords(const Mat4& mat, const Vec3* pIn, Vec3* pOut, int count)
+{
+#if defined(VECMATH_SSE)
+	__m128 r0 = _mm_loadu_ps(mat.m[0]), r1 = _mm_loadu_ps(mat.m[1]);
+	__m128 r2 = _mm_loadu_ps(mat.m[2]), r3 = _mm_loadu_ps(mat.m[3]);
+	for (int i = 0; i < count; i++) {
+		__m128 r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pIn[i].x), r0), r3);
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(pIn[i].y), r1));
+		r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(pIn[i].z), r2));
+		float out[4];
+		_mm_storeu_ps(out, r);
+		float invW = out[3] != 0 ? 1.0f / out[3] : 0.0f;
+		pOut[i] = Vec3(out[0] * invW, out[1] * invW, out[2] * invW);
+	}
+#elif defined(VECMATH_NEON)
+	float32x4_t r0 = vld1q_f32(mat.m[0]), r1 = vld1q_f32(mat.m[1]);
+	float32x4_t r2 = vld1q_f32(mat.m[2]), r3 = vld1q_f32(mat.m[3]);
+	for (int i = 0; i < count; i++) {
+		float32x4_t r = vmlaq_n_f32(r3, r0, pIn[i].x);
+		r = vmlaq_n_f32(r, r1, pIn[i].y);
+		r = vmlaq_n_f32(r, r2, pIn[i].z);
+		float out[4];
+		vst1q_f32(out, r);
+		float invW = out[3] != 0 ? 1.0f / out[3] : 0.0f;
+		pOut[i] = Vec3(out[0] * invW, out[1] * invW, out[2] * invW);
+	}
+#else
+	for (int i = 0; i < count; i++)
+		pOut[i] = transformCoord(pIn[i], mat);
+#endif
+}
+
+#endif // __vecmathH__
@@ -1,1179 +1,2105 @@
-////////////////////////////////////////////////////////////////////////////////
-//
-// File: virtualLego.cpp
-//
-// Original Author: 박창현 Chang-hyeon Park, 
-// Modified by Bong-Soo Sohn and Dong-Jun Kim
-// 
-// Originally programmed for Virtual LEGO. 
-// Modified later to program for Virtual Billiard.
-//        
-////////////////////////////////////////////////////////////////////////////////
-
-#include "d3dUtility.h"
-#include <vector>
-#include <ctime>
-#include <cstdlib>
-#include <cstdio>
-#include <cassert>
-#include <math.h>
-
-IDirect3DDevice9* Device = NULL;
-
-// window size
-const int Width = 1024;
-const int Height = 768;
-
-// There are four balls
-// initialize the position (coordinate) of each ball (ball0 ~ ball3)
-const float spherePos[4][2] = { {-2.7f,0} , {+2.4f,0} , {3.3f,0} , {-2.7f,-0.9f} };
-// initialize the color of each ball (ball0 ~ ball3)
-const D3DXCOLOR sphereColor[4] = { d3d::RED, d3d::RED, d3d::YELLOW, d3d::WHITE };
-
-// -----------------------------------------------------------------------------
-// Transform matrices
-// -----------------------------------------------------------------------------
-D3DXMATRIX g_mWorld;
-D3DXMATRIX g_mView;
-D3DXMATRIX g_mProj;
-
-#define M_RADIUS 0.21   // ball radius
-#define PI 3.14159265
-#define M_HEIGHT 0.01
-#define DECREASE_RATE 0.9982
-
-// -----------------------------------------------------------------------------
-// CSphere class definition
-// -----------------------------------------------------------------------------
-
-class CSphere {
-private:
-	float					center_x, center_y, center_z;
-	float                   m_radius;
-	float					m_velocity_x;
-	float					m_velocity_z;
-
-public:
-	CSphere(void)
-	{
-		D3DXMatrixIdentity(&m_mLocal);
-		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
-		m_radius = 0;
-		m_velocity_x = 0;
-		m_velocity_z = 0;
-		m_pSphereMesh = NULL;
-	}
-	~CSphere(void) {}
-
-public:
-	bool create(IDirect3DDevice9* pDevice, D3DXCOLOR color = d3d::WHITE)
-	{
-		if (NULL == pDevice)
-			return false;
-
-		m_mtrl.Ambient = color;
-		m_mtrl.Diffuse = color;
-		m_mtrl.Specular = color;
-		m_mtrl.Emissive = d3d::BLACK;
-		m_mtrl.Power = 5.0f;
-
-		if (FAILED(D3DXCreateSphere(pDevice, getRadius(), 50, 50, &m_pSphereMesh, NULL)))
-			return false;
-		return true;
-	}
-
-	void destroy(void)
-	{
-		if (m_pSphereMesh != NULL) {
-			m_pSphereMesh->Release();
-			m_pSphereMesh = NULL;
-		}
-	}
-
-	void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-	{
-		if (NULL == pDevice)
-			return;
-		pDevice->SetTransform(D3DTS_WORLD, &mWorld);
-		pDevice->MultiplyTransform(D3DTS_WORLD, &m_mLocal);
-		pDevice->SetMaterial(&m_mtrl);
-		m_pSphereMesh->DrawSubset(0);
-	}
-
-	bool hasIntersected(CSphere& ball)
-	{
-		// Insert your code here.
-		double dist = sqrt(pow(center_x - ball.getPos_X(), 2) + pow(center_z - ball.getPos_Z(), 2));
-		if (dist < 2 * getRadius() - 0.0) return true;
-		else return false;
-	}
-
-	void hitBy(CSphere& ball)
-	{
-		if (hasIntersected(ball))
-		{
-			// Calculate relative velocity
-			float relVelX = ball.getVelocity_X() - getVelocity_X();
-			float relVelZ = ball.getVelocity_Z() - getVelocity_Z();
-			// Calculate the normal vector at the collision point
-			D3DXVECTOR3 normal = ball.getCenter() - getCenter();
-			D3DXVec3Normalize(&normal, &normal);
-			// Calculate impulse based on the normal and relative velocity
-			float impulse = relVelX * normal.x + relVelZ * normal.z;
-			// Update velocities
-			setPower(getVelocity_X() + impulse * normal.x, getVelocity_Z() + impulse * normal.z);
-			ball.setPower(ball.getVelocity_X() - impulse * normal.x, ball.getVelocity_Z() - impulse * normal.z);
-		}
-	}
-
-	void ballUpdate(float timeDiff)
-	{
-		const float TIME_SCALE = 3.3;
-		D3DXVECTOR3 cord = this->getCenter();
-		double vx = abs(this->getVelocity_X());
-		double vz = abs(this->getVelocity_Z());
-
-		if (vx > 0.0001 || vz > 0.0001)
-		{
-			float tX = cord.x + TIME_SCALE * timeDiff * m_velocity_x;
-			float tZ = cord.z + TIME_SCALE * timeDiff * m_velocity_z;
-
-			//correction of position of ball
-			// Please uncomment this part because this correction of ball position is necessary when a ball collides with a wall
-			/*if(tX >= (4.5 - M_RADIUS))
-				tX = 4.5 - M_RADIUS;
-			else if(tX <=(-4.5 + M_RADIUS))
-				tX = -4.5 + M_RADIUS;
-			else if(tZ <= (-3 + M_RADIUS))
-				tZ = -3 + M_RADIUS;
-			else if(tZ >= (3 - M_RADIUS))
-				tZ = 3 - M_RADIUS;*/
-
-			this->setCenter(tX, cord.y, tZ);
-		}
-		else { this->setPower(0, 0); }
-		//this->setPower(this->getVelocity_X() * DECREASE_RATE, this->getVelocity_Z() * DECREASE_RATE);
-		double rate = 1 - (1 - DECREASE_RATE) * timeDiff * 400;
-		if (rate < 0)
-			rate = 0;
-		this->setPower(getVelocity_X() * rate, getVelocity_Z() * rate);
-	}
-
-	double getVelocity_X() { return this->m_velocity_x; }
-	double getVelocity_Z() { return this->m_velocity_z; }
-	double getPos_X() { return this->center_x; }
-	double getPos_Y() { return this->center_y; }
-	double getPos_Z() { return this->center_z; }
-
-	void setPower(double vx, double vz)
-	{
-		this->m_velocity_x = vx;
-		this->m_velocity_z = vz;
-	}
-
-	void setCenter(float x, float y, float z)
-	{
-		D3DXMATRIX m;
-		center_x = x;	center_y = y;	center_z = z;
-		D3DXMatrixTranslation(&m, x, y, z);
-		setLocalTransform(m);
-	}
-	bool isStopped() {
-		return abs(m_velocity_x) < 0.01 && abs(m_velocity_z) < 0.01;
-	}
-
-	float getRadius(void)  const { return (float)(M_RADIUS); }
-	const D3DXMATRIX& getLocalTransform(void) const { return m_mLocal; }
-	void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
-	D3DXVECTOR3 getCenter(void) const
-	{
-		D3DXVECTOR3 org(center_x, center_y, center_z);
-		return org;
-	}
-
-private:
-	D3DXMATRIX              m_mLocal;
-	D3DMATERIAL9            m_mtrl;
-	ID3DXMesh* m_pSphereMesh;
-
-};
-
-
-
-// -----------------------------------------------------------------------------
-// CWall class definition
-// -----------------------------------------------------------------------------
-
-class CWall {
-
-private:
-
-	float					m_x;
-	float					m_z;
-	float                   m_width;
-	float                   m_depth;
-	float					m_height;
-
-public:
-	CWall(void)
-	{
-		D3DXMatrixIdentity(&m_mLocal);
-		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
-		m_width = 0;
-		m_depth = 0;
-		m_pBoundMesh = NULL;
-	}
-	~CWall(void) {}
-public:
-	bool create(IDirect3DDevice9* pDevice, float ix, float iz, float iwidth, float iheight, float idepth, D3DXCOLOR color = d3d::WHITE)
-	{
-		if (NULL == pDevice)
-			return false;
-
-		m_mtrl.Ambient = color;
-		m_mtrl.Diffuse = color;
-		m_mtrl.Specular = color;
-		m_mtrl.Emissive = d3d::BLACK;
-		m_mtrl.Power = 5.0f;
-
-		m_width = iwidth;
-		m_depth = idepth;
-
-		if (FAILED(D3DXCreateBox(pDevice, iwidth, iheight, idepth, &m_pBoundMesh, NULL)))
-			return false;
-		return true;
-	}
-	void destroy(void)
-	{
-		if (m_pBoundMesh != NULL) {
-			m_pBoundMesh->Release();
-			m_pBoundMesh = NULL;
-		}
-	}
-	void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-	{
-		if (NULL == pDevice)
-			return;
-		pDevice->SetTransform(D3DTS_WORLD, &mWorld);
-		pDevice->MultiplyTransform(D3DTS_WORLD, &m_mLocal);
-		pDevice->SetMaterial(&m_mtrl);
-		m_pBoundMesh->DrawSubset(0);
-	}
-
-	bool hasIntersected(CSphere& ball)
-	{
-		auto ballPos = ball.getCenter();
-		if (abs(ballPos.x - m_x) < (m_width / 2) + ball.getRadius() && abs(ballPos.z - m_z) < (m_depth / 2) + ball.getRadius()) {
-			return true;
-		}
-		else return false;
-	}
-
-	void hitBy(CSphere& ball)
-	{
-		if (hasIntersected(ball)) {
-			if (m_width > m_depth) {												// 가로방향 벽일 때
-				if (ball.getVelocity_Z() * (m_z - ball.getCenter().z) > 0) {		// 공이 벽을 향해 움직이고 있을 때만 충돌 판정
-					ball.setPower(0.7 * ball.getVelocity_X(), -0.7 * ball.getVelocity_Z());		// 공의 속도의 z성분 부호 반전
-				}
-			}
-			else {																	// 세로방향 벽일 때
-				if (ball.getVelocity_X() * (m_x - ball.getCenter().x) > 0) {		// 공이 벽을 향해 움직이고 있을 때만 충돌 판정
-					ball.setPower(-0.7 * ball.getVelocity_X(), 0.7 * ball.getVelocity_Z());		// 공의 속도의 x성분 부호 반전
-				}
-			}
-		}
-	}
-
-	void setPosition(float x, float y, float z)
-	{
-		D3DXMATRIX m;
-		this->m_x = x;
-		this->m_z = z;
-
-		D3DXMatrixTranslation(&m, x, y, z);
-		setLocalTransform(m);
-	}
-
-	float getHeight(void) const { return M_HEIGHT; }
-
-
-
-private:
-	void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
-
-	D3DXMATRIX              m_mLocal;
-	D3DMATERIAL9            m_mtrl;
-	ID3DXMesh* m_pBoundMesh;
-};
-
-// 공이 움직일 경로 표시
-class CPath {
-private:
-	class CDot {
-	private:
-		float					center_x, center_y, center_z;
-		float                   m_radius;
-		float					m_velocity_x;
-		float					m_velocity_z;
-
-	public:
-		CDot(void)
-		{
-			D3DXMatrixIdentity(&m_mLocal);
-			ZeroMemory(&m_mtrl, sizeof(m_mtrl));
-			m_radius = 0;
-			m_velocity_x = 0;
-			m_velocity_z = 0;
-			m_pSphereMesh = NULL;
-		}
-		~CDot(void) {}
-
-	public:
-		bool create(IDirect3DDevice9* pDevice, D3DXCOLOR color = d3d::WHITE)
-		{
-			if (NULL == pDevice)
-				return false;
-
-			m_mtrl.Ambient = color;
-			m_mtrl.Diffuse = color;
-			m_mtrl.Specular = color;
-			m_mtrl.Emissive = d3d::BLACK;
-			m_mtrl.Power = 5.0f;
-
-			if (FAILED(D3DXCreateSphere(pDevice, 0.05, 50, 50, &m_pSphereMesh, NULL)))
-				return false;
-			return true;
-		}
-
-		void destroy(void)
-		{
-			if (m_pSphereMesh != NULL) {
-				m_pSphereMesh->Release();
-				m_pSphereMesh = NULL;
-			}
-		}
-
-		void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-		{
-			if (NULL == pDevice)
-				return;
-			pDevice->SetTransform(D3DTS_WORLD, &mWorld);
-			pDevice->MultiplyTransform(D3DTS_WORLD, &m_mLocal);
-			pDevice->SetMaterial(&m_mtrl);
-			m_pSphereMesh->DrawSubset(0);
-		}
-
-		void setCenter(float x, float y, float z)
-		{
-			D3DXMATRIX m;
-			center_x = x;	center_y = y;	center_z = z;
-			D3DXMatrixTranslation(&m, x, y, z);
-			setLocalTransform(m);
-		}
-		const D3DXMATRIX& getLocalTransform(void) const { return m_mLocal; }
-		void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
-		D3DXVECTOR3 getCenter(void) const
-		{
-			D3DXVECTOR3 org(center_x, center_y, center_z);
-			return org;
-		}
-
-	private:
-		D3DXMATRIX              m_mLocal;
-		D3DMATERIAL9            m_mtrl;
-		ID3DXMesh* m_pSphereMesh;
-
-	};
-
-private:
-	CDot dots[60];
-	const float width = 9;
-	const float depth = 6.24f;
-public:
-	// 공 생성
-	void create(IDirect3DDevice9* pDevice) {
-		if (NULL == pDevice)
-			return;
-		for (int i = 0; i < 60; i++) {
-			dots[i].create(pDevice);
-		}
-	}
-	// startPos에서 endPos 방향으로 벽까지 0.2 간격으로 공을 그림
-	void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld, D3DXVECTOR3 startPos, D3DXVECTOR3 endPos) {
-		auto direction = endPos - startPos;
-		float length = sqrt((direction.x * direction.x) + (direction.y * direction.y) + (direction.z * direction.z));
-		direction /= length;
-		direction *= 0.2f;
-		int i = 0;
-		auto pos = startPos + direction;
-		while (i < 60 && pos.x > -width / 2 && pos.x < width / 2 && pos.z > -depth / 2 && pos.z < depth / 2) {
-			dots[i].setCenter(pos.x, pos.y, pos.z);
-			dots[i].draw(pDevice, mWorld);
-			pos += direction;
-			i++;
-		}
-	}
-};
-
-// 당구채
-class CStick {
-private:
-	float m_x;
-	float m_y;
-	float m_z;
-	float m_length;
-	float m_angle;
-	float m_velocity_x;
-	float m_velocity_z;
-	bool isMoving;
-
-public:
-	CStick(void)
-	{
-		D3DXMatrixIdentity(&m_mLocal);
-		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
-		m_pBoundMesh = NULL;
-		isMoving = false;
-	}
-	~CStick(void) {}
-
-	bool create(IDirect3DDevice9* pDevice, float radius1, float radius2, float length, D3DXCOLOR color = d3d::WHITE) {
-		if (NULL == pDevice)
-			return false;
-
-		m_mtrl.Ambient = color;
-		m_mtrl.Diffuse = color;
-		m_mtrl.Specular = color;
-		m_mtrl.Emissive = d3d::BLACK;
-		m_mtrl.Power = 5.0f;
-
-		m_length = length;
-		// radius1이 radius2보다 크다면 두 값을 바꿈
-		if (radius2 < radius1) {
-			float temp = radius1;
-			radius1 = radius2;
-			radius2 = temp;
-		}
-
-		if (FAILED(D3DXCreateCylinder(pDevice, radius1, radius2, length, 8, 3, &m_pBoundMesh, NULL)))
-			return false;
-		return true;
-	}
-	void destroy(void)
-	{
-		if (m_pBoundMesh != NULL) {
-			m_pBoundMesh->Release();
-			m_pBoundMesh = NULL;
-		}
-	}
-	void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-	{
-		if (NULL == pDevice)
-			return;
-		pDevice->SetTransform(D3DTS_WORLD, &mWorld);
-		pDevice->MultiplyTransform(D3DTS_WORLD, &m_mLocal);
-		pDevice->SetMaterial(&m_mtrl);
-		m_pBoundMesh->DrawSubset(0);
-	}
-	bool hasIntersected(CSphere& ball)
-	{
-		auto ballPos = ball.getCenter();
-		float dist = (ballPos.x - m_x) * (ballPos.x - m_x);
-		dist += (ballPos.z - m_z) * (ballPos.z - m_z);
-		return dist < (m_length / 2) * (m_length / 2);
-	}
-
-	void hitBy(CSphere& ball)
-	{
-		// 공과 부딪히면 공을 움직이고 당구채는 멈춤
-		if (hasIntersected(ball)) {
-			ball.setPower(m_velocity_x, m_velocity_z);
-			setPower(0, 0);
-			isMoving = false;
-		}
-	}
-
-	// 당구채의 위치, 각도 설정
-	void setTransform(float x, float y, float z, float angle) {
-		setRotation(angle);
-		setPosition(x, y, z);
-	}
-
-	// 당구채 이동
-	void stickUpdate(float timeDiff)
-	{
-		const float TIME_SCALE = 3.3;
-		D3DXVECTOR3 cord = this->getCenter();
-		double vx = abs(this->getVelocity_X());
-		double vz = abs(this->getVelocity_Z());
-
-		if (vx > 0.01 || vz > 0.01)
-		{
-			float tX = cord.x + TIME_SCALE * timeDiff * m_velocity_x;
-			float tZ = cord.z + TIME_SCALE * timeDiff * m_velocity_z;
-
-			setTransform(tX, cord.y, tZ, m_angle);
-		}
-		else { this->setPower(0, 0); }
-	}
-
-	double getVelocity_X() { return this->m_velocity_x; }
-	double getVelocity_Z() { return this->m_velocity_z; }
-
-	void setPower(double vx, double vz)
-	{
-		this->m_velocity_x = vx;
-		this->m_velocity_z = vz;
-		if (abs(vx) > 0.01 || abs(vz) > 0.01) {
-			isMoving = true;
-		}
-	}
-	D3DXVECTOR3 getCenter(void) const {
-		D3DXVECTOR3 org(m_x, m_y, m_z);
-		return org;
-	}
-
-	// 당구채가 움직이는 중이면 true
-	bool isMove() const {
-		return isMoving;
-	}
-
-	// startPos에서 endPos 방향으로 당구채의 각도와 위치 설정
-	void setTarget(D3DXVECTOR3 startPos, D3DXVECTOR3 endPos) {
-		auto direction = endPos - startPos;
-		float length = sqrt((direction.x * direction.x) + (direction.y * direction.y) + (direction.z * direction.z));
-		float angle = acos(-direction.z / length);
-		if (direction.x > 0) {
-			angle = 2 * PI - angle;
-		}
-		direction /= -length;
-		direction *= m_length * 0.5 + M_RADIUS + length * 0.5;
-		this->setTransform(direction.x + startPos.x, direction.y + startPos.y, direction.z + startPos.z, angle);
-	}
-
-private:
-	void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
-	void setPosition(float x, float y, float z)
-	{
-		D3DXMATRIX m;
-		this->m_x = x;
-		this->m_y = y;
-		this->m_z = z;
-
-		D3DXMatrixTranslation(&m, x, y, z);
-		m_mLocal *= m;
-	}
-
-	void setRotation(float angle) {
-		m_angle = angle;
-		D3DXMATRIX m;
-		D3DXMatrixRotationY(&m, angle);
-		setLocalTransform(m);
-	}
-
-	D3DXMATRIX              m_mLocal;
-	D3DMATERIAL9            m_mtrl;
-	ID3DXMesh* m_pBoundMesh;
-};
-
-class CText {
-private:
-	float m_x;
-	float m_y;
-	float m_z;
-	float m_angle;
-	float m_scale;
-
-public:
-	CText(void)
-	{
-		D3DXMatrixIdentity(&m_mLocal);
-		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
-		m_pBoundMesh = NULL;
-	}
-	~CText(void) {}
-
-	bool create(IDirect3DDevice9* pDevice, const char* text, D3DXCOLOR color = d3d::WHITE)
-	{
-		if (NULL == pDevice)
-			return false;
-
-		m_mtrl.Ambient = color;
-		m_mtrl.Diffuse = color;
-		m_mtrl.Specular = color;
-		m_mtrl.Emissive = d3d::BLACK;
-		m_mtrl.Power = 5.0f;
-
-		// 폰트 설정
-		HDC hdc = CreateCompatibleDC(0);
-		HFONT hFont;
-		HFONT hFontOld;
-		LOGFONT lf;
-		ZeroMemory(&lf, sizeof(LOGFONT));
-		lf.lfHeight = 25;
-		lf.lfWidth = 12;
-		lf.lfEscapement = 0;
-		lf.lfOrientation = 0;
-		lf.lfWeight = 500;
-		lf.lfItalic = false;
-		lf.lfUnderline = false;
-		lf.lfStrikeOut = false;
-		lf.lfCharSet = DEFAULT_CHARSET;
-		lf.lfOutPrecision = 0;
-		lf.lfClipPrecision = 0;
-		lf.lfQuality = 0;
-		lf.lfPitchAndFamily = 0;
-		lf.lfFaceName, TEXT("맑은고딕");
-		hFont = CreateFontIndirect(&lf);
-		hFontOld = (HFONT)SelectObject(hdc, hFont);
-
-		bool ret = FAILED(D3DXCreateText(pDevice, hdc, text, 0.01f, 0.2f, &m_pBoundMesh, NULL, NULL));
-		SelectObject(hdc, hFontOld);
-		DeleteObject(hFont);
-		DeleteObject(hdc);
-		return ret;
-	}
-	void destroy(void)
-	{
-		if (m_pBoundMesh != NULL) {
-			m_pBoundMesh->Release();
-			m_pBoundMesh = NULL;
-		}
-	}
-	void draw(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-	{
-		if (NULL == pDevice)
-			return;
-		pDevice->SetTransform(D3DTS_WORLD, &mWorld);
-		pDevice->MultiplyTransform(D3DTS_WORLD, &m_mLocal);
-		pDevice->SetMaterial(&m_mtrl);
-		m_pBoundMesh->DrawSubset(0);
-	}
-
-	// 텍스트 위치, 각도, 크기 설정
-	void setTransform(float x, float y, float z, float angle, float scale) {
-		D3DXMATRIX m;
-		m_scale = scale;
-		D3DXMatrixScaling(&m, scale, scale, scale);
-		setLocalTransform(m);
-		setRotation(angle);
-		setPosition(x, y, z);
-	}
-
-private:
-	void setLocalTransform(const D3DXMATRIX& mLocal) { m_mLocal = mLocal; }
-	void setPosition(float x, float y, float z)
-	{
-		D3DXMATRIX m;
-		this->m_x = x;
-		this->m_y = y;
-		this->m_z = z;
-
-		D3DXMatrixTranslation(&m, x, y, z);
-		m_mLocal *= m;
-	}
-
-	void setRotation(float angle) {
-		D3DXMATRIX m;
-		D3DXMatrixRotationX(&m, angle);
-		m_mLocal *= m;
-	}
-
-	D3DXMATRIX              m_mLocal;
-	D3DMATERIAL9            m_mtrl;
-	ID3DXMesh* m_pBoundMesh;
-};
-
-
-// -----------------------------------------------------------------------------
-// CLight class definition
-// -----------------------------------------------------------------------------
-
-class CLight {
-public:
-	CLight(void)
-	{
-		static DWORD i = 0;
-		m_index = i++;
-		D3DXMatrixIdentity(&m_mLocal);
-		::ZeroMemory(&m_lit, sizeof(m_lit));
-		m_pMesh = NULL;
-		m_bound._center = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
-		m_bound._radius = 0.0f;
-	}
-	~CLight(void) {}
-public:
-	bool create(IDirect3DDevice9* pDevice, const D3DLIGHT9& lit, float radius = 0.1f)
-	{
-		if (NULL == pDevice)
-			return false;
-		if (FAILED(D3DXCreateSphere(pDevice, radius, 10, 10, &m_pMesh, NULL)))
-			return false;
-
-		m_bound._center = lit.Position;
-		m_bound._radius = radius;
-
-		m_lit.Type = lit.Type;
-		m_lit.Diffuse = lit.Diffuse;
-		m_lit.Specular = lit.Specular;
-		m_lit.Ambient = lit.Ambient;
-		m_lit.Position = lit.Position;
-		m_lit.Direction = lit.Direction;
-		m_lit.Range = lit.Range;
-		m_lit.Falloff = lit.Falloff;
-		m_lit.Attenuation0 = lit.Attenuation0;
-		m_lit.Attenuation1 = lit.Attenuation1;
-		m_lit.Attenuation2 = lit.Attenuation2;
-		m_lit.Theta = lit.Theta;
-		m_lit.Phi = lit.Phi;
-		return true;
-	}
-	void destroy(void)
-	{
-		if (m_pMesh != NULL) {
-			m_pMesh->Release();
-			m_pMesh = NULL;
-		}
-	}
-	bool setLight(IDirect3DDevice9* pDevice, const D3DXMATRIX& mWorld)
-	{
-		if (NULL == pDevice)
-			return false;
-
-		D3DXVECTOR3 pos(m_bound._center);
-		D3DXVec3TransformCoord(&pos, &pos, &m_mLocal);
-		D3DXVec3TransformCoord(&pos, &pos, &mWorld);
-		m_lit.Position = pos;
-
-		pDevice->SetLight(m_index, &m_lit);
-		pDevice->LightEnable(m_index, TRUE);
-		return true;
-	}
-
-	void draw(IDirect3DDevice9* pDevice)
-	{
-		if (NULL == pDevice)
-			return;
-		D3DXMATRIX m;
-		D3DXMatrixTranslation(&m, m_lit.Position.x, m_lit.Position.y, m_lit.Position.z);
-		pDevice->SetTransform(D3DTS_WORLD, &m);
-		pDevice->SetMaterial(&d3d::WHITE_MTRL);
-		m_pMesh->DrawSubset(0);
-	}
-
-	D3DXVECTOR3 getPosition(void) const { return D3DXVECTOR3(m_lit.Position); }
-
-private:
-	DWORD               m_index;
-	D3DXMATRIX          m_mLocal;
-	D3DLIGHT9           m_lit;
-	ID3DXMesh* m_pMesh;
-	d3d::BoundingSphere m_bound;
-};
-
-
-// -----------------------------------------------------------------------------
-// Global variables
-// -----------------------------------------------------------------------------
-CWall	g_legoPlane;
-CWall	g_legowall[4];
-CSphere	g_sphere[4];
-CSphere	g_target_blueball;
-CLight	g_light;
-
-CPath path;				// 공이 움직일 경로
-bool isTarget = false;	// 마우스 우클릭 여부
-CStick stick;			// 당구채
-CText text1;			// 플레이어1 텍스트
-CText text2;			// 플레이어2 텍스트
-CText scoreText1;		// 플레이어1 점수 텍스트
-CText scoreText2;		// 점수 텍스트
-int score1 = 50;		// 플레이어1 점수 저장, 50점에서 시작
-int score2 = 50;		// 플레이어2 점수 저장, 50점에서 시작
-bool isNewTurn = false;								// 게임의 턴이 새로 돌아왔는지 저장
-bool isHit[4] = { false, false, false, false };		// 각 공의 충돌 여부 저장
-//bool isStopped[4] = { false, false, false, false };	// 각 공의 정지 여부 저장
-int currentPlayer = 1; //처음 시작은 Player1(흰공)
-int currentBall = 3; //시작 흰공(3), 다음 노란공(2)
-
-double g_camera_pos[3] = { 0.0, 5.0, -8.0 };
-
-// -----------------------------------------------------------------------------
-// Functions
-// -----------------------------------------------------------------------------
-
-
-void destroyAllLegoBlock(void)
-{
-}
-
-// initialization
-bool Setup()
-{
-	int i;
-
-	D3DXMatrixIdentity(&g_mWorld);
-	D3DXMatrixIdentity(&g_mView);
-	D3DXMatrixIdentity(&g_mProj);
-
-	// create plane and set the position
-	if (false == g_legoPlane.create(Device, -1, -1, 9, 0.03f, 6, d3d::GREEN)) return false;
-	g_legoPlane.setPosition(0.0f, -0.0006f / 5, 0.0f);
-
-	// create walls and set the position. note that there are four walls
-	if (false == g_legowall[0].create(Device, -1, -1, 9, 0.3f, 0.12f, d3d::DARKRED)) return false;
-	g_legowall[0].setPosition(0.0f, 0.12f, 3.06f);
-	if (false == g_legowall[1].create(Device, -1, -1, 9, 0.3f, 0.12f, d3d::DARKRED)) return false;
-	g_legowall[1].setPosition(0.0f, 0.12f, -3.06f);
-	if (false == g_legowall[2].create(Device, -1, -1, 0.12f, 0.3f, 6.24f, d3d::DARKRED)) return false;
-	g_legowall[2].setPosition(4.56f, 0.12f, 0.0f);
-	if (false == g_legowall[3].create(Device, -1, -1, 0.12f, 0.3f, 6.24f, d3d::DARKRED)) return false;
-	g_legowall[3].setPosition(-4.56f, 0.12f, 0.0f);
-
-	// create four balls and set the position
-	for (i = 0; i < 4; i++) {
-		if (false == g_sphere[i].create(Device, sphereColor[i])) return false;
-		g_sphere[i].setCenter(spherePos[i][0], (float)M_RADIUS, spherePos[i][1]);
-		g_sphere[i].setPower(0, 0);
-	}
-
-	// create blue ball for set direction
-	if (false == g_target_blueball.create(Device, d3d::BLUE)) return false;
-	g_target_blueball.setCenter(.0f, (float)M_RADIUS, .0f);
-
-	// 경로 생성
-	path.create(Device);
-	// 당구채 생성
-	stick.create(Device, 0.05f, 0.1f, 7);
-	// 텍스트 생성
-	text1.create(Device, "Score(Player1) : "); //플레이어1
-	text1.setTransform(-2, 0.2f, 3.7f, PI / 2, 0.5f);
-	text2.create(Device, "Score(Player2) : "); //플레이어2
-	text2.setTransform(-2, 0.2f, 3.2f, PI / 2, 0.5f);
-
-	// 점수 텍스트 생성
-	scoreText1.create(Device, std::to_string(score1).c_str()); //플레이어1
-	scoreText1.setTransform(2, 0.2f, 3.7f, PI / 2, 0.5f);
-	scoreText2.create(Device, std::to_string(score2).c_str()); //플레이어2
-	scoreText2.setTransform(2, 0.2f, 3.2f, PI / 2, 0.5f);
-
-	// light setting 
-	D3DLIGHT9 lit;
-	::ZeroMemory(&lit, sizeof(lit));
-	lit.Type = D3DLIGHT_POINT;
-	lit.Diffuse = d3d::WHITE;
-	lit.Specular = d3d::WHITE * 0.9f;
-	lit.Ambient = d3d::WHITE * 0.9f;
-	lit.Position = D3DXVECTOR3(0.0f, 3.0f, 0.0f);
-	lit.Range = 100.0f;
-	lit.Attenuation0 = 0.0f;
-	lit.Attenuation1 = 0.9f;
-	lit.Attenuation2 = 0.0f;
-	if (false == g_light.create(Device, lit))
-		return false;
-
-	// Position and aim the camera.
-	D3DXVECTOR3 pos(0.0f, 5.0f, -8.0f);
-	D3DXVECTOR3 target(0.0f, 0.0f, 0.0f);
-	D3DXVECTOR3 up(0.0f, 2.0f, 0.0f);
-	D3DXMatrixLookAtLH(&g_mView, &pos, &target, &up);
-	Device->SetTransform(D3DTS_VIEW, &g_mView);
-
-	// Set the projection matrix.
-	D3DXMatrixPerspectiveFovLH(&g_mProj, D3DX_PI / 4,
-		(float)Width / (float)Height, 1.0f, 100.0f);
-	Device->SetTransform(D3DTS_PROJECTION, &g_mProj);
-
-	// Set render states.
-	Device->SetRenderState(D3DRS_LIGHTING, TRUE);
-	Device->SetRenderState(D3DRS_SPECULARENABLE, TRUE);
-	Device->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
-
-	g_light.setLight(Device, g_mWorld);
-	return true;
-}
-
-void Cleanup(void)
-{
-	g_legoPlane.destroy();
-	for (int i = 0; i < 4; i++) {
-		g_legowall[i].destroy();
-	}
-	destroyAllLegoBlock();
-	g_light.destroy();
-}
-
-
-// timeDelta represents the time between the current image frame and the last image frame.
-// the distance of moving balls should be "velocity * timeDelta"
-bool Display(float timeDelta)
-{
-	int i = 0;
-	int j = 0;
-
-
-	if (Device)
-	{
-		Device->Clear(0, 0, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00afafaf, 1.0f, 0);
-		Device->BeginScene();
-
-		if (!isNewTurn && !g_sphere[currentBall].isStopped()) {
-			if (currentPlayer == 1) {
-				currentPlayer = 2;
-				currentBall = 2; //노란 공
-			}
-			else {
-				currentPlayer = 1;
-				currentBall = 3; //흰 공
-			}
-			isNewTurn = true;
-		}
-
-		// update the position of each ball. during update, check whether each ball hit by walls.
-		for (i = 0; i < 4; i++) {
-			g_sphere[i].ballUpdate(timeDelta);
-			for (j = 0; j < 4; j++) { g_legowall[i].hitBy(g_sphere[j]); }
-		}
-
-		// check whether any two balls hit together and update the direction of balls
-		for (i = 0; i < 4; i++) {
-			for (j = 0; j < 4; j++) {
-				if (i >= j) { continue; }
-				g_sphere[i].hitBy(g_sphere[j]);
-			}
-		}
-
-		for (i = 0; i < 4; i++) {
-			for (j = 0; j < 4; j++) {
-				if (i == j) { continue; }
-
-				if (!isHit[i] && g_sphere[i].hasIntersected(g_sphere[j]))
-					isHit[i] = true;
-			}
-			/*if (isNewTurn && abs(g_sphere[i].getVelocity_X()) < 0.01 && abs(g_sphere[i].getVelocity_Z()) < 0.01)
-				isStopped[i] = true;*/
-		}
-
-		if (isNewTurn && g_sphere[0].isStopped() && g_sphere[1].isStopped() && g_sphere[2].isStopped() && g_sphere[3].isStopped()) {
-			if (currentPlayer != 1)//하얀공이면(이전의 플레이어를 계산하는 방식)
-			{
-				if (!isHit[0] && !isHit[1] && !isHit[2])
-					score1 -= 10;				// 아무 공에도 맞지 않으면 점수 -10
-				else if (isHit[2])
-					score1 -= 10;				// 노란 공에 맞으면 점수 -10
-				else {
-					if (isHit[0] && isHit[1]) {
-						score1 += 10;			// 빨간 공 2개에 연달아 맞으면 점수 +10
-						if (score1 < 0) score1 = 0;
-					}
-					if ((isHit[0] && !isHit[1]) || (!isHit[0] && isHit[1])) {
-						score1 += 0;				// 빨간 공 하나만 맞으면 점수 +0
-					}
-				}
-			}
-			else if (currentPlayer != 2) {
-				if (!isHit[0] && !isHit[1] && !isHit[3])
-					score2 -= 10;				// 아무 공에도 맞지 않으면 점수 -10
-				else if (isHit[3])
-					score2 -= 10;				// 노란 공에 맞으면 점수 -10
-				else {
-					if (isHit[0] && isHit[1]) {
-						score2 += 10;			// 빨간 공 2개에 연달아 맞으면 점수 +10
-						if (score1 < 0) score1 = 0;
-					}
-					if ((isHit[0] && !isHit[1]) || (!isHit[0] && isHit[1])) {
-						score2 += 0;				// 빨간 공 하나만 맞으면 점수 +0
-					}
-				}
-			}
-			isNewTurn = false;
-			memset(isHit, false, 4);
-			//memset(isStopped, false, 4);
-
-		}
-
-		scoreText1.destroy();						// 기존 점수 텍스트 제거
-		scoreText1.create(Device, std::to_string(score1).c_str()); // 점수 텍스트 업데이트
-		scoreText2.destroy();						// 기존 점수 텍스트 제거
-		scoreText2.create(Device, std::to_string(score2).c_str()); // 점수 텍스트 업데이트
-
-		// draw plane, walls, and spheres
-		g_legoPlane.draw(Device, g_mWorld);
-		for (i = 0; i < 4; i++) {
-			g_legowall[i].draw(Device, g_mWorld);
-			g_sphere[i].draw(Device, g_mWorld);
-		}
-		g_target_blueball.draw(Device, g_mWorld);
-		//g_light.draw(Device);
-
-		if (stick.isMove()) {	// 당구채가 움직이는 중이라면
-			stick.stickUpdate(timeDelta);	// 당구채 이동
-			stick.hitBy(g_sphere[currentBall]);		// 흰 공과 충돌 검사
-			stick.draw(Device, g_mWorld);	// 당구채 그리기
-		}
-		else if (isTarget) {		// 당구채가 움직이지 않고 마우스 우클릭 중이라면
-			path.draw(Device, g_mWorld, g_sphere[currentBall].getCenter(), g_target_blueball.getCenter()); // 경로 그리기
-			stick.setTarget(g_sphere[currentBall].getCenter(), g_target_blueball.getCenter());		// 흰 공과 파란 공에 맞춰 당구채 위치, 각도 설정
-			stick.draw(Device, g_mWorld);				// 당구채 그리기
-		}
-
-		text1.draw(Device, g_mWorld);		// 텍스트 그리기
-		text2.draw(Device, g_mWorld);		// 텍스트 그리기
-		scoreText1.draw(Device, g_mWorld);	// 점수 텍스트 그리기
-		scoreText2.draw(Device, g_mWorld);	// 점수 텍스트 그리기
-
-		Device->EndScene();
-		Device->Present(0, 0, 0, 0);
-		Device->SetTexture(0, NULL);
-	}
-	return true;
-}
-
-LRESULT CALLBACK d3d::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
-{
-	static bool wire = false;
-	static bool isReset = true;
-	static int old_x = 0;
-	static int old_y = 0;
-	static enum { WORLD_MOVE, LIGHT_MOVE, BLOCK_MOVE } move = WORLD_MOVE;
-
-	switch (msg) {
-	case WM_DESTROY:
-	{
-		::PostQuitMessage(0);
-		break;
-	}
-	case WM_KEYDOWN:
-	{
-		switch (wParam) {
-		case VK_ESCAPE:
-			::DestroyWindow(hwnd);
-			break;
-		case VK_RETURN:
-			if (NULL != Device) {
-				wire = !wire;
-				Device->SetRenderState(D3DRS_FILLMODE,
-					(wire ? D3DFILL_WIREFRAME : D3DFILL_SOLID));
-			}
-			break;
-		case VK_SPACE:
-			// 마우스 우클릭 + 흰 공이 멈춰있을 때만
-			if (isTarget) {
-				isTarget = false; // 마우스 우클릭 해제
-
-				D3DXVECTOR3 targetpos = g_target_blueball.getCenter();
-				D3DXVECTOR3	whitepos = g_sphere[currentBall].getCenter();
-				double theta = acos(sqrt(pow(targetpos.x - whitepos.x, 2)) / sqrt(pow(targetpos.x - whitepos.x, 2) +
-					pow(targetpos.z - whitepos.z, 2)));		// 기본 1 사분면
-				if (targetpos.z - whitepos.z <= 0 && targetpos.x - whitepos.x >= 0) { theta = -theta; }	//4 사분면
-				if (targetpos.z - whitepos.z >= 0 && targetpos.x - whitepos.x <= 0) { theta = PI - theta; } //2 사분면
-				if (targetpos.z - whitepos.z <= 0 && targetpos.x - whitepos.x <= 0) { theta = PI + theta; } // 3 사분면
-				double distance = sqrt(pow(targetpos.x - whitepos.x, 2) + pow(targetpos.z - whitepos.z, 2));
-				//g_sphere[3].setPower(distance * cos(theta), distance * sin(theta));
-
-				stick.setPower(distance * cos(theta), distance * sin(theta));		// 당구채 움직임
-
-				for (int i = 0; i < 4; i++) {		// 공을 칠 때마다 isHit 배열 초기화
-					isHit[i] = false;
-				}
-
-			}
-			break;
-
-		}
-		break;
-	}
-
-	case WM_MOUSEMOVE:
-	{
-		int new_x = LOWORD(lParam);
-		int new_y = HIWORD(lParam);
-		float dx;
-		float dy;
-
-		if (LOWORD(wParam) & MK_LBUTTON) {
-
-			isTarget = false;		// 마우스 우클릭 해제
-
-			if (isReset) {
-				isReset = false;
-			}
-			else {
-				D3DXVECTOR3 vDist;
-				D3DXVECTOR3 vTrans;
-				D3DXMATRIX mTrans;
-				D3DXMATRIX mX;
-				D3DXMATRIX mY;
-
-				switch (move) {
-				case WORLD_MOVE:
-					dx = (old_x - new_x) * 0.01f;
-					dy = (old_y - new_y) * 0.01f;
-					D3DXMatrixRotationY(&mX, dx);
-					D3DXMatrixRotationX(&mY, dy);
-					g_mWorld = g_mWorld * mX * mY;
-
-					break;
-				}
-			}
-
-			old_x = new_x;
-			old_y = new_y;
-
-		}
-		else {
-			isReset = true;
-
-			isTarget = false;		// 마우스 우클릭 해제
-			if (LOWORD(wParam) & MK_RBUTTON) {
-				if (!stick.isMove() && !isNewTurn) {
-					isTarget = true;	// 흰 공과 당구채가 멈춰있을 때만 true
-				}
-
-				dx = (old_x - new_x);// * 0.01f;
-				dy = (old_y - new_y);// * 0.01f;
-
-				D3DXVECTOR3 coord3d = g_target_blueball.getCenter();
-				g_target_blueball.setCenter(coord3d.x + dx * (-0.007f), coord3d.y, coord3d.z + dy * 0.007f);
-			}
-			old_x = new_x;
-			old_y = new_y;
-
-			move = WORLD_MOVE;
-		}
-		break;
-	}
-	}
-
-	return ::DefWindowProc(hwnd, msg, wParam, lParam);
-}
-
-int WINAPI WinMain(HINSTANCE hinstance,
-	HINSTANCE prevInstance,
-	PSTR cmdLine,
-	int showCmd)
-{
-	srand(static_cast<unsigned int>(time(NULL)));
-
-	if (!d3d::InitD3D(hinstance,
-		Width, Height, true, D3DDEVTYPE_HAL, &Device))
-	{
-		::MessageBox(0, "InitD3D() - FAILED", 0, 0);
-		return 0;
-	}
-
-	if (!Setup())
-	{
-		::MessageBox(0, "Setup() - FAILED", 0, 0);
-		return 0;
-	}
-
-	d3d::EnterMsgLoop(Display);
-
-	Cleanup();
-
-	Device->Release();
-
-	return 0;
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: virtualLego.cpp
+//
+// Original Author: 박창현 Chang-hyeon Park, 
+// Modified by Bong-Soo Sohn and Dong-Jun Kim
+// 
+// Originally programmed for Virtual LEGO. 
+// Modified later to program for Virtual Billiard.
+//        
+////////////////////////////////////////////////////////////////////////////////
+
+#include "d3dUtility.h"
+#include "game.h"
+#include "levelFormat.h"
+#include "particles.h"
+#include "frameCapture.h"
+#include "eventLog.h"
+#include "metrics.h"
+#include "workerPool.h"
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <ctime>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <math.h>
+
+IDirect3DDevice9* Device = NULL;
+
+// window size
+const int Width = 1024;
+const int Height = 768;
+
+// There are four balls (레벨 파일이 없을 때의 4구 배치)
+// initialize the position (coordinate) of each ball (ball0 ~ ball3)
+const float spherePos[CAROM_BALLS][2] = { {-2.7f,0} , {+2.4f,0} , {3.3f,0} , {-2.7f,-0.9f} };
+// initialize the color of each ball (ball0 ~ ball3)
+const D3DXCOLOR sphereColor[CAROM_BALLS] = { d3d::RED, d3d::RED, d3d::YELLOW, d3d::WHITE };
+
+// -----------------------------------------------------------------------------
+// Transform matrices
+// -----------------------------------------------------------------------------
+Mat4 g_mWorld;
+
+#define M_RADIUS BALL_RADIUS   // ball radius
+#define PI 3.14159265
+#define M_HEIGHT 0.01
+#define LEVEL_FILE "levels/default.lvl"		// tools/levelconv 로 levels/default.txt 에서 만듦
+#define POCKET_HEIGHT 0.01f
+#define STICK_LENGTH 7.0f
+#define STICK_TIP_RADIUS 0.05f
+#define STICK_BUTT_RADIUS 0.1f
+#define SHOT_LOG_FILE "lastgame.shots"		// 창을 닫을 때 이번 게임의 샷, --render의 입력
+#define EVENT_LOG_FILE "lastgame.events"	// 이번 게임의 사건 기록, tools/eventlog2csv로 읽음
+#define FRAME_SPIKE_MS 33.3f				// 이보다 오래 걸린 프레임은 사건 기록에 남김
+#define RENDER_FPS 60				// --render 기본값
+#define RENDER_CHUNK 8				// 스레드가 한번에 가져가는 프레임
+#define RENDER_AIM_SECONDS 0.5f		// 치기 전에 조준을 보여주는 시간
+#define RENDER_END_SECONDS 1.0f		// 마지막 샷이 멈춘 뒤 남기는 시간
+#define RENDER_MAX_SHOT_SECONDS 120	// 샷 하나가 멈추지 않을 때 자르는 시간
+
+// -----------------------------------------------------------------------------
+// CRenderQueue class definition
+// -----------------------------------------------------------------------------
+
+// 한 프레임 동안 그릴 물체를 모아 (재질, 메쉬, 깊이) 순으로 정렬한 뒤 한번에 그림
+// 직전에 설정한 world 행렬과 재질을 기억해 두고 같은 값이면 장치 호출을 생략함
+class CRenderQueue {
+public:
+	struct Stats {
+		int items;				// 실제로 그린 물체 수
+		int culled;				// 시야 밖이라 제외된 물체 수
+		int materialSets;		// 실제 SetMaterial 호출 수
+		int materialSkips;		// 생략된 SetMaterial 호출 수
+		int transformSets;		// 실제 SetTransform 호출 수
+		int transformSkips;		// 생략된 SetTransform 호출 수
+	};
+
+	CRenderQueue(void)
+	{
+		ZeroMemory(&m_stats, sizeof(m_stats));
+		m_culled = 0;
+		m_items.reserve(128);
+		m_order.reserve(128);
+	}
+
+	// 프레임 시작 시 호출, view 행렬은 깊이 계산에 사용
+	// 모든 물체가 같은 mWorld(테이블 회전)를 쓰므로 절두체는 테이블 좌표계에서 만듦
+	void begin(const Mat4& mWorld, const Mat4& mView, const Mat4& mProj)
+	{
+		m_frustum.extract(d3d::toD3DX(mWorld * mView * mProj));
+
+		m_mView = mView;
+		m_items.clear();
+		m_order.clear();
+		m_culled = 0;
+	}
+
+	// bound는 테이블 좌표계 기준, 시야 밖이면 제출하지 않음
+	void submit(ID3DXMesh* pMesh, const D3DMATERIAL9& mtrl, const Mat4& mWorld, const Mat4& mLocal, const d3d::BoundingSphere& bound)
+	{
+		if (!m_frustum.isVisible(bound)) {
+			m_culled++;
+			return;
+		}
+		submit(pMesh, mtrl, mWorld, mLocal);
+	}
+	void submit(ID3DXMesh* pMesh, const D3DMATERIAL9& mtrl, const Mat4& mWorld, const Mat4& mLocal, const d3d::BoundingBox& bound)
+	{
+		if (!m_frustum.isVisible(bound)) {
+			m_culled++;
+			return;
+		}
+		submit(pMesh, mtrl, mWorld, mLocal);
+	}
+
+	// 최종 world 행렬(mLocal * mWorld)을 CPU에서 미리 계산해 저장
+	void submit(ID3DXMesh* pMesh, const D3DMATERIAL9& mtrl, const Mat4& mWorld, const Mat4& mLocal)
+	{
+		if (NULL == pMesh)
+			return;
+
+		Item item;
+		item.world = mLocal * mWorld;
+		item.pMesh = pMesh;
+		item.material = internMaterial(mtrl);
+
+		// view 공간에서의 z 값 (앞에 있는 물체부터 그리도록)
+		float depth = item.world.m[3][0] * m_mView.m[0][2] + item.world.m[3][1] * m_mView.m[1][2] + item.world.m[3][2] * m_mView.m[2][2] + m_mView.m[3][2];
+		if (depth < 0) depth = 0;
+		if (depth > 65535.0f) depth = 65535.0f;
+
+		unsigned long long key = 0;
+		key |= (unsigned long long)(item.material & 0xffff) << 48;
+		key |= (unsigned long long)(internMesh(pMesh) & 0xffff) << 32;
+		key |= (unsigned long long)(depth * 65536.0f);
+
+		m_order.push_back(SortEntry(key, (int)m_items.size()));
+		m_items.push_back(item);
+	}
+
+	// 정렬 후 그리기, 중복 상태 변경은 생략
+	void flush(IDirect3DDevice9* pDevice)
+	{
+		ZeroMemory(&m_stats, sizeof(m_stats));
+		if (NULL == pDevice)
+			return;
+
+		std::sort(m_order.begin(), m_order.end());
+
+		// 다른 코드가 장치 상태를 바꿨을 수 있으므로 매 프레임 캐시를 비움
+		bool worldValid = false;
+		int currentMaterial = -1;
+		Mat4 currentWorld;
+
+		for (size_t i = 0; i < m_order.size(); i++) {
+			const Item& item = m_items[m_order[i].second];
+
+			if (worldValid && 0 == memcmp(&currentWorld, &item.world, sizeof(Mat4))) {
+				m_stats.transformSkips++;
+			}
+			else {
+				pDevice->SetTransform(D3DTS_WORLD, &d3d::toD3DX(item.world));
+				currentWorld = item.world;
+				worldValid = true;
+				m_stats.transformSets++;
+			}
+
+			if (currentMaterial == item.material) {
+				m_stats.materialSkips++;
+			}
+			else {
+				pDevice->SetMaterial(&m_materials[item.material]);
+				currentMaterial = item.material;
+				m_stats.materialSets++;
+			}
+
+			item.pMesh->DrawSubset(0);
+		}
+		m_stats.items = (int)m_order.size();
+		m_stats.culled = m_culled;
+
+		m_items.clear();
+		m_order.clear();
+		m_meshes.clear();
+	}
+
+	const Stats& getStats(void) const { return m_stats; }
+
+private:
+	struct Item {
+		Mat4		world;
+		ID3DXMesh*	pMesh;
+		int			material;
+	};
+	typedef std::pair<unsigned long long, int> SortEntry;
+
+	// 값이 같은 재질은 같은 번호를 받음 (벽 4개가 같은 DARKRED 재질을 공유)
+	int internMaterial(const D3DMATERIAL9& mtrl)
+	{
+		for (size_t i = 0; i < m_materials.size(); i++) {
+			if (0 == memcmp(&m_materials[i], &mtrl, sizeof(D3DMATERIAL9)))
+				return (int)i;
+		}
+		m_materials.push_back(mtrl);
+		return (int)m_materials.size() - 1;
+	}
+
+	int internMesh(ID3DXMesh* pMesh)
+	{
+		for (size_t i = 0; i < m_meshes.size(); i++) {
+			if (m_meshes[i] == pMesh)
+				return (int)i;
+		}
+		m_meshes.push_back(pMesh);
+		return (int)m_meshes.size() - 1;
+	}
+
+	Mat4						m_mView;
+	d3d::Frustum				m_frustum;
+	int							m_culled;
+	std::vector<Item>			m_items;
+	std::vector<SortEntry>		m_order;
+	std::vector<D3DMATERIAL9>	m_materials;	// 프레임이 지나도 유지
+	std::vector<ID3DXMesh*>		m_meshes;		// 텍스트 메쉬는 매 프레임 새로 만들어지므로 프레임마다 비움
+	Stats						m_stats;
+};
+
+// -----------------------------------------------------------------------------
+// CTransform class definition
+// -----------------------------------------------------------------------------
+
+// 위치, 회전, 크기만 저장하고 행렬은 렌더러가 요청할 때, 값이 바뀐 경우에만 다시 만듦
+// 따라서 물리 갱신(ballUpdate, stickUpdate)은 4x4 행렬을 건드리지 않음
+class CTransform {
+public:
+	CTransform(void)
+	{
+		m_x = m_y = m_z = 0;
+		m_angleX = m_angleY = 0;
+		m_scale = 1;
+		m_dirty = true;
+	}
+
+	// 값이 같으면 아무것도 하지 않음, 위치만 바뀌면 행렬의 이동 줄만 고침
+	void setPosition(float x, float y, float z)
+	{
+		if (x == m_x && y == m_y && z == m_z)
+			return;
+		m_x = x;	m_y = y;	m_z = z;
+		if (!m_dirty) {
+			m_mLocal.m[3][0] = x;
+			m_mLocal.m[3][1] = y;
+			m_mLocal.m[3][2] = z;
+		}
+	}
+	void setRotationX(float angle)
+	{
+		if (angle != m_angleX) {
+			m_angleX = angle;
+			m_dirty = true;
+		}
+	}
+	void setRotationY(float angle)
+	{
+		if (angle != m_angleY) {
+			m_angleY = angle;
+			m_dirty = true;
+		}
+	}
+	void setScale(float scale)
+	{
+		if (scale != m_scale) {
+			m_scale = scale;
+			m_dirty = true;
+		}
+	}
+
+	// scale * rotationX * rotationY * translation
+	const Mat4& getMatrix(void) const
+	{
+		if (m_dirty) {
+			rebuild();
+			m_dirty = false;
+		}
+		return m_mLocal;
+	}
+
+private:
+	// 행렬 곱 대신 합성된 결과를 직접 계산
+	void rebuild(void) const
+	{
+		float cx = cosf(m_angleX), sx = sinf(m_angleX);
+		float cy = cosf(m_angleY), sy = sinf(m_angleY);
+		float s = m_scale;
+
+		m_mLocal = Mat4(s * cy,			0,			-s * sy,		0,
+						s * sx * sy,	s * cx,		s * sx * cy,	0,
+						s * cx * sy,	-s * sx,	s * cx * cy,	0,
+						m_x,			m_y,		m_z,			1);
+	}
+
+	float				m_x, m_y, m_z;
+	float				m_angleX;
+	float				m_angleY;
+	float				m_scale;
+	mutable bool		m_dirty;
+	mutable Mat4		m_mLocal;
+};
+
+// -----------------------------------------------------------------------------
+// CSphere class definition
+// -----------------------------------------------------------------------------
+
+class CSphere {
+private:
+	BallBody				m_body;		// CGame의 공 상태를 그릴 때마다 복사해 옴
+	float                   m_radius;
+
+public:
+	CSphere(void)
+	{
+		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+		ZeroMemory(&m_body, sizeof(m_body));
+		m_radius = 0;
+		m_pSphereMesh = NULL;
+	}
+	~CSphere(void) {}
+
+public:
+	bool create(IDirect3DDevice9* pDevice, D3DXCOLOR color = d3d::WHITE)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		m_mtrl.Ambient = color;
+		m_mtrl.Diffuse = color;
+		m_mtrl.Specular = color;
+		m_mtrl.Emissive = d3d::BLACK;
+		m_mtrl.Power = 5.0f;
+
+		if (FAILED(D3DXCreateSphere(pDevice, getRadius(), 50, 50, &m_pSphereMesh, NULL)))
+			return false;
+		return true;
+	}
+
+	void destroy(void)
+	{
+		if (m_pSphereMesh != NULL) {
+			m_pSphereMesh->Release();
+			m_pSphereMesh = NULL;
+		}
+	}
+
+	// alpha: 직전 물리 상태(0)와 현재 상태(1) 사이의 보간 비율
+	void draw(CRenderQueue& queue, const Mat4& mWorld, float alpha = 1.0f)
+	{
+		float x = m_body.prevX + (m_body.x - m_body.prevX) * alpha;
+		float z = m_body.prevZ + (m_body.z - m_body.prevZ) * alpha;
+		m_transform.setPosition(x, m_body.y, z);
+
+		d3d::BoundingSphere bound;
+		bound._center = D3DXVECTOR3(x, m_body.y, z);
+		bound._radius = getRadius();
+		queue.submit(m_pSphereMesh, m_mtrl, mWorld, m_transform.getMatrix(), bound);
+	}
+
+	float getPos_X() const { return m_body.x; }
+	float getPos_Y() const { return m_body.y; }
+	float getPos_Z() const { return m_body.z; }
+
+	// 이번 프레임에 그릴 물리 상태, 직전 위치까지 함께 받아 보간에 씀
+	void setBody(const BallBody& body)
+	{
+		m_body = body;
+	}
+
+	// 공을 바로 옮김 (보간하지 않음)
+	void setCenter(float x, float y, float z)
+	{
+		m_body.x = x;	m_body.y = y;	m_body.z = z;
+		m_body.prevX = x;	m_body.prevZ = z;
+		m_transform.setPosition(x, y, z);
+	}
+
+	float getRadius(void)  const { return (float)(M_RADIUS); }
+	const Mat4& getLocalTransform(void) const { return m_transform.getMatrix(); }
+	Vec3 getCenter(void) const { return Vec3(m_body.x, m_body.y, m_body.z); }
+
+private:
+	CTransform              m_transform;
+	D3DMATERIAL9            m_mtrl;
+	ID3DXMesh* m_pSphereMesh;
+
+};
+
+
+
+// -----------------------------------------------------------------------------
+// CWall class definition
+// -----------------------------------------------------------------------------
+
+class CWall {
+
+private:
+
+	WallBody				m_body;		// 위치와 크기, 충돌은 CGame이 같은 값으로 판정
+	float					m_height;
+
+public:
+	CWall(void)
+	{
+		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+		ZeroMemory(&m_body, sizeof(m_body));
+		m_height = 0;
+		m_pBoundMesh = NULL;
+	}
+	~CWall(void) {}
+public:
+	bool create(IDirect3DDevice9* pDevice, float ix, float iz, float iwidth, float iheight, float idepth, D3DXCOLOR color = d3d::WHITE)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		m_mtrl.Ambient = color;
+		m_mtrl.Diffuse = color;
+		m_mtrl.Specular = color;
+		m_mtrl.Emissive = d3d::BLACK;
+		m_mtrl.Power = 5.0f;
+
+		m_body.width = iwidth;
+		m_body.depth = idepth;
+		m_height = iheight;
+
+		if (FAILED(D3DXCreateBox(pDevice, iwidth, iheight, idepth, &m_pBoundMesh, NULL)))
+			return false;
+		return true;
+	}
+	void destroy(void)
+	{
+		if (m_pBoundMesh != NULL) {
+			m_pBoundMesh->Release();
+			m_pBoundMesh = NULL;
+		}
+	}
+	void draw(CRenderQueue& queue, const Mat4& mWorld)
+	{
+		queue.submit(m_pBoundMesh, m_mtrl, mWorld, m_transform.getMatrix(), m_bound);
+	}
+
+	void setPosition(float x, float y, float z)
+	{
+		this->m_body.x = x;
+		this->m_body.z = z;
+		m_transform.setPosition(x, y, z);
+
+		float w = m_body.width, d = m_body.depth;
+		m_bound._min = D3DXVECTOR3(x - w / 2, y - m_height / 2, z - d / 2);
+		m_bound._max = D3DXVECTOR3(x + w / 2, y + m_height / 2, z + d / 2);
+	}
+
+	float getHeight(void) const { return M_HEIGHT; }
+	const WallBody& getBody(void) const { return m_body; }
+
+
+
+private:
+	CTransform              m_transform;
+	d3d::BoundingBox        m_bound;		// 테이블 좌표계 기준 AABB
+	D3DMATERIAL9            m_mtrl;
+	ID3DXMesh* m_pBoundMesh;
+};
+
+// -----------------------------------------------------------------------------
+// CBricks class definition
+// -----------------------------------------------------------------------------
+
+// ARKANOID 벽돌: 배치와 충돌은 CGame의 CBrickField가 맡고, 여기서는 그리기만 담당
+#define BRICK_HEIGHT 0.3f
+
+class CBricks {
+public:
+	CBricks(void)
+	{
+		ZeroMemory(m_mtrl, sizeof(m_mtrl));
+		m_pBoxMesh = NULL;
+	}
+	~CBricks(void) {}
+
+	bool create(IDirect3DDevice9* pDevice, float cellWidth, float cellDepth)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		// 내구도 1, 2, 3 별 색상
+		const D3DXCOLOR colors[BRICK_MAX_HP] = { d3d::CYAN, d3d::MAGENTA, d3d::YELLOW };
+		for (int i = 0; i < BRICK_MAX_HP; i++) {
+			m_mtrl[i].Ambient = colors[i];
+			m_mtrl[i].Diffuse = colors[i];
+			m_mtrl[i].Specular = colors[i];
+			m_mtrl[i].Emissive = d3d::BLACK;
+			m_mtrl[i].Power = 5.0f;
+		}
+
+		// 모든 벽돌이 같은 메쉬를 공유, 사이 간격을 조금 둠
+		if (FAILED(D3DXCreateBox(pDevice, cellWidth * 0.92f, BRICK_HEIGHT, cellDepth * 0.92f, &m_pBoxMesh, NULL)))
+			return false;
+		return true;
+	}
+
+	void destroy(void)
+	{
+		if (m_pBoxMesh != NULL) {
+			m_pBoxMesh->Release();
+			m_pBoxMesh = NULL;
+		}
+	}
+
+	void draw(CRenderQueue& queue, const Mat4& mWorld, const CBrickField& field)
+	{
+		const float y = 0.12f;
+		const float halfW = field.getCellWidth() / 2;
+		const float halfD = field.getCellDepth() / 2;
+		d3d::BoundingBox bound;
+
+		field.forEachAlive([&](int col, int row, int hp) {
+			float x = field.getCenterX(col);
+			float z = field.getCenterZ(row);
+			Mat4 m = Mat4::translation(x, y, z);
+			bound._min = D3DXVECTOR3(x - halfW, y - BRICK_HEIGHT / 2, z - halfD);
+			bound._max = D3DXVECTOR3(x + halfW, y + BRICK_HEIGHT / 2, z + halfD);
+			queue.submit(m_pBoxMesh, m_mtrl[(hp > BRICK_MAX_HP ? BRICK_MAX_HP : hp) - 1], mWorld, m, bound);
+		});
+	}
+
+private:
+	D3DMATERIAL9            m_mtrl[BRICK_MAX_HP];
+	ID3DXMesh* m_pBoxMesh;
+};
+
+// -----------------------------------------------------------------------------
+// CPockets class definition
+// -----------------------------------------------------------------------------
+
+// 포켓볼의 포켓, 바닥 위에 얇은 검은 원판으로 그림
+class CPockets {
+public:
+	CPockets(void)
+	{
+		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+		ZeroMemory(m_pMesh, sizeof(m_pMesh));
+		m_count = 0;
+	}
+	~CPockets(void) {}
+
+	bool create(IDirect3DDevice9* pDevice, const CGame& game)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		m_mtrl.Ambient = d3d::BLACK;
+		m_mtrl.Diffuse = d3d::BLACK;
+		m_mtrl.Specular = d3d::BLACK;
+		m_mtrl.Emissive = d3d::BLACK;
+		m_mtrl.Power = 5.0f;
+
+		// 원기둥은 z축 방향으로 만들어지므로 x축으로 눕혀 세움, 윗면이 바닥보다 살짝 위
+		destroy();
+		m_count = game.getPocketCount();
+		for (int i = 0; i < m_count; i++) {
+			const Pocket& p = game.getPocket(i);
+			if (FAILED(D3DXCreateCylinder(pDevice, p.radius, p.radius, POCKET_HEIGHT, 24, 1, &m_pMesh[i], NULL)))
+				return false;
+			m_transform[i].setRotationX((float)PI / 2);
+			m_transform[i].setPosition(p.x, 0.015f, p.z);
+			m_bound[i]._center = D3DXVECTOR3(p.x, 0.015f, p.z);
+			m_bound[i]._radius = p.radius;
+		}
+		return true;
+	}
+
+	void destroy(void)
+	{
+		for (int i = 0; i < MAX_POCKETS; i++) {
+			if (m_pMesh[i] != NULL) {
+				m_pMesh[i]->Release();
+				m_pMesh[i] = NULL;
+			}
+		}
+		m_count = 0;
+	}
+
+	void draw(CRenderQueue& queue, const Mat4& mWorld)
+	{
+		for (int i = 0; i < m_count; i++)
+			queue.submit(m_pMesh[i], m_mtrl, mWorld, m_transform[i].getMatrix(), m_bound[i]);
+	}
+
+private:
+	D3DMATERIAL9            m_mtrl;
+	ID3DXMesh*				m_pMesh[MAX_POCKETS];
+	CTransform				m_transform[MAX_POCKETS];
+	d3d::BoundingSphere		m_bound[MAX_POCKETS];
+	int						m_count;
+};
+
+// 공이 움직일 경로 표시
+class CPath {
+private:
+	class CDot {
+	private:
+		float					center_x, center_y, center_z;
+		float                   m_radius;
+		float					m_velocity_x;
+		float					m_velocity_z;
+
+	public:
+		CDot(void)
+		{
+			ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+			m_radius = 0;
+			m_velocity_x = 0;
+			m_velocity_z = 0;
+			m_pSphereMesh = NULL;
+		}
+		~CDot(void) {}
+
+	public:
+		bool create(IDirect3DDevice9* pDevice, D3DXCOLOR color = d3d::WHITE)
+		{
+			if (NULL == pDevice)
+				return false;
+
+			m_mtrl.Ambient = color;
+			m_mtrl.Diffuse = color;
+			m_mtrl.Specular = color;
+			m_mtrl.Emissive = d3d::BLACK;
+			m_mtrl.Power = 5.0f;
+
+			if (FAILED(D3DXCreateSphere(pDevice, 0.05, 50, 50, &m_pSphereMesh, NULL)))
+				return false;
+			return true;
+		}
+
+		void destroy(void)
+		{
+			if (m_pSphereMesh != NULL) {
+				m_pSphereMesh->Release();
+				m_pSphereMesh = NULL;
+			}
+		}
+
+		void draw(CRenderQueue& queue, const Mat4& mWorld)
+		{
+			d3d::BoundingSphere bound;
+			bound._center = d3d::toD3DX(getCenter());
+			bound._radius = 0.05f;
+			queue.submit(m_pSphereMesh, m_mtrl, mWorld, m_transform.getMatrix(), bound);
+		}
+
+		void setCenter(float x, float y, float z)
+		{
+			center_x = x;	center_y = y;	center_z = z;
+			m_transform.setPosition(x, y, z);
+		}
+		const Mat4& getLocalTransform(void) const { return m_transform.getMatrix(); }
+		Vec3 getCenter(void) const { return Vec3(center_x, center_y, center_z); }
+
+	private:
+		CTransform              m_transform;
+		D3DMATERIAL9            m_mtrl;
+		ID3DXMesh* m_pSphereMesh;
+
+	};
+
+private:
+	CDot dots[60];
+	const float width = 9;
+	const float depth = 6.24f;
+public:
+	// 공 생성
+	void create(IDirect3DDevice9* pDevice) {
+		if (NULL == pDevice)
+			return;
+		for (int i = 0; i < 60; i++) {
+			dots[i].create(pDevice);
+		}
+	}
+	// startPos에서 endPos 방향으로 벽까지 0.2 간격으로 공을 그림
+	void draw(CRenderQueue& queue, const Mat4& mWorld, const Vec3& startPos, const Vec3& endPos) {
+		Vec3 direction = normalize(endPos - startPos) * 0.2f;
+		int i = 0;
+		Vec3 pos = startPos + direction;
+		while (i < 60 && pos.x > -width / 2 && pos.x < width / 2 && pos.z > -depth / 2 && pos.z < depth / 2) {
+			dots[i].setCenter(pos.x, pos.y, pos.z);
+			dots[i].draw(queue, mWorld);
+			pos += direction;
+			i++;
+		}
+	}
+};
+
+// 당구채
+class CStick {
+private:
+	StickBody m_body;	// 위치, 각도, 충돌용 캡슐 크기
+
+public:
+	CStick(void)
+	{
+		ZeroMemory(&m_body, sizeof(m_body));
+		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+		m_pBoundMesh = NULL;
+	}
+	~CStick(void) {}
+
+	bool create(IDirect3DDevice9* pDevice, float radius1, float radius2, float length, D3DXCOLOR color = d3d::WHITE) {
+		if (NULL == pDevice)
+			return false;
+
+		m_mtrl.Ambient = color;
+		m_mtrl.Diffuse = color;
+		m_mtrl.Specular = color;
+		m_mtrl.Emissive = d3d::BLACK;
+		m_mtrl.Power = 5.0f;
+
+		m_body.length = length;
+		// radius1이 radius2보다 크다면 두 값을 바꿈
+		if (radius2 < radius1) {
+			float temp = radius1;
+			radius1 = radius2;
+			radius2 = temp;
+		}
+		m_body.radius = radius2;		// 충돌용 캡슐은 굵은 쪽 끝 기준
+
+		if (FAILED(D3DXCreateCylinder(pDevice, radius1, radius2, length, 8, 3, &m_pBoundMesh, NULL)))
+			return false;
+		return true;
+	}
+	void destroy(void)
+	{
+		if (m_pBoundMesh != NULL) {
+			m_pBoundMesh->Release();
+			m_pBoundMesh = NULL;
+		}
+	}
+	// alpha: 직전 물리 상태(0)와 현재 상태(1) 사이의 보간 비율
+	void draw(CRenderQueue& queue, const Mat4& mWorld, float alpha = 1.0f)
+	{
+		float x = m_body.prevX + (m_body.x - m_body.prevX) * alpha;
+		float z = m_body.prevZ + (m_body.z - m_body.prevZ) * alpha;
+		m_transform.setPosition(x, m_body.y, z);
+
+		d3d::BoundingSphere bound;
+		bound._center = D3DXVECTOR3(x, m_body.y, z);
+		bound._radius = m_body.length / 2;
+		queue.submit(m_pBoundMesh, m_mtrl, mWorld, m_transform.getMatrix(), bound);
+	}
+	// 이번 프레임에 그릴 당구채 상태, 위치와 각도는 CGame이 정함
+	void setBody(const StickBody& body)
+	{
+		m_body = body;
+		m_transform.setRotationY(body.angle);
+	}
+
+	float getLength(void) const { return m_body.length; }
+	float getRadius(void) const { return m_body.radius; }	// 충돌용 캡슐 반지름
+	Vec3 getCenter(void) const { return Vec3(m_body.x, m_body.y, m_body.z); }
+
+private:
+	CTransform              m_transform;
+	D3DMATERIAL9            m_mtrl;
+	ID3DXMesh* m_pBoundMesh;
+};
+
+class CText {
+private:
+	float m_x;
+	float m_y;
+	float m_z;
+	float m_angle;
+	float m_scale;
+
+public:
+	CText(void)
+	{
+		m_scale = 1;
+		ZeroMemory(&m_mtrl, sizeof(m_mtrl));
+		m_pBoundMesh = NULL;
+	}
+	~CText(void) {}
+
+	bool create(IDirect3DDevice9* pDevice, const char* text, D3DXCOLOR color = d3d::WHITE)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		m_mtrl.Ambient = color;
+		m_mtrl.Diffuse = color;
+		m_mtrl.Specular = color;
+		m_mtrl.Emissive = d3d::BLACK;
+		m_mtrl.Power = 5.0f;
+
+		// 폰트 설정
+		HDC hdc = CreateCompatibleDC(0);
+		HFONT hFont;
+		HFONT hFontOld;
+		LOGFONT lf;
+		ZeroMemory(&lf, sizeof(LOGFONT));
+		lf.lfHeight = 25;
+		lf.lfWidth = 12;
+		lf.lfEscapement = 0;
+		lf.lfOrientation = 0;
+		lf.lfWeight = 500;
+		lf.lfItalic = false;
+		lf.lfUnderline = false;
+		lf.lfStrikeOut = false;
+		lf.lfCharSet = DEFAULT_CHARSET;
+		lf.lfOutPrecision = 0;
+		lf.lfClipPrecision = 0;
+		lf.lfQuality = 0;
+		lf.lfPitchAndFamily = 0;
+		lf.lfFaceName, TEXT("맑은고딕");
+		hFont = CreateFontIndirect(&lf);
+		hFontOld = (HFONT)SelectObject(hdc, hFont);
+
+		bool ret = FAILED(D3DXCreateText(pDevice, hdc, text, 0.01f, 0.2f, &m_pBoundMesh, NULL, NULL));
+		computeBound();
+		SelectObject(hdc, hFontOld);
+		DeleteObject(hFont);
+		DeleteObject(hdc);
+		return ret;
+	}
+	void destroy(void)
+	{
+		if (m_pBoundMesh != NULL) {
+			m_pBoundMesh->Release();
+			m_pBoundMesh = NULL;
+		}
+	}
+	void draw(CRenderQueue& queue, const Mat4& mWorld)
+	{
+		d3d::BoundingSphere bound;
+		bound._center = d3d::toD3DX(transformCoord(d3d::fromD3DX(m_localBound._center), m_transform.getMatrix()));
+		bound._radius = m_localBound._radius * m_scale;
+		queue.submit(m_pBoundMesh, m_mtrl, mWorld, m_transform.getMatrix(), bound);
+	}
+
+	// 텍스트 위치, 각도, 크기 설정
+	void setTransform(float x, float y, float z, float angle, float scale) {
+		m_scale = scale;
+		m_transform.setScale(scale);
+		setRotation(angle);
+		setPosition(x, y, z);
+	}
+
+private:
+	// 글자 메쉬의 정점으로 경계 구를 구함 (크기, 회전 적용 전)
+	void computeBound(void)
+	{
+		m_localBound._center = D3DXVECTOR3(0, 0, 0);
+		m_localBound._radius = 0;
+		if (NULL == m_pBoundMesh)
+			return;
+
+		void* pVertices = NULL;
+		if (FAILED(m_pBoundMesh->LockVertexBuffer(D3DLOCK_READONLY, &pVertices)))
+			return;
+		D3DXComputeBoundingSphere((D3DXVECTOR3*)pVertices, m_pBoundMesh->GetNumVertices(),
+			D3DXGetFVFVertexSize(m_pBoundMesh->GetFVF()), &m_localBound._center, &m_localBound._radius);
+		m_pBoundMesh->UnlockVertexBuffer();
+	}
+
+	void setPosition(float x, float y, float z)
+	{
+		this->m_x = x;
+		this->m_y = y;
+		this->m_z = z;
+		m_transform.setPosition(x, y, z);
+	}
+
+	void setRotation(float angle) {
+		m_angle = angle;
+		m_transform.setRotationX(angle);
+	}
+
+	d3d::BoundingSphere     m_localBound;
+
+	CTransform              m_transform;
+	D3DMATERIAL9            m_mtrl;
+	ID3DXMesh* m_pBoundMesh;
+};
+
+
+// -----------------------------------------------------------------------------
+// CParticleEmitter class definition
+// -----------------------------------------------------------------------------
+
+// 입자 풀 하나를 점 스프라이트로 그림, 에미터마다 DrawPrimitiveUP 한 번
+class CParticleEmitter {
+private:
+	struct Vertex {
+		float x, y, z;
+		D3DCOLOR color;
+	};
+	enum { FVF = D3DFVF_XYZ | D3DFVF_DIFFUSE };
+
+public:
+	CParticleEmitter(void)
+	{
+		m_pointSize = 0.05f;
+		m_gravity = 9.8f;
+		m_drag = 1.0f;
+	}
+	~CParticleEmitter(void) {}
+
+	// 정점 배열까지 미리 할당해서 게임 중에는 할당이 없음
+	bool create(int capacity, D3DXCOLOR color, float pointSize)
+	{
+		if (!m_pool.create(capacity))
+			return false;
+		m_vertices.resize(m_pool.getCapacity());
+		m_color = color;
+		m_pointSize = pointSize;
+		return true;
+	}
+	void destroy(void)
+	{
+		m_pool.destroy();
+		m_vertices.clear();
+	}
+
+	void emit(float x, float y, float z, float nx, float nz, int count, float speed, float life)
+	{
+		m_pool.emitBurst(x, y, z, nx, nz, count, speed, life);
+	}
+
+	void update(float timeDiff)
+	{
+		if (m_pool.getAliveCount() > 0)
+			m_pool.update(timeDiff, m_gravity, m_drag);
+	}
+
+	bool isActive(void) const { return m_pool.getAliveCount() > 0; }
+	int getAliveCount(void) const { return m_pool.getAliveCount(); }
+
+	// 입자는 테이블 좌표계에 있으므로 mWorld만 적용
+	void draw(IDirect3DDevice9* pDevice, const Mat4& mWorld)
+	{
+		if (NULL == pDevice || !isActive())
+			return;
+
+		int count = 0;
+		Vertex* v = &m_vertices[0];
+		const D3DXCOLOR& c = m_color;
+		m_pool.forEachAlive([&](float x, float y, float z, float life) {
+			v[count].x = x;
+			v[count].y = y;
+			v[count].z = z;
+			v[count].color = D3DCOLOR_ARGB((int)(life * 255), (int)(c.r * 255), (int)(c.g * 255), (int)(c.b * 255));
+			count++;
+		});
+
+		float minSize = 1.0f, scaleA = 0.0f, scaleC = 1.0f;
+		pDevice->SetTransform(D3DTS_WORLD, &d3d::toD3DX(mWorld));
+		pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+		pDevice->SetRenderState(D3DRS_POINTSPRITEENABLE, TRUE);
+		pDevice->SetRenderState(D3DRS_POINTSCALEENABLE, TRUE);
+		pDevice->SetRenderState(D3DRS_POINTSIZE, *(DWORD*)&m_pointSize);
+		pDevice->SetRenderState(D3DRS_POINTSIZE_MIN, *(DWORD*)&minSize);
+		pDevice->SetRenderState(D3DRS_POINTSCALE_A, *(DWORD*)&scaleA);
+		pDevice->SetRenderState(D3DRS_POINTSCALE_B, *(DWORD*)&scaleA);
+		pDevice->SetRenderState(D3DRS_POINTSCALE_C, *(DWORD*)&scaleC);
+		pDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
+		pDevice->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+		pDevice->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_ONE);
+		pDevice->SetRenderState(D3DRS_ZWRITEENABLE, FALSE);
+
+		pDevice->SetFVF(FVF);
+		pDevice->DrawPrimitiveUP(D3DPT_POINTLIST, count, v, sizeof(Vertex));
+
+		pDevice->SetRenderState(D3DRS_ZWRITEENABLE, TRUE);
+		pDevice->SetRenderState(D3DRS_ALPHABLENDENABLE, FALSE);
+		pDevice->SetRenderState(D3DRS_POINTSCALEENABLE, FALSE);
+		pDevice->SetRenderState(D3DRS_POINTSPRITEENABLE, FALSE);
+		pDevice->SetRenderState(D3DRS_LIGHTING, TRUE);
+	}
+
+private:
+	CParticlePool			m_pool;
+	std::vector<Vertex>		m_vertices;
+	D3DXCOLOR				m_color;
+	float					m_pointSize;
+	float					m_gravity;
+	float					m_drag;
+};
+
+
+// -----------------------------------------------------------------------------
+// CLight class definition
+// -----------------------------------------------------------------------------
+
+class CLight {
+public:
+	CLight(void)
+	{
+		static DWORD i = 0;
+		m_index = i++;
+		::ZeroMemory(&m_lit, sizeof(m_lit));
+		m_pMesh = NULL;
+		m_bound._center = D3DXVECTOR3(0.0f, 0.0f, 0.0f);
+		m_bound._radius = 0.0f;
+	}
+	~CLight(void) {}
+public:
+	bool create(IDirect3DDevice9* pDevice, const D3DLIGHT9& lit, float radius = 0.1f)
+	{
+		if (NULL == pDevice)
+			return false;
+		if (FAILED(D3DXCreateSphere(pDevice, radius, 10, 10, &m_pMesh, NULL)))
+			return false;
+
+		m_bound._center = lit.Position;
+		m_bound._radius = radius;
+
+		m_lit.Type = lit.Type;
+		m_lit.Diffuse = lit.Diffuse;
+		m_lit.Specular = lit.Specular;
+		m_lit.Ambient = lit.Ambient;
+		m_lit.Position = lit.Position;
+		m_lit.Direction = lit.Direction;
+		m_lit.Range = lit.Range;
+		m_lit.Falloff = lit.Falloff;
+		m_lit.Attenuation0 = lit.Attenuation0;
+		m_lit.Attenuation1 = lit.Attenuation1;
+		m_lit.Attenuation2 = lit.Attenuation2;
+		m_lit.Theta = lit.Theta;
+		m_lit.Phi = lit.Phi;
+		return true;
+	}
+	void destroy(void)
+	{
+		if (m_pMesh != NULL) {
+			m_pMesh->Release();
+			m_pMesh = NULL;
+		}
+	}
+	bool setLight(IDirect3DDevice9* pDevice, const Mat4& mWorld)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		Vec3 pos = transformCoord(transformCoord(d3d::fromD3DX(m_bound._center), m_mLocal), mWorld);
+		m_lit.Position = d3d::toD3DX(pos);
+
+		pDevice->SetLight(m_index, &m_lit);
+		pDevice->LightEnable(m_index, TRUE);
+		return true;
+	}
+
+	void draw(IDirect3DDevice9* pDevice)
+	{
+		if (NULL == pDevice)
+			return;
+		Mat4 m = Mat4::translation(m_lit.Position.x, m_lit.Position.y, m_lit.Position.z);
+		pDevice->SetTransform(D3DTS_WORLD, &d3d::toD3DX(m));
+		pDevice->SetMaterial(&d3d::WHITE_MTRL);
+		m_pMesh->DrawSubset(0);
+	}
+
+	Vec3 getPosition(void) const { return Vec3(m_lit.Position.x, m_lit.Position.y, m_lit.Position.z); }
+
+private:
+	DWORD               m_index;
+	Mat4                m_mLocal;
+	D3DLIGHT9           m_lit;
+	ID3DXMesh* m_pMesh;
+	d3d::BoundingSphere m_bound;
+};
+
+
+// -----------------------------------------------------------------------------
+// CScene class definition
+// -----------------------------------------------------------------------------
+
+// Display()가 그리는 테이블, 공, 당구채, 텍스트와 카메라
+// 창과 오프라인 렌더링의 장치마다 하나씩 만들고, CGame 상태를 받아 그리기만 함
+class CScene {
+public:
+	CScene(void)
+	{
+		m_wallCount = 0;
+	}
+	~CScene(void) {}
+
+	// pLevel이 NULL이면 기본 배치, game은 setupGame()으로 꾸민 상태
+	bool create(IDirect3DDevice9* pDevice, const CLevelFile* pLevel, const CGame& game, int width, int height)
+	{
+		if (NULL == pDevice)
+			return false;
+
+		if (pLevel != NULL) {
+			if (false == createLevel(pDevice, *pLevel)) return false;
+		}
+		else {
+			if (false == createDefaultTable(pDevice)) return false;
+		}
+		if (false == m_pockets.create(pDevice, game)) return false;
+
+		// create blue ball for set direction
+		if (false == m_target.create(pDevice, d3d::BLUE)) return false;
+		m_target.setCenter(.0f, (float)M_RADIUS, .0f);
+
+		// 경로 생성
+		m_path.create(pDevice);
+		// 당구채 생성
+		m_stick.create(pDevice, STICK_TIP_RADIUS, STICK_BUTT_RADIUS, STICK_LENGTH);
+		// 텍스트 생성
+		m_text1.create(pDevice, "Score(Player1) : "); //플레이어1
+		m_text1.setTransform(-2, 0.2f, 3.7f, PI / 2, 0.5f);
+		m_text2.create(pDevice, "Score(Player2) : "); //플레이어2
+		m_text2.setTransform(-2, 0.2f, 3.2f, PI / 2, 0.5f);
+
+		// 점수 텍스트 생성
+		prepareScore(pDevice, 1, game.getScore(1)); //플레이어1
+		prepareScore(pDevice, 2, game.getScore(2)); //플레이어2
+
+		// light setting 
+		D3DLIGHT9 lit;
+		::ZeroMemory(&lit, sizeof(lit));
+		lit.Type = D3DLIGHT_POINT;
+		lit.Diffuse = d3d::WHITE;
+		lit.Specular = d3d::WHITE * 0.9f;
+		lit.Ambient = d3d::WHITE * 0.9f;
+		lit.Position = D3DXVECTOR3(0.0f, 3.0f, 0.0f);
+		lit.Range = 100.0f;
+		lit.Attenuation0 = 0.0f;
+		lit.Attenuation1 = 0.9f;
+		lit.Attenuation2 = 0.0f;
+		if (false == m_light.create(pDevice, lit))
+			return false;
+
+		// Position and aim the camera.
+		Vec3 pos(0.0f, 5.0f, -8.0f);
+		Vec3 target(0.0f, 0.0f, 0.0f);
+		Vec3 up(0.0f, 2.0f, 0.0f);
+		m_mView = Mat4::lookAtLH(pos, target, up);
+		pDevice->SetTransform(D3DTS_VIEW, &d3d::toD3DX(m_mView));
+
+		// Set the projection matrix.
+		m_mProj = Mat4::perspectiveFovLH(D3DX_PI / 4,
+			(float)width / (float)height, 1.0f, 100.0f);
+		pDevice->SetTransform(D3DTS_PROJECTION, &d3d::toD3DX(m_mProj));
+
+		// Set render states.
+		pDevice->SetRenderState(D3DRS_LIGHTING, TRUE);
+		pDevice->SetRenderState(D3DRS_SPECULARENABLE, TRUE);
+		pDevice->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
+
+		m_light.setLight(pDevice, Mat4::identity());
+		return true;
+	}
+
+	void destroy(void)
+	{
+		m_plane.destroy();
+		for (int i = 0; i < m_wallCount; i++) {
+			m_walls[i].destroy();
+		}
+		for (size_t i = 0; i < m_spheres.size(); i++) {
+			m_spheres[i].destroy();
+		}
+		m_pockets.destroy();
+		m_bricks.destroy();
+		m_target.destroy();
+		m_stick.destroy();
+		m_text1.destroy();
+		m_text2.destroy();
+		for (int p = 0; p < 2; p++) {
+			for (std::map<int, CText>::iterator it = m_scoreTexts[p].begin(); it != m_scoreTexts[p].end(); ++it)
+				it->second.destroy();
+			m_scoreTexts[p].clear();
+		}
+		m_light.destroy();
+	}
+
+	// player의 점수 score를 그릴 텍스트 메쉬를 아직 없으면 만듦
+	// 글꼴과 메쉬를 만드므로 장치를 만든 스레드에서 draw()보다 먼저, draw()는 만들어 둔 것을 고르기만 함
+	void prepareScore(IDirect3DDevice9* pDevice, int player, int score)
+	{
+		std::map<int, CText>& texts = m_scoreTexts[player - 1];
+		if (texts.find(score) != texts.end())
+			return;
+		CText& text = texts[score];
+		text.create(pDevice, std::to_string(score).c_str());
+		text.setTransform(2, 0.2f, player == 1 ? 3.7f : 3.2f, PI / 2, 0.5f);
+	}
+
+	// BeginScene()과 EndScene() 사이에서, 입자 효과는 창에서만 생기므로 호출한 쪽이 그림
+	// alpha: 직전 물리 상태(0)와 현재 상태(1) 사이의 보간 비율
+	void draw(IDirect3DDevice9* pDevice, const CGame& game, const Mat4& mWorld, float alpha)
+	{
+		int i;
+
+		// 게임 상태를 그릴 물체에 옮김
+		for (i = 0; i < game.getBallCount(); i++)
+			m_spheres[game.getBallId(i)].setBody(game.getBall(i));
+		m_target.setCenter(game.getTargetX(), (float)M_RADIUS, game.getTargetZ());
+		m_stick.setBody(game.getStick());
+
+		// draw plane, walls, and spheres
+		m_queue.begin(mWorld, m_mView, m_mProj);
+		m_plane.draw(m_queue, mWorld);
+		for (i = 0; i < m_wallCount; i++) {
+			m_walls[i].draw(m_queue, mWorld);
+		}
+		m_pockets.draw(m_queue, mWorld);
+		for (i = 0; i < game.getBallCount(); i++) {
+			m_spheres[game.getBallId(i)].draw(m_queue, mWorld, alpha);
+		}
+		m_bricks.draw(m_queue, mWorld, game.getBricks());
+		m_target.draw(m_queue, mWorld);
+		//m_light.draw(pDevice);
+
+		if (game.isStickMoving()) {	// 당구채가 움직이는 중이라면
+			m_stick.draw(m_queue, mWorld, alpha);	// 당구채 그리기
+		}
+		else if (game.isAiming()) {		// 당구채가 움직이지 않고 마우스 우클릭 중이라면
+			m_path.draw(m_queue, mWorld, m_spheres[game.getBallId(game.getCurrentBall())].getCenter(), m_target.getCenter()); // 경로 그리기
+			m_stick.draw(m_queue, mWorld);				// 흰 공과 파란 공에 맞춰 놓인 당구채 그리기
+		}
+
+		m_text1.draw(m_queue, mWorld);		// 텍스트 그리기
+		m_text2.draw(m_queue, mWorld);		// 텍스트 그리기
+		// 점수 텍스트 그리기, prepareScore()로 만들어 둔 메쉬 중에서 고름
+		for (int p = 0; p < 2; p++) {
+			std::map<int, CText>::iterator it = m_scoreTexts[p].find(game.getScore(p + 1));
+			if (it != m_scoreTexts[p].end())
+				it->second.draw(m_queue, mWorld);
+		}
+
+		m_queue.flush(pDevice);				// 정렬 후 한번에 그리기
+	}
+
+	const CRenderQueue::Stats& getStats(void) const { return m_queue.getStats(); }
+
+private:
+	// 레벨 파일에서 테이블, 벽, 공, 벽돌을 그릴 물체로 만듦
+	// 파일은 메모리 맵으로 열려 있고 각 배열을 그대로 읽기만 함
+	bool createLevel(IDirect3DDevice9* pDevice, const CLevelFile& level)
+	{
+		const LevelHeader& h = level.getHeader();
+		const LevelMaterial* mtrl = level.getMaterials();
+		const LevelWall* walls = level.getWalls();
+		const LevelBall* balls = level.getBalls();
+		const LevelBricks* bricks = level.getBricks();
+		unsigned int i;
+
+		// 0번 벽은 테이블 바닥
+		const LevelWall& plane = walls[0];
+		const LevelMaterial& pm = mtrl[plane.material];
+		if (false == m_plane.create(pDevice, -1, -1, plane.width, plane.height, plane.depth, D3DXCOLOR(pm.r, pm.g, pm.b, pm.a))) return false;
+		m_plane.setPosition(plane.x, plane.y, plane.z);
+
+		m_wallCount = (int)h.wallCount - 1;
+		for (i = 1; i < h.wallCount; i++) {
+			const LevelWall& w = walls[i];
+			const LevelMaterial& m = mtrl[w.material];
+			if (false == m_walls[i - 1].create(pDevice, -1, -1, w.width, w.height, w.depth, D3DXCOLOR(m.r, m.g, m.b, m.a))) return false;
+			m_walls[i - 1].setPosition(w.x, w.y, w.z);
+		}
+
+		m_spheres.resize(h.ballCount);
+		for (i = 0; i < h.ballCount; i++) {
+			const LevelMaterial& m = mtrl[balls[i].material];
+			if (false == m_spheres[i].create(pDevice, D3DXCOLOR(m.r, m.g, m.b, m.a))) return false;
+		}
+
+		if (bricks != NULL) {
+			if (false == m_bricks.create(pDevice, bricks->cellWidth, bricks->cellDepth)) return false;
+		}
+		else {
+			if (false == m_bricks.create(pDevice, 0.6f, 0.4f)) return false;
+		}
+		return true;
+	}
+
+	// 레벨 파일이 없을 때의 기본 배치
+	bool createDefaultTable(IDirect3DDevice9* pDevice)
+	{
+		int i;
+
+		// create plane and set the position
+		if (false == m_plane.create(pDevice, -1, -1, DEFAULT_TABLE.width, 0.03f, DEFAULT_TABLE.depth, d3d::GREEN)) return false;
+		m_plane.setPosition(0.0f, -0.0006f / 5, 0.0f);
+
+		// create walls and set the position. note that there are four walls
+		m_wallCount = TABLE_CUSHIONS;
+		for (i = 0; i < TABLE_CUSHIONS; i++) {
+			const WallBody w = DEFAULT_TABLE.cushion(i);
+			if (false == m_walls[i].create(pDevice, -1, -1, w.width, DEFAULT_TABLE.cushionHeight, w.depth, d3d::DARKRED)) return false;
+			m_walls[i].setPosition(w.x, 0.12f, w.z);
+		}
+
+		// create bricks
+		if (false == m_bricks.create(pDevice, 0.6f, 0.4f)) return false;
+
+		// create four balls
+		m_spheres.resize(CAROM_BALLS);
+		for (i = 0; i < CAROM_BALLS; i++) {
+			if (false == m_spheres[i].create(pDevice, sphereColor[i])) return false;
+		}
+		return true;
+	}
+
+	CWall	m_plane;
+	CWall	m_walls[MAX_WALLS];
+	int		m_wallCount;
+	CBricks	m_bricks;		// ARKANOID 벽돌, B 키로 켜고 끔
+	std::vector<CSphere> m_spheres;	// 레벨의 공 순서 (CGame::getBallId()), 포켓에 빠진 공은 그리지 않음
+	CPockets m_pockets;
+	CSphere	m_target;		// 조준하는 파란 공
+	CLight	m_light;
+	CRenderQueue m_queue;	// 프레임마다 그릴 물체를 모아 정렬
+
+	CPath	m_path;			// 공이 움직일 경로
+	CStick	m_stick;		// 당구채
+	CText	m_text1;		// 플레이어1 텍스트
+	CText	m_text2;		// 플레이어2 텍스트
+	std::map<int, CText>	m_scoreTexts[2];	// 플레이어별, 점수마다 한 번 만든 텍스트
+
+	Mat4	m_mView;
+	Mat4	m_mProj;
+};
+
+
+// -----------------------------------------------------------------------------
+// Global variables
+// -----------------------------------------------------------------------------
+CGame	g_game;			// 공, 벽, 벽돌, 당구채, 턴과 점수, g_scene은 이 상태를 그리기만 함
+CScene	g_scene;		// 창의 장치에 만든 그릴 물체
+CParticleEmitter g_sparks;		// 공, 벽 충돌 효과
+CParticleEmitter g_debris;		// 벽돌이 깨질 때 효과
+CFrameCapture g_capture;		// V 키로 녹화, capture0.raw, capture1.raw, ...
+std::string g_shotLog;			// 이번 게임의 샷과 B 키, 끝날 때 SHOT_LOG_FILE로 저장
+CEventLog g_eventLog;			// 샷, 충돌, 턴, 점수, 프레임 지연을 EVENT_LOG_FILE로
+
+bool g_sceneDirty = true;	// 입력, 카메라 회전 등으로 화면을 다시 그려야 하는지 저장
+const char* g_levelFile = LEVEL_FILE;	// 명령줄 인자로 다른 레벨 (예: levels/pool.lvl)
+
+double g_camera_pos[3] = { 0.0, 5.0, -8.0 };
+
+// -----------------------------------------------------------------------------
+// Functions
+// -----------------------------------------------------------------------------
+
+
+void destroyAllLegoBlock(void)
+{
+}
+
+// 게임에서 일어난 충돌을 입자 효과로 보여줌
+class CImpactEffects : public CGameListener {
+public:
+	void onImpact(const Contact& contact)
+	{
+		// 약한 충돌은 효과 없음, 세게 부딪힐수록 많이
+		int count = (int)(contact.speed * 12);
+		if (count < 2)
+			return;
+		if (count > 48)
+			count = 48;
+		g_sparks.emit(contact.x, (float)M_RADIUS, contact.z, contact.normalX, contact.normalZ, count,
+			0.6f + contact.speed * 0.5f, 0.35f);
+	}
+
+	void onBrickBroken(float x, float z, float normalX, float normalZ)
+	{
+		g_debris.emit(x, 0.12f, z, normalX, normalZ, 64, 1.5f, 0.6f);
+	}
+};
+
+CImpactEffects g_effects;
+CEventLogListener g_gameEvents;		// 기록하고 g_effects로 넘김
+
+// 그리기 쪽 지표, 게임 쪽은 GameMetrics로 CGame이 직접 올림
+struct FrameMetrics {
+	CCounter*	frames;
+	CHistogram*	frameMs;			// Display() 사이 시간
+	CHistogram*	simulateMs;			// advance()
+	CHistogram*	drawMs;				// Clear부터 Present까지 CPU 시간
+	CGauge*		drawnItems;			// 렌더 큐가 그린 물체
+	CGauge*		culledItems;
+	CCounter*	stateSets;			// SetMaterial, SetTransform 호출
+	CCounter*	stateSkips;			// 같은 값이라 생략한 호출
+	CGauge*		particles;			// 살아 있는 불꽃과 파편
+	CGauge*		captureDropped;		// 이번 녹화에서 버린 프레임
+};
+
+// http://127.0.0.1:METRICS_PORT/metrics, 포트를 잡지 못하면 (창을 두 개 띄움 등) 내보내지만 않음
+CMetrics g_metrics;
+GameMetrics g_gameMetrics;
+FrameMetrics g_frameMetrics;
+CMetricsServer g_metricsServer;
+
+bool registerFrameMetrics(CMetrics& metrics, FrameMetrics& m)
+{
+	static const double msBounds[] = { 1, 2, 4, 8, 12, 16.7, 20, 25, 33.3, 50, 100, 250 };
+	static const double shortBounds[] = { 0.05, 0.1, 0.25, 0.5, 1, 2, 4, 8, 16.7 };
+	const int msCount = (int)(sizeof(msBounds) / sizeof(msBounds[0]));
+	const int shortCount = (int)(sizeof(shortBounds) / sizeof(shortBounds[0]));
+	m.frames = metrics.addCounter("vlego_frames_total", "Frames drawn.");
+	m.frameMs = metrics.addHistogram("vlego_frame_ms", "Time between drawn frames.", msBounds, msCount);
+	m.simulateMs = metrics.addHistogram("vlego_simulate_ms", "Physics time per frame (CGame::advance).", shortBounds, shortCount);
+	m.drawMs = metrics.addHistogram("vlego_draw_ms", "CPU time from Clear to Present.", shortBounds, shortCount);
+	m.drawnItems = metrics.addGauge("vlego_render_items", "Objects drawn in the last frame.");
+	m.culledItems = metrics.addGauge("vlego_render_culled_items", "Objects outside the view in the last frame.");
+	m.stateSets = metrics.addCounter("vlego_render_state_sets_total", "SetMaterial and SetTransform calls made.");
+	m.stateSkips = metrics.addCounter("vlego_render_state_skips_total", "SetMaterial and SetTransform calls skipped as redundant.");
+	m.particles = metrics.addGauge("vlego_particles", "Live spark and debris particles.");
+	m.captureDropped = metrics.addGauge("vlego_capture_dropped_frames", "Frames dropped by the current or last recording.");
+	return m.frames != NULL && m.frameMs != NULL && m.simulateMs != NULL && m.drawMs != NULL &&
+		m.drawnItems != NULL && m.culledItems != NULL && m.stateSets != NULL && m.stateSkips != NULL &&
+		m.particles != NULL && m.captureDropped != NULL;
+}
+
+// 공이나 당구채, 효과가 움직이는 중이면 true
+// 녹화 중에는 멈춘 장면도 계속 그려서 영상이 끊기지 않게 함
+bool isSceneAnimating(void)
+{
+	return g_game.isAnimating() || g_sparks.isActive() || g_debris.isActive() || g_capture.isRecording();
+}
+
+// 렌더 큐가 생략한 상태 변경 수를 일정 프레임마다 디버그 출력으로 보고
+void reportRenderStats(const CRenderQueue::Stats& stats)
+{
+	static int frame = 0;
+	if (++frame % 120 != 0)
+		return;
+
+	char buf[256];
+	sprintf_s(buf, sizeof(buf), "[render] submitted %d, culled %d | SetMaterial %d (saved %d) | SetTransform %d (saved %d)\n",
+		stats.items, stats.culled, stats.materialSets, stats.materialSkips, stats.transformSets, stats.transformSkips);
+	OutputDebugStringA(buf);
+}
+
+// 녹화를 켜고 끔, 끌 때 버린 프레임과 지연을 디버그 출력으로 보고
+void toggleCapture(void)
+{
+	static int take = 0;
+	char buf[256];
+	if (!g_capture.isRecording()) {
+		sprintf_s(buf, sizeof(buf), "capture%d.raw", take);
+		if (g_capture.start(Device, buf)) {
+			take++;
+			sprintf_s(buf, sizeof(buf), "[capture] recording capture%d.raw, %dx%d bgr0 at %d fps\n",
+				take - 1, g_capture.getWriter().getWidth(), g_capture.getWriter().getHeight(), CAPTURE_FPS);
+		}
+		else
+			sprintf_s(buf, sizeof(buf), "[capture] cannot start recording\n");
+		OutputDebugStringA(buf);
+		return;
+	}
+
+	g_capture.stop();
+	const CFrameCapture::Stats& s = g_capture.getStats();
+	CFrameWriter::Stats w = g_capture.getWriter().getStats();
+	sprintf_s(buf, sizeof(buf),
+		"[capture] frames %lld, copied %lld, written %lld | dropped ring %lld, writer %lld | "
+		"latency %.1f frames (worst %d) | cpu %.1f us/frame (worst %.1f) | write %.1f ms/frame (worst %.1f)\n",
+		s.frames, s.copied, w.framesWritten, s.droppedRing, s.droppedWriter,
+		s.copied > 0 ? (double)s.latencyFrames / s.copied : 0.0, s.worstLatencyFrames,
+		s.frames > 0 ? s.cpuSeconds / s.frames * 1e6 : 0.0, s.worstCpuSeconds * 1e6,
+		w.framesWritten > 0 ? w.writeSeconds / w.framesWritten * 1e3 : 0.0, w.worstWriteSeconds * 1e3);
+	OutputDebugStringA(buf);
+}
+
+// 4구는 공 4개, 포켓볼은 수구와 공 하나 이상, 벽은 MAX_WALLS 개, 포켓은 MAX_POCKETS 개까지만 지원
+bool isSupportedLevel(const CLevelFile& level)
+{
+	const LevelHeader& h = level.getHeader();
+	bool balls = level.getRules().mode == LEVEL_MODE_POOL ? h.ballCount >= 2 : h.ballCount == CAROM_BALLS;
+	return balls && h.wallCount - 1 <= MAX_WALLS && h.pocketCount <= MAX_POCKETS;
+}
+
+// 충돌, 턴, 점수에 쓰는 배치와 규칙을 게임 상태로, pLevel이 NULL이면 기본 배치
+// 창과 오프라인 렌더링이 같이 써서 같은 샷이 같은 결과를 냄
+bool setupGame(CGame& game, const CLevelFile* pLevel)
+{
+	if (pLevel != NULL) {
+		if (false == game.loadLevel(*pLevel)) return false;
+	}
+	else {
+		int i;
+		game.clearWalls();
+		for (i = 0; i < TABLE_CUSHIONS; i++) {
+			const WallBody w = DEFAULT_TABLE.cushion(i);
+			game.addWall(w.x, w.z, w.width, w.depth);
+		}
+		game.createBricks(12, 4, -3.6f, 1.0f, 0.6f, 0.4f);
+		game.setBallCount(CAROM_BALLS);
+		game.clearPockets();
+		for (i = 0; i < CAROM_BALLS; i++)
+			game.setBall(i, spherePos[i][0], spherePos[i][1]);
+	}
+	// 충돌용 캡슐은 굵은 쪽 끝 기준
+	game.setStick(STICK_LENGTH, STICK_BUTT_RADIUS);
+	return true;
+}
+
+// 친 샷을 서버와 같은 줄 형식으로 기록, 목표는 %a로 적어 다시 읽어도 같은 float
+void logShot(void)
+{
+	char buf[128];
+	sprintf_s(buf, sizeof(buf), "shot %a %a %d %d\n", g_game.getTargetX(), g_game.getTargetZ(),
+		(int)floorf(g_game.getTipSide() / TIP_STEP + 0.5f), (int)floorf(g_game.getTipHeight() / TIP_STEP + 0.5f));
+	g_shotLog += buf;
+}
+
+// 무른 샷과 그 뒤의 입력을 기록에서 지움
+void unlogShot(void)
+{
+	size_t pos = g_shotLog.rfind("shot ");
+	if (pos != std::string::npos)
+		g_shotLog.erase(pos);
+}
+
+// initialization
+bool Setup()
+{
+	g_mWorld = Mat4::identity();
+
+	// 레벨 파일이 있으면 그 배치를, 없으면 기본 배치를 사용
+	CLevelFile level;
+	const CLevelFile* pLevel = NULL;
+	if (level.open(g_levelFile) && isSupportedLevel(level))
+		pLevel = &level;
+	if (false == setupGame(g_game, pLevel)) return false;
+	if (false == g_scene.create(Device, pLevel, g_game, Width, Height)) return false;
+	level.close();
+
+	// 사건 기록은 파일을 열지 못해도 게임에는 상관없음
+	g_eventLog.start(EVENT_LOG_FILE);
+	g_gameEvents.attach(&g_eventLog, &g_effects);
+	g_game.setListener(&g_gameEvents);
+	g_game.enableHistory(HISTORY_SLOTS, HISTORY_INTERVAL);
+
+	if (false == registerGameMetrics(g_metrics, g_gameMetrics)) return false;
+	if (false == registerFrameMetrics(g_metrics, g_frameMetrics)) return false;
+	g_game.setMetrics(&g_gameMetrics);
+	g_metricsServer.start(g_metrics);
+
+	// 충돌 효과
+	if (false == g_sparks.create(2048, d3d::WHITE, 0.04f)) return false;
+	if (false == g_debris.create(4096, d3d::CYAN, 0.06f)) return false;
+	return true;
+}
+
+void Cleanup(void)
+{
+	g_metricsServer.stop();
+	g_capture.stop();
+	if (g_eventLog.isRunning()) {
+		g_eventLog.stop();
+		CEventLog::Stats s = g_eventLog.getStats();
+		char buf[256];
+		sprintf_s(buf, sizeof(buf), "[events] logged %lld, dropped %lld, written %lld | flush %.2f ms (worst %.2f)\n",
+			s.logged, s.dropped, s.written, s.flushSeconds * 1e3, s.worstFlushSeconds * 1e3);
+		OutputDebugStringA(buf);
+	}
+	g_scene.destroy();
+	g_sparks.destroy();
+	g_debris.destroy();
+	destroyAllLegoBlock();
+
+	// 다음에 --render로 영상을 만들 수 있게 이번 게임의 샷을 남김
+	if (!g_shotLog.empty()) {
+		FILE* fp = fopen(SHOT_LOG_FILE, "w");
+		if (fp != NULL) {
+			fputs(g_shotLog.c_str(), fp);
+			fclose(fp);
+		}
+	}
+}
+
+
+// timeDelta represents the time between the current image frame and the last image frame.
+// the distance of moving balls should be "velocity * timeDelta"
+bool Display(float timeDelta)
+{
+	// 움직이는 것도 없고 입력도 없으면 다시 그리지 않음, 메시지 루프가 대기 상태로 들어감
+	if (!g_sceneDirty && !isSceneAnimating()) {
+		g_game.resetClock();
+		return false;
+	}
+
+	// timeDelta는 ms * 0.0007
+	float frameMs = timeDelta / 0.0007f;
+	if (frameMs > FRAME_SPIKE_MS)
+		g_eventLog.log(EVENT_FRAME_SPIKE, 0, 0, frameMs, FRAME_SPIKE_MS);
+
+	// 물리는 고정 간격으로 진행하고, 남은 시간 비율(alpha)만큼 이전/현재 상태를 보간해서 그림
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	float alpha = g_game.advance(timeDelta);
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	g_sparks.update(timeDelta);
+	g_debris.update(timeDelta);
+
+	const FrameMetrics& m = g_frameMetrics;
+	m.frames->add();
+	m.frameMs->observe(frameMs);
+	m.simulateMs->observe(std::chrono::duration<double, std::milli>(t1 - t0).count());
+	m.particles->set(g_sparks.getAliveCount() + g_debris.getAliveCount());
+
+	if (Device)
+	{
+		t0 = std::chrono::steady_clock::now();
+		Device->Clear(0, 0, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00afafaf, 1.0f, 0);
+		Device->BeginScene();
+
+		g_scene.prepareScore(Device, 1, g_game.getScore(1));
+		g_scene.prepareScore(Device, 2, g_game.getScore(2));
+		g_scene.draw(Device, g_game, g_mWorld, alpha);
+		g_sparks.draw(Device, g_mWorld);			// 반투명 효과는 불투명 물체 다음에
+		g_debris.draw(Device, g_mWorld);
+		reportRenderStats(g_scene.getStats());
+
+		Device->EndScene();
+		g_capture.onFrame();		// 백 버퍼를 GPU에서 복사만 하고, 끝난 이전 복사본을 읽음
+		Device->Present(0, 0, 0, 0);
+		Device->SetTexture(0, NULL);
+
+		const CRenderQueue::Stats& r = g_scene.getStats();
+		m.drawMs->observe(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+		m.drawnItems->set(r.items);
+		m.culledItems->set(r.culled);
+		m.stateSets->add((uint64_t)(r.materialSets + r.transformSets));
+		m.stateSkips->add((uint64_t)(r.materialSkips + r.transformSkips));
+		if (g_capture.isRecording()) {
+			const CFrameCapture::Stats& c = g_capture.getStats();
+			m.captureDropped->set((double)(c.droppedRing + c.droppedWriter));
+		}
+	}
+	g_sceneDirty = false;
+	return isSceneAnimating();
+}
+
+// -----------------------------------------------------------------------------
+// Offline rendering
+// -----------------------------------------------------------------------------
+
+// --render로 샷 기록을 영상으로 만들 때의 설정
+struct RenderOptions {
+	const char*	pShots;			// SHOT_LOG_FILE 형식의 샷 기록
+	const char*	pOut;			// 번호 (%d, %0Nd)가 있으면 TGA 연속, 아니면 raw 영상 (CFrameWriter)
+	int			width, height;
+	int			fps;
+	int			threads;		// 장치와 스레드 수, 0이면 코어 수
+};
+
+// 샷 기록 한 줄
+struct ReplayCommand {
+	bool	bricks;				// B 키, 아니면 샷
+	float	targetX, targetZ;
+	int		tipRight, tipUp;
+};
+
+bool loadShots(const char* path, std::vector<ReplayCommand>& commands)
+{
+	FILE* fp = fopen(path, "r");
+	if (fp == NULL)
+		return false;
+	char line[256];
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		ReplayCommand c = { false, 0, 0, 0, 0 };
+		if (strncmp(line, "bricks", 6) == 0)
+			c.bricks = true;
+		else if (sscanf(line, "shot %f %f %d %d", &c.targetX, &c.targetZ, &c.tipRight, &c.tipUp) != 4)
+			continue;
+		commands.push_back(c);
+	}
+	fclose(fp);
+	return true;
+}
+
+// 창에서처럼 조준, 치기, 멈출 때까지를 1/fps 간격으로 진행하고 프레임마다 게임 상태를 압축해 모음
+// 물리는 창과 같은 고정 간격이므로 같은 샷은 같은 결과, 프레임 간격은 보간 비율(alpha)로만 나타남
+void simulateReplay(CGame& game, const std::vector<ReplayCommand>& commands, int fps,
+	std::vector<unsigned char>& frames, std::vector<float>& alphas, size_t frameSize)
+{
+	const float timeDelta = 0.7f / fps;		// Display()의 timeDelta와 같은 단위 (ms * 0.0007)
+	auto addFrame = [&](float alpha) {
+		frames.resize(frames.size() + frameSize);
+		game.saveCompact(&frames[frames.size() - frameSize]);
+		alphas.push_back(alpha);
+	};
+
+	for (size_t i = 0; i < commands.size(); i++) {
+		const ReplayCommand& c = commands[i];
+		if (c.bricks) {
+			game.toggleBricks();
+			continue;
+		}
+		game.moveTip(c.tipRight - (int)floorf(game.getTipSide() / TIP_STEP + 0.5f),
+			c.tipUp - (int)floorf(game.getTipHeight() / TIP_STEP + 0.5f));
+		game.aimAt(c.targetX, c.targetZ);
+		// 치기 전에 조준한 경로와 당구채를 잠시 보여줌
+		for (int f = 0; f < (int)(RENDER_AIM_SECONDS * fps); f++)
+			addFrame(1.0f);
+		if (!game.strike())
+			continue;
+		game.resetClock();
+		for (int f = 0; f < RENDER_MAX_SHOT_SECONDS * fps && game.isAnimating(); f++)
+			addFrame(game.advance(timeDelta));
+	}
+	for (int f = 0; f < (int)(RENDER_END_SECONDS * fps); f++)
+		addFrame(1.0f);
+}
+
+// 스레드 하나가 쓰는 장치, 게임 상태, 그릴 물체와 렌더 타깃
+// 장치는 D3DCREATE_MULTITHREADED 없이 만들므로, 이 스레드에서 만들고 지우는 것 말고는 작업 스레드 하나만 씀
+struct RenderWorker {
+	HWND				window;			// 장치의 숨은 창, 만든 스레드에서 없앰
+	IDirect3DDevice9*	pDevice;
+	IDirect3DSurface9*	pTarget;		// 출력 크기의 렌더 타깃
+	IDirect3DSurface9*	pDepth;
+	IDirect3DSurface9*	pReadback;		// 시스템 메모리
+	CGame				game;			// restoreCompact()로 프레임마다 상태만 바꿈
+	CScene				scene;
+	int					frames;
+};
+
+// scores: 플레이어별로 기록에 나오는 점수, 점수 텍스트를 모두 여기서 만들어 둠
+bool createRenderWorker(HINSTANCE hinstance, RenderWorker& w, const CLevelFile* pLevel, const RenderOptions& opt,
+	const std::vector<int> (&scores)[2])
+{
+	if (!d3d::InitOffscreenD3D(hinstance, D3DDEVTYPE_HAL, &w.pDevice, &w.window))
+		return false;
+	if (FAILED(w.pDevice->CreateRenderTarget(opt.width, opt.height, D3DFMT_X8R8G8B8,
+		D3DMULTISAMPLE_NONE, 0, FALSE, &w.pTarget, NULL)))
+		return false;
+	if (FAILED(w.pDevice->CreateDepthStencilSurface(opt.width, opt.height, D3DFMT_D24S8,
+		D3DMULTISAMPLE_NONE, 0, TRUE, &w.pDepth, NULL)) &&
+		FAILED(w.pDevice->CreateDepthStencilSurface(opt.width, opt.height, D3DFMT_D16,
+		D3DMULTISAMPLE_NONE, 0, TRUE, &w.pDepth, NULL)))
+		return false;
+	if (FAILED(w.pDevice->CreateOffscreenPlainSurface(opt.width, opt.height, D3DFMT_X8R8G8B8,
+		D3DPOOL_SYSTEMMEM, &w.pReadback, NULL)))
+		return false;
+	// SetRenderTarget()은 뷰포트도 렌더 타깃 전체로 맞춤
+	w.pDevice->SetRenderTarget(0, w.pTarget);
+	w.pDevice->SetDepthStencilSurface(w.pDepth);
+
+	if (!setupGame(w.game, pLevel))
+		return false;
+	if (!w.scene.create(w.pDevice, pLevel, w.game, opt.width, opt.height))
+		return false;
+	for (int p = 0; p < 2; p++) {
+		for (size_t i = 0; i < scores[p].size(); i++)
+			w.scene.prepareScore(w.pDevice, p + 1, scores[p][i]);
+	}
+	return true;
+}
+
+void destroyRenderWorker(RenderWorker& w)
+{
+	w.scene.destroy();
+	d3d::Release(w.pReadback);
+	d3d::Release(w.pDepth);
+	d3d::Release(w.pTarget);
+	d3d::Release(w.pDevice);
+	if (w.window != NULL) {
+		::DestroyWindow(w.window);
+		w.window = NULL;
+	}
+}
+
+// 샷 기록을 고정 프레임 빈도, 원하는 해상도로 실시간보다 빠르게 그려 파일로 씀
+// 시뮬레이션은 한 번만 하고, 스레드마다 자기 장치로 몇 프레임씩 가져가 그린 뒤
+// 프레임 번호 차례대로 CFrameWriter에 넘김. 입자 효과는 그리지 않음
+bool renderReplay(HINSTANCE hinstance, const RenderOptions& opt)
+{
+	std::vector<ReplayCommand> commands;
+	if (!loadShots(opt.pShots, commands))
+		return false;
+
+	CLevelFile level;
+	const CLevelFile* pLevel = NULL;
+	if (level.open(g_levelFile) && isSupportedLevel(level))
+		pLevel = &level;
+
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+	CGame game;
+	if (!setupGame(game, pLevel))
+		return false;
+	size_t frameSize = game.getCompactSize(game.getBallCount());
+	std::vector<unsigned char> frames;
+	std::vector<float> alphas;
+	simulateReplay(game, commands, opt.fps, frames, alphas, frameSize);
+	int frameCount = (int)alphas.size();
+
+	// 작업 스레드에서는 메쉬를 만들지 않으므로 기록에 나오는 점수를 모아 두었다가 장치마다 미리 만듦
+	std::vector<int> scores[2];
+	for (int f = 0; f < frameCount; f++) {
+		game.restoreCompact(&frames[(size_t)f * frameSize]);
+		for (int p = 0; p < 2; p++) {
+			int score = game.getScore(p + 1);
+			if (std::find(scores[p].begin(), scores[p].end(), score) == scores[p].end())
+				scores[p].push_back(score);
+		}
+	}
+
+	int threads = opt.threads > 0 ? opt.threads : (int)std::thread::hardware_concurrency();
+	if (threads < 1)
+		threads = 1;
+	if (threads > frameCount / RENDER_CHUNK + 1)
+		threads = frameCount / RENDER_CHUNK + 1;
+
+	// 장치와 텍스트 메쉬는 이 스레드에서 모두 만들고, 그리기만 작업 스레드에서
+	std::vector<std::unique_ptr<RenderWorker> > workers(threads);
+	bool ok = true;
+	for (int t = 0; t < threads && ok; t++) {
+		workers[t].reset(new RenderWorker());
+		RenderWorker& w = *workers[t];
+		w.window = NULL;
+		w.pDevice = NULL;
+		w.pTarget = w.pDepth = w.pReadback = NULL;
+		w.frames = 0;
+		ok = createRenderWorker(hinstance, w, pLevel, opt, scores);
+	}
+
+	CFrameWriter writer;
+	if (ok)
+		ok = writer.start(opt.pOut, opt.width, opt.height, threads * 2 + 2);
+
+	std::atomic<int> nextChunk(0);
+	std::mutex orderMutex;
+	std::condition_variable orderChanged;
+	int nextToWrite = 0;			// 다음에 쓸 프레임 번호
+
+	std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+	if (ok) {
+		CWorkerPool pool;
+		pool.start(threads);
+		pool.run([&](int thread) {
+			RenderWorker& w = *workers[thread];
+			// 덩어리를 번호 순으로 가져가므로 가장 앞선 프레임을 가진 스레드는 기다리지 않음
+			for (;;) {
+				int first = nextChunk.fetch_add(RENDER_CHUNK);
+				if (first >= frameCount)
+					break;
+				int last = std::min(first + RENDER_CHUNK, frameCount);
+				for (int f = first; f < last; f++) {
+					w.game.restoreCompact(&frames[(size_t)f * frameSize]);
+					w.pDevice->Clear(0, 0, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, 0x00afafaf, 1.0f, 0);
+					w.pDevice->BeginScene();
+					w.scene.draw(w.pDevice, w.game, g_mWorld, alphas[f]);
+					w.pDevice->EndScene();
+
+					D3DLOCKED_RECT locked;
+					bool read = SUCCEEDED(w.pDevice->GetRenderTargetData(w.pTarget, w.pReadback)) &&
+						SUCCEEDED(w.pReadback->LockRect(&locked, NULL, D3DLOCK_READONLY));
+
+					{
+						std::unique_lock<std::mutex> lock(orderMutex);
+						orderChanged.wait(lock, [&] { return nextToWrite == f; });
+					}
+					// 버퍼가 모자라면 쓰기 스레드를 기다림, 오프라인이므로 버리지 않음
+					unsigned char* pFrame = writer.acquire(true);
+					int pitch = writer.getPitch();
+					if (read) {
+						const unsigned char* pSrc = (const unsigned char*)locked.pBits;
+						for (int y = 0; y < opt.height; y++)
+							memcpy(pFrame + y * pitch, pSrc + y * locked.Pitch, pitch);
+						w.pReadback->UnlockRect();
+					}
+					else
+						memset(pFrame, 0, (size_t)pitch * opt.height);
+					writer.submit(pFrame);
+					w.frames++;
+					{
+						std::lock_guard<std::mutex> lock(orderMutex);
+						nextToWrite++;
+					}
+					orderChanged.notify_all();
+				}
+			}
+		});
+		writer.stop();
+	}
+	std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+
+	for (int t = 0; t < threads; t++) {
+		if (workers[t])
+			destroyRenderWorker(*workers[t]);
+	}
+	level.close();
+	if (!ok)
+		return false;
+
+	double simSeconds = std::chrono::duration<double>(t1 - t0).count();
+	double renderSeconds = std::chrono::duration<double>(t2 - t1).count();
+	double length = (double)frameCount / opt.fps;
+	CFrameWriter::Stats s = writer.getStats();
+	char buf[256];
+	sprintf_s(buf, sizeof(buf),
+		"[render] %s: %d frames (%.1f s at %d fps), %dx%d, %d threads | simulate %.2f s, render %.2f s, %.1fx real time | written %lld\n",
+		opt.pOut, frameCount, length, opt.fps, opt.width, opt.height, threads,
+		simSeconds, renderSeconds, renderSeconds > 0 ? length / renderSeconds : 0.0, s.framesWritten);
+	OutputDebugStringA(buf);
+	return s.framesWritten == frameCount;
+}
+
+LRESULT CALLBACK d3d::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	static bool wire = false;
+	static bool isReset = true;
+	static int old_x = 0;
+	static int old_y = 0;
+	static enum { WORLD_MOVE, LIGHT_MOVE, BLOCK_MOVE } move = WORLD_MOVE;
+
+	switch (msg) {
+	case WM_DESTROY:
+	{
+		::PostQuitMessage(0);
+		break;
+	}
+	case WM_PAINT:
+	{
+		g_sceneDirty = true;	// 창이 가려졌다가 다시 보이는 경우
+		break;
+	}
+	case WM_KEYDOWN:
+	{
+		g_sceneDirty = true;
+		switch (wParam) {
+		case VK_ESCAPE:
+			::DestroyWindow(hwnd);
+			break;
+		case 'B':
+			// ARKANOID 벽돌 켜기/끄기
+			g_game.toggleBricks();
+			g_shotLog += "bricks\n";
+			break;
+		case 'V':
+			toggleCapture();
+			break;
+		case VK_BACK:
+			// 마지막 샷 무르기, 친 자리와 조준이 그대로 돌아옴
+			if (g_game.takeBack())
+				unlogShot();
+			break;
+		case VK_RETURN:
+			if (NULL != Device) {
+				wire = !wire;
+				Device->SetRenderState(D3DRS_FILLMODE,
+					(wire ? D3DFILL_WIREFRAME : D3DFILL_SOLID));
+			}
+			break;
+		case VK_SPACE:
+			// 마우스 우클릭 + 흰 공이 멈춰있을 때만 당구채가 움직임
+			if (g_game.strike())
+				logShot();
+			break;
+		// 당점, 좌우는 회전(english), 위는 밀어치기, 아래는 끌어치기
+		case VK_LEFT:	g_game.moveTip(-1, 0); break;
+		case VK_RIGHT:	g_game.moveTip(1, 0); break;
+		case VK_UP:		g_game.moveTip(0, 1); break;
+		case VK_DOWN:	g_game.moveTip(0, -1); break;
+
+		}
+		break;
+	}
+
+	case WM_MOUSEMOVE:
+	{
+		int new_x = LOWORD(lParam);
+		int new_y = HIWORD(lParam);
+		float dx;
+		float dy;
+		bool wasTarget = g_game.isAiming();
+
+		// 카메라 회전이나 조준 중일 때만 다시 그림
+		if (LOWORD(wParam) & (MK_LBUTTON | MK_RBUTTON))
+			g_sceneDirty = true;
+
+		if (LOWORD(wParam) & MK_LBUTTON) {
+
+			g_game.cancelAim();		// 마우스 우클릭 해제
+
+			if (isReset) {
+				isReset = false;
+			}
+			else {
+				switch (move) {
+				case WORLD_MOVE:
+					dx = (old_x - new_x) * 0.01f;
+					dy = (old_y - new_y) * 0.01f;
+					g_mWorld = g_mWorld * Mat4::rotationY(dx) * Mat4::rotationX(dy);
+
+					break;
+				}
+			}
+
+			old_x = new_x;
+			old_y = new_y;
+
+		}
+		else {
+			isReset = true;
+
+			// 우클릭 중이면 파란 공을 옮기고 조준, 아니면 조준 해제
+			g_game.aim((LOWORD(wParam) & MK_RBUTTON) != 0, old_x - new_x, old_y - new_y);
+			old_x = new_x;
+			old_y = new_y;
+
+			move = WORLD_MOVE;
+		}
+		if (wasTarget != g_game.isAiming())
+			g_sceneDirty = true;	// 경로와 당구채 표시가 바뀜
+		break;
+	}
+	}
+
+	return ::DefWindowProc(hwnd, msg, wParam, lParam);
+}
+
+int WINAPI WinMain(HINSTANCE hinstance,
+	HINSTANCE prevInstance,
+	PSTR cmdLine,
+	int showCmd)
+{
+	srand(static_cast<unsigned int>(time(NULL)));
+	// 인자가 레벨 파일 하나면 창에서 게임, --render가 있으면 창 없이 샷 기록을 영상으로
+	//   [level] --render lastgame.shots [--out replay%05d.tga] [--size 1920x1080] [--fps 60] [--threads N]
+	if (cmdLine != NULL && strstr(cmdLine, "--render") != NULL) {
+		static std::vector<std::string> args;
+		for (const char* p = cmdLine; *p != '\0'; ) {
+			while (*p == ' ')
+				p++;
+			const char* end = p;
+			while (*end != '\0' && *end != ' ')
+				end++;
+			if (end != p)
+				args.push_back(std::string(p, end));
+			p = end;
+		}
+		RenderOptions opt = { NULL, "replay%05d.tga", 1920, 1080, RENDER_FPS, 0 };
+		for (size_t i = 0; i < args.size(); i++) {
+			const char* a = args[i].c_str();
+			bool more = i + 1 < args.size();
+			if (strcmp(a, "--render") == 0 && more)
+				opt.pShots = args[++i].c_str();
+			else if (strcmp(a, "--out") == 0 && more)
+				opt.pOut = args[++i].c_str();
+			else if (strcmp(a, "--size") == 0 && more)
+				sscanf(args[++i].c_str(), "%dx%d", &opt.width, &opt.height);
+			else if (strcmp(a, "--fps") == 0 && more)
+				opt.fps = atoi(args[++i].c_str());
+			else if (strcmp(a, "--threads") == 0 && more)
+				opt.threads = atoi(args[++i].c_str());
+			else if (a[0] != '-')
+				g_levelFile = a;
+		}
+		if (opt.pShots == NULL || opt.fps <= 0 || opt.width <= 0 || opt.height <= 0 ||
+			!renderReplay(hinstance, opt)) {
+			::MessageBox(0, "renderReplay() - FAILED", 0, 0);
+			return 1;
+		}
+		return 0;
+	}
+	if (cmdLine != NULL && cmdLine[0] != '\0')
+		g_levelFile = cmdLine;
+
+	if (!d3d::InitD3D(hinstance,
+		Width, Height, true, D3DDEVTYPE_HAL, &Device))
+	{
+		::MessageBox(0, "InitD3D() - FAILED", 0, 0);
+		return 0;
+	}
+
+	if (!Setup())
+	{
+		::MessageBox(0, "Setup() - FAILED", 0, 0);
+		return 0;
+	}
+
+	d3d::EnterMsgLoop(Display);
+
+	Cleanup();
+
+	Device->Release();
+
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: workerPool.cpp
+//
+// Desc: Worker threads woken once per run(), spin barriers inside a run.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "workerPool.h"
+#include <chrono>
+
+typedef std::chrono::steady_clock Clock;
+
+CWorkerPool::CWorkerPool(void)
+{
+	m_threadCount = 1;
+	m_stats.resize(1);
+	m_pJob = NULL;
+	m_jobId = 0;
+	m_quit = false;
+	m_running = 0;
+	m_arrived = 0;
+	m_sense = 0;
+	resetStats();
+}
+
+CWorkerPool::~CWorkerPool(void)
+{
+	stop();
+}
+
+void CWorkerPool::start(int threads)
+{
+	stop();
+	if (threads < 1)
+		threads = 1;
+	m_threadCount = threads;
+	m_stats.resize(threads);
+	resetStats();
+
+	// 이전 스레드는 stop()에서 모두 끝났으므로, 새 스레드가 지난 run()을 새 일로 보지 않게 번호를 처음으로
+	m_pJob = NULL;
+	m_jobId = 0;
+	m_quit = false;
+	for (int i = 1; i < threads; i++)
+		m_threads.push_back(std::thread(&CWorkerPool::workerMain, this, i));
+}
+
+void CWorkerPool::stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_all();
+	for (size_t i = 0; i < m_threads.size(); i++)
+		m_threads[i].join();
+	m_threads.clear();
+	m_threadCount = 1;
+	m_stats.resize(1);
+}
+
+void CWorkerPool::resetStats(void)
+{
+	for (size_t i = 0; i < m_stats.size(); i++) {
+		m_stats[i].busySeconds = 0;
+		m_stats[i].waitSeconds = 0;
+	}
+}
+
+void CWorkerPool::run(const std::function<void(int)>& job)
+{
+	if (m_threadCount == 1) {
+		m_pJob = &job;
+		runJob(0);
+		m_pJob = NULL;
+		return;
+	}
+
+	m_running = m_threadCount - 1;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pJob = &job;
+		m_jobId++;
+	}
+	m_wake.notify_all();
+
+	runJob(0);
+	// 남은 스레드는 보통 바로 끝나므로 잠들지 않고 양보만 함
+	while (m_running.load(std::memory_order_acquire) != 0)
+		std::this_thread::yield();
+	m_pJob = NULL;
+}
+
+void CWorkerPool::runJob(int thread)
+{
+	ThreadStats& stats = m_stats[thread];
+	double waitBefore = stats.waitSeconds;
+	Clock::time_point t0 = Clock::now();
+	(*m_pJob)(thread);
+	double total = std::chrono::duration<double>(Clock::now() - t0).count();
+	stats.busySeconds += total - (stats.waitSeconds - waitBefore);
+}
+
+void CWorkerPool::workerMain(int thread)
+{
+	unsigned int seen = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&]() { return m_quit || m_jobId != seen; });
+			if (m_quit)
+				return;
+			seen = m_jobId;
+		}
+		runJob(thread);
+		m_running.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+// 마지막으로 도착한 스레드가 방향을 뒤집어 나머지를 풀어 줌
+// 스레드가 코어보다 많아도 멈추지 않도록 기다리는 동안 양보함
+void CWorkerPool::barrier(int thread)
+{
+	if (m_threadCount == 1)
+		return;
+
+	Clock::time_point t0 = Clock::now();
+	int sense = m_sense.load(std::memory_order_relaxed);
+	if (m_arrived.fetch_add(1, std::memory_order_acq_rel) == m_threadCount - 1) {
+		m_arrived.store(0, std::memory_order_relaxed);
+		m_sense.store(sense ^ 1, std::memory_order_release);
+	}
+	else {
+		while (m_sense.load(std::memory_order_acquire) == sense)
+			std::this_thread::yield();
+	}
+	m_stats[thread].waitSeconds += std::chrono::duration<double>(Clock::now() - t0).count();
+}
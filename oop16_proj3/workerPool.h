@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////////////
+//
+// File: workerPool.h
+//
+// Desc: Small fixed pool of worker threads for the physics. run() hands
+//       the same job to every thread (the calling thread is thread 0) and
+//       returns when all of them are done; inside the job, barrier() lines
+//       the threads up between phases that depend on each other. One run()
+//       per solve keeps the thread wake-up cost out of the inner loops.
+//       Time spent working and waiting at barriers is kept per thread.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __workerPoolH__
+#define __workerPoolH__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CWorkerPool {
+public:
+	struct ThreadStats {
+		double	busySeconds;		// run() 안에서 일한 시간 (barrier 대기 제외)
+		double	waitSeconds;		// barrier()에서 기다린 시간
+	};
+
+	CWorkerPool(void);
+	~CWorkerPool(void);
+
+	// 호출한 스레드를 포함해 threads개로 일함, 1이면 스레드를 만들지 않음
+	void start(int threads);
+	void stop(void);
+	int getThreadCount(void) const { return m_threadCount; }
+
+	// 모든 스레드에서 job(thread)을 실행하고 끝날 때까지 기다림
+	void run(const std::function<void(int)>& job);
+	// job 안에서만 호출, 모든 스레드가 도착할 때까지 기다림
+	void barrier(int thread);
+
+	const ThreadStats& getStats(int thread) const { return m_stats[thread]; }
+	void resetStats(void);
+
+private:
+	CWorkerPool(const CWorkerPool&);
+	CWorkerPool& operator=(const CWorkerPool&);
+
+	void workerMain(int thread);
+	void runJob(int thread);
+
+	int								m_threadCount;
+	std::vector<std::thread>		m_threads;
+	std::vector<ThreadStats>		m_stats;
+
+	// run()에서 일을 나눠 주는 부분, 일이 없는 동안 작업 스레드는 잠들어 있음
+	std::mutex						m_mutex;
+	std::condition_variable			m_wake;
+	const std::function<void(int)>*	m_pJob;
+	unsigned int					m_jobId;		// run()마다 증가
+	bool							m_quit;
+	std::atomic<int>				m_running;		// 아직 끝나지 않은 작업 스레드 수
+
+	// 방향을 뒤집는 spin barrier
+	std::atomic<int>				m_arrived;
+	std::atomic<int>				m_sense;
+};
+
+#endif // __workerPoolH__